@@ -44,6 +44,8 @@ struct EdgeAppLibColor {
 #define AITRIOS_COLOR_GREEN ((struct EdgeAppLibColor){0x00, 0xFF, 0x00})
 #define AITRIOS_COLOR_BLUE ((struct EdgeAppLibColor){0x00, 0x00, 0xFF})
 
+#define AITRIOS_DRAW_MAX_THREADS 8 /**< Maximum of SetDrawThreads */
+
 /**
  * @enum EdgeAppLibDrawFormat
  * @brief
@@ -52,6 +54,12 @@ enum EdgeAppLibDrawFormat {
   AITRIOS_DRAW_FORMAT_UNDEFINED = 0,
   AITRIOS_DRAW_FORMAT_RGB8, /**< RGB, 8-bits per component, interleaved */
   AITRIOS_DRAW_FORMAT_RGB8_PLANAR, /**< RGB, 8-bits per component, planar */
+  AITRIOS_DRAW_FORMAT_BGR8,  /**< BGR, 8-bits per component, interleaved */
+  AITRIOS_DRAW_FORMAT_GRAY8, /**< Grayscale, 8-bits per pixel */
+  AITRIOS_DRAW_FORMAT_NV12,  /**< YUV 4:2:0, Y plane then interleaved UV plane,
+                                BT.601 limited range */
+  AITRIOS_DRAW_FORMAT_I420,  /**< YUV 4:2:0, Y, U and V planes, BT.601
+                                limited range */
 };
 
 /**
@@ -67,6 +75,13 @@ struct EdgeAppLibDrawBuffer {
   uint32_t stride_byte;             /**< image stride in bytes */
 };
 
+/*
+ * Plane layout: RGB8_PLANAR is 3 planes of stride_byte * height bytes. NV12
+ * and I420 need an even width and height; their chroma planes follow the Y
+ * plane with stride_byte bytes per row (NV12) or stride_byte / 2 (I420), on
+ * height / 2 rows. A stride_byte of zero is the packed row size.
+ */
+
 /**
  * @brief Draw a rectangle outline on an image buffer.
  *
@@ -99,7 +114,8 @@ int32_t DrawRectangle(struct EdgeAppLibDrawBuffer *buffer, uint32_t left,
  * @return Zero for success or negative value for failure
  *
  * @details If the rectangle is not fully inside the image bounds, the rectangle
- * is clamped to the image bounds.
+ * is clamped to the image bounds. If the formats differ, the pixels are
+ * converted as in ConvertFormat in the same pass.
  */
 
 int32_t CropRectangle(struct EdgeAppLibDrawBuffer *src,
@@ -112,13 +128,160 @@ int32_t CropRectangle(struct EdgeAppLibDrawBuffer *src,
  * @param[out] dst Destination image buffer to store the resized image.
  * @return Zero for success or negative value for failure
  * @details If the source and destination sizes are the same, the image data
- * is copied directly without resizing.
- * Supported formats: AITRIOS_DRAW_FORMAT_RGB8, AITRIOS_DRAW_FORMAT_RGB8_PLANAR
+ * is copied directly without resizing. Downscales of 2x or more in both
+ * directions average the source pixels of each destination pixel instead.
+ * If the formats differ, the pixels are converted as in ConvertFormat in the
+ * same pass. Same-format resizes support AITRIOS_DRAW_FORMAT_RGB8,
+ * AITRIOS_DRAW_FORMAT_RGB8_PLANAR, AITRIOS_DRAW_FORMAT_BGR8 and
+ * AITRIOS_DRAW_FORMAT_GRAY8.
  */
 
 int32_t ResizeRectangle(const struct EdgeAppLibDrawBuffer *src,
                         struct EdgeAppLibDrawBuffer *dst);
 
+/**
+ * @struct EdgeAppLibLetterbox
+ * @brief Placement of an image resized with its aspect ratio preserved.
+ * @details A destination pixel (x, y) of the image maps to the source pixel
+ * ((x - left) / scale, (y - top) / scale).
+ */
+struct EdgeAppLibLetterbox {
+  float scale;     /**< destination pixels per source pixel */
+  uint32_t left;   /**< left padding in pixels */
+  uint32_t top;    /**< top padding in pixels */
+  uint32_t width;  /**< resized image width in pixels */
+  uint32_t height; /**< resized image height in pixels */
+};
+
+/**
+ * @brief Compute the placement of a letterbox resize.
+ * @param[in] src_width Source width in pixels.
+ * @param[in] src_height Source height in pixels.
+ * @param[in] dst_width Destination width in pixels.
+ * @param[in] dst_height Destination height in pixels.
+ * @param[out] letterbox Placement of the resized image, centered in the
+ * destination. All zero when a size is zero.
+ */
+void ComputeLetterbox(uint32_t src_width, uint32_t src_height,
+                      uint32_t dst_width, uint32_t dst_height,
+                      struct EdgeAppLibLetterbox *letterbox);
+
+/**
+ * @brief Resize an image buffer preserving its aspect ratio.
+ * @param[in] src Source image buffer to resize from.
+ * @param[out] dst Destination image buffer to store the resized image.
+ * @param[in] pad Color of the destination pixels outside of the image.
+ * @param[out] letterbox Placement of the image in |dst|, or NULL.
+ * @return Zero for success or negative value for failure
+ * @details The image is scaled to fit |dst| and centered, as placed by
+ * ComputeLetterbox, then resized as in ResizeRectangle.
+ */
+int32_t LetterboxRectangle(const struct EdgeAppLibDrawBuffer *src,
+                           struct EdgeAppLibDrawBuffer *dst,
+                           struct EdgeAppLibColor pad,
+                           struct EdgeAppLibLetterbox *letterbox);
+
+/**
+ * @brief Convert an image buffer to another pixel format.
+ * @param[in] src Source image buffer, of any format.
+ * @param[out] dst Destination image buffer of the same size.
+ * @return Zero for success or negative value for failure
+ * @details Destination formats: AITRIOS_DRAW_FORMAT_RGB8,
+ * AITRIOS_DRAW_FORMAT_RGB8_PLANAR, AITRIOS_DRAW_FORMAT_BGR8 and
+ * AITRIOS_DRAW_FORMAT_GRAY8. Grayscale is the BT.601 luma of the pixels and
+ * each chroma sample of a YUV source applies to its 2x2 block of pixels.
+ */
+int32_t ConvertFormat(const struct EdgeAppLibDrawBuffer *src,
+                      struct EdgeAppLibDrawBuffer *dst);
+
+/**
+ * @struct EdgeAppLibDrawBox
+ * @brief Rectangle outline drawn by DrawPrimitives.
+ */
+struct EdgeAppLibDrawBox {
+  uint32_t left;                /**< left side coordinate in pixels */
+  uint32_t top;                 /**< top side coordinate in pixels */
+  uint32_t right;               /**< right side coordinate in pixels */
+  uint32_t bottom;              /**< bottom side coordinate in pixels */
+  struct EdgeAppLibColor color; /**< outline color */
+  uint32_t thickness; /**< outline width in pixels, inside the box, 0 is 1 */
+};
+
+/**
+ * @struct EdgeAppLibDrawMask
+ * @brief Rectangle filled with a color drawn by DrawPrimitives.
+ * @details Each pixel is blended with the color by alpha * mask / 255, where
+ * mask is the pixel coverage from 0 (none) to 255 (full).
+ */
+struct EdgeAppLibDrawMask {
+  uint32_t left;        /**< left side coordinate in pixels */
+  uint32_t top;         /**< top side coordinate in pixels */
+  uint32_t width;       /**< width in pixels */
+  uint32_t height;      /**< height in pixels */
+  const uint8_t *mask;  /**< width x height coverage, NULL for full */
+  uint32_t mask_stride; /**< mask stride in bytes */
+  struct EdgeAppLibColor color; /**< fill color */
+  uint8_t alpha; /**< opacity, from 0 (transparent) to 255 (opaque) */
+};
+
+/**
+ * @struct EdgeAppLibDrawLabel
+ * @brief Text drawn by DrawPrimitives.
+ * @details Characters are drawn with a 3x5 pixel font, 4 pixels apart, scaled
+ * by |scale|. Lowercase letters are drawn as uppercase and characters without
+ * a glyph as '?'.
+ */
+struct EdgeAppLibDrawLabel {
+  uint32_t left;                /**< left side coordinate in pixels */
+  uint32_t top;                 /**< top side coordinate in pixels */
+  const char *text;             /**< null-terminated ASCII text */
+  struct EdgeAppLibColor color; /**< text color */
+  uint32_t scale;               /**< pixel size of the font, 0 is 1 */
+};
+
+/**
+ * @struct EdgeAppLibDrawPrimitives
+ * @brief Primitives drawn together by DrawPrimitives.
+ */
+struct EdgeAppLibDrawPrimitives {
+  const struct EdgeAppLibDrawBox *boxes;
+  uint32_t num_boxes;
+  const struct EdgeAppLibDrawMask *masks;
+  uint32_t num_masks;
+  const struct EdgeAppLibDrawLabel *labels;
+  uint32_t num_labels;
+};
+
+/**
+ * @brief Draw boxes, masks and labels on an image buffer in one pass.
+ * @param[in] buffer Image to draw in.
+ * @param[in] primitives Primitives to draw.
+ * @return Zero for success or negative value for failure
+ * @details Masks are drawn first, then boxes and labels, each in array order.
+ * The rows of the image are visited once, which is faster than drawing the
+ * primitives one by one for overlays of many objects. Boxes are clamped to the
+ * image bounds as in DrawRectangle, which draws the same pixels as a box of
+ * thickness 1; boxes with left > right or top > bottom are skipped. Masks and
+ * labels are clipped. Supports AITRIOS_DRAW_FORMAT_RGB8,
+ * AITRIOS_DRAW_FORMAT_RGB8_PLANAR and AITRIOS_DRAW_FORMAT_BGR8.
+ */
+int32_t DrawPrimitives(struct EdgeAppLibDrawBuffer *buffer,
+                       const struct EdgeAppLibDrawPrimitives *primitives);
+
+/**
+ * @brief Set the number of threads used by the draw operations.
+ * @param[in] num_threads Number of threads, the calling thread included, from
+ * 1 (default, single-threaded) to AITRIOS_DRAW_MAX_THREADS.
+ * @return Zero for success or negative value for failure
+ * @details CropRectangle, ResizeRectangle, LetterboxRectangle and
+ * ConvertFormat split large images into horizontal stripes processed in
+ * parallel by a shared pool of worker threads. Results do not depend on the
+ * number of threads. An operation started while the pool is busy with another
+ * one, small operations and builds without thread support run on the calling
+ * thread.
+ */
+int32_t SetDrawThreads(uint32_t num_threads);
+
 #ifdef __cplusplus
 }
 #endif
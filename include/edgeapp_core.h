@@ -45,21 +45,84 @@ typedef enum {
 
 typedef enum { edge_cpu, edge_gpu, edge_npu, edge_imx500 } EdgeAppCoreTarget;
 
+typedef enum {
+  EdgeAppCoreLayoutNHWC = 0, /**< Interleaved channels. */
+  EdgeAppCoreLayoutNCHW = 1  /**< Planar channels. */
+} EdgeAppCoreTensorLayout;
+
+typedef enum {
+  EdgeAppCoreResizeStretch = 0,   /**< Scale each side to the input size. */
+  EdgeAppCoreResizeLetterbox = 1  /**< Preserve the aspect ratio, pad. */
+} EdgeAppCoreResizeMode;
+
+// Built-in preprocessing for CPU/GPU/NPU models.
+// When set in EdgeAppCoreModelInfo, Process crops the ROI, resizes it
+// (bilinear) to width x height, normalizes it with mean/norm values and writes
+// it in the requested layout and type in a single pass, replacing the
+// preprocess callback chain. Normalization only applies to float32 output.
+// In letterbox mode the ROI keeps its aspect ratio and the rest of the input
+// is filled with pad_value (before normalization).
+struct EdgeAppCorePreprocessInfo {
+  uint32_t width;                         ///< Model input width
+  uint32_t height;                        ///< Model input height
+  EdgeAppCoreTensorLayout layout;         ///< Model input layout
+  EdgeAppLib::EdgeAppLibTensorType type;  ///< TensorTypeFloat32 or UInt8
+  EdgeAppCoreResizeMode resize = EdgeAppCoreResizeStretch;
+  uint8_t pad_value = 114;  ///< Component value of the letterbox padding
+};
+
+// Mapping of the model input of a frame to its RAW_IMAGE pixels: a model
+// input pixel (x, y) comes from the frame pixel
+// (origin_x + (x - pad_x) / scale_x, origin_y + (y - pad_y) / scale_y).
+// Set on output tensors, see MapPointsToFrame.
+struct EdgeAppCoreInputTransform {
+  float scale_x = 1.0f;  ///< Model input pixels per frame pixel
+  float scale_y = 1.0f;
+  float pad_x = 0.0f;  ///< Letterbox padding in model input pixels
+  float pad_y = 0.0f;
+  float origin_x = 0.0f;  ///< ROI origin in frame pixels
+  float origin_y = 0.0f;
+  uint32_t input_width = 0;  ///< Model input size
+  uint32_t input_height = 0;
+};
+
+// Change gating for CPU/GPU/NPU models (see SetChangeGate).
+// Process compares a small signature of each frame with the one of the frame
+// the current outputs were inferred from, and skips the inference when they
+// differ by less than threshold. The outputs are then returned again, with
+// Tensor::reused set.
+struct EdgeAppCoreChangeGate {
+  float threshold;      ///< Mean absolute difference (0-255) to infer again
+  uint32_t max_reused;  ///< Frames reused in a row, 0 for no limit
+};
+
 struct EdgeAppCoreModelInfo {
   const char *model_name;    ///< Name of the model
   EdgeAppCoreTarget target;  ///< Target for the tensor
   const std::vector<float> *mean_values;
   const std::vector<float> *norm_values;
+  const EdgeAppCorePreprocessInfo *preprocess;  ///< Optional, may be nullptr
+  uint32_t concurrent_contexts;  ///< Contexts for ComputeConcurrent, 0 if none
+  bool quantized_input;          ///< Feed uint8 input to the model as is
 };
 
 #define MAX_GRAPH_CONTEXTS 8
 #define MAX_OUTPUT_TENSORS_SIZE 512 * 1024  // 500KB for output tensors
 #define MAX_OUTPUT_TENSOR_NUM 4
+#define MAX_PIPELINE_DEPTH 4          // Frames in flight with ProcessAsync
+#define MAX_BATCH_ROIS 8              // ROIs in a single batched Process
+#define MAX_OUTPUT_LAYOUT_TENSORS 16  // IMX500 output tensors in a layout
+#define MAX_CACHED_MODELS 4           // Models kept resident by the cache
+#define MAX_CASCADE_STAGES 8          // Stages of a cascade
+#define MAX_CASCADE_WORKERS 8         // Worker threads of a cascade
+#define MAX_CASCADE_QUEUE 64          // Queued ROIs of a cascade
+#define MAX_CASCADE_ROIS 16           // ROIs a stage derives from one output
 
 enum TensorMemoryOwner {
   Unknown,
   Sensor,  // memory ownership is with Sensor/host
-  App      // memory ownership is with the application
+  App,     // memory ownership is with the application
+  Core     // memory ownership is with EdgeAppCore (pooled per context)
 };
 
 // Structure to hold temporary tensor information
@@ -72,6 +135,137 @@ struct TempTensorInfo {
   uint64_t timestamp = 0;  ///< Timestamp for the tensor
   TensorMemoryOwner memory_owner =
       TensorMemoryOwner::Unknown;  ///< Memory ownership of the tensor
+  EdgeAppLib::EdgeAppLibTensorType type =
+      EdgeAppLib::TensorTypeUInt8;  ///< Element type of the buffer
+  EdgeAppCoreTensorLayout layout = EdgeAppCoreLayoutNHWC;
+  uint32_t batch = 1;  ///< Images in the buffer (dims[0])
+  EdgeAppCoreInputTransform transform;  ///< Of the last image of the buffer
+};
+
+// Structure to hold the model input binding of a CPU/GPU/NPU context
+// The binding is created on the first frame and reused while the input shape,
+// type and normalization stay the same, so that setting the input of a frame
+// does not allocate.
+struct InputBindingState {
+  EdgeAppLib::EdgeAppLibInputBinding *binding = nullptr;
+  uint32_t dims[4] = {0};
+  EdgeAppLib::EdgeAppLibTensorType type = EdgeAppLib::TensorTypeFloat32;
+  bool normalize = false;  ///< uint8 source normalized to float32
+};
+
+// Structure to hold pooled output tensors
+// The pool is sized once from the real output sizes reported after the first
+// Compute and reused for every following frame. Tensors returned by
+// GetOutput/GetOutputs for CPU/NPU targets are views into this buffer and stay
+// valid until the next Process on the same context, ReleaseOutputs or
+// UnloadModel.
+struct OutputTensorPool {
+  uint8_t *buffer = nullptr;
+  size_t capacity = 0;                            ///< Allocated size in bytes
+  uint32_t num_tensors = 0;                       ///< Tensor slots in the pool
+  uint32_t fetched = 0;                           ///< Slots filled this frame
+  uint32_t offsets[MAX_OUTPUT_TENSOR_NUM] = {0};  ///< Slot offsets in bytes
+  uint32_t sizes[MAX_OUTPUT_TENSOR_NUM] = {0};    ///< Slot sizes in bytes
+};
+
+// Caller-provided destination of a CPU/GPU/NPU output tensor.
+// Registered once with SetOutputDestinations; GetOutputsInto then writes the
+// tensor straight into |buffer|. When channels, height and width are set, the
+// output is taken as the other layout of |layout| ([C,H,W] for NHWC, [H,W,C]
+// for NCHW) and transposed into |layout| while it is written.
+struct EdgeAppCoreOutputDestination {
+  float *buffer;                   ///< Caller-owned destination
+  size_t capacity;                 ///< Size of |buffer| in bytes
+  EdgeAppCoreTensorLayout layout;  ///< Layout to write the tensor in
+  uint32_t channels;               ///< Optional, 0 keeps the model layout
+  uint32_t height;
+  uint32_t width;
+};
+
+// Structure to hold the compiled layout of the IMX500 output tensors
+// Built once from the tensor shapes property of the network and reused for
+// every frame, so GetOutput/GetOutputs only add offsets to the output address.
+// It is compiled again after LoadModel or InvalidateOutputLayout, when the
+// settings generation changes (another network selected) or when the output
+// size of the network changes.
+struct OutputTensorLayout {
+  bool valid = false;
+  uint32_t num_tensors = 0;
+  size_t raw_size = 0;      ///< Output size the layout was compiled for
+  uint32_t generation = 0;  ///< Settings generation it was compiled for
+  uint32_t offsets[MAX_OUTPUT_LAYOUT_TENSORS] = {0};  ///< Offsets in bytes
+  uint32_t sizes[MAX_OUTPUT_LAYOUT_TENSORS] = {0};    ///< Sizes in bytes
+  uint32_t ndims[MAX_OUTPUT_LAYOUT_TENSORS] = {0};    ///< Kept dimensions
+  uint32_t dims[MAX_OUTPUT_LAYOUT_TENSORS][MAX_TENSOR_DIMS] = {};
+};
+
+// Structure to hold the state of a batched (multi-ROI) Process
+// With built-in preprocessing, all ROIs are written into one N-batched input
+// and run with a single Compute; each output tensor is then split into N
+// equal parts. Models that reject a batched input fall back to one Compute
+// per ROI, whose outputs are gathered in |outputs|.
+struct BatchState {
+  uint32_t num_rois = 0;        ///< ROIs of the last Process, 0 if not batched
+  uint32_t num_tensors = 0;     ///< Output tensors per ROI
+  bool native = false;          ///< Outputs are slices of the output pool
+  bool unsupported = false;     ///< Model rejected a batched input
+  uint8_t *input = nullptr;     ///< N-batched input buffer
+  size_t input_capacity = 0;    ///< Allocated size in bytes
+  uint8_t *outputs = nullptr;   ///< Per-ROI outputs of the fallback loop
+  size_t outputs_capacity = 0;  ///< Allocated size in bytes
+  uint32_t offsets[MAX_BATCH_ROIS][MAX_OUTPUT_TENSOR_NUM] = {};
+  uint32_t sizes[MAX_BATCH_ROIS][MAX_OUTPUT_TENSOR_NUM] = {};
+  EdgeAppCoreInputTransform transforms[MAX_BATCH_ROIS];
+};
+
+namespace EdgeAppCore {
+enum TensorDataType : uint8_t;
+struct PreprocessPlan;
+struct FramePipeline;
+struct GraphContextPool;
+struct Cascade;
+struct ChangeGate;
+struct CachedModel;
+struct StageStats;
+}  // namespace EdgeAppCore
+
+// Element type and quantization of a CPU/GPU/NPU output tensor.
+// Registered with SetOutputQuantization for models with int8/uint8/float16
+// outputs. The tensors returned by GetOutput/GetOutputs then keep their
+// element type, and the real values of integer tensors are
+// scale * (q - zero_point). They are only converted to float when the caller
+// asks for it, with DequantizeTensor or GetOutputsInto.
+struct EdgeAppCoreQuantization {
+  EdgeAppCore::TensorDataType type;  ///< Element type of the tensor
+  float scale;                       ///< 0 if the values are not quantized
+  int32_t zero_point;
+};
+
+// Stages measured by the built-in latency statistics (see GetStats).
+typedef enum {
+  EdgeAppCoreStageGetFrame = 0, /**< SensorGetFrame. */
+  EdgeAppCoreStageGetRawData,   /**< Raw image of the frame. */
+  EdgeAppCoreStageCrop,         /**< ROI crop of the raw image. */
+  EdgeAppCoreStagePreprocess,   /**< Preprocess callback or built-in. */
+  EdgeAppCoreStageSetInput,     /**< Model input. */
+  EdgeAppCoreStageCompute,      /**< Inference. */
+  EdgeAppCoreStageGetOutput,    /**< Output tensors of the frame. */
+  EdgeAppCoreStageSendInput,    /**< SendInputTensor. */
+  EdgeAppCoreStageNum
+} EdgeAppCoreStage;
+
+// Latency of one stage. Percentiles cover the last 1024 to 2048 samples and
+// are upper bounds of histogram buckets (within 25%).
+struct EdgeAppCoreStageStats {
+  uint64_t count;   ///< Samples since LoadModel or ResetStats
+  uint32_t p50_us;  ///< Median, in microseconds
+  uint32_t p95_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+};
+
+struct EdgeAppCoreStats {
+  EdgeAppCoreStageStats stages[EdgeAppCoreStageNum];
 };
 
 typedef struct {
@@ -80,9 +274,32 @@ typedef struct {
   EdgeAppLibGraphContext *graph_ctx; /**< Multiple graph execution contexts. */
   EdgeAppCoreTarget target;          /**< Target for each graph context. */
   TempTensorInfo temp_input;
-  uint32_t model_idx; /**< Count of loaded models. */
+  OutputTensorPool output_pool;     /**< Reusable output tensor storage. */
+  InputBindingState input_binding;  /**< Reusable model input. */
+  BatchState batch;                 /**< Multi-ROI Process state. */
+  OutputTensorLayout output_layout; /**< IMX500 output layout. */
+  EdgeAppCoreOutputDestination output_dests[MAX_OUTPUT_TENSOR_NUM] =
+      {}; /**< Registered output destinations. */
+  uint32_t num_output_dests = 0;
+  EdgeAppCoreQuantization output_quant[MAX_OUTPUT_TENSOR_NUM] =
+      {}; /**< Registered output element types. */
+  uint32_t num_output_quant = 0;
+  bool quantized_input = false; /**< uint8 input is fed as is. */
+  uint32_t model_idx;               /**< Count of loaded models. */
   const std::vector<float> *mean_values;
   const std::vector<float> *norm_values;
+  EdgeAppCore::PreprocessPlan *preprocess =
+      nullptr; /**< Built-in preprocessing (optional). */
+  EdgeAppCore::FramePipeline *pipeline =
+      nullptr; /**< Frame prefetch pipeline (optional). */
+  EdgeAppCore::GraphContextPool *context_pool =
+      nullptr; /**< Contexts for ComputeConcurrent (optional). */
+  EdgeAppCore::CachedModel *cached_model =
+      nullptr; /**< Model cache entry (optional). */
+  EdgeAppCore::StageStats *stats =
+      nullptr; /**< Stage latency statistics. */
+  EdgeAppCore::ChangeGate *change_gate =
+      nullptr; /**< Change gating state (optional). */
 } EdgeAppCoreCtx;
 
 namespace EdgeAppCore {
@@ -92,7 +309,8 @@ enum TensorDataType : uint8_t {
   TensorTypeFloat32 = 1,
   TensorTypeUInt8 = 2,
   TensorTypeInt32 = 3,
-  TensorTypeInt64 = 4
+  TensorTypeInt64 = 4,
+  TensorTypeInt8 = 5  ///< Passed to the runtime as uint8 bytes
   // Extend as needed
 };
 
@@ -118,13 +336,26 @@ struct Tensor {
   char name[64] = {0};  ///< Optional name for the tensor
   EdgeAppLibDrawFormat format = AITRIOS_DRAW_FORMAT_UNDEFINED;
   TensorMemoryOwner memory_owner = TensorMemoryOwner::Unknown;
+  float scale = 0.0f;  ///< Quantization scale, 0 if not quantized
+  int32_t zero_point = 0;
+  bool reused = false;  ///< Outputs of an earlier frame (change gating)
+  EdgeAppCoreInputTransform transform;  ///< Model input to frame pixels
+
+  bool IsQuantized() const { return scale != 0.0f; }
 
+  // Raw element access. Quantized and float16 tensors are not converted here,
+  // use DequantizeTensor to read them as float.
   template <typename T>
   T *DataAs() {
     if constexpr (std::is_same<T, float>::value) {
       return (type == TensorTypeFloat32) ? static_cast<T *>(data) : nullptr;
     } else if constexpr (std::is_same<T, uint8_t>::value) {
       return (type == TensorTypeUInt8) ? static_cast<T *>(data) : nullptr;
+    } else if constexpr (std::is_same<T, int8_t>::value) {
+      return (type == TensorTypeInt8) ? static_cast<T *>(data) : nullptr;
+    } else if constexpr (std::is_same<T, uint16_t>::value) {
+      // float16 bit patterns
+      return (type == TensorTypeFloat16) ? static_cast<T *>(data) : nullptr;
     } else if constexpr (std::is_same<T, int32_t>::value) {
       return (type == TensorTypeInt32) ? static_cast<T *>(data) : nullptr;
     } else {
@@ -311,6 +542,14 @@ class ProcessedFrame {
 
   ProcessedFrame compute();
 
+  // Gives up the ownership of the frame, which is then not released with this
+  // object. For frames owned by another ProcessedFrame, such as the frame of
+  // the root stage that the other stages of a cascade run on.
+  ProcessedFrame &disown() {
+    owns_frame_ = false;
+    return *this;
+  }
+
   bool empty() const {
     if (!is_computed_) {
       return true;
@@ -337,6 +576,35 @@ class ProcessedFrame {
   bool owns_frame_ = false;  // If true, destructor will release the frame
 };
 
+// Derives the ROIs of a cascade stage from the outputs of its parent stage for
+// |parent_roi|. Returns the number of ROIs written to |rois|.
+typedef uint32_t (*CascadeRoiSource)(
+    const Tensor *outputs, uint32_t num_outputs,
+    const EdgeAppLibSensorImageCropProperty &parent_roi,
+    EdgeAppLibSensorImageCropProperty *rois, uint32_t max_rois,
+    void *user_data);
+// Receives the outputs of a cascade stage for one ROI. Called from the worker
+// threads of the cascade. A failure skips the child stages of the ROI.
+typedef EdgeAppCoreResult (*CascadeSink)(
+    uint32_t stage, EdgeAppLibSensorFrame frame,
+    const EdgeAppLibSensorImageCropProperty &roi, const Tensor *outputs,
+    uint32_t num_outputs, void *user_data);
+
+// Stage of a cascade. Stage 0 is the root and runs on the whole frame; every
+// other stage runs on the ROIs its roi_source derives from its parent, which
+// must come before it. ROIs of a stage run in parallel on its contexts, each
+// of them loaded with the model of the stage.
+struct CascadeStage {
+  EdgeAppCoreCtx *contexts;     ///< Array of num_contexts loaded contexts
+  uint32_t num_contexts;        ///< 1 to MAX_GRAPH_CONTEXTS
+  EdgeAppCoreCtx *shared_ctx;   ///< Context of the sensor stream
+  int32_t parent;               ///< Parent stage, -1 for the root
+  uint32_t num_outputs;         ///< Output tensors, 1 to MAX_OUTPUT_TENSOR_NUM
+  CascadeRoiSource roi_source;  ///< Required except for the root
+  CascadeSink sink;             ///< Optional
+  void *user_data;              ///< Passed to roi_source and sink
+};
+
 // C++ only APIs
 EdgeAppCoreResult LoadModel(EdgeAppCoreModelInfo models, EdgeAppCoreCtx &ctx,
                             EdgeAppCoreCtx *shared_ctx);
@@ -345,16 +613,79 @@ ProcessedFrame Process(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
 ProcessedFrame Process(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
                        EdgeAppLibSensorFrame frame,
                        EdgeAppLibSensorImageCropProperty &roi);
+ProcessedFrame Process(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
+                       EdgeAppLibSensorFrame frame,
+                       const EdgeAppLibSensorImageCropProperty *rois,
+                       uint32_t num_rois);
 Tensor GetOutput(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame,
                  uint32_t max_tensor_num = 1);
 std::vector<Tensor> GetOutputs(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame,
                                uint32_t max_tensor_num);
 Tensor GetInput(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame);
+EdgeAppCoreResult ReleaseOutputs(EdgeAppCoreCtx &ctx);
+EdgeAppCoreResult InvalidateOutputLayout(EdgeAppCoreCtx &ctx);
+EdgeAppCoreResult SetOutputDestinations(
+    EdgeAppCoreCtx &ctx, const EdgeAppCoreOutputDestination *destinations,
+    uint32_t num_tensors);
+EdgeAppCoreResult GetOutputsInto(EdgeAppCoreCtx &ctx,
+                                 EdgeAppLibSensorFrame frame, Tensor *outputs,
+                                 uint32_t num_tensors);
+EdgeAppCoreResult SetOutputQuantization(
+    EdgeAppCoreCtx &ctx, const EdgeAppCoreQuantization *quantization,
+    uint32_t num_tensors);
+EdgeAppCoreResult DequantizeTensor(const Tensor &tensor, float *dst,
+                                   size_t capacity);
+// Maps |num_points| (x, y) pairs of model input coordinates of |tensor|, in
+// place, to frame pixels. Normalized points are fractions of the input size.
+EdgeAppCoreResult MapPointsToFrame(const Tensor &tensor, float *points,
+                                   size_t num_points, bool normalized);
+EdgeAppCoreResult ComputeConcurrent(
+    EdgeAppCoreCtx &ctx, const Tensor &input,
+    const EdgeAppCoreOutputDestination *destinations, Tensor *outputs,
+    uint32_t num_tensors);
+EdgeAppCoreResult SetChangeGate(EdgeAppCoreCtx &ctx,
+                                const EdgeAppCoreChangeGate *gate);
+// Pipelining: above depth 1, a worker thread acquires and preprocesses the
+// next frames while the application handles the one returned by ProcessAsync.
+// The input of that frame (GetInput) is a slot buffer valid until the next
+// ProcessAsync call on the context. Process may be called in between: it does
+// not share the slots nor the preprocessing state of the worker.
+EdgeAppCoreResult SetPipelineDepth(EdgeAppCoreCtx &ctx,
+                                   EdgeAppCoreCtx *shared_ctx, uint32_t depth);
+ProcessedFrame ProcessAsync(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
+                            EdgeAppLibSensorImageCropProperty &roi);
 EdgeAppCoreResult UnloadModel(EdgeAppCoreCtx &ctx);
+// Model cache: with a non-zero limit (sum of model file sizes in bytes),
+// UnloadModel keeps the models and the IMX500 sensor stream resident, and the
+// next LoadModel of the same model reuses them. 0 (default) disables it.
+EdgeAppCoreResult SetModelCacheLimit(size_t max_bytes);
+EdgeAppCoreResult EvictModel(const char *model_name);
+// Stage latency statistics, unless built with EDGEAPP_CORE_NO_STATS
+EdgeAppCoreStats GetStats(EdgeAppCoreCtx &ctx);
+EdgeAppCoreResult ResetStats(EdgeAppCoreCtx &ctx);
+EdgeAppCoreResult SendStats(EdgeAppCoreCtx &ctx, const char *topic);
+// Cascade scheduler: ROIs are queued to |num_workers| threads; when the
+// |queue_depth| queue is full, the submitting thread runs them itself
+Cascade *CreateCascade(const CascadeStage *stages, uint32_t num_stages,
+                       uint32_t num_workers, uint32_t queue_depth);
+EdgeAppCoreResult RunCascade(Cascade *cascade, EdgeAppLibSensorFrame frame,
+                             const EdgeAppLibSensorImageCropProperty &roi);
+void DestroyCascade(Cascade *cascade);
 EdgeAppCoreResult SendInputTensor(Tensor *input_tensor);
+// Queues the input tensor to the SendDataAsyncImage worker, which encodes and
+// uploads it; data owned by the app is handed over, other data is copied
+EdgeAppCoreResult SendInputTensorAsync(
+    Tensor *input_tensor, EdgeAppLibSendDataCallback callback = nullptr,
+    void *user_data = nullptr);
 EdgeAppCoreResult SendInference(void *data, size_t datalen,
                                 EdgeAppLibSendDataType datatype,
                                 uint64_t timestamp);
+// Queues the inference with SendDataAsyncMeta instead of waiting for the
+// upload; |callback|, if any, receives the upload result
+EdgeAppCoreResult SendInferenceAsync(
+    void *data, size_t datalen, EdgeAppLibSendDataType datatype,
+    uint64_t timestamp, EdgeAppLibSendDataCallback callback = nullptr,
+    void *user_data = nullptr);
 
 }  // namespace EdgeAppCore
 #endif  // __cplusplus
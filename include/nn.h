@@ -74,6 +74,23 @@ EdgeAppLibNNResult SetInput(EdgeAppLibGraphContext ctx, uint8_t *input_tensor,
 EdgeAppLibNNResult SetInputFromTensor(EdgeAppLibGraphContext ctx,
                                       uint8_t *input_tensor, uint32_t (*dim)[4],
                                       EdgeAppLibTensorType type);
+
+// Input of a graph context with a fixed shape, type and normalization.
+// Created once per graph context, it owns the dimensions and the float
+// staging buffer, so that BindInput sets a new source per frame without
+// allocating. With mean_values or norm_values, a uint8 NHWC source is
+// normalized to float32 like SetInput does (missing values default to 0 and
+// 1); otherwise the source is given to the graph as |type| as is.
+typedef struct EdgeAppLibInputBinding EdgeAppLibInputBinding;
+
+EdgeAppLibNNResult CreateInputBinding(
+    EdgeAppLibGraphContext ctx, uint32_t (*dim)[4], EdgeAppLibTensorType type,
+    const float *mean_values, size_t mean_size, const float *norm_values,
+    size_t norm_size, EdgeAppLibInputBinding **binding);
+EdgeAppLibNNResult BindInput(EdgeAppLibInputBinding *binding,
+                             uint8_t *input_tensor);
+void DestroyInputBinding(EdgeAppLibInputBinding *binding);
+
 EdgeAppLibNNResult Compute(EdgeAppLibGraphContext ctx);
 EdgeAppLibNNResult GetOutput(EdgeAppLibGraphContext ctx, uint32_t index,
                              float *out_tensor, uint32_t *out_size);
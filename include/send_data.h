@@ -19,7 +19,7 @@
  * @brief Header file for the EdgeAppLib Send Data.
  * @details This file defines the interface for interacting with the EdgeAppLib
  * Send Data, including data types, result codes, and functions for
- * synchronous operations. It provides functionalities such as
+ * synchronous and asynchronous operations. It provides functionalities such as
  * sending data.
  */
 
@@ -27,6 +27,15 @@
 #define AITRIOS_SEND_DATA_H
 
 #define MAX_NUMBER_OF_INFERENCE_QUEUE 100
+/* Batched inferences are sent once their timestamps span this window */
+#define INFERENCE_BATCH_WINDOW_MS 10000
+/* Upper bound of the asynchronous queue size */
+#define SEND_DATA_ASYNC_MAX_QUEUE_SIZE 16
+#define SEND_DATA_ASYNC_DEFAULT_QUEUE_SIZE 4
+/* Images waiting for the encode worker of SendDataAsyncImage */
+#define SEND_DATA_ASYNC_IMAGE_QUEUE_SIZE 2
+/* Encoded images being uploaded, each in an output buffer of the pool */
+#define SEND_DATA_ASYNC_IMAGE_POOL_SIZE 2
 
 #include <stdint.h>
 
@@ -68,6 +77,94 @@ EdgeAppLibSendDataResult SendDataSyncImage(
     uint64_t timestamp, int timeout_ms = -1, uint32_t current = 1,
     uint32_t division = 1);
 
+/**
+ * @brief Sends metadata to AITRIOS without waiting for the upload.
+ *
+ * The metadata is formatted as SendDataSyncMeta does and queued. Messages are
+ * handed to EVP one at a time, in order; when the queue is full, the overflow
+ * policy set with SendDataSetAsyncPolicy applies. With
+ * number_of_inference_per_message > 1, inferences are batched as with
+ * SendDataSyncMeta and only the call completing a batch queues messages.
+ *
+ * @note Uploads complete on the thread running the callbacks, so from a
+ * callback, i.e. on the thread processing EVP events, a full queue never
+ * blocks: EdgeAppLibSendDataOverflowBlock drops the new message instead.
+ *
+ * @param data The serialized data to upload. Not referenced after returning.
+ * @param datalen The length of the serialized data.
+ * @param datatype The type of the data to upload.
+ * @param timestamp The timestamp of the processed frame in nanoseconds.
+ * @param callback Optional. Called with the result of the upload of the last
+ * message queued by this call, or with EdgeAppLibSendDataResultDropped,
+ * before returning if the new message is the one dropped.
+ * @param user_data Argument passed to callback.
+ * @return EdgeAppLibSendDataResultEnqueued if queued, or the error that
+ * prevented it. callback is not called when formatting fails.
+ */
+EdgeAppLibSendDataResult SendDataAsyncMeta(
+    void *data, int datalen, EdgeAppLibSendDataType datatype,
+    uint64_t timestamp, EdgeAppLibSendDataCallback callback = nullptr,
+    void *user_data = nullptr);
+
+/**
+ * @brief Sends an image to AITRIOS without waiting for its encoding nor its
+ * upload.
+ *
+ * The image is queued for a worker thread, which formats it as
+ * SendDataSyncImage does in an output buffer of a pool and hands it to EVP.
+ * The worker waits for a free output buffer, so at most
+ * SEND_DATA_ASYNC_IMAGE_POOL_SIZE encoded images are in flight. When the
+ * queue of SEND_DATA_ASYNC_IMAGE_QUEUE_SIZE images is full, the overflow
+ * policy set with SendDataSetAsyncPolicy applies. As with SendDataAsyncMeta,
+ * a full queue never blocks a callback.
+ *
+ * @param data The image to upload. Referenced until release is called: the
+ * caller keeps it, e.g. keeps its frame, until then.
+ * @param datalen The length of the image.
+ * @param image_property The image properties, such as width, height, and
+ * pixel format.
+ * @param timestamp The timestamp of the processed frame in nanoseconds.
+ * @param release Optional. Called once data is no longer referenced, when it
+ * has been encoded or if it is dropped.
+ * @param callback Optional. Called with the result of the upload, or with
+ * EdgeAppLibSendDataResultDropped, before returning if the new image is the
+ * one dropped.
+ * @param user_data Argument passed to release and callback.
+ * @return EdgeAppLibSendDataResultEnqueued if queued, or the error that
+ * prevented it. release is only called for queued images, callback also for
+ * a dropped new image.
+ */
+EdgeAppLibSendDataResult SendDataAsyncImage(
+    void *data, int datalen, EdgeAppLibImageProperty *image_property,
+    uint64_t timestamp, EdgeAppLibSendDataReleaseCallback release = nullptr,
+    EdgeAppLibSendDataCallback callback = nullptr, void *user_data = nullptr);
+
+/**
+ * @brief Configures the queue of SendDataAsyncMeta, and the overflow policy of
+ * SendDataAsyncImage.
+ *
+ * @param queue_size Messages queued or in flight, from 1 to
+ * SEND_DATA_ASYNC_MAX_QUEUE_SIZE. Messages already queued are kept.
+ * @param policy What to do when a message or an image is sent to a full
+ * queue.
+ * @return EdgeAppLibSendDataResultInvalidParam if out of range.
+ */
+EdgeAppLibSendDataResult SendDataSetAsyncPolicy(
+    uint32_t queue_size, EdgeAppLibSendDataOverflowPolicy policy);
+
+/**
+ * @brief Waits until the messages queued by SendDataAsyncMeta and the images
+ * queued by SendDataAsyncImage are sent.
+ *
+ * @note The State Machine also waits for them when leaving Running, before
+ * onStop.
+ * @param timeout_ms Timeout in milliseconds. -1 to wait until the queue is
+ * empty.
+ * @return EdgeAppLibSendDataResultSuccess when empty, or
+ * EdgeAppLibSendDataResultTimeout.
+ */
+EdgeAppLibSendDataResult SendDataAsyncDrain(int timeout_ms = -1);
+
 #ifdef __cplusplus
 }
 #endif
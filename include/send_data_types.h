@@ -37,10 +37,36 @@ typedef enum {
                        to send data without  the device in stream-mode. */
   EdgeAppLibSendDataResultEnqueued = 6, /**< Operation has been enqueed. */
   EdgeAppLibSendDataResultUninitialized =
-      7 /**< Result has not yet been initialized. No operation has been
+      7, /**< Result has not yet been initialized. No operation has been
            performed. */
+  EdgeAppLibSendDataResultDropped = 8 /**< Discarded by the overflow policy
+                                         of a full asynchronous queue. */
 } EdgeAppLibSendDataResult;
 
+/** What an asynchronous send does when its queue is full */
+typedef enum {
+  EdgeAppLibSendDataOverflowBlock = 0, /**< Wait for a queued message to be
+                                          sent. */
+  EdgeAppLibSendDataOverflowDropOldest = 1, /**< Discard the oldest message
+                                               not yet handed to EVP. */
+  EdgeAppLibSendDataOverflowDropNewest = 2  /**< Discard the new message. */
+} EdgeAppLibSendDataOverflowPolicy;
+
+/**
+ * @brief Completion callback of an asynchronous send, called from the thread
+ * processing EVP events or, if the message is dropped or fails to be handed to
+ * EVP, from the sending thread.
+ */
+typedef void (*EdgeAppLibSendDataCallback)(EdgeAppLibSendDataResult result,
+                                           void *user_data);
+
+/**
+ * @brief Called by SendDataAsyncImage once the image passed to it is no longer
+ * referenced, from the encode worker or, if the image is dropped, from the
+ * sending thread.
+ */
+typedef void (*EdgeAppLibSendDataReleaseCallback)(void *data, void *user_data);
+
 typedef enum {
   EdgeAppLibSendDataBase64 = 0,
   EdgeAppLibSendDataJson = 1
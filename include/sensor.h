@@ -736,6 +736,30 @@ struct EdgeAppLibSensorInputDataTypeProperty {
  * @details RGB 8-bit
  */
 #define AITRIOS_SENSOR_PIXEL_FORMAT_RGB8_PLANAR "image_rgb8_planar"
+/**
+ * @def AITRIOS_SENSOR_PIXEL_FORMAT_BGR24
+ * @brief Pixel formats/Packed BGR
+ * @details BGR 888
+ */
+#define AITRIOS_SENSOR_PIXEL_FORMAT_BGR24 "image_bgr24"
+/**
+ * @def AITRIOS_SENSOR_PIXEL_FORMAT_GREY
+ * @brief Pixel formats/Greyscale
+ * @details 8-bit
+ */
+#define AITRIOS_SENSOR_PIXEL_FORMAT_GREY "image_grey"
+/**
+ * @def AITRIOS_SENSOR_PIXEL_FORMAT_NV12
+ * @brief Pixel formats/YUV
+ * @details YUV 4:2:0, Y plane and interleaved UV plane
+ */
+#define AITRIOS_SENSOR_PIXEL_FORMAT_NV12 "image_nv12"
+/**
+ * @def AITRIOS_SENSOR_PIXEL_FORMAT_YUV420
+ * @brief Pixel formats/YUV
+ * @details YUV 4:2:0, Y, U and V planes
+ */
+#define AITRIOS_SENSOR_PIXEL_FORMAT_YUV420 "image_yuv420"
 /**
  * @struct EdgeAppLibSensorImageProperty
  * @brief Value of AITRIOS_SENSOR_IMAGE_PROPERTY_KEY
@@ -0,0 +1,88 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file base64_codec.h
+ * @details Standard (RFC 4648) base64 with padding. The encoder writes into a
+ * caller-provided buffer, so it can target the final send buffer directly.
+ * Output is not NUL-terminated.
+ */
+
+#ifndef BASE64_CODEC_H
+#define BASE64_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of characters produced when encoding `size` bytes.
+ */
+#define BASE64_ENCODED_SIZE(size) ((((size) + 2) / 3) * 4)
+
+/**
+ * @brief State of an incremental encoder. Holds the 0-2 input bytes that do
+ * not yet form a full 3-byte group.
+ */
+typedef struct {
+  uint8_t tail[2];
+  uint8_t tail_size;
+} Base64Encoder;
+
+/**
+ * @brief Encode `in_size` bytes from `in` into `out`.
+ *
+ * @param out Must have room for BASE64_ENCODED_SIZE(in_size) characters.
+ * @return The number of characters written.
+ */
+size_t base64_encode(const void *in, size_t in_size, char *out);
+
+void base64_encoder_init(Base64Encoder *encoder);
+
+/**
+ * @brief Feed `in_size` bytes to the encoder and write every complete group.
+ *
+ * @param out Must have room for BASE64_ENCODED_SIZE(in_size) characters.
+ * @return The number of characters written.
+ */
+size_t base64_encoder_update(Base64Encoder *encoder, const void *in,
+                             size_t in_size, char *out);
+
+/**
+ * @brief Flush the pending bytes with padding. Writes at most 4 characters.
+ *
+ * @return The number of characters written.
+ */
+size_t base64_encoder_final(Base64Encoder *encoder, char *out);
+
+/**
+ * @brief Decode `in_size` characters from `in` into `out`.
+ *
+ * @param out_size In: capacity of `out`. Out: number of bytes written.
+ * @return 0 on success, -1 if the input is not valid base64 or `out` is too
+ * small.
+ */
+int base64_decode(const char *in, size_t in_size, uint8_t *out,
+                  size_t *out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BASE64_CODEC_H */
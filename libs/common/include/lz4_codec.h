@@ -0,0 +1,77 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file lz4_codec.h
+ * @details LZ4 frames of independent 4 MB blocks, without checksums, so that
+ * the output can be read with the standard lz4 tools (`lz4 -d`). Blocks that
+ * do not compress are stored as is. Both directions write into a
+ * caller-provided buffer.
+ */
+
+#ifndef LZ4_CODEC_H
+#define LZ4_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LZ4_BLOCK_SIZE (4 * 1024 * 1024)
+#define LZ4_HASH_LOG 12
+
+/**
+ * @brief Largest frame produced when compressing `size` bytes: the header,
+ * the end mark, and each block stored as is with its size.
+ */
+#define LZ4_COMPRESS_BOUND(size) \
+  (11 + 4 * (((size) + LZ4_BLOCK_SIZE - 1) / LZ4_BLOCK_SIZE) + (size))
+
+/**
+ * @brief Match finder of the compressor, reset for each block. Kept out of
+ * the stack as it is 16 KB.
+ */
+typedef struct {
+  uint32_t table[1 << LZ4_HASH_LOG];
+} Lz4Compressor;
+
+/**
+ * @brief Compress `in_size` bytes from `in` into a frame in `out`.
+ *
+ * @param out_capacity Stops as soon as the frame would exceed it, so a
+ * capacity below `in_size` only spends time on data that compresses.
+ * @return The size of the frame, or 0 if it does not fit in `out_capacity`.
+ */
+size_t lz4_compress(Lz4Compressor *compressor, const void *in, size_t in_size,
+                    void *out, size_t out_capacity);
+
+/**
+ * @brief Decompress the frame of `in_size` bytes from `in` into `out`.
+ * Dictionaries are not supported and checksums are skipped.
+ *
+ * @param out_size In: capacity of `out`. Out: number of bytes written.
+ * @return 0 on success, -1 if the frame is invalid or `out` is too small.
+ */
+int lz4_decompress(const void *in, size_t in_size, void *out,
+                   size_t *out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LZ4_CODEC_H */
@@ -0,0 +1,218 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "base64_codec.h"
+
+#include <string.h>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+/* Any value with the top bits set marks a character outside the alphabet */
+const uint8_t kInvalid = 0xff;
+
+/* Two output characters per 12 input bits: halves the lookups of the
+ * 6-bit alphabet table */
+struct PairTable {
+  char pairs[4096][2];
+};
+
+constexpr PairTable MakePairTable() {
+  PairTable table{};
+  for (int i = 0; i < 4096; ++i) {
+    table.pairs[i][0] = kAlphabet[i >> 6];
+    table.pairs[i][1] = kAlphabet[i & 0x3f];
+  }
+  return table;
+}
+
+struct DecodeTable {
+  uint8_t values[256];
+};
+
+constexpr DecodeTable MakeDecodeTable() {
+  DecodeTable table{};
+  for (int i = 0; i < 256; ++i) table.values[i] = kInvalid;
+  for (int i = 0; i < 64; ++i) table.values[(uint8_t)kAlphabet[i]] = i;
+  return table;
+}
+
+constexpr PairTable kPairs = MakePairTable();
+constexpr DecodeTable kDecode = MakeDecodeTable();
+
+#if defined(__SSSE3__)
+/* Encodes 12 bytes per iteration from 16-byte loads. Returns the number of
+ * input bytes consumed, a multiple of 3. */
+size_t EncodeBlocks(const uint8_t *in, size_t in_size, char *out) {
+  const __m128i shuffle =
+      _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  /* Offset to add to each 6-bit index, selected by its range */
+  const __m128i offsets =
+      _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  size_t done = 0;
+  for (; in_size - done >= 16; done += 12, out += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(in + done));
+    v = _mm_shuffle_epi8(v, shuffle);
+    /* Move the four 6-bit fields of each 24-bit group into separate bytes */
+    __m128i hi = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                                 _mm_set1_epi32(0x04000040));
+    __m128i lo = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                                 _mm_set1_epi32(0x01000010));
+    __m128i indices = _mm_or_si128(hi, lo);
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    __m128i chars =
+        _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+    _mm_storeu_si128((__m128i *)out, chars);
+  }
+  return done;
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/* Encodes 48 bytes per iteration with de-interleaving loads and a 64-entry
+ * table lookup. Returns the number of input bytes consumed. */
+size_t EncodeBlocks(const uint8_t *in, size_t in_size, char *out) {
+  const uint8_t *alphabet = (const uint8_t *)kAlphabet;
+  uint8x16x4_t lut;
+  lut.val[0] = vld1q_u8(alphabet);
+  lut.val[1] = vld1q_u8(alphabet + 16);
+  lut.val[2] = vld1q_u8(alphabet + 32);
+  lut.val[3] = vld1q_u8(alphabet + 48);
+  const uint8x16_t mask = vdupq_n_u8(0x3f);
+  size_t done = 0;
+  for (; in_size - done >= 48; done += 48, out += 64) {
+    uint8x16x3_t src = vld3q_u8(in + done);
+    uint8x16x4_t idx;
+    idx.val[0] = vshrq_n_u8(src.val[0], 2);
+    idx.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[0], 4), vshrq_n_u8(src.val[1], 4)), mask);
+    idx.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[1], 2), vshrq_n_u8(src.val[2], 6)), mask);
+    idx.val[3] = vandq_u8(src.val[2], mask);
+    uint8x16x4_t chars;
+    for (int i = 0; i < 4; ++i) chars.val[i] = vqtbl4q_u8(lut, idx.val[i]);
+    vst4q_u8((uint8_t *)out, chars);
+  }
+  return done;
+}
+#else
+size_t EncodeBlocks(const uint8_t *, size_t, char *) { return 0; }
+#endif
+
+/* Encodes whole 3-byte groups. `in_size` must be a multiple of 3. */
+size_t EncodeGroups(const uint8_t *in, size_t in_size, char *out) {
+  size_t done = EncodeBlocks(in, in_size, out);
+  char *dst = out + done / 3 * 4;
+  for (; done < in_size; done += 3, dst += 4) {
+    uint32_t group = (uint32_t)in[done] << 16 | (uint32_t)in[done + 1] << 8 |
+                     in[done + 2];
+    memcpy(dst, kPairs.pairs[group >> 12], 2);
+    memcpy(dst + 2, kPairs.pairs[group & 0xfff], 2);
+  }
+  return dst - out;
+}
+
+/* Encodes the final 1 or 2 bytes with padding */
+size_t EncodeTail(const uint8_t *in, size_t in_size, char *out) {
+  if (in_size == 0) return 0;
+  uint32_t group = (uint32_t)in[0] << 16;
+  if (in_size > 1) group |= (uint32_t)in[1] << 8;
+  out[0] = kAlphabet[group >> 18];
+  out[1] = kAlphabet[(group >> 12) & 0x3f];
+  out[2] = in_size > 1 ? kAlphabet[(group >> 6) & 0x3f] : '=';
+  out[3] = '=';
+  return 4;
+}
+
+}  // namespace
+
+size_t base64_encode(const void *in, size_t in_size, char *out) {
+  const uint8_t *src = (const uint8_t *)in;
+  size_t whole = in_size - in_size % 3;
+  size_t written = EncodeGroups(src, whole, out);
+  return written + EncodeTail(src + whole, in_size - whole, out + written);
+}
+
+void base64_encoder_init(Base64Encoder *encoder) { encoder->tail_size = 0; }
+
+size_t base64_encoder_update(Base64Encoder *encoder, const void *in,
+                             size_t in_size, char *out) {
+  const uint8_t *src = (const uint8_t *)in;
+  size_t written = 0;
+  if (encoder->tail_size > 0) {
+    if (encoder->tail_size + in_size < 3) {
+      memcpy(encoder->tail + encoder->tail_size, src, in_size);
+      encoder->tail_size += in_size;
+      return 0;
+    }
+    uint8_t group[3];
+    size_t used = 3 - encoder->tail_size;
+    memcpy(group, encoder->tail, encoder->tail_size);
+    memcpy(group + encoder->tail_size, src, used);
+    written = EncodeGroups(group, 3, out);
+    src += used;
+    in_size -= used;
+    encoder->tail_size = 0;
+  }
+  size_t whole = in_size - in_size % 3;
+  written += EncodeGroups(src, whole, out + written);
+  encoder->tail_size = in_size - whole;
+  memcpy(encoder->tail, src + whole, encoder->tail_size);
+  return written;
+}
+
+size_t base64_encoder_final(Base64Encoder *encoder, char *out) {
+  size_t written = EncodeTail(encoder->tail, encoder->tail_size, out);
+  encoder->tail_size = 0;
+  return written;
+}
+
+int base64_decode(const char *in, size_t in_size, uint8_t *out,
+                  size_t *out_size) {
+  if (in_size % 4 != 0) return -1;
+  size_t padding = 0;
+  if (in_size > 0 && in[in_size - 1] == '=') padding++;
+  if (in_size > 1 && in[in_size - 2] == '=') padding++;
+  size_t decoded_size = in_size / 4 * 3 - padding;
+  if (decoded_size > *out_size) return -1;
+
+  const uint8_t *src = (const uint8_t *)in;
+  size_t o = 0;
+  for (size_t i = 0; i < in_size; i += 4) {
+    bool last = i + 4 == in_size;
+    uint8_t a = kDecode.values[src[i]];
+    uint8_t b = kDecode.values[src[i + 1]];
+    uint8_t c = last && padding == 2 ? 0 : kDecode.values[src[i + 2]];
+    uint8_t d = last && padding > 0 ? 0 : kDecode.values[src[i + 3]];
+    if ((a | b | c | d) & 0xc0) return -1;
+    uint32_t group = (uint32_t)a << 18 | (uint32_t)b << 12 |
+                     (uint32_t)c << 6 | d;
+    out[o++] = group >> 16;
+    if (o < decoded_size) out[o++] = (group >> 8) & 0xff;
+    if (o < decoded_size) out[o++] = group & 0xff;
+  }
+  *out_size = decoded_size;
+  return 0;
+}
@@ -0,0 +1,305 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "lz4_codec.h"
+
+#include <string.h>
+
+/* Matches are compared 8 bytes at a time, the first difference being the
+ * lowest set bit */
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "lz4_codec assumes a little-endian target");
+
+namespace {
+
+/* Magic number, FLG (version 01, independent blocks), BD (4 MB blocks) and
+ * HC, the second byte of the xxh32 of FLG and BD */
+const uint8_t kFrameHeader[] = {0x04, 0x22, 0x4d, 0x18, 0x60, 0x70, 0x73};
+const uint32_t kMagic = 0x184d2204;
+const uint8_t kFlagVersionMask = 0xc0;
+const uint8_t kFlagVersion = 0x40;
+const uint8_t kFlagIndependentBlocks = 0x20;
+const uint8_t kFlagBlockChecksum = 0x10;
+const uint8_t kFlagContentSize = 0x08;
+const uint8_t kFlagContentChecksum = 0x04;
+const uint8_t kFlagDictId = 0x01;
+const uint32_t kBlockUncompressed = 0x80000000;
+
+const size_t kMinMatch = 4;
+/* The last 5 bytes of a block are literals, and its last match starts at
+ * least 12 bytes before its end */
+const size_t kLastLiterals = 5;
+const size_t kMatchFindLimit = 12;
+const size_t kMaxOffset = 65535;
+/* Searches before the step grows, to go faster over incompressible data */
+const int kSkipTrigger = 6;
+const size_t kRunMask = 15;
+
+inline uint32_t Read32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint64_t Read64(const uint8_t *p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline void Write32(uint8_t *p, uint32_t value) {
+  memcpy(p, &value, sizeof(value));
+}
+
+/* Hash of the 5 bytes at |p|: fewer collisions than 4 bytes on tensors, whose
+ * values share their exponent bytes. Reads 8 bytes, which the match find
+ * limit leaves room for. */
+inline uint32_t Hash(const uint8_t *p) {
+  return (uint32_t)(((Read64(p) << 24) * 889523592379ULL) >>
+                    (64 - LZ4_HASH_LOG));
+}
+
+/* Length of the common prefix of |ip| and |match|, up to |limit| */
+inline size_t MatchLength(const uint8_t *ip, const uint8_t *match,
+                          const uint8_t *limit) {
+  const uint8_t *start = ip;
+  while (ip + sizeof(uint64_t) <= limit) {
+    uint64_t diff = Read64(ip) ^ Read64(match);
+    if (diff != 0) return ip - start + (__builtin_ctzll(diff) >> 3);
+    ip += sizeof(uint64_t);
+    match += sizeof(uint64_t);
+  }
+  while (ip < limit && *ip == *match) {
+    ++ip;
+    ++match;
+  }
+  return ip - start;
+}
+
+/* Size of a length stored as a 4-bit field and its 255-byte extension */
+inline size_t LengthSize(size_t length) {
+  return length < kRunMask ? 0 : (length - kRunMask) / 255 + 1;
+}
+
+inline uint8_t *WriteLength(uint8_t *op, size_t length) {
+  for (length -= kRunMask; length >= 255; length -= 255) *op++ = 255;
+  *op++ = (uint8_t)length;
+  return op;
+}
+
+/* Writes |literals| bytes from |anchor|, then the match if |match_length| is
+ * not 0. Returns nullptr when the sequence does not fit. */
+uint8_t *WriteSequence(uint8_t *op, const uint8_t *oend, const uint8_t *anchor,
+                       size_t literals, size_t offset, size_t match_length) {
+  size_t size = 1 + LengthSize(literals) + literals;
+  if (match_length > 0) size += 2 + LengthSize(match_length - kMinMatch);
+  if (size > (size_t)(oend - op)) return nullptr;
+
+  uint8_t *token = op++;
+  *token = (uint8_t)((literals < kRunMask ? literals : kRunMask) << 4);
+  if (literals >= kRunMask) op = WriteLength(op, literals);
+  memcpy(op, anchor, literals);
+  op += literals;
+  if (match_length == 0) return op;
+
+  *op++ = (uint8_t)offset;
+  *op++ = (uint8_t)(offset >> 8);
+  match_length -= kMinMatch;
+  *token |= (uint8_t)(match_length < kRunMask ? match_length : kRunMask);
+  if (match_length >= kRunMask) op = WriteLength(op, match_length);
+  return op;
+}
+
+/* Compresses one block. Returns 0 when it does not fit in |capacity|. */
+size_t CompressBlock(uint32_t *table, const uint8_t *src, size_t size,
+                     uint8_t *dst, size_t capacity) {
+  const uint8_t *ip = src;
+  const uint8_t *anchor = src;
+  const uint8_t *end = src + size;
+  uint8_t *op = dst;
+  const uint8_t *oend = dst + capacity;
+
+  if (size > kMatchFindLimit) {
+    const uint8_t *find_limit = end - kMatchFindLimit;
+    const uint8_t *match_limit = end - kLastLiterals;
+    memset(table, 0, sizeof(uint32_t) << LZ4_HASH_LOG);
+    ++ip;
+    for (;;) {
+      const uint8_t *match;
+      size_t step = 1;
+      size_t searches = 1 << kSkipTrigger;
+      for (;;) {
+        uint32_t hash = Hash(ip);
+        match = src + table[hash];
+        table[hash] = (uint32_t)(ip - src);
+        if (match < ip && (size_t)(ip - match) <= kMaxOffset &&
+            Read32(match) == Read32(ip)) {
+          break;
+        }
+        ip += step;
+        step = searches++ >> kSkipTrigger;
+        if (ip > find_limit) goto last_literals;
+      }
+      while (ip > anchor && match > src && ip[-1] == match[-1]) {
+        --ip;
+        --match;
+      }
+      size_t match_length =
+          kMinMatch +
+          MatchLength(ip + kMinMatch, match + kMinMatch, match_limit);
+      op = WriteSequence(op, oend, anchor, ip - anchor, ip - match,
+                         match_length);
+      if (op == nullptr) return 0;
+      ip += match_length;
+      anchor = ip;
+      if (ip > find_limit) break;
+      table[Hash(ip - 2)] = (uint32_t)(ip - 2 - src);
+    }
+  }
+
+last_literals:
+  op = WriteSequence(op, oend, anchor, end - anchor, 0, 0);
+  return op == nullptr ? 0 : op - dst;
+}
+
+inline bool ReadLength(const uint8_t **ip, const uint8_t *iend,
+                       size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= iend) return false;
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/* Decompresses one block, with matches reaching back to |window| */
+bool DecompressBlock(const uint8_t *ip, size_t size, const uint8_t *window,
+                     uint8_t **op_ptr, const uint8_t *oend) {
+  const uint8_t *iend = ip + size;
+  uint8_t *op = *op_ptr;
+  while (ip < iend) {
+    uint8_t token = *ip++;
+    size_t length = token >> 4;
+    if (length == kRunMask && !ReadLength(&ip, iend, &length)) return false;
+    if (length > (size_t)(iend - ip) || length > (size_t)(oend - op)) {
+      return false;
+    }
+    memcpy(op, ip, length);
+    op += length;
+    ip += length;
+    if (ip == iend) break;
+
+    if (iend - ip < 2) return false;
+    size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - window)) return false;
+    length = token & kRunMask;
+    if (length == kRunMask && !ReadLength(&ip, iend, &length)) return false;
+    length += kMinMatch;
+    if (length > (size_t)(oend - op)) return false;
+    const uint8_t *match = op - offset;
+    // Overlapping matches repeat the last |offset| bytes: copy them, then
+    // twice as many from the same start, and so on
+    uint8_t *copy_end = op + length;
+    while (op < copy_end) {
+      size_t size = op - match;
+      if (size > (size_t)(copy_end - op)) size = copy_end - op;
+      memcpy(op, match, size);
+      op += size;
+    }
+  }
+  *op_ptr = op;
+  return true;
+}
+
+}  // namespace
+
+size_t lz4_compress(Lz4Compressor *compressor, const void *in, size_t in_size,
+                    void *out, size_t out_capacity) {
+  const uint8_t *src = (const uint8_t *)in;
+  uint8_t *dst = (uint8_t *)out;
+  // Header and end mark
+  if (out_capacity < sizeof(kFrameHeader) + 4) return 0;
+  memcpy(dst, kFrameHeader, sizeof(kFrameHeader));
+  size_t size = sizeof(kFrameHeader);
+
+  for (size_t offset = 0; offset < in_size;) {
+    size_t block_size = in_size - offset;
+    if (block_size > LZ4_BLOCK_SIZE) block_size = LZ4_BLOCK_SIZE;
+    // Room for the block after its size, keeping the end mark
+    if (out_capacity - size < 8) return 0;
+    size_t room = out_capacity - size - 8;
+    // Compressed only when smaller than stored
+    size_t capacity = room < block_size ? room : block_size - 1;
+    size_t compressed = CompressBlock(compressor->table, src + offset,
+                                      block_size, dst + size + 4, capacity);
+    if (compressed > 0) {
+      Write32(dst + size, (uint32_t)compressed);
+    } else {
+      if (room < block_size) return 0;
+      Write32(dst + size, (uint32_t)block_size | kBlockUncompressed);
+      memcpy(dst + size + 4, src + offset, block_size);
+      compressed = block_size;
+    }
+    size += 4 + compressed;
+    offset += block_size;
+  }
+
+  Write32(dst + size, 0);
+  return size + 4;
+}
+
+int lz4_decompress(const void *in, size_t in_size, void *out,
+                   size_t *out_size) {
+  const uint8_t *src = (const uint8_t *)in;
+  uint8_t *op = (uint8_t *)out;
+  const uint8_t *oend = op + *out_size;
+
+  if (in_size < 7 || Read32(src) != kMagic) return -1;
+  uint8_t flags = src[4];
+  if ((flags & kFlagVersionMask) != kFlagVersion || (flags & kFlagDictId)) {
+    return -1;
+  }
+  size_t pos = 6 + ((flags & kFlagContentSize) ? 8 : 0) + 1;
+
+  for (;;) {
+    if (in_size < pos + 4) return -1;
+    uint32_t block_size = Read32(src + pos);
+    pos += 4;
+    if (block_size == 0) break;
+    bool uncompressed = block_size & kBlockUncompressed;
+    block_size &= ~kBlockUncompressed;
+    if (block_size > in_size - pos) return -1;
+    if (uncompressed) {
+      if (block_size > (size_t)(oend - op)) return -1;
+      memcpy(op, src + pos, block_size);
+      op += block_size;
+    } else {
+      // Linked blocks may refer to the output of the previous ones
+      const uint8_t *window =
+          (flags & kFlagIndependentBlocks) ? op : (const uint8_t *)out;
+      if (!DecompressBlock(src + pos, block_size, window, &op, oend)) {
+        return -1;
+      }
+    }
+    pos += block_size + ((flags & kFlagBlockChecksum) ? 4 : 0);
+  }
+  if ((flags & kFlagContentChecksum) && in_size < pos + 4) return -1;
+
+  *out_size = op - (uint8_t *)out;
+  return 0;
+}
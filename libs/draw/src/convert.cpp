@@ -0,0 +1,154 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "convert.hpp"
+
+#include <string.h>
+
+// BT.601 limited range YUV to RGB, 8-bit fixed point
+#define YUV_SHIFT 8
+#define YUV_ROUND (1 << (YUV_SHIFT - 1))
+
+static inline uint8_t Clamp8(int32_t v) {
+  return v < 0 ? 0 : (v > 255 ? 255 : static_cast<uint8_t>(v));
+}
+
+// Converts a row of Y with its chroma row. Chroma samples are |step| bytes
+// apart, U and V of a sample are at u[i] and v[i]. The chroma terms of a
+// sample are computed once for its two pixels.
+static void YuvRowToRgb(const uint8_t *luma, const uint8_t *u,
+                        const uint8_t *v, uint32_t step, uint32_t x,
+                        uint32_t width, uint8_t *rgb) {
+  for (uint32_t i = 0; i < width;) {
+    const uint32_t c = ((x + i) >> 1) * step;
+    const int32_t d = u[c] - 128;
+    const int32_t e = v[c] - 128;
+    const int32_t r = 409 * e + YUV_ROUND;
+    const int32_t g = -100 * d - 208 * e + YUV_ROUND;
+    const int32_t b = 516 * d + YUV_ROUND;
+    // Both pixels of the sample, or the second one only at an odd start
+    uint32_t n = ((x + i) & 1) ? 1 : 2;
+    if (n > width - i) n = width - i;
+    for (uint32_t k = 0; k < n; ++k, ++i) {
+      const int32_t yv = 298 * (luma[x + i] - 16);
+      rgb[i * 3 + 0] = Clamp8((yv + r) >> YUV_SHIFT);
+      rgb[i * 3 + 1] = Clamp8((yv + g) >> YUV_SHIFT);
+      rgb[i * 3 + 2] = Clamp8((yv + b) >> YUV_SHIFT);
+    }
+  }
+}
+
+bool IsRgbStoreFormat(enum EdgeAppLibDrawFormat format) {
+  return format == AITRIOS_DRAW_FORMAT_RGB8 ||
+         format == AITRIOS_DRAW_FORMAT_RGB8_PLANAR ||
+         format == AITRIOS_DRAW_FORMAT_BGR8 ||
+         format == AITRIOS_DRAW_FORMAT_GRAY8;
+}
+
+void LoadRgbRow(const struct EdgeAppLibDrawBuffer *src, uint32_t x,
+                uint32_t y, uint32_t width, uint8_t *rgb) {
+  const uint8_t *base = static_cast<const uint8_t *>(src->address);
+  const size_t stride = src->stride_byte;
+  const size_t plane = stride * src->height;
+  const uint8_t *row = base + y * stride;
+
+  switch (src->format) {
+    case AITRIOS_DRAW_FORMAT_RGB8:
+      memcpy(rgb, row + x * 3, width * 3);
+      break;
+    case AITRIOS_DRAW_FORMAT_BGR8:
+      row += x * 3;
+      for (uint32_t i = 0; i < width; ++i) {
+        rgb[i * 3 + 0] = row[i * 3 + 2];
+        rgb[i * 3 + 1] = row[i * 3 + 1];
+        rgb[i * 3 + 2] = row[i * 3 + 0];
+      }
+      break;
+    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
+      row += x;
+      for (uint32_t i = 0; i < width; ++i) {
+        rgb[i * 3 + 0] = row[i];
+        rgb[i * 3 + 1] = row[plane + i];
+        rgb[i * 3 + 2] = row[2 * plane + i];
+      }
+      break;
+    case AITRIOS_DRAW_FORMAT_GRAY8:
+      row += x;
+      for (uint32_t i = 0; i < width; ++i) {
+        rgb[i * 3 + 0] = rgb[i * 3 + 1] = rgb[i * 3 + 2] = row[i];
+      }
+      break;
+    case AITRIOS_DRAW_FORMAT_NV12: {
+      // Interleaved UV plane of height / 2 rows after the Y plane
+      const uint8_t *uv = base + plane + (y >> 1) * stride;
+      YuvRowToRgb(row, uv, uv + 1, 2, x, width, rgb);
+      break;
+    }
+    case AITRIOS_DRAW_FORMAT_I420: {
+      // U then V planes of width / 2 x height / 2 after the Y plane
+      const size_t chroma_stride = stride / 2;
+      const uint8_t *u = base + plane + (y >> 1) * chroma_stride;
+      const uint8_t *v = u + chroma_stride * (src->height / 2);
+      YuvRowToRgb(row, u, v, 1, x, width, rgb);
+      break;
+    }
+    default:
+      memset(rgb, 0, width * 3);
+      break;
+  }
+}
+
+void StoreRgbRow(const uint8_t *rgb, struct EdgeAppLibDrawBuffer *dst,
+                 uint32_t x, uint32_t y, uint32_t width) {
+  uint8_t *base = static_cast<uint8_t *>(dst->address);
+  const size_t stride = dst->stride_byte;
+  const size_t plane = stride * dst->height;
+  uint8_t *row = base + y * stride;
+
+  switch (dst->format) {
+    case AITRIOS_DRAW_FORMAT_RGB8:
+      row += x * 3;
+      if (row != rgb) memcpy(row, rgb, width * 3);
+      break;
+    case AITRIOS_DRAW_FORMAT_BGR8:
+      row += x * 3;
+      for (uint32_t i = 0; i < width; ++i) {
+        row[i * 3 + 0] = rgb[i * 3 + 2];
+        row[i * 3 + 1] = rgb[i * 3 + 1];
+        row[i * 3 + 2] = rgb[i * 3 + 0];
+      }
+      break;
+    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
+      row += x;
+      for (uint32_t i = 0; i < width; ++i) {
+        row[i] = rgb[i * 3 + 0];
+        row[plane + i] = rgb[i * 3 + 1];
+        row[2 * plane + i] = rgb[i * 3 + 2];
+      }
+      break;
+    case AITRIOS_DRAW_FORMAT_GRAY8:
+      row += x;
+      for (uint32_t i = 0; i < width; ++i) {
+        row[i] = static_cast<uint8_t>((77 * rgb[i * 3 + 0] +
+                                       150 * rgb[i * 3 + 1] +
+                                       29 * rgb[i * 3 + 2] + 128) >>
+                                      8);
+      }
+      break;
+    default:
+      break;
+  }
+}
@@ -0,0 +1,56 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _AITRIOS_DRAW_CONVERT_H_
+#define _AITRIOS_DRAW_CONVERT_H_
+
+#include <stdint.h>
+
+#include "draw.h"
+
+/**
+ * @brief Whether rows of |format| can be written by StoreRgbRow.
+ */
+bool IsRgbStoreFormat(enum EdgeAppLibDrawFormat format);
+
+/**
+ * @brief Reads |width| pixels of row |y| of |src| from column |x| as RGB8.
+ * @details YUV sources are converted with BT.601 limited range coefficients;
+ * chroma is taken from the 2x2 block of each pixel.
+ *
+ * @param[in] src Valid buffer of any supported format.
+ * @param[in] x First column.
+ * @param[in] y Row.
+ * @param[in] width Number of pixels, x + width <= src->width.
+ * @param[out] rgb Interleaved RGB output of width * 3 bytes.
+ */
+void LoadRgbRow(const struct EdgeAppLibDrawBuffer *src, uint32_t x,
+                uint32_t y, uint32_t width, uint8_t *rgb);
+
+/**
+ * @brief Writes |width| RGB8 pixels to row |y| of |dst| from column |x|.
+ * @details Grayscale is the BT.601 luma of the pixels.
+ *
+ * @param[in] rgb Interleaved RGB input of width * 3 bytes.
+ * @param[in] dst Valid buffer of a format accepted by IsRgbStoreFormat.
+ * @param[in] x First column.
+ * @param[in] y Row.
+ * @param[in] width Number of pixels, x + width <= dst->width.
+ */
+void StoreRgbRow(const uint8_t *rgb, struct EdgeAppLibDrawBuffer *dst,
+                 uint32_t x, uint32_t y, uint32_t width);
+
+#endif /* _AITRIOS_DRAW_CONVERT_H_ */
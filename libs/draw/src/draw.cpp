@@ -15,9 +15,16 @@
  ****************************************************************************/
 #include "draw.h"
 
-#include <cmath>
+#include <string.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "convert.hpp"
+#include "draw_pool.hpp"
 #include "log.h"
+#include "primitives.hpp"
 
 static bool IsValidDrawBuffer(struct EdgeAppLibDrawBuffer *buffer) {
   if (buffer == nullptr) {
@@ -30,25 +37,48 @@ static bool IsValidDrawBuffer(struct EdgeAppLibDrawBuffer *buffer) {
     return false;
   }
   if (buffer->format < AITRIOS_DRAW_FORMAT_RGB8 ||
-      buffer->format > AITRIOS_DRAW_FORMAT_RGB8_PLANAR) {
+      buffer->format > AITRIOS_DRAW_FORMAT_I420) {
     LOG_ERR("IsValidDrawBuffer: Invalid format %d", buffer->format);
     return false;
   }
+  bool is_yuv = buffer->format == AITRIOS_DRAW_FORMAT_NV12 ||
+                buffer->format == AITRIOS_DRAW_FORMAT_I420;
+  if (is_yuv && (buffer->width % 2 != 0 || buffer->height % 2 != 0)) {
+    LOG_ERR("IsValidDrawBuffer: Odd YUV dimensions %ux%u", buffer->width,
+            buffer->height);
+    return false;
+  }
   // To ensure compatibility with the legacy draw functions,
   if (buffer->stride_byte == 0) {
-    if (buffer->format == AITRIOS_DRAW_FORMAT_RGB8) {
+    if (buffer->format == AITRIOS_DRAW_FORMAT_RGB8 ||
+        buffer->format == AITRIOS_DRAW_FORMAT_BGR8) {
       buffer->stride_byte = static_cast<uint32_t>(buffer->width) *
                             3;  // RGB format, 3 bytes per pixel
-    }
-    if (buffer->format == AITRIOS_DRAW_FORMAT_RGB8_PLANAR) {
+    } else {
       buffer->stride_byte = static_cast<uint32_t>(
-          buffer->width);  // Planar format, 1 byte per pixel
+          buffer->width);  // Planar formats, 1 byte per pixel
     }
   }
+  if (buffer->format == AITRIOS_DRAW_FORMAT_I420 &&
+      buffer->stride_byte % 2 != 0) {
+    LOG_ERR("IsValidDrawBuffer: Odd I420 stride %u", buffer->stride_byte);
+    return false;
+  }
 
-  uint32_t expected_size = (buffer->format == AITRIOS_DRAW_FORMAT_RGB8_PLANAR)
-                               ? buffer->stride_byte * buffer->height * 3
-                               : buffer->stride_byte * buffer->height;
+  uint32_t plane_size = buffer->stride_byte * buffer->height;
+  uint32_t expected_size = plane_size;
+  switch (buffer->format) {
+    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
+      expected_size = plane_size * 3;
+      break;
+    case AITRIOS_DRAW_FORMAT_NV12:
+    case AITRIOS_DRAW_FORMAT_I420:
+      // Chroma at half resolution in both directions
+      expected_size = plane_size + plane_size / 2;
+      break;
+    default:
+      break;
+  }
 
   if (buffer->size != expected_size) {
     LOG_ERR("IsValidDrawBuffer: Buffer size mismatch");
@@ -63,6 +93,7 @@ static bool IsValidDrawBuffer(struct EdgeAppLibDrawBuffer *buffer) {
 template <enum EdgeAppLibDrawFormat>
 struct FormatTraits {
   static constexpr int kPixelComponentStride = 0;
+  static constexpr int kPlanes = 0;
   static void PixelComponents(struct EdgeAppLibDrawBuffer *buffer, uint8_t **r,
                               uint8_t **g, uint8_t **b) {}
 };
@@ -70,6 +101,7 @@ struct FormatTraits {
 template <>
 struct FormatTraits<AITRIOS_DRAW_FORMAT_RGB8> {
   static constexpr int kPixelComponentStride = 3;
+  static constexpr int kPlanes = 1;
 
   static void PixelComponents(struct EdgeAppLibDrawBuffer *buffer, uint8_t **r,
                               uint8_t **g, uint8_t **b) {
@@ -82,6 +114,7 @@ struct FormatTraits<AITRIOS_DRAW_FORMAT_RGB8> {
 template <>
 struct FormatTraits<AITRIOS_DRAW_FORMAT_RGB8_PLANAR> {
   static constexpr int kPixelComponentStride = 1;
+  static constexpr int kPlanes = 3;
 
   static void PixelComponents(struct EdgeAppLibDrawBuffer *buffer, uint8_t **r,
                               uint8_t **g, uint8_t **b) {
@@ -93,6 +126,33 @@ struct FormatTraits<AITRIOS_DRAW_FORMAT_RGB8_PLANAR> {
   }
 };
 
+template <>
+struct FormatTraits<AITRIOS_DRAW_FORMAT_BGR8> {
+  static constexpr int kPixelComponentStride = 3;
+  static constexpr int kPlanes = 1;
+
+  static void PixelComponents(struct EdgeAppLibDrawBuffer *buffer, uint8_t **r,
+                              uint8_t **g, uint8_t **b) {
+    *r = (uint8_t *)buffer->address + 2;
+    *g = (uint8_t *)buffer->address + 1;
+    *b = (uint8_t *)buffer->address + 0;
+  }
+};
+
+// Crop and resize only, single component
+template <>
+struct FormatTraits<AITRIOS_DRAW_FORMAT_GRAY8> {
+  static constexpr int kPixelComponentStride = 1;
+  static constexpr int kPlanes = 1;
+};
+
+// Start of plane |p| of a buffer with FormatTraits<FMT>::kPlanes planes
+static inline uint8_t *PlaneAddress(const struct EdgeAppLibDrawBuffer *buffer,
+                                    int p) {
+  return static_cast<uint8_t *>(buffer->address) +
+         static_cast<size_t>(buffer->stride_byte) * buffer->height * p;
+}
+
 template <enum EdgeAppLibDrawFormat FMT>
 static int PixelOffset(uint32_t stride_bytes, int x, int y) {
   return (y * stride_bytes + x * FormatTraits<FMT>::kPixelComponentStride);
@@ -129,119 +189,355 @@ static void DrawRectangle(struct EdgeAppLibDrawBuffer *buffer, uint32_t left,
 #undef PIXEL_PUT
 }
 
+struct CropJob {
+  const uint8_t *src[3];  // Plane pointers
+  uint8_t *dst[3];
+  uint32_t src_stride;
+  uint32_t dst_stride;
+  uint32_t left;
+  uint32_t top;
+  size_t row_bytes;  // Bytes per row of a plane
+};
+
+template <enum EdgeAppLibDrawFormat FMT>
+static void CropStripe(void *args, uint32_t begin, uint32_t end) {
+  const CropJob *job = static_cast<const CropJob *>(args);
+  // Rows of a plane are contiguous: interleaved components are copied as one
+  // plane, planar ones plane by plane
+  for (int p = 0; p < FormatTraits<FMT>::kPlanes; ++p) {
+    for (uint32_t y = begin; y < end; ++y) {
+      int src_index =
+          PixelOffset<FMT>(job->src_stride, job->left, job->top + y);
+      int dst_index = PixelOffset<FMT>(job->dst_stride, 0, y);
+      memcpy(job->dst[p] + dst_index, job->src[p] + src_index, job->row_bytes);
+    }
+  }
+}
+
 template <enum EdgeAppLibDrawFormat FMT>
 static void CropRectangle(const struct EdgeAppLibDrawBuffer *src,
                           struct EdgeAppLibDrawBuffer *dst, uint32_t left,
                           uint32_t top, uint32_t right, uint32_t bottom) {
-  uint8_t *src_r, *src_g, *src_b;
-  uint8_t *dst_r, *dst_g, *dst_b;
-
-  FormatTraits<FMT>::PixelComponents((struct EdgeAppLibDrawBuffer *)src, &src_r,
-                                     &src_g, &src_b);
-  FormatTraits<FMT>::PixelComponents(dst, &dst_r, &dst_g, &dst_b);
-
-  uint32_t src_stride = src->stride_byte;
-  uint32_t dst_stride = dst->stride_byte;
   uint32_t crop_width = right - left + 1;
   uint32_t crop_height = bottom - top + 1;
 
-  for (uint32_t y = 0; y < crop_height; ++y) {
-    for (uint32_t x = 0; x < crop_width; ++x) {
-      int src_index = PixelOffset<FMT>(src_stride, left + x, top + y);
-      int dst_index = PixelOffset<FMT>(dst_stride, x, y);
+  CropJob job;
+  for (int p = 0; p < 3; ++p) {
+    job.src[p] = PlaneAddress(src, p);
+    job.dst[p] = PlaneAddress(dst, p);
+  }
+  job.src_stride = src->stride_byte;
+  job.dst_stride = dst->stride_byte;
+  job.left = left;
+  job.top = top;
+  job.row_bytes = static_cast<size_t>(crop_width) *
+                  FormatTraits<FMT>::kPixelComponentStride;
+  RunDrawStripes(crop_height, job.row_bytes * FormatTraits<FMT>::kPlanes * 2,
+                 CropStripe<FMT>, &job);
+}
 
-      dst_r[dst_index] = src_r[src_index];
-      dst_g[dst_index] = src_g[src_index];
-      dst_b[dst_index] = src_b[src_index];
+struct ConvertJob {
+  const EdgeAppLibDrawBuffer *src;
+  EdgeAppLibDrawBuffer *dst;
+  uint32_t left;
+  uint32_t top;
+  uint32_t width;
+};
+
+// Crop with format conversion: each row goes through an RGB8 row, read in
+// place when the destination is RGB8
+static void ConvertStripe(void *args, uint32_t begin, uint32_t end) {
+  const ConvertJob *job = static_cast<const ConvertJob *>(args);
+  std::vector<uint8_t> scratch;
+  if (job->dst->format != AITRIOS_DRAW_FORMAT_RGB8) {
+    scratch.resize(static_cast<size_t>(job->width) * 3);
+  }
+  for (uint32_t y = begin; y < end; ++y) {
+    uint8_t *row = scratch.data();
+    if (scratch.empty()) {
+      row = static_cast<uint8_t *>(job->dst->address) +
+            static_cast<size_t>(y) * job->dst->stride_byte;
     }
+    LoadRgbRow(job->src, job->left, job->top + y, job->width, row);
+    StoreRgbRow(row, job->dst, 0, y, job->width);
   }
 }
 
-// Bilinear resize using float precision (RGB8 / RGB8_PLANAR)
-template <enum EdgeAppLibDrawFormat FMT>
-static void ResizeRectangle(const EdgeAppLibDrawBuffer *src,
-                            EdgeAppLibDrawBuffer *dst) {
-  uint8_t *src_r, *src_g, *src_b;
-  uint8_t *dst_r, *dst_g, *dst_b;
-  FormatTraits<FMT>::PixelComponents(const_cast<EdgeAppLibDrawBuffer *>(src),
-                                     &src_r, &src_g, &src_b);
-  FormatTraits<FMT>::PixelComponents(dst, &dst_r, &dst_g, &dst_b);
+static void ConvertRectangle(const struct EdgeAppLibDrawBuffer *src,
+                             struct EdgeAppLibDrawBuffer *dst, uint32_t left,
+                             uint32_t top, uint32_t right, uint32_t bottom) {
+  ConvertJob job = {src, dst, left, top, right - left + 1};
+  RunDrawStripes(bottom - top + 1, static_cast<size_t>(job.width) * 6,
+                 ConvertStripe, &job);
+}
 
-  const uint32_t src_w = src->width, src_h = src->height;
-  const uint32_t dst_w = dst->width, dst_h = dst->height;
-  const uint32_t src_stride = src->stride_byte, dst_stride = dst->stride_byte;
-
-  // Pixel-center mapping
-  const float scale_x = static_cast<float>(src_w) / static_cast<float>(dst_w);
-  const float scale_y = static_cast<float>(src_h) / static_cast<float>(dst_h);
-
-  for (uint32_t y = 0; y < dst_h; ++y) {
-    float sy = (static_cast<float>(y) + 0.5f) * scale_y - 0.5f;
-    int y0 = static_cast<int>(std::floor(sy));
-    float wy = sy - static_cast<float>(y0);
-    int y1 = y0 + 1;
-    if (y0 < 0) {
-      y0 = 0;
-      wy = 1.0f;
+// Bilinear weights are fixed point with RESIZE_BITS fractional bits
+#define RESIZE_BITS 11
+#define RESIZE_ONE (1 << RESIZE_BITS)
+
+// Source positions of the destination columns or rows, computed once per
+// resize: offsets of the two neighbours and the weight of the second one.
+struct ResizeAxis {
+  std::vector<int32_t> ofs0;
+  std::vector<int32_t> ofs1;
+  std::vector<int32_t> weight;
+};
+
+// Pixel-center mapping, in integer arithmetic: the source position of |i| is
+// ((2 * i + 1) * src_len - dst_len) / (2 * dst_len).
+static void BuildResizeAxis(uint32_t src_len, uint32_t dst_len,
+                            int32_t step, ResizeAxis *axis) {
+  axis->ofs0.resize(dst_len);
+  axis->ofs1.resize(dst_len);
+  axis->weight.resize(dst_len);
+  const int64_t den = 2 * static_cast<int64_t>(dst_len);
+  for (uint32_t i = 0; i < dst_len; ++i) {
+    int64_t num = (2 * static_cast<int64_t>(i) + 1) * src_len - dst_len;
+    int64_t i0 = 0;
+    int64_t frac = 0;
+    if (num > 0) {
+      i0 = num / den;
+      frac = num % den;
     }
-    if (y1 >= static_cast<int>(src_h)) y1 = static_cast<int>(src_h) - 1;
-    if (y0 >= static_cast<int>(src_h)) y0 = static_cast<int>(src_h) - 1;
+    int64_t i1 = i0 + 1;
+    if (i0 >= src_len) i0 = src_len - 1;
+    if (i1 >= src_len) i1 = src_len - 1;
+    axis->ofs0[i] = static_cast<int32_t>(i0) * step;
+    axis->ofs1[i] = static_cast<int32_t>(i1) * step;
+    axis->weight[i] =
+        static_cast<int32_t>((frac * RESIZE_ONE + dst_len) / den);
+  }
+}
 
-    for (uint32_t x = 0; x < dst_w; ++x) {
-      float sx = (static_cast<float>(x) + 0.5f) * scale_x - 0.5f;
-      int x0 = static_cast<int>(std::floor(sx));
-      float wx = sx - static_cast<float>(x0);
-      int x1 = x0 + 1;
-      if (x0 < 0) {
-        x0 = 0;
-        wx = 1.0f;
-      }
-      if (x1 >= static_cast<int>(src_w)) x1 = static_cast<int>(src_w) - 1;
-      if (x0 >= static_cast<int>(src_w)) x0 = static_cast<int>(src_w) - 1;
-
-      const int i00 = PixelOffset<FMT>(src_stride, x0, y0);
-      const int i10 = PixelOffset<FMT>(src_stride, x1, y0);
-      const int i01 = PixelOffset<FMT>(src_stride, x0, y1);
-      const int i11 = PixelOffset<FMT>(src_stride, x1, y1);
-      const int o = PixelOffset<FMT>(dst_stride, x, y);
-
-      // R
-      {
-        float v0 = src_r[i00] * (1.0f - wx) + src_r[i10] * wx;
-        float v1 = src_r[i01] * (1.0f - wx) + src_r[i11] * wx;
-        float v = v0 * (1.0f - wy) + v1 * wy;
-        if (v < 0.0f)
-          v = 0.0f;
-        else if (v > 255.0f)
-          v = 255.0f;
-        dst_r[o] = static_cast<uint8_t>(v + 0.5f);
+// Interpolates a source row horizontally: RESIZE_ONE times the value.
+template <int C>
+static void ResizeRowH(const uint8_t *row, const ResizeAxis &xs,
+                       uint32_t dst_w, int32_t *out) {
+  for (uint32_t x = 0; x < dst_w; ++x) {
+    const uint8_t *p0 = row + xs.ofs0[x];
+    const uint8_t *p1 = row + xs.ofs1[x];
+    const int32_t w1 = xs.weight[x];
+    const int32_t w0 = RESIZE_ONE - w1;
+    for (int c = 0; c < C; ++c) out[x * C + c] = p0[c] * w0 + p1[c] * w1;
+  }
+}
+
+// Row access of the resize kernels. A plane is read and written in place;
+// other formats go through an RGB8 row converted on the fly, so a resize
+// between formats costs one conversion per source row read and per
+// destination row written.
+struct PlaneRows {
+  const uint8_t *base;
+  uint32_t stride;
+  const uint8_t *Row(uint32_t y) {
+    return base + static_cast<size_t>(y) * stride;
+  }
+};
+
+struct PlaneOut {
+  uint8_t *base;
+  uint32_t stride;
+  uint8_t *Row(uint32_t y) { return base + static_cast<size_t>(y) * stride; }
+  void Commit(uint32_t y) {}
+};
+
+struct RgbRows {
+  const EdgeAppLibDrawBuffer *buffer;
+  std::vector<uint8_t> row;
+  explicit RgbRows(const EdgeAppLibDrawBuffer *b)
+      : buffer(b), row(static_cast<size_t>(b->width) * 3) {}
+  const uint8_t *Row(uint32_t y) {
+    LoadRgbRow(buffer, 0, y, buffer->width, row.data());
+    return row.data();
+  }
+};
+
+// Writes rows of |width| pixels from (left, top) of |buffer|
+struct RgbOut {
+  EdgeAppLibDrawBuffer *buffer;
+  uint32_t left;
+  uint32_t top;
+  uint32_t width;
+  std::vector<uint8_t> row;
+  RgbOut(EdgeAppLibDrawBuffer *b, uint32_t l, uint32_t t, uint32_t w)
+      : buffer(b), left(l), top(t), width(w),
+        row(static_cast<size_t>(w) * 3) {}
+  uint8_t *Row(uint32_t y) { return row.data(); }
+  void Commit(uint32_t y) {
+    StoreRgbRow(row.data(), buffer, left, top + y, width);
+  }
+};
+
+// Bilinear resize of rows [y_begin, y_end) of one plane of C components per
+// pixel. Rows are interpolated horizontally once and kept while consecutive
+// destination rows use them; the vertical pass is a plain loop over
+// contiguous values the compiler can vectorize.
+template <int C, class Rows, class Out>
+static void ResizePlaneBilinear(Rows &src, Out &dst, uint32_t dst_w,
+                                uint32_t y_begin, uint32_t y_end,
+                                const ResizeAxis &xs, const ResizeAxis &ys) {
+  const uint32_t row_len = dst_w * C;
+  std::vector<int32_t> rows(2 * row_len);
+  int32_t *row0 = rows.data();
+  int32_t *row1 = rows.data() + row_len;
+  int32_t cached0 = -1, cached1 = -1;
+
+  for (uint32_t y = y_begin; y < y_end; ++y) {
+    const int32_t y0 = ys.ofs0[y], y1 = ys.ofs1[y];
+    if (y0 == cached1 && y0 != cached0) {
+      std::swap(row0, row1);
+      std::swap(cached0, cached1);
+    }
+    if (y0 != cached0) {
+      ResizeRowH<C>(src.Row(y0), xs, dst_w, row0);
+      cached0 = y0;
+    }
+    if (y1 != cached1) {
+      if (y1 == cached0) {
+        memcpy(row1, row0, row_len * sizeof(int32_t));
+      } else {
+        ResizeRowH<C>(src.Row(y1), xs, dst_w, row1);
       }
-      // G
-      {
-        float v0 = src_g[i00] * (1.0f - wx) + src_g[i10] * wx;
-        float v1 = src_g[i01] * (1.0f - wx) + src_g[i11] * wx;
-        float v = v0 * (1.0f - wy) + v1 * wy;
-        if (v < 0.0f)
-          v = 0.0f;
-        else if (v > 255.0f)
-          v = 255.0f;
-        dst_g[o] = static_cast<uint8_t>(v + 0.5f);
+      cached1 = y1;
+    }
+
+    const uint32_t w1 = ys.weight[y];
+    const uint32_t w0 = RESIZE_ONE - w1;
+    uint8_t *out = dst.Row(y);
+    for (uint32_t i = 0; i < row_len; ++i) {
+      uint32_t v = row0[i] * w0 + row1[i] * w1;
+      out[i] = static_cast<uint8_t>(
+          (v + (1u << (2 * RESIZE_BITS - 1))) >> (2 * RESIZE_BITS));
+    }
+    dst.Commit(y);
+  }
+}
+
+// Area averaging of rows [y_begin, y_end) of one plane, used for downscales
+// of 2x or more where bilinear sampling would skip most of the source pixels.
+// Each destination pixel is the rounded mean of its box of source pixels. The
+// rows of a box are first summed column by column, a contiguous loop the
+// compiler can vectorize, then the columns of each box.
+template <int C, class Rows, class Out>
+static void ResizePlaneArea(Rows &src, uint32_t src_w, uint32_t src_h,
+                            Out &dst, uint32_t dst_w, uint32_t dst_h,
+                            uint32_t y_begin, uint32_t y_end) {
+  std::vector<uint32_t> x_start(dst_w + 1);
+  for (uint32_t x = 0; x <= dst_w; ++x) {
+    x_start[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * src_w /
+                                       dst_w);
+  }
+  const uint32_t row_len = src_w * C;
+  std::vector<uint32_t> columns(row_len);
+
+  for (uint32_t y = y_begin; y < y_end; ++y) {
+    const uint32_t sy0 =
+        static_cast<uint32_t>(static_cast<uint64_t>(y) * src_h / dst_h);
+    const uint32_t sy1 =
+        static_cast<uint32_t>(static_cast<uint64_t>(y + 1) * src_h / dst_h);
+    uint32_t *col = columns.data();
+    const uint8_t *row = src.Row(sy0);
+    for (uint32_t i = 0; i < row_len; ++i) col[i] = row[i];
+    for (uint32_t sy = sy0 + 1; sy < sy1; ++sy) {
+      row = src.Row(sy);
+      for (uint32_t i = 0; i < row_len; ++i) col[i] += row[i];
+    }
+
+    uint8_t *out = dst.Row(y);
+    for (uint32_t x = 0; x < dst_w; ++x) {
+      uint32_t sum[C] = {};
+      for (uint32_t sx = x_start[x]; sx < x_start[x + 1]; ++sx) {
+        for (int c = 0; c < C; ++c) sum[c] += col[sx * C + c];
       }
-      // B
-      {
-        float v0 = src_b[i00] * (1.0f - wx) + src_b[i10] * wx;
-        float v1 = src_b[i01] * (1.0f - wx) + src_b[i11] * wx;
-        float v = v0 * (1.0f - wy) + v1 * wy;
-        if (v < 0.0f)
-          v = 0.0f;
-        else if (v > 255.0f)
-          v = 255.0f;
-        dst_b[o] = static_cast<uint8_t>(v + 0.5f);
+      const uint32_t area = (x_start[x + 1] - x_start[x]) * (sy1 - sy0);
+      for (int c = 0; c < C; ++c) {
+        out[x * C + c] = static_cast<uint8_t>((sum[c] + area / 2) / area);
       }
     }
+    dst.Commit(y);
+  }
+}
+
+struct ResizeJob {
+  const EdgeAppLibDrawBuffer *src_buffer;
+  EdgeAppLibDrawBuffer *dst_buffer;
+  // Window of the destination the image is resized to
+  uint32_t dst_left;
+  uint32_t dst_top;
+  uint32_t dst_width;
+  uint32_t dst_height;
+  bool area;
+  ResizeAxis xs;  // Bilinear only
+  ResizeAxis ys;
+};
+
+template <int C, class Rows, class Out>
+static void ResizeRows(const ResizeJob *job, Rows &src, Out &dst,
+                       uint32_t begin, uint32_t end) {
+  const EdgeAppLibDrawBuffer *s = job->src_buffer;
+  if (job->area) {
+    ResizePlaneArea<C>(src, s->width, s->height, dst, job->dst_width,
+                       job->dst_height, begin, end);
+  } else {
+    ResizePlaneBilinear<C>(src, dst, job->dst_width, begin, end, job->xs,
+                           job->ys);
   }
 }
 
+template <enum EdgeAppLibDrawFormat FMT>
+static void ResizeStripe(void *args, uint32_t begin, uint32_t end) {
+  const ResizeJob *job = static_cast<const ResizeJob *>(args);
+  const uint32_t dst_stride = job->dst_buffer->stride_byte;
+  // Interleaved components are resized as one plane of 3 components per pixel
+  for (int p = 0; p < FormatTraits<FMT>::kPlanes; ++p) {
+    PlaneRows src = {PlaneAddress(job->src_buffer, p),
+                     job->src_buffer->stride_byte};
+    PlaneOut dst = {PlaneAddress(job->dst_buffer, p) +
+                        PixelOffset<FMT>(dst_stride, job->dst_left,
+                                         job->dst_top),
+                    dst_stride};
+    ResizeRows<FormatTraits<FMT>::kPixelComponentStride>(job, src, dst, begin,
+                                                         end);
+  }
+}
+
+// Resize between formats, on RGB8 rows
+static void ResizeConvertStripe(void *args, uint32_t begin, uint32_t end) {
+  const ResizeJob *job = static_cast<const ResizeJob *>(args);
+  RgbRows src(job->src_buffer);
+  RgbOut dst(job->dst_buffer, job->dst_left, job->dst_top, job->dst_width);
+  ResizeRows<3>(job, src, dst, begin, end);
+}
+
+// Resize using fixed-point bilinear interpolation, or area averaging for
+// large downscales, to the |dst_w| x |dst_h| window at (dst_x, dst_y) of
+// |dst|. |stride| is the component stride of the rows the kernels see: that
+// of FMT, or 3 for RGB8 rows when converting.
+static void ResizeRectangle(const EdgeAppLibDrawBuffer *src,
+                            EdgeAppLibDrawBuffer *dst, uint32_t dst_x,
+                            uint32_t dst_y, uint32_t dst_w, uint32_t dst_h,
+                            int stride, DrawStripeFn stripe) {
+  ResizeJob job;
+  job.src_buffer = src;
+  job.dst_buffer = dst;
+  job.dst_left = dst_x;
+  job.dst_top = dst_y;
+  job.dst_width = dst_w;
+  job.dst_height = dst_h;
+
+  const uint32_t src_w = src->width, src_h = src->height;
+  size_t row_cost = static_cast<size_t>(dst_w) * 3;
+  job.area = src_w >= 2 * dst_w && src_h >= 2 * dst_h;
+  if (job.area) {
+    // Every source pixel is read
+    row_cost += static_cast<size_t>(src_w) * 3 * (src_h / dst_h);
+  } else {
+    BuildResizeAxis(src_w, dst_w, stride, &job.xs);
+    BuildResizeAxis(src_h, dst_h, 1, &job.ys);
+  }
+  RunDrawStripes(dst_h, row_cost, stripe, &job);
+}
+
 int32_t DrawRectangle(struct EdgeAppLibDrawBuffer *buffer, uint32_t left,
                       uint32_t top, uint32_t right, uint32_t bottom,
                       struct EdgeAppLibColor color) {
@@ -268,6 +564,10 @@ int32_t DrawRectangle(struct EdgeAppLibDrawBuffer *buffer, uint32_t left,
       DrawRectangle<AITRIOS_DRAW_FORMAT_RGB8_PLANAR>(buffer, left, top, right,
                                                      bottom, color);
       break;
+    case AITRIOS_DRAW_FORMAT_BGR8:
+      DrawRectangle<AITRIOS_DRAW_FORMAT_BGR8>(buffer, left, top, right, bottom,
+                                              color);
+      break;
     default:
       LOG_ERR("DrawRectangle: Unknown format %d", buffer->format);
       return -1;
@@ -276,6 +576,94 @@ int32_t DrawRectangle(struct EdgeAppLibDrawBuffer *buffer, uint32_t left,
   return 0;
 }
 
+int32_t DrawPrimitives(struct EdgeAppLibDrawBuffer *buffer,
+                       const struct EdgeAppLibDrawPrimitives *primitives) {
+  if (!IsValidDrawBuffer(buffer)) {
+    LOG_ERR("DrawPrimitives: Invalid buffer");
+    return -1;
+  }
+  if (primitives == nullptr ||
+      (primitives->num_boxes && primitives->boxes == nullptr) ||
+      (primitives->num_masks && primitives->masks == nullptr) ||
+      (primitives->num_labels && primitives->labels == nullptr)) {
+    LOG_ERR("DrawPrimitives: Invalid primitives");
+    return -1;
+  }
+  switch (buffer->format) {
+    case AITRIOS_DRAW_FORMAT_RGB8:
+    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
+    case AITRIOS_DRAW_FORMAT_BGR8:
+      break;
+    default:
+      LOG_ERR("DrawPrimitives: Unknown format %d", buffer->format);
+      return -1;
+  }
+
+  RenderPrimitives(buffer, primitives);
+  return 0;
+}
+
+// Same-format crop and resize handle these, conversions any source format
+// to the formats accepted by IsRgbStoreFormat
+static bool IsSupportedPair(const struct EdgeAppLibDrawBuffer *src,
+                            const struct EdgeAppLibDrawBuffer *dst) {
+  if (src->format == dst->format) return IsRgbStoreFormat(src->format);
+  return IsRgbStoreFormat(dst->format);
+}
+
+// Resizes |src| to the |w| x |h| window at (x, y) of |dst|, for formats
+// accepted by IsSupportedPair
+static void ResizeWindow(const struct EdgeAppLibDrawBuffer *src,
+                         struct EdgeAppLibDrawBuffer *dst, uint32_t x,
+                         uint32_t y, uint32_t w, uint32_t h) {
+  if (src->format != dst->format) {
+    ResizeRectangle(src, dst, x, y, w, h, 3, ResizeConvertStripe);
+    return;
+  }
+
+  switch (src->format) {
+    case AITRIOS_DRAW_FORMAT_RGB8:
+    case AITRIOS_DRAW_FORMAT_BGR8:
+      // Same layout, the components are never reordered
+      ResizeRectangle(src, dst, x, y, w, h, 3,
+                      ResizeStripe<AITRIOS_DRAW_FORMAT_RGB8>);
+      break;
+    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
+      ResizeRectangle(src, dst, x, y, w, h, 1,
+                      ResizeStripe<AITRIOS_DRAW_FORMAT_RGB8_PLANAR>);
+      break;
+    case AITRIOS_DRAW_FORMAT_GRAY8:
+      ResizeRectangle(src, dst, x, y, w, h, 1,
+                      ResizeStripe<AITRIOS_DRAW_FORMAT_GRAY8>);
+      break;
+    default:
+      break;
+  }
+}
+
+// Fills |dst| outside of the image placed by |letterbox|
+static void FillLetterboxBorders(struct EdgeAppLibDrawBuffer *dst,
+                                 const struct EdgeAppLibLetterbox &letterbox,
+                                 struct EdgeAppLibColor color) {
+  const uint32_t width = dst->width;
+  std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+  for (uint32_t x = 0; x < width; ++x) {
+    row[x * 3 + 0] = color.red;
+    row[x * 3 + 1] = color.green;
+    row[x * 3 + 2] = color.blue;
+  }
+  const uint32_t right = letterbox.left + letterbox.width;
+  const uint32_t bottom = letterbox.top + letterbox.height;
+  for (uint32_t y = 0; y < dst->height; ++y) {
+    if (y < letterbox.top || y >= bottom) {
+      StoreRgbRow(row.data(), dst, 0, y, width);
+      continue;
+    }
+    if (letterbox.left > 0) StoreRgbRow(row.data(), dst, 0, y, letterbox.left);
+    if (right < width) StoreRgbRow(row.data(), dst, right, y, width - right);
+  }
+}
+
 int32_t ResizeRectangle(const struct EdgeAppLibDrawBuffer *src,
                         struct EdgeAppLibDrawBuffer *dst) {
   if (!IsValidDrawBuffer(const_cast<EdgeAppLibDrawBuffer *>(src)) ||
@@ -284,29 +672,77 @@ int32_t ResizeRectangle(const struct EdgeAppLibDrawBuffer *src,
     return -1;
   }
 
-  if (src->format != dst->format) {
-    LOG_ERR("ResizeRectangle: Format mismatch between source and destination");
+  if (!IsSupportedPair(src, dst)) {
+    LOG_ERR("ResizeRectangle: Unsupported conversion from format %d to %d",
+            src->format, dst->format);
     return -1;
   }
 
   if (src->width == dst->width && src->height == dst->height) {
+    if (src->format != dst->format) {
+      ConvertRectangle(src, dst, 0, 0, src->width - 1, src->height - 1);
+      return 0;
+    }
     // No resizing needed, just copy the data
     memcpy(dst->address, src->address, src->size);
     return 0;
   }
 
-  switch (src->format) {
-    case AITRIOS_DRAW_FORMAT_RGB8:
-      ResizeRectangle<AITRIOS_DRAW_FORMAT_RGB8>(src, dst);
-      break;
-    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
-      ResizeRectangle<AITRIOS_DRAW_FORMAT_RGB8_PLANAR>(src, dst);
-      break;
-    default:
-      LOG_ERR("ResizeRectangle: Unknown format %d", src->format);
-      return -1;
+  ResizeWindow(src, dst, 0, 0, dst->width, dst->height);
+  return 0;
+}
+
+void ComputeLetterbox(uint32_t src_width, uint32_t src_height,
+                      uint32_t dst_width, uint32_t dst_height,
+                      struct EdgeAppLibLetterbox *letterbox) {
+  if (letterbox == nullptr) return;
+  *letterbox = {};
+  if (src_width == 0 || src_height == 0 || dst_width == 0 ||
+      dst_height == 0) {
+    return;
+  }
+  // The limiting side fills the destination, the other one is rounded
+  const uint64_t sw = src_width, sh = src_height;
+  const uint64_t dw = dst_width, dh = dst_height;
+  uint64_t width = dw, height = dh;
+  if (dw * sh <= dh * sw) {
+    height = (2 * sh * dw + sw) / (2 * sw);
+    letterbox->scale = static_cast<float>(dw) / static_cast<float>(sw);
+  } else {
+    width = (2 * sw * dh + sh) / (2 * sh);
+    letterbox->scale = static_cast<float>(dh) / static_cast<float>(sh);
+  }
+  letterbox->width =
+      static_cast<uint32_t>(std::min(std::max<uint64_t>(width, 1), dw));
+  letterbox->height =
+      static_cast<uint32_t>(std::min(std::max<uint64_t>(height, 1), dh));
+  letterbox->left = (dst_width - letterbox->width) / 2;
+  letterbox->top = (dst_height - letterbox->height) / 2;
+}
+
+int32_t LetterboxRectangle(const struct EdgeAppLibDrawBuffer *src,
+                           struct EdgeAppLibDrawBuffer *dst,
+                           struct EdgeAppLibColor pad,
+                           struct EdgeAppLibLetterbox *letterbox) {
+  if (!IsValidDrawBuffer(const_cast<EdgeAppLibDrawBuffer *>(src)) ||
+      !IsValidDrawBuffer(dst)) {
+    LOG_ERR("LetterboxRectangle: Invalid buffer");
+    return -1;
+  }
+
+  if (!IsSupportedPair(src, dst)) {
+    LOG_ERR("LetterboxRectangle: Unsupported conversion from format %d to %d",
+            src->format, dst->format);
+    return -1;
   }
 
+  struct EdgeAppLibLetterbox placement;
+  ComputeLetterbox(src->width, src->height, dst->width, dst->height,
+                   &placement);
+  FillLetterboxBorders(dst, placement, pad);
+  ResizeWindow(src, dst, placement.left, placement.top, placement.width,
+               placement.height);
+  if (letterbox != nullptr) *letterbox = placement;
   return 0;
 }
 
@@ -318,6 +754,12 @@ int32_t CropRectangle(struct EdgeAppLibDrawBuffer *src,
     return -1;
   }
 
+  if (!IsSupportedPair(src, dst)) {
+    LOG_ERR("CropRectangle: Unsupported conversion from format %d to %d",
+            src->format, dst->format);
+    return -1;
+  }
+
   uint32_t width = src->width;
   uint32_t height = src->height;
 
@@ -326,8 +768,14 @@ int32_t CropRectangle(struct EdgeAppLibDrawBuffer *src,
   if (top >= height) top = height - 1;
   if (bottom >= height) bottom = height - 1;
 
+  if (src->format != dst->format) {
+    ConvertRectangle(src, dst, left, top, right, bottom);
+    return 0;
+  }
+
   switch (src->format) {
     case AITRIOS_DRAW_FORMAT_RGB8:
+    case AITRIOS_DRAW_FORMAT_BGR8:
       CropRectangle<AITRIOS_DRAW_FORMAT_RGB8>(src, dst, left, top, right,
                                               bottom);
       break;
@@ -335,6 +783,10 @@ int32_t CropRectangle(struct EdgeAppLibDrawBuffer *src,
       CropRectangle<AITRIOS_DRAW_FORMAT_RGB8_PLANAR>(src, dst, left, top, right,
                                                      bottom);
       break;
+    case AITRIOS_DRAW_FORMAT_GRAY8:
+      CropRectangle<AITRIOS_DRAW_FORMAT_GRAY8>(src, dst, left, top, right,
+                                               bottom);
+      break;
     default:
       LOG_ERR("CropRectangle: Unknown format %d", src->format);
       return -1;
@@ -342,3 +794,27 @@ int32_t CropRectangle(struct EdgeAppLibDrawBuffer *src,
 
   return 0;
 }
+
+int32_t ConvertFormat(const struct EdgeAppLibDrawBuffer *src,
+                      struct EdgeAppLibDrawBuffer *dst) {
+  if (!IsValidDrawBuffer(const_cast<EdgeAppLibDrawBuffer *>(src)) ||
+      !IsValidDrawBuffer(dst)) {
+    LOG_ERR("ConvertFormat: Invalid buffer");
+    return -1;
+  }
+  if (src->width != dst->width || src->height != dst->height) {
+    LOG_ERR("ConvertFormat: Size mismatch %ux%u to %ux%u", src->width,
+            src->height, dst->width, dst->height);
+    return -1;
+  }
+  if (!IsRgbStoreFormat(dst->format)) {
+    LOG_ERR("ConvertFormat: Unsupported destination format %d", dst->format);
+    return -1;
+  }
+  ConvertRectangle(src, dst, 0, 0, src->width - 1, src->height - 1);
+  return 0;
+}
+
+int32_t SetDrawThreads(uint32_t num_threads) {
+  return SetDrawPoolThreads(num_threads);
+}
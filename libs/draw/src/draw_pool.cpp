@@ -0,0 +1,175 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "draw_pool.hpp"
+
+#include "draw.h"
+#include "log.h"
+
+// Wasm modules built without the atomics feature cannot start threads
+#if defined(__wasm__) && !defined(__wasm_atomics__)
+#define DRAW_NO_THREADS
+#endif
+
+#ifndef DRAW_NO_THREADS
+#include <pthread.h>
+#endif
+
+// Smaller operations run on the calling thread
+#define DRAW_MIN_STRIPE_ROWS 8
+#define DRAW_MIN_STRIPE_COST (64 * 1024)
+
+#ifdef DRAW_NO_THREADS
+
+int32_t SetDrawPoolThreads(uint32_t num_threads) {
+  if (num_threads == 0 || num_threads > AITRIOS_DRAW_MAX_THREADS) {
+    return -1;
+  }
+  return 0;
+}
+
+void RunDrawStripes(uint32_t rows, size_t row_cost, DrawStripeFn fn,
+                    void *args) {
+  fn(args, 0, rows);
+}
+
+#else
+
+struct DrawPool {
+  pthread_mutex_t run_mutex = PTHREAD_MUTEX_INITIALIZER;  // One operation
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+  pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+  pthread_t workers[AITRIOS_DRAW_MAX_THREADS - 1];
+  uint32_t num_workers = 0;
+  bool stop = false;
+
+  // Current operation
+  DrawStripeFn fn = nullptr;
+  void *args = nullptr;
+  uint32_t rows = 0;
+  uint32_t num_stripes = 0;
+  uint32_t next_stripe = 0;
+  uint32_t pending = 0;  // Stripes not finished yet
+};
+
+static DrawPool pool;
+
+// Takes and runs stripes of the current operation until none is left.
+// Called with pool.mutex locked.
+static void RunPendingStripes() {
+  while (pool.next_stripe < pool.num_stripes) {
+    uint32_t stripe = pool.next_stripe++;
+    uint64_t rows = pool.rows;
+    uint32_t begin = static_cast<uint32_t>(rows * stripe / pool.num_stripes);
+    uint32_t end =
+        static_cast<uint32_t>(rows * (stripe + 1) / pool.num_stripes);
+    DrawStripeFn fn = pool.fn;
+    void *args = pool.args;
+    pthread_mutex_unlock(&pool.mutex);
+    fn(args, begin, end);
+    pthread_mutex_lock(&pool.mutex);
+    if (--pool.pending == 0) pthread_cond_signal(&pool.done_cond);
+  }
+}
+
+static void *DrawWorker(void *) {
+  pthread_mutex_lock(&pool.mutex);
+  while (!pool.stop) {
+    if (pool.next_stripe < pool.num_stripes) {
+      RunPendingStripes();
+    } else {
+      pthread_cond_wait(&pool.work_cond, &pool.mutex);
+    }
+  }
+  pthread_mutex_unlock(&pool.mutex);
+  return nullptr;
+}
+
+static void StopWorkers() {
+  pthread_mutex_lock(&pool.mutex);
+  pool.stop = true;
+  pthread_cond_broadcast(&pool.work_cond);
+  pthread_mutex_unlock(&pool.mutex);
+  for (uint32_t i = 0; i < pool.num_workers; ++i) {
+    pthread_join(pool.workers[i], nullptr);
+  }
+  pool.num_workers = 0;
+  pool.stop = false;
+}
+
+int32_t SetDrawPoolThreads(uint32_t num_threads) {
+  if (num_threads == 0 || num_threads > AITRIOS_DRAW_MAX_THREADS) {
+    LOG_ERR("SetDrawThreads: num_threads must be 1 to %d",
+            AITRIOS_DRAW_MAX_THREADS);
+    return -1;
+  }
+  pthread_mutex_lock(&pool.run_mutex);
+  StopWorkers();
+  for (uint32_t i = 0; i + 1 < num_threads; ++i) {
+    int res =
+        pthread_create(&pool.workers[i], nullptr, DrawWorker, nullptr);
+    if (res != 0) {
+      // Keep going with the threads started so far
+      LOG_WARN("SetDrawThreads: pthread_create failed: %d", res);
+      break;
+    }
+    pool.num_workers++;
+  }
+  pthread_mutex_unlock(&pool.run_mutex);
+  return 0;
+}
+
+void RunDrawStripes(uint32_t rows, size_t row_cost, DrawStripeFn fn,
+                    void *args) {
+  uint64_t num_stripes = rows / DRAW_MIN_STRIPE_ROWS;
+  uint64_t cost = static_cast<uint64_t>(rows) * row_cost;
+  if (num_stripes > cost / DRAW_MIN_STRIPE_COST) {
+    num_stripes = cost / DRAW_MIN_STRIPE_COST;
+  }
+  // The pool serves one operation at a time, others run inline
+  if (num_stripes <= 1 || pthread_mutex_trylock(&pool.run_mutex) != 0) {
+    fn(args, 0, rows);
+    return;
+  }
+  if (num_stripes > pool.num_workers + 1) {
+    num_stripes = pool.num_workers + 1;
+  }
+  if (num_stripes <= 1) {
+    pthread_mutex_unlock(&pool.run_mutex);
+    fn(args, 0, rows);
+    return;
+  }
+
+  pthread_mutex_lock(&pool.mutex);
+  pool.fn = fn;
+  pool.args = args;
+  pool.rows = rows;
+  pool.num_stripes = static_cast<uint32_t>(num_stripes);
+  pool.next_stripe = 0;
+  pool.pending = pool.num_stripes;
+  pthread_cond_broadcast(&pool.work_cond);
+  RunPendingStripes();
+  while (pool.pending != 0) {
+    pthread_cond_wait(&pool.done_cond, &pool.mutex);
+  }
+  pool.num_stripes = 0;
+  pool.next_stripe = 0;
+  pthread_mutex_unlock(&pool.mutex);
+  pthread_mutex_unlock(&pool.run_mutex);
+}
+
+#endif /* DRAW_NO_THREADS */
@@ -0,0 +1,51 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _AITRIOS_DRAW_POOL_H_
+#define _AITRIOS_DRAW_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Processes rows [begin, end) of an operation.
+ */
+typedef void (*DrawStripeFn)(void *args, uint32_t begin, uint32_t end);
+
+/**
+ * @brief Sets the number of threads of the stripe pool, the calling thread
+ * included. See SetDrawThreads.
+ */
+int32_t SetDrawPoolThreads(uint32_t num_threads);
+
+/**
+ * @brief Runs |fn| on horizontal stripes of |rows| rows.
+ * @details Stripes are split on the pool threads when the operation is large
+ * enough; otherwise, when the pool is used by another thread or when threads
+ * are unavailable, |fn| runs once on all rows from the calling thread.
+ * Stripe bounds only depend on |rows| and the number of threads, and each
+ * stripe must only write its own rows, so results do not depend on
+ * scheduling.
+ *
+ * @param[in] rows Number of rows of the operation.
+ * @param[in] row_cost Bytes read and written per row, to size the stripes.
+ * @param[in] fn Stripe function.
+ * @param[in] args Argument of |fn|.
+ */
+void RunDrawStripes(uint32_t rows, size_t row_cost, DrawStripeFn fn,
+                    void *args);
+
+#endif /* _AITRIOS_DRAW_POOL_H_ */
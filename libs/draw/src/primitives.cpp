@@ -0,0 +1,290 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "primitives.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// 3x5 pixel font of the characters 0x20 to 0x5F, one byte per row with the
+// left column in bit 2. Glyphs are 4 pixels apart.
+#define FONT_WIDTH 3
+#define FONT_HEIGHT 5
+#define FONT_ADVANCE 4
+#define FONT_FIRST 0x20
+#define FONT_LAST 0x5F
+
+static const uint8_t kFont[FONT_LAST - FONT_FIRST + 1][FONT_HEIGHT] = {
+    {0, 0, 0, 0, 0},  // space
+    {2, 2, 2, 0, 2},  // !
+    {5, 5, 0, 0, 0},  // "
+    {5, 7, 5, 7, 5},  // #
+    {3, 6, 7, 3, 6},  // $
+    {5, 1, 2, 4, 5},  // %
+    {2, 5, 2, 5, 3},  // &
+    {2, 2, 0, 0, 0},  // '
+    {1, 2, 2, 2, 1},  // (
+    {4, 2, 2, 2, 4},  // )
+    {5, 2, 7, 2, 5},  // *
+    {0, 2, 7, 2, 0},  // +
+    {0, 0, 0, 2, 4},  // ,
+    {0, 0, 7, 0, 0},  // -
+    {0, 0, 0, 0, 2},  // .
+    {1, 1, 2, 4, 4},  // /
+    {7, 5, 5, 5, 7},  // 0
+    {2, 6, 2, 2, 7},  // 1
+    {7, 1, 7, 4, 7},  // 2
+    {7, 1, 7, 1, 7},  // 3
+    {5, 5, 7, 1, 1},  // 4
+    {7, 4, 7, 1, 7},  // 5
+    {7, 4, 7, 5, 7},  // 6
+    {7, 1, 1, 1, 1},  // 7
+    {7, 5, 7, 5, 7},  // 8
+    {7, 5, 7, 1, 7},  // 9
+    {0, 2, 0, 2, 0},  // :
+    {0, 2, 0, 2, 4},  // ;
+    {1, 2, 4, 2, 1},  // <
+    {0, 7, 0, 7, 0},  // =
+    {4, 2, 1, 2, 4},  // >
+    {6, 1, 2, 0, 2},  // ?
+    {7, 5, 7, 4, 3},  // @
+    {2, 5, 7, 5, 5},  // A
+    {6, 5, 6, 5, 6},  // B
+    {3, 4, 4, 4, 3},  // C
+    {6, 5, 5, 5, 6},  // D
+    {7, 4, 6, 4, 7},  // E
+    {7, 4, 6, 4, 4},  // F
+    {3, 4, 5, 5, 3},  // G
+    {5, 5, 7, 5, 5},  // H
+    {7, 2, 2, 2, 7},  // I
+    {1, 1, 1, 5, 2},  // J
+    {5, 5, 6, 5, 5},  // K
+    {4, 4, 4, 4, 7},  // L
+    {5, 7, 7, 5, 5},  // M
+    {6, 5, 5, 5, 5},  // N
+    {2, 5, 5, 5, 2},  // O
+    {6, 5, 6, 4, 4},  // P
+    {2, 5, 5, 6, 3},  // Q
+    {6, 5, 6, 5, 5},  // R
+    {3, 4, 2, 1, 6},  // S
+    {7, 2, 2, 2, 2},  // T
+    {5, 5, 5, 5, 7},  // U
+    {5, 5, 5, 5, 2},  // V
+    {5, 5, 7, 7, 5},  // W
+    {5, 5, 2, 5, 5},  // X
+    {5, 5, 2, 2, 2},  // Y
+    {7, 1, 2, 4, 7},  // Z
+    {3, 2, 2, 2, 3},  // [
+    {4, 4, 2, 1, 1},  // backslash
+    {6, 2, 2, 2, 6},  // ]
+    {2, 5, 0, 0, 0},  // ^
+    {0, 0, 0, 0, 7},  // _
+};
+
+// Lowercase letters use the uppercase glyphs, other characters '?'
+static const uint8_t *Glyph(char c) {
+  if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+  if (c < FONT_FIRST || c > FONT_LAST) c = '?';
+  return kFont[c - FONT_FIRST];
+}
+
+// Component pointers of a row of the buffer: pixel x of component i is at
+// c[i][x * step]
+struct RowWriter {
+  uint8_t *c[3];
+  uint32_t step;
+
+  void Fill(uint32_t x0, uint32_t x1, const EdgeAppLibColor &color) {
+    for (uint32_t x = x0; x <= x1; ++x) {
+      c[0][x * step] = color.red;
+      c[1][x * step] = color.green;
+      c[2][x * step] = color.blue;
+    }
+  }
+
+  // |alpha| 0 (keep) to 255 (color)
+  void Blend(uint32_t x, const EdgeAppLibColor &color, uint32_t alpha) {
+    const uint32_t keep = 255 - alpha;
+    uint8_t *p0 = &c[0][x * step];
+    uint8_t *p1 = &c[1][x * step];
+    uint8_t *p2 = &c[2][x * step];
+    *p0 = static_cast<uint8_t>((*p0 * keep + color.red * alpha + 127) / 255);
+    *p1 = static_cast<uint8_t>((*p1 * keep + color.green * alpha + 127) / 255);
+    *p2 = static_cast<uint8_t>((*p2 * keep + color.blue * alpha + 127) / 255);
+  }
+};
+
+static RowWriter MakeRowWriter(struct EdgeAppLibDrawBuffer *buffer,
+                               uint32_t y) {
+  uint8_t *row = static_cast<uint8_t *>(buffer->address) +
+                 static_cast<size_t>(y) * buffer->stride_byte;
+  const size_t plane = static_cast<size_t>(buffer->stride_byte) *
+                       buffer->height;
+  switch (buffer->format) {
+    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
+      return {{row, row + plane, row + 2 * plane}, 1};
+    case AITRIOS_DRAW_FORMAT_BGR8:
+      return {{row + 2, row + 1, row}, 3};
+    default:
+      return {{row, row + 1, row + 2}, 3};
+  }
+}
+
+enum PrimitiveKind { kMask = 0, kBox = 1, kLabel = 2 };
+
+// Rows [top, bottom] of a primitive, clamped to the buffer. Primitives are
+// drawn in the order of |order|: masks, boxes then labels, each in array
+// order.
+struct PrimitiveSpan {
+  uint32_t top;
+  uint32_t bottom;
+  uint32_t order;
+  PrimitiveKind kind;
+  uint32_t index;
+};
+
+static void RenderBoxRow(RowWriter &row, const EdgeAppLibDrawBox &box,
+                         uint32_t y, uint32_t width, uint32_t height) {
+  const uint32_t left = std::min(box.left, width - 1);
+  const uint32_t right = std::min(box.right, width - 1);
+  const uint32_t top = std::min(box.top, height - 1);
+  const uint32_t bottom = std::min(box.bottom, height - 1);
+  if (left > right) return;
+  const uint32_t t = box.thickness ? box.thickness - 1 : 0;
+  if (y <= top + t || y + t >= bottom) {
+    row.Fill(left, right, box.color);
+    return;
+  }
+  row.Fill(left, std::min(left + t, right), box.color);
+  row.Fill(right > t && right - t > left ? right - t : left, right,
+           box.color);
+}
+
+static void RenderMaskRow(RowWriter &row, const EdgeAppLibDrawMask &mask,
+                          uint32_t y, uint32_t width) {
+  if (mask.left >= width) return;
+  const uint32_t x_end = static_cast<uint32_t>(
+      std::min<uint64_t>(static_cast<uint64_t>(mask.left) + mask.width, width));
+  const uint8_t *coverage =
+      mask.mask ? mask.mask + static_cast<size_t>(y - mask.top) *
+                                  mask.mask_stride
+                : nullptr;
+  if (coverage == nullptr && mask.alpha == 255) {
+    row.Fill(mask.left, x_end - 1, mask.color);
+    return;
+  }
+  for (uint32_t x = mask.left; x < x_end; ++x) {
+    uint32_t alpha = mask.alpha;
+    if (coverage) alpha = (alpha * coverage[x - mask.left] + 127) / 255;
+    if (alpha != 0) row.Blend(x, mask.color, alpha);
+  }
+}
+
+static void RenderLabelRow(RowWriter &row, const EdgeAppLibDrawLabel &label,
+                           uint32_t y, uint32_t width) {
+  const uint32_t scale = label.scale ? label.scale : 1;
+  const uint32_t glyph_row = (y - label.top) / scale;
+  uint32_t x = label.left;
+  for (const char *c = label.text; *c != '\0' && x < width; ++c) {
+    const uint8_t bits = Glyph(*c)[glyph_row];
+    for (uint32_t col = 0; col < FONT_WIDTH; ++col) {
+      if ((bits & (4 >> col)) == 0) continue;
+      const uint32_t x0 = x + col * scale;
+      if (x0 >= width) break;
+      row.Fill(x0, std::min(x0 + scale, width) - 1, label.color);
+    }
+    x += FONT_ADVANCE * scale;
+  }
+}
+
+void RenderPrimitives(struct EdgeAppLibDrawBuffer *buffer,
+                      const struct EdgeAppLibDrawPrimitives *primitives) {
+  const uint32_t width = buffer->width;
+  const uint32_t height = buffer->height;
+  std::vector<PrimitiveSpan> spans;
+  spans.reserve(primitives->num_masks + primitives->num_boxes +
+                primitives->num_labels);
+  uint32_t order = 0;
+  auto add = [&](PrimitiveKind kind, uint32_t index, uint32_t top,
+                 uint64_t rows) {
+    uint32_t o = order++;
+    if (rows == 0 || top >= height) return;
+    uint64_t bottom = std::min<uint64_t>(top + rows - 1, height - 1);
+    spans.push_back({top, static_cast<uint32_t>(bottom), o, kind, index});
+  };
+  for (uint32_t i = 0; i < primitives->num_masks; ++i) {
+    const EdgeAppLibDrawMask &m = primitives->masks[i];
+    add(kMask, i, m.top, m.width ? m.height : 0);
+  }
+  for (uint32_t i = 0; i < primitives->num_boxes; ++i) {
+    const EdgeAppLibDrawBox &b = primitives->boxes[i];
+    // Clamped like DrawRectangle: boxes below the image touch its last row
+    uint32_t top = std::min(b.top, height - 1);
+    uint32_t bottom = std::min(b.bottom, height - 1);
+    add(kBox, i, top, bottom >= top ? bottom - top + 1 : 0);
+  }
+  for (uint32_t i = 0; i < primitives->num_labels; ++i) {
+    const EdgeAppLibDrawLabel &l = primitives->labels[i];
+    uint32_t scale = l.scale ? l.scale : 1;
+    add(kLabel, i, l.top, l.text ? FONT_HEIGHT * scale : 0);
+  }
+  std::sort(spans.begin(), spans.end(),
+            [](const PrimitiveSpan &a, const PrimitiveSpan &b) {
+              return a.top != b.top ? a.top < b.top : a.order < b.order;
+            });
+
+  // Active primitives, kept in drawing order
+  std::vector<const PrimitiveSpan *> active;
+  size_t next = 0;
+  uint32_t y = spans.empty() ? height : spans[0].top;
+  while (y < height) {
+    for (; next < spans.size() && spans[next].top == y; ++next) {
+      const PrimitiveSpan *span = &spans[next];
+      active.insert(std::upper_bound(active.begin(), active.end(), span,
+                                     [](const PrimitiveSpan *a,
+                                        const PrimitiveSpan *b) {
+                                       return a->order < b->order;
+                                     }),
+                    span);
+    }
+    if (active.empty()) {
+      if (next == spans.size()) break;
+      y = spans[next].top;  // Skip the rows without primitives
+      continue;
+    }
+
+    RowWriter row = MakeRowWriter(buffer, y);
+    for (const PrimitiveSpan *span : active) {
+      switch (span->kind) {
+        case kMask:
+          RenderMaskRow(row, primitives->masks[span->index], y, width);
+          break;
+        case kBox:
+          RenderBoxRow(row, primitives->boxes[span->index], y, width, height);
+          break;
+        case kLabel:
+          RenderLabelRow(row, primitives->labels[span->index], y, width);
+          break;
+      }
+    }
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [y](const PrimitiveSpan *span) {
+                                  return span->bottom == y;
+                                }),
+                 active.end());
+    ++y;
+  }
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _AITRIOS_DRAW_PRIMITIVES_H_
+#define _AITRIOS_DRAW_PRIMITIVES_H_
+
+#include "draw.h"
+
+/**
+ * @brief Renders a batch of primitives in a single pass over the rows.
+ * @details The primitives are sorted by their first row; each row of the
+ * buffer they touch is visited once, rendering the primitives covering it
+ * in drawing order.
+ *
+ * @param[in] buffer Valid RGB8, BGR8 or RGB8_PLANAR buffer.
+ * @param[in] primitives Primitives to render.
+ */
+void RenderPrimitives(struct EdgeAppLibDrawBuffer *buffer,
+                      const struct EdgeAppLibDrawPrimitives *primitives);
+
+#endif /* _AITRIOS_DRAW_PRIMITIVES_H_ */
@@ -0,0 +1,290 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <string.h>
+
+#include <vector>
+
+#include "edgeapp_core.h"
+#include "log.h"
+
+namespace EdgeAppCore {
+
+// ROI of a stage waiting to run
+struct CascadeItem {
+  uint32_t stage;
+  EdgeAppLibSensorImageCropProperty roi;
+};
+
+struct Cascade {
+  CascadeStage stages[MAX_CASCADE_STAGES];
+  uint32_t num_stages = 0;
+  bool busy[MAX_CASCADE_STAGES][MAX_GRAPH_CONTEXTS] = {};  // Contexts in use
+
+  pthread_t workers[MAX_CASCADE_WORKERS];
+  uint32_t num_workers = 0;
+  CascadeItem queue[MAX_CASCADE_QUEUE];
+  uint32_t queue_depth = 0;
+  uint32_t head = 0;   // Next item to run
+  uint32_t count = 0;  // Items in the queue
+
+  EdgeAppLibSensorFrame frame = 0;  // Frame of the running RunCascade
+  uint32_t pending = 0;             // Items of the frame not finished yet
+  bool failed = false;
+  bool stop = false;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t work_cond;     // Queue not empty, or stop
+  pthread_cond_t context_cond;  // A context was released
+  pthread_cond_t done_cond;     // pending dropped to 0
+};
+
+static void RunItem(Cascade *cascade, const CascadeItem &item);
+
+static void MarkFailed(Cascade *cascade) {
+  pthread_mutex_lock(&cascade->mutex);
+  cascade->failed = true;
+  pthread_mutex_unlock(&cascade->mutex);
+}
+
+// Queues |item|, or runs it on the calling thread when the queue is full so
+// that producers slow down to the pace of the workers
+static void Submit(Cascade *cascade, const CascadeItem &item) {
+  pthread_mutex_lock(&cascade->mutex);
+  cascade->pending++;
+  if (cascade->num_workers != 0 && cascade->count < cascade->queue_depth) {
+    uint32_t tail = (cascade->head + cascade->count) % cascade->queue_depth;
+    cascade->queue[tail] = item;
+    cascade->count++;
+    pthread_cond_signal(&cascade->work_cond);
+    pthread_mutex_unlock(&cascade->mutex);
+    return;
+  }
+  pthread_mutex_unlock(&cascade->mutex);
+  RunItem(cascade, item);
+}
+
+static void FinishItem(Cascade *cascade) {
+  pthread_mutex_lock(&cascade->mutex);
+  if (--cascade->pending == 0) pthread_cond_broadcast(&cascade->done_cond);
+  pthread_mutex_unlock(&cascade->mutex);
+}
+
+// Hands the outputs of |item| to the sink of its stage and submits the ROIs
+// of the child stages. |ctx| must stay owned by the caller, since the outputs
+// are views into its output pool.
+static bool CompleteStage(Cascade *cascade, const CascadeItem &item,
+                          EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame) {
+  const CascadeStage &stage = cascade->stages[item.stage];
+  std::vector<Tensor> outputs = GetOutputs(ctx, frame, stage.num_outputs);
+  if (outputs.empty()) {
+    LOG_ERR("Cascade: no output for stage %" PRIu32 ".", item.stage);
+    return false;
+  }
+  uint32_t num_outputs = outputs.size();
+  if (stage.sink != nullptr &&
+      stage.sink(item.stage, frame, item.roi, outputs.data(), num_outputs,
+                 stage.user_data) != EdgeAppCoreResultSuccess) {
+    LOG_WARN("Cascade: sink of stage %" PRIu32 " failed.", item.stage);
+    return false;
+  }
+
+  for (uint32_t child = item.stage + 1; child < cascade->num_stages; ++child) {
+    const CascadeStage &next = cascade->stages[child];
+    if (next.parent != (int32_t)item.stage) continue;
+    EdgeAppLibSensorImageCropProperty rois[MAX_CASCADE_ROIS];
+    uint32_t num_rois =
+        next.roi_source(outputs.data(), num_outputs, item.roi, rois,
+                        MAX_CASCADE_ROIS, next.user_data);
+    if (num_rois > MAX_CASCADE_ROIS) num_rois = MAX_CASCADE_ROIS;
+    for (uint32_t i = 0; i < num_rois; ++i) {
+      Submit(cascade, {child, rois[i]});
+    }
+  }
+  return true;
+}
+
+// Runs the stage of |item| on a free context of the stage
+static void RunItem(Cascade *cascade, const CascadeItem &item) {
+  const CascadeStage &stage = cascade->stages[item.stage];
+  bool *busy = cascade->busy[item.stage];
+  uint32_t index = 0;
+  pthread_mutex_lock(&cascade->mutex);
+  for (;;) {
+    for (index = 0; index < stage.num_contexts && busy[index]; ++index) {
+    }
+    if (index < stage.num_contexts) break;
+    pthread_cond_wait(&cascade->context_cond, &cascade->mutex);
+  }
+  busy[index] = true;
+  EdgeAppLibSensorFrame frame = cascade->frame;
+  pthread_mutex_unlock(&cascade->mutex);
+
+  EdgeAppCoreCtx &ctx = stage.contexts[index];
+  EdgeAppLibSensorImageCropProperty roi = item.roi;
+  bool ok = false;
+  {
+    ProcessedFrame processed = Process(ctx, stage.shared_ctx, frame, roi);
+    // The frame stays owned by the root stage in RunCascade
+    processed.disown();
+    if ((EdgeAppLibSensorFrame)processed == 0) {
+      LOG_ERR("Cascade: stage %" PRIu32 " failed to process its ROI.",
+              item.stage);
+    } else {
+      ok = CompleteStage(cascade, item, ctx, frame);
+    }
+  }
+
+  pthread_mutex_lock(&cascade->mutex);
+  busy[index] = false;
+  if (!ok) cascade->failed = true;
+  pthread_cond_broadcast(&cascade->context_cond);
+  pthread_mutex_unlock(&cascade->mutex);
+  FinishItem(cascade);
+}
+
+static void *CascadeWorker(void *arg) {
+  Cascade *cascade = static_cast<Cascade *>(arg);
+  pthread_mutex_lock(&cascade->mutex);
+  for (;;) {
+    while (!cascade->stop && cascade->count == 0) {
+      pthread_cond_wait(&cascade->work_cond, &cascade->mutex);
+    }
+    if (cascade->count == 0) break;  // Stopped
+    CascadeItem item = cascade->queue[cascade->head];
+    cascade->head = (cascade->head + 1) % cascade->queue_depth;
+    cascade->count--;
+    pthread_mutex_unlock(&cascade->mutex);
+    RunItem(cascade, item);
+    pthread_mutex_lock(&cascade->mutex);
+  }
+  pthread_mutex_unlock(&cascade->mutex);
+  return nullptr;
+}
+
+static bool ValidStage(const CascadeStage *stages, uint32_t i) {
+  const CascadeStage &stage = stages[i];
+  if (stage.contexts == nullptr || stage.num_contexts == 0 ||
+      stage.num_contexts > MAX_GRAPH_CONTEXTS || stage.shared_ctx == nullptr ||
+      stage.num_outputs == 0 || stage.num_outputs > MAX_OUTPUT_TENSOR_NUM) {
+    return false;
+  }
+  if (i == 0) return stage.parent == -1;
+  if (stage.parent < 0 || stage.parent >= (int32_t)i ||
+      stage.roi_source == nullptr) {
+    return false;
+  }
+  // The IMX500 only runs on whole frames
+  for (uint32_t j = 0; j < stage.num_contexts; ++j) {
+    if (stage.contexts[j].target == edge_imx500) return false;
+  }
+  return true;
+}
+
+Cascade *CreateCascade(const CascadeStage *stages, uint32_t num_stages,
+                       uint32_t num_workers, uint32_t queue_depth) {
+  if (stages == nullptr || num_stages == 0 ||
+      num_stages > MAX_CASCADE_STAGES || num_workers > MAX_CASCADE_WORKERS ||
+      (num_workers != 0 && queue_depth == 0) ||
+      queue_depth > MAX_CASCADE_QUEUE) {
+    LOG_ERR("CreateCascade: invalid parameters.");
+    return nullptr;
+  }
+  for (uint32_t i = 0; i < num_stages; ++i) {
+    if (!ValidStage(stages, i)) {
+      LOG_ERR("CreateCascade: stage %" PRIu32 " is invalid.", i);
+      return nullptr;
+    }
+  }
+
+  Cascade *cascade = new Cascade();
+  memcpy(cascade->stages, stages, sizeof(CascadeStage) * num_stages);
+  cascade->num_stages = num_stages;
+  cascade->queue_depth = queue_depth;
+  pthread_mutex_init(&cascade->mutex, nullptr);
+  pthread_cond_init(&cascade->work_cond, nullptr);
+  pthread_cond_init(&cascade->context_cond, nullptr);
+  pthread_cond_init(&cascade->done_cond, nullptr);
+  for (uint32_t i = 0; i < num_workers; ++i) {
+    int res = pthread_create(&cascade->workers[i], nullptr, CascadeWorker,
+                             cascade);
+    if (res != 0) {
+      LOG_ERR("pthread_create failed: %d", res);
+      DestroyCascade(cascade);
+      return nullptr;
+    }
+    cascade->num_workers++;
+  }
+  return cascade;
+}
+
+EdgeAppCoreResult RunCascade(Cascade *cascade, EdgeAppLibSensorFrame frame,
+                             const EdgeAppLibSensorImageCropProperty &roi) {
+  if (cascade == nullptr) {
+    LOG_ERR("RunCascade: cascade is null.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  const CascadeStage &root = cascade->stages[0];
+  EdgeAppLibSensorImageCropProperty root_roi = roi;
+  // Releases the frame it got from the sensor once all stages are done
+  ProcessedFrame processed =
+      Process(root.contexts[0], root.shared_ctx, frame, root_roi);
+  frame = processed;
+  if (frame == 0) {
+    LOG_ERR("RunCascade: failed to process the frame.");
+    return EdgeAppCoreResultFailure;
+  }
+
+  pthread_mutex_lock(&cascade->mutex);
+  cascade->frame = frame;
+  cascade->failed = false;
+  cascade->pending = 1;
+  pthread_mutex_unlock(&cascade->mutex);
+
+  if (!CompleteStage(cascade, {0, roi}, root.contexts[0], frame)) {
+    MarkFailed(cascade);
+  }
+  FinishItem(cascade);
+
+  pthread_mutex_lock(&cascade->mutex);
+  while (cascade->pending != 0) {
+    pthread_cond_wait(&cascade->done_cond, &cascade->mutex);
+  }
+  bool failed = cascade->failed;
+  cascade->frame = 0;
+  pthread_mutex_unlock(&cascade->mutex);
+  return failed ? EdgeAppCoreResultFailure : EdgeAppCoreResultSuccess;
+}
+
+void DestroyCascade(Cascade *cascade) {
+  if (cascade == nullptr) return;
+  pthread_mutex_lock(&cascade->mutex);
+  cascade->stop = true;
+  pthread_cond_broadcast(&cascade->work_cond);
+  pthread_mutex_unlock(&cascade->mutex);
+  for (uint32_t i = 0; i < cascade->num_workers; ++i) {
+    pthread_join(cascade->workers[i], nullptr);
+  }
+  pthread_mutex_destroy(&cascade->mutex);
+  pthread_cond_destroy(&cascade->work_cond);
+  pthread_cond_destroy(&cascade->context_cond);
+  pthread_cond_destroy(&cascade->done_cond);
+  delete cascade;
+}
+
+}  // namespace EdgeAppCore
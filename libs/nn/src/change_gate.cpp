@@ -0,0 +1,132 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "change_gate.hpp"
+
+#include <string.h>
+
+namespace EdgeAppCore {
+
+#define GATE_GRID 16    // Blocks per side of the signature
+#define GATE_SAMPLES 4  // Pixels sampled per side of a block
+#define GATE_SIGNATURE_SIZE (GATE_GRID * GATE_GRID * 3)
+
+struct ChangeGate {
+  EdgeAppCoreChangeGate config;
+  uint8_t reference[GATE_SIGNATURE_SIZE];  // Frame of the current outputs
+  uint8_t candidate[GATE_SIGNATURE_SIZE];  // Last frame checked
+  EdgeAppLibSensorImageCropProperty reference_roi;
+  EdgeAppLibSensorImageCropProperty candidate_roi;
+  bool valid;           // reference matches the outputs
+  bool pending;         // candidate holds the signature of the last frame
+  bool reused;          // The last frame reused the outputs
+  uint32_t num_reused;  // Frames reused in a row
+};
+
+ChangeGate *CreateChangeGate(const EdgeAppCoreChangeGate &config) {
+  ChangeGate *gate = new ChangeGate();
+  gate->config = config;
+  return gate;
+}
+
+void DestroyChangeGate(ChangeGate *gate) { delete gate; }
+
+static void ComputeSignature(const EdgeAppLibDrawBuffer &src,
+                             uint8_t *signature) {
+  const uint32_t steps = GATE_GRID * GATE_SAMPLES;
+  const uint8_t *image = static_cast<const uint8_t *>(src.address);
+  uint32_t stride = src.stride_byte != 0 ? src.stride_byte : src.width * 3;
+  for (uint32_t by = 0; by < GATE_GRID; ++by) {
+    for (uint32_t bx = 0; bx < GATE_GRID; ++bx) {
+      uint32_t sum[3] = {0, 0, 0};
+      for (uint32_t sy = 0; sy < GATE_SAMPLES; ++sy) {
+        // Sample at the center of each step
+        uint32_t y = ((by * GATE_SAMPLES + sy) * 2 + 1) * src.height /
+                     (2 * steps);
+        const uint8_t *row = image + (size_t)y * stride;
+        for (uint32_t sx = 0; sx < GATE_SAMPLES; ++sx) {
+          uint32_t x = ((bx * GATE_SAMPLES + sx) * 2 + 1) * src.width /
+                       (2 * steps);
+          const uint8_t *pixel = row + x * 3;
+          sum[0] += pixel[0];
+          sum[1] += pixel[1];
+          sum[2] += pixel[2];
+        }
+      }
+      uint8_t *block = signature + (by * GATE_GRID + bx) * 3;
+      for (uint32_t c = 0; c < 3; ++c) {
+        block[c] = sum[c] / (GATE_SAMPLES * GATE_SAMPLES);
+      }
+    }
+  }
+}
+
+bool ChangeGateCheck(ChangeGate *gate, const EdgeAppLibDrawBuffer &src,
+                     const EdgeAppLibSensorImageCropProperty &roi) {
+  gate->reused = false;
+  uint32_t stride = src.stride_byte != 0 ? src.stride_byte : src.width * 3;
+  if (src.address == nullptr || src.format != AITRIOS_DRAW_FORMAT_RGB8 ||
+      src.width == 0 || src.height == 0 || stride < src.width * 3 ||
+      src.size < (size_t)stride * (src.height - 1) + src.width * 3) {
+    gate->valid = false;
+    gate->pending = false;
+    return false;
+  }
+  ComputeSignature(src, gate->candidate);
+  gate->pending = true;
+  gate->candidate_roi = roi;
+  if (!gate->valid ||
+      memcmp(&roi, &gate->reference_roi, sizeof(roi)) != 0 ||
+      (gate->config.max_reused != 0 &&
+       gate->num_reused >= gate->config.max_reused)) {
+    return false;
+  }
+
+  uint32_t diff = 0;
+  for (uint32_t i = 0; i < GATE_SIGNATURE_SIZE; ++i) {
+    int32_t d = (int32_t)gate->candidate[i] - (int32_t)gate->reference[i];
+    diff += d < 0 ? -d : d;
+  }
+  if ((float)diff / GATE_SIGNATURE_SIZE >= gate->config.threshold) {
+    return false;
+  }
+  gate->reused = true;
+  gate->pending = false;
+  gate->num_reused++;
+  return true;
+}
+
+void ChangeGateCommit(ChangeGate *gate) {
+  if (gate == nullptr || !gate->pending) return;
+  memcpy(gate->reference, gate->candidate, sizeof(gate->reference));
+  gate->reference_roi = gate->candidate_roi;
+  gate->valid = true;
+  gate->reused = false;
+  gate->num_reused = 0;
+}
+
+void ChangeGateInvalidate(ChangeGate *gate) {
+  if (gate == nullptr) return;
+  gate->valid = false;
+  gate->reused = false;
+  gate->num_reused = 0;
+}
+
+bool ChangeGateReused(const ChangeGate *gate) {
+  return gate != nullptr && gate->reused;
+}
+
+}  // namespace EdgeAppCore
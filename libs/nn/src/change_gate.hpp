@@ -0,0 +1,69 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef EDGEAPP_CORE_CHANGE_GATE_H_
+#define EDGEAPP_CORE_CHANGE_GATE_H_
+
+#include "edgeapp_core.h"
+
+namespace EdgeAppCore {
+
+/**
+ * @brief State of the change gating of a context.
+ * @details Holds the signature of the frame the current outputs were inferred
+ * from: the per-channel means of a 16 x 16 grid of blocks, each sampled on a
+ * 4 x 4 grid of pixels. A frame is compared with it by the mean absolute
+ * difference of the two signatures.
+ */
+struct ChangeGate;
+
+ChangeGate *CreateChangeGate(const EdgeAppCoreChangeGate &config);
+void DestroyChangeGate(ChangeGate *gate);
+
+/**
+ * @brief Tells whether the outputs inferred last can be reused for |src|.
+ * @details Frames with another ROI, frames past max_reused and frames that
+ * differ by threshold or more are not reused. Their signature is kept until
+ * ChangeGateCommit.
+ *
+ * @param[in] gate Gate created by CreateChangeGate.
+ * @param[in] src Raw image of the frame (AITRIOS_DRAW_FORMAT_RGB8).
+ * @param[in] roi ROI the model input is cropped from.
+ *
+ * @return true to skip the inference.
+ */
+bool ChangeGateCheck(ChangeGate *gate, const EdgeAppLibDrawBuffer &src,
+                     const EdgeAppLibSensorImageCropProperty &roi);
+
+/**
+ * @brief Makes the frame last given to ChangeGateCheck the reference.
+ * Call it once the frame was inferred.
+ */
+void ChangeGateCommit(ChangeGate *gate);
+
+/**
+ * @brief Forgets the reference, as the outputs no longer match it.
+ */
+void ChangeGateInvalidate(ChangeGate *gate);
+
+/**
+ * @brief Whether the outputs of the context were reused for the last frame.
+ */
+bool ChangeGateReused(const ChangeGate *gate);
+
+}  // namespace EdgeAppCore
+
+#endif  // EDGEAPP_CORE_CHANGE_GATE_H_
@@ -27,6 +27,7 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,16 +41,22 @@
 #include <utility>
 #endif
 
+#include <atomic>
 #include <string>
 
+#include "change_gate.hpp"
 #include "data_export.h"
 #include "draw.h"
 #include "log.h"
 #include "memory_manager.hpp"
+#include "model_cache.hpp"
 #include "nn.h"
+#include "preprocess.hpp"
 #include "receive_data.h"
 #include "send_data.h"
+#include "sm_api.hpp"
 #include "sm_types.h"
+#include "stage_stats.hpp"
 
 #define PORTNAME_META "metadata"
 #define PORTNAME_INPUT "input"
@@ -60,6 +67,7 @@ using namespace EdgeAppLib;
 
 namespace EdgeAppCore {
 static uint32_t model_count = 0;  // Count of loaded models
+static StageStats *send_stats = nullptr;  // SendInputTensor has no context
 char *state_topic = "edgeapp";
 
 char *GetConfigureErrorJsonSm(ResponseCode code, const char *message,
@@ -109,6 +117,195 @@ static char *FindFilenameByRealFilename(const char *dir,
   return filename;
 }
 
+static void FreeOutputPool(OutputTensorPool &pool) {
+  free(pool.buffer);
+  pool = {};
+}
+
+static void FreeBatchOutputs(BatchState &batch) {
+  free(batch.outputs);
+  batch.outputs = nullptr;
+  batch.outputs_capacity = 0;
+  batch.num_rois = 0;
+}
+
+static void FreeBatchState(BatchState &batch) {
+  free(batch.input);
+  free(batch.outputs);
+  batch = {};
+}
+
+#define CONTEXT_POOL_EMPTY 0xFFFFFFFFu
+
+// Execution contexts of one graph shared by the threads calling
+// ComputeConcurrent. Free contexts are kept in a lock-free stack of indices;
+// the head packs a tag in its upper 32 bits so a stale head never wins a CAS.
+// Threads finding the stack empty sleep on |cond| until a context is pushed.
+struct GraphContextPool {
+  uint32_t num_contexts = 0;
+  EdgeAppLibGraphContext contexts[MAX_GRAPH_CONTEXTS];
+  std::atomic<uint32_t> next[MAX_GRAPH_CONTEXTS];
+  std::atomic<uint64_t> head;
+  std::atomic<uint32_t> waiters{0};
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+  ~GraphContextPool() {
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&cond);
+  }
+};
+
+static uint64_t NextHead(uint64_t head, uint32_t index) {
+  return (((head >> 32) + 1) << 32) | index;
+}
+
+static GraphContextPool *CreateContextPool(EdgeAppLibGraph graph,
+                                           uint32_t num_contexts) {
+  GraphContextPool *pool = new GraphContextPool();
+  for (uint32_t i = 0; i < num_contexts; ++i) {
+    if (InitContext(graph, &pool->contexts[i]) != 0) {
+      LOG_ERR("Failed to initialize graph execution context %u.", i);
+      delete pool;
+      return nullptr;
+    }
+    pool->next[i].store(i + 1 < num_contexts ? i + 1 : CONTEXT_POOL_EMPTY,
+                        std::memory_order_relaxed);
+  }
+  pool->num_contexts = num_contexts;
+  pool->head.store(0, std::memory_order_release);
+  return pool;
+}
+
+// Blocks until the stack of free contexts is not empty. |waiters| is raised
+// before the head is checked again so that ReleaseContext, which pushes before
+// reading |waiters|, either sees the waiter or is seen by it.
+static uint64_t WaitForContext(GraphContextPool *pool) {
+  pthread_mutex_lock(&pool->mutex);
+  pool->waiters.fetch_add(1);
+  uint64_t head = pool->head.load();
+  while (static_cast<uint32_t>(head) == CONTEXT_POOL_EMPTY) {
+    pthread_cond_wait(&pool->cond, &pool->mutex);
+    head = pool->head.load();
+  }
+  pool->waiters.fetch_sub(1);
+  pthread_mutex_unlock(&pool->mutex);
+  return head;
+}
+
+// Pops a free context, waiting for one when all of them are in use
+static uint32_t AcquireContext(GraphContextPool *pool) {
+  uint64_t head = pool->head.load(std::memory_order_acquire);
+  for (;;) {
+    uint32_t index = static_cast<uint32_t>(head);
+    if (index == CONTEXT_POOL_EMPTY) {
+      head = WaitForContext(pool);
+      continue;
+    }
+    uint32_t next = pool->next[index].load(std::memory_order_relaxed);
+    if (pool->head.compare_exchange_weak(head, NextHead(head, next),
+                                         std::memory_order_acquire,
+                                         std::memory_order_acquire)) {
+      return index;
+    }
+  }
+}
+
+static void ReleaseContext(GraphContextPool *pool, uint32_t index) {
+  uint64_t head = pool->head.load(std::memory_order_relaxed);
+  do {
+    pool->next[index].store(static_cast<uint32_t>(head),
+                            std::memory_order_relaxed);
+  } while (!pool->head.compare_exchange_weak(head, NextHead(head, index),
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed));
+  if (pool->waiters.load() > 0) {
+    pthread_mutex_lock(&pool->mutex);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+  }
+}
+
+// Size in bytes of one element of |type|.
+static size_t ElementSize(TensorDataType type) {
+  switch (type) {
+    case TensorDataType::TensorTypeFloat16:
+      return 2;
+    case TensorDataType::TensorTypeUInt8:
+    case TensorDataType::TensorTypeInt8:
+      return 1;
+    case TensorDataType::TensorTypeInt64:
+      return 8;
+    default:
+      return 4;
+  }
+}
+
+// Tensor type given to the runtime for |type|. int8 has no runtime type and
+// is passed as bytes.
+static EdgeAppLib::EdgeAppLibTensorType RuntimeTensorType(
+    TensorDataType type) {
+  if (type == TensorDataType::TensorTypeInt8) {
+    return EdgeAppLib::TensorTypeUInt8;
+  }
+  return static_cast<EdgeAppLib::EdgeAppLibTensorType>(type);
+}
+
+// Registered element type of output tensor |index|, float32 if none.
+static EdgeAppCoreQuantization OutputQuantization(const EdgeAppCoreCtx &ctx,
+                                                  uint32_t index) {
+  if (index < ctx.num_output_quant) return ctx.output_quant[index];
+  return {TensorDataType::TensorTypeFloat32, 0.0f, 0};
+}
+
+// Sets the element type, quantization and shape of output tensor |index|
+// holding |size| bytes.
+static void SetOutputElementInfo(const EdgeAppCoreCtx &ctx, uint32_t index,
+                                 size_t size, Tensor &tensor) {
+  EdgeAppCoreQuantization quant = OutputQuantization(ctx, index);
+  tensor.type = quant.type;
+  tensor.scale = quant.scale;
+  tensor.zero_point = quant.zero_point;
+  tensor.shape_info.ndim = 1;
+  tensor.shape_info.dims[0] = size / ElementSize(quant.type);
+}
+
+// Takes the sensor stream of |name| from the model cache and starts it again.
+static bool ReuseCachedSensor(EdgeAppCoreCtx &ctx, const char *name) {
+  CachedModel *cached = AcquireCachedModel(name, edge_imx500, 0);
+  if (cached == nullptr) return false;
+
+  ctx.sensor_core =
+      (EdgeAppLibSensorCore *)xmalloc(sizeof(EdgeAppLibSensorCore));
+  ctx.sensor_stream =
+      (EdgeAppLibSensorStream *)xmalloc(sizeof(EdgeAppLibSensorStream));
+  if (ctx.sensor_core != nullptr && ctx.sensor_stream != nullptr) {
+    *ctx.sensor_core = cached->sensor_core;
+    *ctx.sensor_stream = cached->sensor_stream;
+    if (SensorStart(*ctx.sensor_stream) == 0) {
+      ctx.cached_model = cached;
+      return true;
+    }
+    EdgeAppLibLogSensorError();
+  }
+  // Open the stream again from scratch
+  free(ctx.sensor_core);
+  ctx.sensor_core = nullptr;
+  free(ctx.sensor_stream);
+  ctx.sensor_stream = nullptr;
+  ReleaseCachedModel(cached);
+  EvictModel(name);
+  return false;
+}
+
+static void ReleaseInputBinding(InputBindingState &state) {
+  DestroyInputBinding(state.binding);
+  state = {};
+}
+
+static void StopPipeline(EdgeAppCoreCtx &ctx);
+static bool FetchOutputsToPool(EdgeAppCoreCtx &ctx, uint32_t num_tensors);
+
 EdgeAppCoreResult LoadModel(EdgeAppCoreModelInfo model, EdgeAppCoreCtx &ctx,
                             EdgeAppCoreCtx *shared_ctx) {
   if (model.model_name == nullptr || model.model_name[0] == '\0') {
@@ -119,15 +316,40 @@ EdgeAppCoreResult LoadModel(EdgeAppCoreModelInfo model, EdgeAppCoreCtx &ctx,
     LOG_ERR("LoadModel: model.target is invalid.");
     return EdgeAppCoreResultInvalidParam;
   }
+  if (model.concurrent_contexts > MAX_GRAPH_CONTEXTS ||
+      (model.concurrent_contexts != 0 && model.target == edge_imx500)) {
+    LOG_ERR("LoadModel: model.concurrent_contexts is invalid.");
+    return EdgeAppCoreResultInvalidParam;
+  }
 
   // Initialize context
   ctx.target = model.target;
   ctx.temp_input = {};
+  FreeOutputPool(ctx.output_pool);
+  StopPipeline(ctx);
+  FreeBatchState(ctx.batch);
+  ctx.output_layout = {};
+  ctx.num_output_dests = 0;
+  ctx.num_output_quant = 0;
+  ctx.quantized_input = model.quantized_input;
+  DestroyPreprocessPlan(ctx.preprocess);
+  ctx.preprocess = nullptr;
+  delete ctx.context_pool;
+  ctx.context_pool = nullptr;
+  ReleaseCachedModel(ctx.cached_model);
+  ctx.cached_model = nullptr;
+  DestroyStageStats(ctx.stats);
+  ctx.stats = nullptr;
+  ReleaseInputBinding(ctx.input_binding);
+  DestroyChangeGate(ctx.change_gate);
+  ctx.change_gate = nullptr;
   ctx.mean_values = model.mean_values;
   ctx.norm_values = model.norm_values;
 
   // Helper lambdas
   auto cleanup = [&]() {
+    ReleaseCachedModel(ctx.cached_model);
+    ctx.cached_model = nullptr;
     if (ctx.sensor_stream) {
       free(ctx.sensor_stream);
       ctx.sensor_stream = nullptr;
@@ -142,7 +364,10 @@ EdgeAppCoreResult LoadModel(EdgeAppCoreModelInfo model, EdgeAppCoreCtx &ctx,
     }
   };
 
-  if (model.target == edge_imx500) {
+  if (model.target == edge_imx500 &&
+      ReuseCachedSensor(ctx, model.model_name)) {
+    LOG_INFO("Reusing the open sensor stream of %s", model.model_name);
+  } else if (model.target == edge_imx500) {
     ctx.sensor_core =
         (EdgeAppLibSensorCore *)xmalloc(sizeof(EdgeAppLibSensorCore));
     if (!ctx.sensor_core || SensorCoreInit(ctx.sensor_core) != 0) {
@@ -186,6 +411,14 @@ EdgeAppCoreResult LoadModel(EdgeAppCoreModelInfo model, EdgeAppCoreCtx &ctx,
       cleanup();
       return EdgeAppCoreResultFailure;
     }
+    if (ModelCacheEnabled()) {
+      CachedModel entry = {};
+      snprintf(entry.name, sizeof(entry.name), "%s", model.model_name);
+      entry.target = edge_imx500;
+      entry.sensor_core = *ctx.sensor_core;
+      entry.sensor_stream = *ctx.sensor_stream;
+      ctx.cached_model = InsertCachedModel(entry);
+    }
   } else {
     EdgeAppLibGraph g;
     const char *path = EdgeAppLibReceiveDataStorePath();
@@ -205,8 +438,19 @@ EdgeAppCoreResult LoadModel(EdgeAppCoreModelInfo model, EdgeAppCoreCtx &ctx,
       cleanup();
       return EdgeAppCoreResultFailure;
     }
-    if (EdgeAppLib::LoadModel((const char *)model_path, &g,
-                              (EdgeAppLibExecutionTarget)model.target) != 0) {
+    // A resident model is reused as long as its file did not change
+    size_t model_size = 0;
+    uint64_t fingerprint =
+        ModelCacheEnabled() ? ModelFileFingerprint(model_path, &model_size) : 0;
+    if (fingerprint != 0) {
+      ctx.cached_model =
+          AcquireCachedModel(model.model_name, model.target, fingerprint);
+    }
+    if (ctx.cached_model != nullptr) {
+      g = ctx.cached_model->graph;
+    } else if (EdgeAppLib::LoadModel(
+                   (const char *)model_path, &g,
+                   (EdgeAppLibExecutionTarget)model.target) != 0) {
       LOG_ERR("Failed to load model: %s", model_path);
       cleanup();
       return EdgeAppCoreResultFailure;
@@ -215,128 +459,240 @@ EdgeAppCoreResult LoadModel(EdgeAppCoreModelInfo model, EdgeAppCoreCtx &ctx,
     ctx.graph_ctx =
         (EdgeAppLibGraphContext *)xmalloc(sizeof(EdgeAppLibGraphContext));
     if (!ctx.graph_ctx) {
+      cleanup();
       return EdgeAppCoreResultFailure;
     }
-    if (InitContext(g, ctx.graph_ctx) != 0) {
+    if (ctx.cached_model != nullptr) {
+      *ctx.graph_ctx = ctx.cached_model->graph_ctx;
+      LOG_INFO("Reusing the resident graph of %s", model.model_name);
+    } else if (InitContext(g, ctx.graph_ctx) != 0) {
       LOG_ERR("Failed to initialize graph execution context for model: %s",
               model.model_name);
       cleanup();
       return EdgeAppCoreResultFailure;
+    } else if (fingerprint != 0) {
+      CachedModel entry = {};
+      snprintf(entry.name, sizeof(entry.name), "%s", model.model_name);
+      entry.target = model.target;
+      entry.fingerprint = fingerprint;
+      entry.size = model_size;
+      entry.graph = g;
+      entry.graph_ctx = *ctx.graph_ctx;
+      ctx.cached_model = InsertCachedModel(entry);
+    }
+    if (model.preprocess != nullptr) {
+      ctx.preprocess = CreatePreprocessPlan(
+          *model.preprocess, model.mean_values, model.norm_values);
+      if (ctx.preprocess == nullptr) {
+        LOG_ERR("Failed to create preprocessing for model: %s",
+                model.model_name);
+        cleanup();
+        return EdgeAppCoreResultFailure;
+      }
+    }
+    if (model.concurrent_contexts != 0) {
+      ctx.context_pool = CreateContextPool(g, model.concurrent_contexts);
+      if (ctx.context_pool == nullptr) {
+        DestroyPreprocessPlan(ctx.preprocess);
+        ctx.preprocess = nullptr;
+        cleanup();
+        return EdgeAppCoreResultFailure;
+      }
     }
   }
   LOG_TRACE("Model loaded: %s model_count: %d", model.model_name, model_count);
   ctx.model_idx = model_count++;
+#ifndef EDGEAPP_CORE_NO_STATS
+  ctx.stats = CreateStageStats();
+  if (send_stats == nullptr) send_stats = CreateStageStats();
+#endif
 
   return EdgeAppCoreResultSuccess;
 }
 
-void ProcessedFrame::ProcessInternal(EdgeAppCoreCtx &ctx,
-                                     EdgeAppCoreCtx *shared_ctx,
-                                     EdgeAppLibSensorFrame frame,
-                                     EdgeAppLibSensorImageCropProperty &roi) {
-  if (frame == 0 && shared_ctx->sensor_stream != nullptr) {
-    int8_t ret = SensorGetFrame(*shared_ctx->sensor_stream, &frame, -1);
-    if (ret < 0) {
-      EdgeAppLibLogSensorError();
-      LOG_ERR("SensorGetFrame failed: ret=%d", ret);
-      return;
+// Draw format of a sensor pixel format, AITRIOS_DRAW_FORMAT_UNDEFINED when
+// the draw library cannot read it
+static EdgeAppLibDrawFormat DrawFormatOf(const char *pixel_format) {
+  static const struct {
+    const char *name;
+    EdgeAppLibDrawFormat format;
+  } kFormats[] = {
+      {AITRIOS_SENSOR_PIXEL_FORMAT_RGB24, AITRIOS_DRAW_FORMAT_RGB8},
+      {AITRIOS_SENSOR_PIXEL_FORMAT_RGB8_PLANAR,
+       AITRIOS_DRAW_FORMAT_RGB8_PLANAR},
+      {AITRIOS_SENSOR_PIXEL_FORMAT_BGR24, AITRIOS_DRAW_FORMAT_BGR8},
+      {AITRIOS_SENSOR_PIXEL_FORMAT_GREY, AITRIOS_DRAW_FORMAT_GRAY8},
+      {AITRIOS_SENSOR_PIXEL_FORMAT_NV12, AITRIOS_DRAW_FORMAT_NV12},
+      {AITRIOS_SENSOR_PIXEL_FORMAT_YUV420, AITRIOS_DRAW_FORMAT_I420},
+  };
+  for (const auto &f : kFormats) {
+    if (strncmp(pixel_format, f.name, AITRIOS_SENSOR_PIXEL_FORMAT_LENGTH) ==
+        0) {
+      return f.format;
     }
-    owns_frame_ = true;
   }
-  // Model-specific processing
-  if (ctx.target == edge_imx500) {
-    // For IMX500: just set the ROI on the sensor stream
-    if (roi.width != 0 && roi.height != 0) {
-      int32_t ret = SensorStreamSetProperty(
-          *ctx.sensor_stream, AITRIOS_SENSOR_IMAGE_CROP_PROPERTY_KEY, &roi,
-          sizeof(EdgeAppLibSensorImageCropProperty));
-      if (ret != 0) {
-        LOG_ERR("SensorStreamSetProperty failed with %" PRId32 ".", ret);
-        EdgeAppLibLogSensorError();
-      }
-    }
-  } else {  // For CPU/GPU/NPU: get raw data, crop, preprocess
-    // Clean up any previous temporary input buffer
-    if (ctx.temp_input.buffer &&
-        ctx.temp_input.memory_owner == TensorMemoryOwner::App) {
-      free(ctx.temp_input.buffer);
-      ctx.temp_input.buffer = nullptr;
-    }
-    ctx.temp_input = {};
+  return AITRIOS_DRAW_FORMAT_UNDEFINED;
+}
 
-    // Get the RAW_IMAGE channel
-    EdgeAppLibSensorChannel channel;
-    int32_t ret = SensorFrameGetChannelFromChannelId(
-        frame, AITRIOS_SENSOR_CHANNEL_ID_INFERENCE_RAW_IMAGE, &channel);
-    if (ret < 0) {
-      LOG_WARN("SensorFrameGetChannelFromChannelId Raw failed: ret=%d.", ret);
-      return;
-    }
+// RAW_IMAGE channel of a frame, read once per frame and shared by the change
+// gate and the preparation of every ROI
+struct RawImage {
+  EdgeAppLibDrawBuffer src;
+  EdgeAppLibSensorImageProperty image_property;
+  uint64_t timestamp;
+};
+
+// Reads the RAW_IMAGE channel of |frame| into |raw|
+static bool ReadRawImage(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame,
+                         RawImage &raw) {
+  EdgeAppLibDrawBuffer &src = raw.src;
+  EdgeAppLibSensorImageProperty &image_property = raw.image_property;
+  uint64_t &timestamp = raw.timestamp;
+  // Get the RAW_IMAGE channel
+  EdgeAppLibSensorChannel channel;
+  int32_t ret = SensorFrameGetChannelFromChannelId(
+      frame, AITRIOS_SENSOR_CHANNEL_ID_INFERENCE_RAW_IMAGE, &channel);
+  if (ret < 0) {
+    LOG_WARN("SensorFrameGetChannelFromChannelId Raw failed: ret=%d.", ret);
+    return false;
+  }
 
-    // Get the raw data
-    struct EdgeAppLibSensorRawData data = {0};
+  // Get the raw data
+  struct EdgeAppLibSensorRawData data = {0};
+  {
+    STAGE_TIMER(ctx.stats, EdgeAppCoreStageGetRawData);
     ret = SensorChannelGetRawData(channel, &data);
-    if (ret != 0) {
-      LOG_ERR("SensorChannelGetRawData failed with %" PRId32 ".", ret);
-      EdgeAppLibLogSensorError();
-    }
-    LOG_DBG(
-        "input_raw_data.address:%p\ninput_raw_data.size:%zu\ninput_raw_data."
-        "timestamp:%llu\ninput_raw_data.type:%s",
-        data.address, data.size, data.timestamp, data.type);
-    EdgeAppLibDrawBuffer src{};
-    EdgeAppLibSensorImageProperty image_property;
-    ret = SensorChannelGetProperty(channel, AITRIOS_SENSOR_IMAGE_PROPERTY_KEY,
-                                   &image_property, sizeof(image_property));
-    if (ret != 0) {
-      LOG_ERR("SensorChannelGetProperty failed with %" PRId32 ".", ret);
-      EdgeAppLibLogSensorError();
-    }
-    src.width = image_property.width;
-    src.height = image_property.height;
-    src.stride_byte = image_property.stride_bytes;
-    if (strncmp(image_property.pixel_format, AITRIOS_SENSOR_PIXEL_FORMAT_RGB24,
-                sizeof(AITRIOS_SENSOR_PIXEL_FORMAT_RGB24)) == 0) {
-      src.format = AITRIOS_DRAW_FORMAT_RGB8;
-    } else {
-      LOG_ERR("Unsupported pixel format: %s", image_property.pixel_format);
-      return;
-    }
-    src.size = data.size;
-    src.address = data.address;
-    LOG_DBG("src.address: %p, src.size: %zu, src.width: %d, src.height: %d",
-            src.address, src.size, src.width, src.height);
+  }
+  if (ret != 0) {
+    LOG_ERR("SensorChannelGetRawData failed with %" PRId32 ".", ret);
+    EdgeAppLibLogSensorError();
+  }
+  LOG_DBG(
+      "input_raw_data.address:%p\ninput_raw_data.size:%zu\ninput_raw_data."
+      "timestamp:%llu\ninput_raw_data.type:%s",
+      data.address, data.size, data.timestamp, data.type);
+  ret = SensorChannelGetProperty(channel, AITRIOS_SENSOR_IMAGE_PROPERTY_KEY,
+                                 &image_property, sizeof(image_property));
+  if (ret != 0) {
+    LOG_ERR("SensorChannelGetProperty failed with %" PRId32 ".", ret);
+    EdgeAppLibLogSensorError();
+  }
+  src.width = image_property.width;
+  src.height = image_property.height;
+  src.stride_byte = image_property.stride_bytes;
+  src.format = DrawFormatOf(image_property.pixel_format);
+  if (src.format == AITRIOS_DRAW_FORMAT_UNDEFINED) {
+    LOG_ERR("Unsupported pixel format: %s", image_property.pixel_format);
+    return false;
+  }
+  src.size = data.size;
+  src.address = data.address;
+  timestamp = data.timestamp;
+  LOG_DBG("src.address: %p, src.size: %zu, src.width: %d, src.height: %d",
+          src.address, src.size, src.width, src.height);
+  return true;
+}
 
-    // Adjust ROI based on actual input image size
-    EdgeAppLibSensorImageProperty it_image_property;
-    ret = SensorFrameGetChannelFromChannelId(
-        frame, AITRIOS_SENSOR_CHANNEL_ID_INFERENCE_INPUT_IMAGE, &channel);
-    if (ret < 0) {
-      LOG_WARN("Failed to get INPUT_IMAGE channel: ret=%d.", ret);
-      return;
-    }
-    ret =
-        SensorChannelGetProperty(channel, AITRIOS_SENSOR_IMAGE_PROPERTY_KEY,
+// Transform of an input resized from the |crop_w| x |crop_h| crop at
+// (left, top) of the frame to |input_w| x |input_h|, as preprocessing
+// callbacks do. An unknown input size keeps the crop scale.
+static EdgeAppCoreInputTransform StretchTransform(uint32_t left, uint32_t top,
+                                                  uint32_t crop_w,
+                                                  uint32_t crop_h,
+                                                  uint32_t input_w,
+                                                  uint32_t input_h) {
+  EdgeAppCoreInputTransform transform;
+  if (crop_w != 0 && input_w != 0) {
+    transform.scale_x = static_cast<float>(input_w) / crop_w;
+  }
+  if (crop_h != 0 && input_h != 0) {
+    transform.scale_y = static_cast<float>(input_h) / crop_h;
+  }
+  transform.origin_x = static_cast<float>(left);
+  transform.origin_y = static_cast<float>(top);
+  transform.input_width = input_w ? input_w : crop_w;
+  transform.input_height = input_h ? input_h : crop_h;
+  return transform;
+}
+
+// Crops |roi| of |raw|, the RAW_IMAGE channel of |frame|, and preprocesses it
+// into |input|, with the built-in preprocessing of |plan| if any. When the
+// result is already a model tensor, it is returned in |pre_t| and
+// |has_tensor_from_preprocess| is set.
+static bool PrepareInput(EdgeAppCoreCtx &ctx, PreprocessPlan *plan,
+                         EdgeAppLibSensorFrame frame, const RawImage &raw,
+                         EdgeAppLibSensorImageCropProperty &roi,
+                         PreprocessCallback preprocess_callback,
+                         PreprocessCallbackTensor preprocess_tensor_callback,
+                         void *preprocess_dst, TempTensorInfo &input,
+                         Tensor &pre_t, bool &has_tensor_from_preprocess) {
+  EdgeAppLibDrawBuffer src = raw.src;
+  const EdgeAppLibSensorImageProperty &image_property = raw.image_property;
+  const uint64_t timestamp = raw.timestamp;
+
+  // Adjust ROI based on actual input image size
+  EdgeAppLibSensorChannel channel;
+  EdgeAppLibSensorImageProperty it_image_property;
+  int32_t ret = SensorFrameGetChannelFromChannelId(
+      frame, AITRIOS_SENSOR_CHANNEL_ID_INFERENCE_INPUT_IMAGE, &channel);
+  if (ret < 0) {
+    LOG_WARN("Failed to get INPUT_IMAGE channel: ret=%d.", ret);
+    return false;
+  }
+  ret = SensorChannelGetProperty(channel, AITRIOS_SENSOR_IMAGE_PROPERTY_KEY,
                                  &it_image_property, sizeof(it_image_property));
-    if (ret != 0) {
-      LOG_ERR("SensorChannelGetProperty failed with %" PRId32 ".", ret);
-      EdgeAppLibLogSensorError();
+  if (ret != 0) {
+    LOG_ERR("SensorChannelGetProperty failed with %" PRId32 ".", ret);
+    EdgeAppLibLogSensorError();
+  }
+  if (roi.width > it_image_property.width) roi.width = it_image_property.width;
+  if (roi.height > it_image_property.height)
+    roi.height = it_image_property.height;
+  if (it_image_property.width != 0) {
+    roi.width = roi.width * image_property.width / it_image_property.width;
+    roi.left = roi.left * image_property.width / it_image_property.width;
+  }
+  if (it_image_property.height != 0) {
+    roi.height = roi.height * image_property.height / it_image_property.height;
+    roi.top = roi.top * image_property.height / it_image_property.height;
+  }
+
+  if (plan != nullptr && preprocess_callback == nullptr &&
+      preprocess_tensor_callback == nullptr) {
+    // Built-in preprocessing: crop, resize, normalize and lay out the ROI in a
+    // single pass from the sensor frame, without intermediate buffers. Rows
+    // of other formats than RGB8 are converted as the resampler reads them.
+    EdgeAppCoreResult r;
+    {
+      STAGE_TIMER(ctx.stats, EdgeAppCoreStagePreprocess);
+      r = RunPreprocess(plan, src, roi, preprocess_dst, &pre_t);
     }
-    if (roi.width > it_image_property.width)
-      roi.width = it_image_property.width;
-    if (roi.height > it_image_property.height)
-      roi.height = it_image_property.height;
-    if (it_image_property.width != 0) {
-      roi.width = roi.width * image_property.width / it_image_property.width;
-      roi.left = roi.left * image_property.width / it_image_property.width;
+    if (r != EdgeAppCoreResultSuccess) {
+      LOG_ERR("Built-in preprocessing failed with result: %d", r);
+      return false;
     }
-    if (it_image_property.height != 0) {
-      roi.height =
-          roi.height * image_property.height / it_image_property.height;
-      roi.top = roi.top * image_property.height / it_image_property.height;
+    has_tensor_from_preprocess = true;
+
+    const EdgeAppCorePreprocessInfo &info = GetPreprocessInfo(plan);
+    input.buffer = static_cast<uint8_t *>(pre_t.data);
+    input.size = pre_t.size;
+    input.width = info.width;
+    input.height = info.height;
+    input.timestamp = timestamp;
+    input.memory_owner = pre_t.memory_owner;
+    input.type = info.type;
+    input.layout = info.layout;
+    input.transform = pre_t.transform;
+  } else {
+    // Crop the image if needed. Frames of other formats than RGB8 are
+    // always copied, converted in the same pass.
+    if ((roi.width == 0 || roi.height == 0) &&
+        src.format != AITRIOS_DRAW_FORMAT_RGB8) {
+      roi.left = 0;
+      roi.top = 0;
+      roi.width = src.width;
+      roi.height = src.height;
     }
-
-    // Crop the image if needed
     EdgeAppLibDrawBuffer dst{};
     bool dst_was_allocated = false;
     size_t dst_size = roi.width * roi.height * 3;
@@ -349,9 +705,10 @@ void ProcessedFrame::ProcessInternal(EdgeAppCoreCtx &ctx,
       dst.address = (uint8_t *)malloc(dst_size);
       if (dst.address == nullptr) {
         LOG_ERR("Failed to allocate memory for cropped image.");
-        return;  // Return anyway
+        return false;
       }
       dst_was_allocated = true;
+      STAGE_TIMER(ctx.stats, EdgeAppCoreStageCrop);
       CropRectangle(&src, &dst, roi.left, roi.top, roi.left + roi.width - 1,
                     roi.top + roi.height - 1);
     } else {
@@ -364,24 +721,31 @@ void ProcessedFrame::ProcessInternal(EdgeAppCoreCtx &ctx,
       roi.height = src.height;
       roi.width = src.width;
     }
+    // Origin of the crop in the frame, for the transform of the input
+    const uint32_t origin_x = dst_was_allocated ? roi.left : 0;
+    const uint32_t origin_y = dst_was_allocated ? roi.top : 0;
 
-    EdgeAppCore::Tensor pre_t{};
-    bool has_tensor_from_preprocess = false;
     EdgeAppLibImageProperty input_property;
     input_property.width = dst.width;
     input_property.height = dst.height;
     input_property.stride_bytes = dst.stride_byte;
-    strncpy(input_property.pixel_format, image_property.pixel_format,
+    strncpy(input_property.pixel_format,
+            dst_was_allocated ? AITRIOS_SENSOR_PIXEL_FORMAT_RGB24
+                              : image_property.pixel_format,
             sizeof(input_property.pixel_format) - 1);
-    input_property.pixel_format[sizeof(input_property.pixel_format) - 1] = '\0';
-
-    if (preprocess_tensor_callback_ != nullptr) {
-      EdgeAppCoreResult r =
-          preprocess_tensor_callback_(dst.address, input_property, &pre_t);
+    input_property.pixel_format[sizeof(input_property.pixel_format) - 1] =
+        '\0';
+
+    if (preprocess_tensor_callback != nullptr) {
+      EdgeAppCoreResult r;
+      {
+        STAGE_TIMER(ctx.stats, EdgeAppCoreStagePreprocess);
+        r = preprocess_tensor_callback(dst.address, input_property, &pre_t);
+      }
       if (r != EdgeAppCoreResultSuccess) {
         LOG_ERR("Preprocessing failed with result: %d", r);
         if (dst_was_allocated) free(dst.address);
-        return;
+        return false;
       }
 
       // Clean up cropped data if it was allocated
@@ -392,27 +756,31 @@ void ProcessedFrame::ProcessInternal(EdgeAppCoreCtx &ctx,
       has_tensor_from_preprocess = true;
 
       // Use preprocessed tensor
-      ctx.temp_input.buffer = static_cast<uint8_t *>(pre_t.data);
-      ctx.temp_input.size = pre_t.size;
+      input.buffer = static_cast<uint8_t *>(pre_t.data);
+      input.size = pre_t.size;
       // NHWC : [N,H,W,C] base
-      ctx.temp_input.width =
+      input.width =
           (pre_t.shape_info.ndim >= 3) ? pre_t.shape_info.dims[2] : 0;
-      ctx.temp_input.height =
+      input.height =
           (pre_t.shape_info.ndim >= 2) ? pre_t.shape_info.dims[1] : 0;
-      ctx.temp_input.timestamp = data.timestamp;
-      ctx.temp_input.memory_owner = pre_t.memory_owner;
-    } else if (preprocess_callback_ != nullptr) {
+      input.timestamp = timestamp;
+      input.memory_owner = pre_t.memory_owner;
+    } else if (preprocess_callback != nullptr) {
       EdgeAppLibImageProperty output_property;
       void *preprocessed_data = nullptr;
-      EdgeAppCoreResult r = preprocess_callback_(
-          dst.address, input_property, &preprocessed_data, &output_property);
+      EdgeAppCoreResult r;
+      {
+        STAGE_TIMER(ctx.stats, EdgeAppCoreStagePreprocess);
+        r = preprocess_callback(dst.address, input_property, &preprocessed_data,
+                                &output_property);
+      }
 
       if (r != EdgeAppCoreResultSuccess) {
         LOG_ERR("Preprocessing failed with result: %d", r);
         if (dst_was_allocated) {
           free(dst.address);
         }
-        return;
+        return false;
       }
 
       // Clean up cropped data if it was allocated
@@ -422,57 +790,219 @@ void ProcessedFrame::ProcessInternal(EdgeAppCoreCtx &ctx,
       }
 
       // Use preprocessed data
-      ctx.temp_input.buffer = static_cast<uint8_t *>(preprocessed_data);
-      ctx.temp_input.size =
+      input.buffer = static_cast<uint8_t *>(preprocessed_data);
+      input.size =
           output_property.width * output_property.height * 3;  // RGB data size
-      ctx.temp_input.width =
-          output_property.width;  // Use preprocessed dimensions
-      ctx.temp_input.height = output_property.height;
-      ctx.temp_input.timestamp = data.timestamp;
-      ctx.temp_input.memory_owner = TensorMemoryOwner::App;
+      input.width = output_property.width;  // Use preprocessed dimensions
+      input.height = output_property.height;
+      input.timestamp = timestamp;
+      input.memory_owner = TensorMemoryOwner::App;
     } else {
       // Use cropped data directly (fallback to original behavior)
-      ctx.temp_input.buffer = static_cast<uint8_t *>(dst.address);
-      ctx.temp_input.size = dst.size;
-      ctx.temp_input.width = dst.width;
-      ctx.temp_input.height = dst.height;
-      ctx.temp_input.timestamp = data.timestamp;
-      ctx.temp_input.memory_owner = dst_was_allocated
-                                        ? TensorMemoryOwner::App
-                                        : TensorMemoryOwner::Sensor;
+      input.buffer = static_cast<uint8_t *>(dst.address);
+      input.size = dst.size;
+      input.width = dst.width;
+      input.height = dst.height;
+      input.timestamp = timestamp;
+      input.memory_owner = dst_was_allocated ? TensorMemoryOwner::App
+                                             : TensorMemoryOwner::Sensor;
+    }
+    input.transform = StretchTransform(origin_x, origin_y, dst.width,
+                                       dst.height, input.width, input.height);
+  }
+  return true;
+}
+
+// Sets |data| as the model input through the binding of |ctx|, which is only
+// created again when the shape, type or normalization changes
+static EdgeAppLibNNResult BindGraphInput(EdgeAppCoreCtx &ctx, uint8_t *data,
+                                         uint32_t (*dims)[4],
+                                         EdgeAppLib::EdgeAppLibTensorType type,
+                                         bool normalize) {
+  static const float default_mean[3] = {0.0f, 0.0f, 0.0f};
+  static const float default_norm[3] = {1.0f, 1.0f, 1.0f};
+  InputBindingState &state = ctx.input_binding;
+  if (state.binding == nullptr ||
+      memcmp(state.dims, *dims, sizeof(state.dims)) != 0 ||
+      state.type != type || state.normalize != normalize) {
+    ReleaseInputBinding(state);
+    const float *mean = default_mean;
+    size_t mean_size = 3;
+    const float *norm = default_norm;
+    size_t norm_size = 3;
+    if (normalize && ctx.mean_values != nullptr) {
+      mean = ctx.mean_values->data();
+      mean_size = ctx.mean_values->size();
+    }
+    if (normalize && ctx.norm_values != nullptr) {
+      norm = ctx.norm_values->data();
+      norm_size = ctx.norm_values->size();
+    }
+    EdgeAppLibNNResult result = CreateInputBinding(
+        *ctx.graph_ctx, dims, type, normalize ? mean : nullptr, mean_size,
+        normalize ? norm : nullptr, norm_size, &state.binding);
+    if (result != EDGEAPP_LIB_NN_SUCCESS) return result;
+    memcpy(state.dims, *dims, sizeof(state.dims));
+    state.type = type;
+    state.normalize = normalize;
+  }
+  return BindInput(state.binding, data);
+}
+
+// Sets the input of the graph from |pre_t|, or from ctx.temp_input without
+// it. Returns false if the input was rejected.
+static bool SetGraphInput(EdgeAppCoreCtx &ctx, Tensor *pre_t) {
+  STAGE_TIMER(ctx.stats, EdgeAppCoreStageSetInput);
+  uint32_t dims[4] = {1, ctx.temp_input.height, ctx.temp_input.width, 3};
+  if (pre_t != nullptr) {
+    // Tensor version SetInput
+    if (BindGraphInput(ctx, ctx.temp_input.buffer, &pre_t->shape_info.dims,
+                       RuntimeTensorType(pre_t->type), false) != 0) {
+      LOG_ERR("Failed to set input tensor (Tensor version)");
+      return false;
+    }
+  } else if (ctx.quantized_input) {
+    // Quantized model: the uint8 image is the model input
+    if (BindGraphInput(ctx, ctx.temp_input.buffer, &dims,
+                       EdgeAppLib::TensorTypeUInt8, false) != 0) {
+      LOG_ERR("Failed to set input tensor (uint8 version)");
+      return false;
+    }
+  } else {
+    // Fallback: uint8 image normalized with the mean/norm values
+    if (BindGraphInput(ctx, ctx.temp_input.buffer, &dims,
+                       EdgeAppLib::TensorTypeFloat32, true) != 0) {
+      LOG_ERR("Failed to set input tensor (buffer version)");
+    }
+  }
+  return true;
+}
+
+// Sets the input of the graph from |pre_t| (or ctx.temp_input) and runs it.
+// Returns false if the input was rejected. |computed|, when given, tells
+// whether Compute succeeded.
+static bool SetInputAndCompute(EdgeAppCoreCtx &ctx, Tensor *pre_t,
+                               bool *computed = nullptr) {
+  bool input_set = true;
+  if (computed != nullptr) *computed = false;
+  if (ctx.graph_ctx != nullptr) {
+    // Outputs of the previous frame are no longer valid
+    ctx.output_pool.fetched = 0;
+    ctx.batch.num_rois = 0;
+    ChangeGateInvalidate(ctx.change_gate);
+    input_set = SetGraphInput(ctx, pre_t);
+
+    EdgeAppLibNNResult result;
+    {
+      STAGE_TIMER(ctx.stats, EdgeAppCoreStageCompute);
+      result = Compute(*(ctx.graph_ctx));
+    }
+    if (result != 0) {
+      LOG_ERR("Failed to compute graph");
+      /*
+       * Note: Keep the frame valid even if Compute fails, as per test
+       * expectations. The frame can still be used for GetInput/GetOutput
+       * operations.
+       */
+      // operations
+    } else if (computed != nullptr) {
+      *computed = true;
+    }
+  }
+  return input_set;
+}
+
+static void ResetTempInput(EdgeAppCoreCtx &ctx) {
+  if (ctx.temp_input.buffer &&
+      ctx.temp_input.memory_owner == TensorMemoryOwner::App) {
+    free(ctx.temp_input.buffer);
+    ctx.temp_input.buffer = nullptr;
+  }
+  ctx.temp_input = {};
+}
+
+static void SetSensorRoi(EdgeAppCoreCtx &ctx,
+                         const EdgeAppLibSensorImageCropProperty &roi) {
+  if (roi.width != 0 && roi.height != 0) {
+    int32_t ret = SensorStreamSetProperty(
+        *ctx.sensor_stream, AITRIOS_SENSOR_IMAGE_CROP_PROPERTY_KEY, &roi,
+        sizeof(EdgeAppLibSensorImageCropProperty));
+    if (ret != 0) {
+      LOG_ERR("SensorStreamSetProperty failed with %" PRId32 ".", ret);
+      EdgeAppLibLogSensorError();
+    }
+  }
+}
+
+// Change gating: tells whether |frame| can keep the outputs of the last
+// inference of |ctx|
+static bool ReuseOutputs(EdgeAppCoreCtx &ctx, const EdgeAppLibDrawBuffer &src,
+                         const EdgeAppLibSensorImageCropProperty &roi) {
+  if (!ChangeGateCheck(ctx.change_gate, src, roi)) {
+    return false;
+  }
+  // The input of the last inference may point into a released frame
+  if (ctx.temp_input.memory_owner == TensorMemoryOwner::Sensor) {
+    ctx.temp_input.buffer = nullptr;
+    ctx.temp_input.size = 0;
+  }
+  return true;
+}
+
+void ProcessedFrame::ProcessInternal(EdgeAppCoreCtx &ctx,
+                                     EdgeAppCoreCtx *shared_ctx,
+                                     EdgeAppLibSensorFrame frame,
+                                     EdgeAppLibSensorImageCropProperty &roi) {
+  if (frame == 0 && shared_ctx->sensor_stream != nullptr) {
+    int8_t ret;
+    {
+      STAGE_TIMER(ctx.stats, EdgeAppCoreStageGetFrame);
+      ret = SensorGetFrame(*shared_ctx->sensor_stream, &frame, -1);
+    }
+    if (ret < 0) {
+      EdgeAppLibLogSensorError();
+      LOG_ERR("SensorGetFrame failed: ret=%d", ret);
+      return;
+    }
+    owns_frame_ = true;
+  }
+  // The frame is read once, for the change gate and the input
+  RawImage raw{};
+  bool has_raw = false;
+  if (ctx.target != edge_imx500) {
+    has_raw = ReadRawImage(ctx, frame, raw);
+    if (!has_raw) raw.src = {};  // Drops the signature of the gate
+  }
+
+  // Model-specific processing
+  if (ctx.target == edge_imx500) {
+    // For IMX500: just set the ROI on the sensor stream
+    SetSensorRoi(ctx, roi);
+  } else if (ctx.change_gate != nullptr && ReuseOutputs(ctx, raw.src, roi)) {
+    // The scene did not change: the outputs of the last inference stand
+    LOG_DBG("Change gate: reusing the outputs of model index: %d",
+            ctx.model_idx);
+  } else {  // For CPU/GPU/NPU: get raw data, crop, preprocess
+    // Clean up any previous temporary input buffer
+    ResetTempInput(ctx);
+
+    EdgeAppCore::Tensor pre_t{};
+    bool has_tensor_from_preprocess = false;
+    if (!has_raw ||
+        !PrepareInput(ctx, ctx.preprocess, frame, raw, roi,
+                      preprocess_callback_, preprocess_tensor_callback_,
+                      nullptr, ctx.temp_input, pre_t,
+                      has_tensor_from_preprocess)) {
+      return;
     }
 
     // Set input tensor and run inference
-    if (ctx.graph_ctx != nullptr) {
-      if (has_tensor_from_preprocess) {
-        // Tensor version SetInput
-        if (SetInputFromTensor(
-                *(ctx.graph_ctx), ctx.temp_input.buffer, &pre_t.shape_info.dims,
-                static_cast<EdgeAppLib::EdgeAppLibTensorType>(pre_t.type)) !=
-            0) {
-          LOG_ERR("Failed to set input tensor (Tensor version)");
-          frame = 0;
-        }
-      } else {
-        // Fallback: buffer version SetInput
-        uint32_t dims[4] = {1, ctx.temp_input.height, ctx.temp_input.width, 3};
-        if (SetInput(*(ctx.graph_ctx), ctx.temp_input.buffer, dims,
-                     ctx.mean_values ? ctx.mean_values->data() : nullptr,
-                     ctx.mean_values ? ctx.mean_values->size() : 0,
-                     ctx.norm_values ? ctx.norm_values->data() : nullptr,
-                     ctx.norm_values ? ctx.norm_values->size() : 0) != 0) {
-          LOG_ERR("Failed to set input tensor (buffer version)");
-        }
-      }
-      if (Compute(*(ctx.graph_ctx)) != 0) {
-        LOG_ERR("Failed to compute graph");
-        /*
-         * Note: Keep the frame valid even if Compute fails, as per test
-         * expectations. The frame can still be used for GetInput/GetOutput
-         * operations.
-         */
-        // operations
-      }
+    bool computed = false;
+    if (!SetInputAndCompute(ctx, has_tensor_from_preprocess ? &pre_t : nullptr,
+                            &computed)) {
+      frame = 0;
+    } else if (computed) {
+      ChangeGateCommit(ctx.change_gate);
     }
   }
 
@@ -495,10 +1025,488 @@ ProcessedFrame Process(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
   return f.withROI(roi).compute();
 }
 
-static bool Imx500FetchOutputOnce(
-    EdgeAppLibSensorFrame frame, EdgeAppLibSensorRawData *out_data,
-    std::vector<std::vector<uint32_t>> *out_shapes) {
-  if (!out_data || !out_shapes) return false;
+// Grows |*buffer| to at least |size| bytes. The content is not kept.
+static bool ReserveBuffer(uint8_t **buffer, size_t *capacity, size_t size) {
+  if (*capacity >= size) return true;
+  free(*buffer);
+  *buffer = static_cast<uint8_t *>(malloc(size));
+  if (*buffer == nullptr) {
+    LOG_ERR("malloc failed");
+    *capacity = 0;
+    return false;
+  }
+  *capacity = size;
+  return true;
+}
+
+// Preprocesses every ROI into one N-batched input and runs a single Compute.
+// Returns false on failure; ctx.batch.unsupported is only set when the model
+// does not accept the batched input, so other failures retry next frame.
+static bool ProcessBatchNative(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame,
+                               const RawImage &raw,
+                               const EdgeAppLibSensorImageCropProperty *rois,
+                               uint32_t num_rois) {
+  BatchState &batch = ctx.batch;
+  size_t roi_size = GetPreprocessOutputSize(ctx.preprocess);
+  if (!ReserveBuffer(&batch.input, &batch.input_capacity,
+                     roi_size * num_rois)) {
+    return false;
+  }
+
+  ResetTempInput(ctx);
+  Tensor pre_t{};
+  for (uint32_t i = 0; i < num_rois; ++i) {
+    EdgeAppLibSensorImageCropProperty roi = rois[i];
+    bool has_tensor_from_preprocess = false;
+    if (!PrepareInput(ctx, ctx.preprocess, frame, raw, roi, nullptr, nullptr,
+                      batch.input + i * roi_size, ctx.temp_input, pre_t,
+                      has_tensor_from_preprocess)) {
+      return false;
+    }
+    batch.transforms[i] = ctx.temp_input.transform;
+  }
+  pre_t.data = batch.input;
+  pre_t.size = roi_size * num_rois;
+  pre_t.shape_info.dims[0] = num_rois;
+  ctx.temp_input.buffer = batch.input;
+  ctx.temp_input.size = pre_t.size;
+  ctx.temp_input.batch = num_rois;
+
+  bool computed = false;
+  if (!SetInputAndCompute(ctx, &pre_t, &computed)) {
+    batch.unsupported = true;
+    return false;
+  }
+  if (!computed || !FetchOutputsToPool(ctx, MAX_OUTPUT_TENSOR_NUM)) {
+    return false;
+  }
+
+  // Every output tensor must split evenly between the ROIs
+  const OutputTensorPool &pool = ctx.output_pool;
+  for (uint32_t j = 0; j < pool.fetched; ++j) {
+    if (pool.sizes[j] % num_rois != 0) {
+      LOG_WARN("Output tensor %u is not batched (%u bytes for %u ROIs).", j,
+               pool.sizes[j], num_rois);
+      batch.unsupported = true;
+      return false;
+    }
+    uint32_t slice = pool.sizes[j] / num_rois;
+    for (uint32_t i = 0; i < num_rois; ++i) {
+      batch.offsets[i][j] = pool.offsets[j] + i * slice;
+      batch.sizes[i][j] = slice;
+    }
+  }
+  batch.num_tensors = pool.fetched;
+  batch.native = true;
+  return true;
+}
+
+// Runs one Compute per ROI and gathers the outputs of each of them.
+static bool ProcessBatchLoop(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame,
+                             const RawImage &raw,
+                             const EdgeAppLibSensorImageCropProperty *rois,
+                             uint32_t num_rois) {
+  BatchState &batch = ctx.batch;
+  size_t used = 0;
+  for (uint32_t i = 0; i < num_rois; ++i) {
+    ResetTempInput(ctx);
+    EdgeAppLibSensorImageCropProperty roi = rois[i];
+    Tensor pre_t{};
+    bool has_tensor_from_preprocess = false;
+    if (!PrepareInput(ctx, ctx.preprocess, frame, raw, roi, nullptr, nullptr,
+                      nullptr, ctx.temp_input, pre_t,
+                      has_tensor_from_preprocess)) {
+      return false;
+    }
+    batch.transforms[i] = ctx.temp_input.transform;
+    if (!SetInputAndCompute(ctx,
+                            has_tensor_from_preprocess ? &pre_t : nullptr) ||
+        !FetchOutputsToPool(ctx, MAX_OUTPUT_TENSOR_NUM)) {
+      return false;
+    }
+
+    const OutputTensorPool &pool = ctx.output_pool;
+    if (i == 0 &&
+        !ReserveBuffer(&batch.outputs, &batch.outputs_capacity,
+                       pool.capacity * num_rois)) {
+      return false;
+    }
+    if (used + pool.capacity > batch.outputs_capacity) {
+      LOG_ERR("Output tensor sizes changed between ROIs.");
+      return false;
+    }
+    memcpy(batch.outputs + used, pool.buffer, pool.capacity);
+    for (uint32_t j = 0; j < pool.fetched; ++j) {
+      batch.offsets[i][j] = used + pool.offsets[j];
+      batch.sizes[i][j] = pool.sizes[j];
+    }
+    batch.num_tensors = pool.fetched;
+    used += pool.capacity;
+  }
+  batch.native = false;
+  return true;
+}
+
+ProcessedFrame Process(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
+                       EdgeAppLibSensorFrame frame,
+                       const EdgeAppLibSensorImageCropProperty *rois,
+                       uint32_t num_rois) {
+  if (shared_ctx == nullptr || rois == nullptr || num_rois == 0 ||
+      num_rois > MAX_BATCH_ROIS) {
+    LOG_ERR("Process: invalid ROIs (num_rois=%u, max=%d).", num_rois,
+            MAX_BATCH_ROIS);
+    return ProcessedFrame();
+  }
+  if (ctx.target == edge_imx500 || ctx.graph_ctx == nullptr) {
+    LOG_ERR("Process: multiple ROIs are only supported for CPU/GPU/NPU.");
+    return ProcessedFrame();
+  }
+  bool acquired = false;
+  if (frame == 0 && shared_ctx->sensor_stream != nullptr) {
+    int32_t ret;
+    {
+      STAGE_TIMER(ctx.stats, EdgeAppCoreStageGetFrame);
+      ret = SensorGetFrame(*shared_ctx->sensor_stream, &frame, -1);
+    }
+    if (ret < 0) {
+      EdgeAppLibLogSensorError();
+      LOG_ERR("SensorGetFrame failed: ret=%d", ret);
+      return ProcessedFrame();
+    }
+    acquired = true;
+  }
+  auto fail = [&]() {
+    if (acquired) SensorReleaseFrame(*shared_ctx->sensor_stream, frame);
+    return ProcessedFrame();
+  };
+
+  // Every ROI is cropped from the same read of the frame
+  RawImage raw{};
+  if (!ReadRawImage(ctx, frame, raw)) return fail();
+
+  // Models with built-in preprocessing have a fixed input size, so the ROIs
+  // can be stacked in dims[0]. Fall back to one Compute per ROI otherwise,
+  // or for this frame only when the batched run fails.
+  bool done = false;
+  if (ctx.preprocess != nullptr && num_rois > 1 && !ctx.batch.unsupported) {
+    done = ProcessBatchNative(ctx, frame, raw, rois, num_rois);
+    if (!done && ctx.batch.unsupported) {
+      LOG_WARN("Model does not accept batched input, running ROIs one by one.");
+    }
+  }
+  if (!done && !ProcessBatchLoop(ctx, frame, raw, rois, num_rois)) {
+    return fail();
+  }
+  ctx.batch.num_rois = num_rois;
+  return ProcessedFrame(shared_ctx->sensor_stream, frame);
+}
+
+#define PIPELINE_GET_FRAME_TIMEOUT_MS 100
+
+// A prefetched frame. For CPU/GPU/NPU targets the input is already prepared.
+struct PipelineSlot {
+  EdgeAppLibSensorFrame frame = 0;
+  TempTensorInfo input;
+  Tensor tensor;
+  bool has_tensor = false;
+  void *buffer = nullptr;  // Built-in preprocessing destination
+};
+
+// Frames are acquired (and preprocessed) by a worker thread while the
+// application computes and post-processes the previous one. Ready slots form
+// a FIFO ring starting at |head|. One slot is always kept for the frame held
+// by the application, so at most |depth| frames are in flight.
+// The worker only writes to the slots and to its own copy of the built-in
+// preprocessing plan, so Process may still be called on the context.
+struct FramePipeline {
+  EdgeAppCoreCtx *ctx = nullptr;
+  EdgeAppCoreCtx *shared_ctx = nullptr;
+  PreprocessPlan *preprocess = nullptr;  // Clone of ctx->preprocess
+  EdgeAppLibSensorStream stream = 0;
+  uint32_t depth = 0;
+  PipelineSlot slots[MAX_PIPELINE_DEPTH];
+  uint32_t head = 0;
+  uint32_t ready = 0;
+  EdgeAppLibSensorImageCropProperty roi = {};
+  bool stop = false;
+  bool failed = false;
+  pthread_t thread;
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+};
+
+static void ReleaseSlot(FramePipeline *pipeline, PipelineSlot &slot) {
+  if (slot.input.buffer != nullptr &&
+      slot.input.memory_owner == TensorMemoryOwner::App) {
+    free(slot.input.buffer);
+  }
+  slot.input = {};
+  slot.tensor = {};
+  slot.has_tensor = false;
+  if (slot.frame != 0) {
+    if (SensorReleaseFrame(pipeline->stream, slot.frame) < 0) {
+      LOG_ERR("SensorReleaseFrame failed in pipeline.");
+    }
+    slot.frame = 0;
+  }
+}
+
+static void *PipelineThread(void *arg) {
+  FramePipeline *pipeline = static_cast<FramePipeline *>(arg);
+  EdgeAppCoreCtx &ctx = *pipeline->ctx;
+
+  pthread_mutex_lock(&pipeline->mutex);
+  while (!pipeline->stop) {
+    if (pipeline->failed || pipeline->ready + 1 >= pipeline->depth) {
+      pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+      continue;
+    }
+    PipelineSlot &slot =
+        pipeline->slots[(pipeline->head + pipeline->ready) % pipeline->depth];
+    EdgeAppLibSensorImageCropProperty roi = pipeline->roi;
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    EdgeAppLibSensorFrame frame = 0;
+    RawImage raw{};
+    bool failed = false;
+    uint64_t start = StageClockUs();
+    int32_t ret = SensorGetFrame(pipeline->stream, &frame,
+                                 PIPELINE_GET_FRAME_TIMEOUT_MS);
+    if (ret >= 0 && ctx.stats != nullptr) {
+      RecordStage(ctx.stats, EdgeAppCoreStageGetFrame, StageClockUs() - start);
+    }
+    if (ret < 0) {
+      // Timeouts only give the worker a chance to observe |stop|
+      if (SensorGetLastErrorCause() != AITRIOS_SENSOR_ERROR_TIMEOUT) {
+        EdgeAppLibLogSensorError();
+        LOG_ERR("SensorGetFrame failed in pipeline: ret=%d", ret);
+        failed = true;
+      }
+      frame = 0;
+    } else if (ctx.target != edge_imx500 &&
+               !(ReadRawImage(ctx, frame, raw) &&
+                 PrepareInput(ctx, pipeline->preprocess, frame, raw, roi,
+                              nullptr, nullptr, slot.buffer, slot.input,
+                              slot.tensor, slot.has_tensor))) {
+      LOG_ERR("Failed to prepare input in pipeline.");
+      slot.frame = frame;
+      ReleaseSlot(pipeline, slot);
+      frame = 0;
+      failed = true;
+    }
+
+    pthread_mutex_lock(&pipeline->mutex);
+    if (frame != 0) {
+      slot.frame = frame;
+      pipeline->ready++;
+    }
+    pipeline->failed = failed;
+    pthread_cond_broadcast(&pipeline->cond);
+  }
+  pthread_mutex_unlock(&pipeline->mutex);
+  return nullptr;
+}
+
+static void StopPipeline(EdgeAppCoreCtx &ctx) {
+  FramePipeline *pipeline = ctx.pipeline;
+  if (pipeline == nullptr) return;
+
+  pthread_mutex_lock(&pipeline->mutex);
+  pipeline->stop = true;
+  pthread_cond_broadcast(&pipeline->cond);
+  pthread_mutex_unlock(&pipeline->mutex);
+  pthread_join(pipeline->thread, nullptr);
+
+  // Frames that were never handed to the application
+  for (uint32_t i = 0; i < pipeline->ready; ++i) {
+    ReleaseSlot(pipeline,
+                pipeline->slots[(pipeline->head + i) % pipeline->depth]);
+  }
+  for (uint32_t i = 0; i < pipeline->depth; ++i) {
+    free(pipeline->slots[i].buffer);
+  }
+  DestroyPreprocessPlan(pipeline->preprocess);
+  pthread_mutex_destroy(&pipeline->mutex);
+  pthread_cond_destroy(&pipeline->cond);
+  delete pipeline;
+  ctx.pipeline = nullptr;
+}
+
+EdgeAppCoreResult SetChangeGate(EdgeAppCoreCtx &ctx,
+                                const EdgeAppCoreChangeGate *gate) {
+  if (ctx.target == edge_imx500 || ctx.graph_ctx == nullptr) {
+    LOG_ERR("SetChangeGate: only supported for loaded CPU/GPU/NPU models.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  if (gate != nullptr && !(gate->threshold >= 0.0f)) {
+    LOG_ERR("SetChangeGate: threshold must not be negative.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  DestroyChangeGate(ctx.change_gate);
+  ctx.change_gate = gate != nullptr ? CreateChangeGate(*gate) : nullptr;
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreResult SetPipelineDepth(EdgeAppCoreCtx &ctx,
+                                   EdgeAppCoreCtx *shared_ctx, uint32_t depth) {
+  if (depth == 0 || depth > MAX_PIPELINE_DEPTH) {
+    LOG_ERR("SetPipelineDepth: depth must be between 1 and %d.",
+            MAX_PIPELINE_DEPTH);
+    return EdgeAppCoreResultInvalidParam;
+  }
+  StopPipeline(ctx);
+  if (depth == 1) {
+    return EdgeAppCoreResultSuccess;
+  }
+  if (shared_ctx == nullptr || shared_ctx->sensor_stream == nullptr) {
+    LOG_ERR("SetPipelineDepth: sensor stream is not initialized.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+
+  FramePipeline *pipeline = new FramePipeline();
+  pipeline->ctx = &ctx;
+  pipeline->shared_ctx = shared_ctx;
+  pipeline->stream = *shared_ctx->sensor_stream;
+  pipeline->depth = depth;
+  if (ctx.target != edge_imx500 && ctx.preprocess != nullptr) {
+    pipeline->preprocess = ClonePreprocessPlan(ctx.preprocess);
+    size_t size = GetPreprocessOutputSize(ctx.preprocess);
+    for (uint32_t i = 0; i < depth && pipeline->preprocess != nullptr; ++i) {
+      pipeline->slots[i].buffer = malloc(size);
+      if (pipeline->slots[i].buffer == nullptr) {
+        for (uint32_t j = 0; j < i; ++j) free(pipeline->slots[j].buffer);
+        DestroyPreprocessPlan(pipeline->preprocess);
+        pipeline->preprocess = nullptr;
+      }
+    }
+    if (pipeline->preprocess == nullptr) {
+      LOG_ERR("SetPipelineDepth: Failed to allocate input buffers.");
+      delete pipeline;
+      return EdgeAppCoreResultFailure;
+    }
+  }
+
+  int res = pthread_create(&pipeline->thread, nullptr, PipelineThread,
+                           pipeline);
+  if (res != 0) {
+    LOG_ERR("pthread_create failed: %d", res);
+    for (uint32_t i = 0; i < depth; ++i) free(pipeline->slots[i].buffer);
+    DestroyPreprocessPlan(pipeline->preprocess);
+    delete pipeline;
+    return EdgeAppCoreResultFailure;
+  }
+  ctx.pipeline = pipeline;
+  LOG_DBG("Pipeline started with depth %" PRIu32 " for model index: %d", depth,
+          ctx.model_idx);
+  return EdgeAppCoreResultSuccess;
+}
+
+ProcessedFrame ProcessAsync(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
+                            EdgeAppLibSensorImageCropProperty &roi) {
+  FramePipeline *pipeline = ctx.pipeline;
+  if (pipeline == nullptr) {
+    // Pipeline depth 1: same as the synchronous call
+    return Process(ctx, shared_ctx, 0, roi);
+  }
+
+  pthread_mutex_lock(&pipeline->mutex);
+  // Applies to the frames prepared from now on
+  pipeline->roi = roi;
+  while (pipeline->ready == 0 && !pipeline->failed) {
+    pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+  }
+  if (pipeline->ready == 0) {
+    // Let the worker retry on the next call
+    pipeline->failed = false;
+    pthread_cond_broadcast(&pipeline->cond);
+    pthread_mutex_unlock(&pipeline->mutex);
+    LOG_ERR("ProcessAsync: Failed to get frame from pipeline.");
+    return ProcessedFrame();
+  }
+  PipelineSlot &slot = pipeline->slots[pipeline->head];
+  EdgeAppLibSensorFrame frame = slot.frame;
+  TempTensorInfo input = slot.input;
+  Tensor tensor = slot.tensor;
+  bool has_tensor = slot.has_tensor;
+  slot.frame = 0;
+  slot.input = {};
+  pipeline->head = (pipeline->head + 1) % pipeline->depth;
+  pipeline->ready--;
+  pthread_cond_broadcast(&pipeline->cond);
+  pthread_mutex_unlock(&pipeline->mutex);
+
+  // The returned frame owns the sensor frame and releases it
+  ProcessedFrame processed(pipeline->shared_ctx->sensor_stream, frame);
+  if (ctx.target == edge_imx500) {
+    SetSensorRoi(ctx, roi);
+    return processed;
+  }
+
+  if (ctx.temp_input.buffer &&
+      ctx.temp_input.memory_owner == TensorMemoryOwner::App) {
+    free(ctx.temp_input.buffer);
+  }
+  ctx.temp_input = input;
+  if (!SetInputAndCompute(ctx, has_tensor ? &tensor : nullptr)) {
+    return ProcessedFrame();
+  }
+  return processed;
+}
+
+// Compiles the flat output layout of the network from the tensor shapes
+// property of |channel|.
+static bool CompileOutputLayout(EdgeAppLibSensorChannel channel,
+                                size_t raw_size, OutputTensorLayout &layout) {
+  EdgeAppLibSensorTensorShapesProperty tensor_shape{};
+  int32_t ret = SensorChannelGetProperty(
+      channel, AITRIOS_SENSOR_TENSOR_SHAPES_PROPERTY_KEY, &tensor_shape,
+      sizeof(tensor_shape));
+  if (ret != 0) {
+    LOG_ERR("SensorChannelGetProperty(SHAPES) failed: %d", ret);
+    return false;
+  }
+
+  layout = {};
+  uint32_t offset = 0;
+  uint32_t index = 0;
+  while (index < AITRIOS_SENSOR_SHAPES_ARRAY_LENGTH) {
+    uint32_t dimension = tensor_shape.shapes_array[index++];
+    if (dimension == 0) break;
+    if (layout.num_tensors >= MAX_OUTPUT_LAYOUT_TENSORS) {
+      LOG_WARN("Too many output tensors, truncating to %d.",
+               MAX_OUTPUT_LAYOUT_TENSORS);
+      break;
+    }
+
+    uint32_t t = layout.num_tensors++;
+    uint32_t elements = 1;
+    for (uint32_t j = 0;
+         j < dimension && index < AITRIOS_SENSOR_SHAPES_ARRAY_LENGTH; ++j) {
+      uint32_t s = tensor_shape.shapes_array[index++];
+      elements *= s;
+      if (j < MAX_TENSOR_DIMS) layout.dims[t][layout.ndims[t]++] = s;
+    }
+    layout.offsets[t] = offset;
+    layout.sizes[t] = elements * sizeof(float);
+    offset += layout.sizes[t];
+  }
+
+  layout.raw_size = raw_size;
+  layout.valid = true;
+  LOG_DBG("Output layout compiled: %u tensors, %u bytes", layout.num_tensors,
+          offset);
+  return true;
+}
+
+// Gets the output of |frame| and the output layout of the network. The layout
+// is only compiled when it is not valid, the settings generation moved (the
+// configuration may have selected another network) or the output size
+// changed.
+static bool Imx500FetchOutputOnce(EdgeAppCoreCtx &ctx,
+                                  EdgeAppLibSensorFrame frame,
+                                  EdgeAppLibSensorRawData *out_data) {
+  if (!out_data) return false;
+  STAGE_TIMER(ctx.stats, EdgeAppCoreStageGetOutput);
 
   EdgeAppLibSensorChannel channel;
   int32_t ret = SensorFrameGetChannelFromChannelId(
@@ -514,31 +1522,117 @@ static bool Imx500FetchOutputOnce(
     return false;
   }
 
-  EdgeAppLibSensorTensorShapesProperty tensor_shape{};
-  ret = SensorChannelGetProperty(channel,
-                                 AITRIOS_SENSOR_TENSOR_SHAPES_PROPERTY_KEY,
-                                 &tensor_shape, sizeof(tensor_shape));
-  if (ret != 0) {
-    LOG_ERR("SensorChannelGetProperty(SHAPES) failed: %d", ret);
-    return false;
+  OutputTensorLayout &layout = ctx.output_layout;
+  uint32_t generation = getSettingsGeneration();
+  if (!layout.valid || layout.raw_size != out_data->size ||
+      layout.generation != generation) {
+    if (!CompileOutputLayout(channel, out_data->size, layout)) {
+      layout.valid = false;
+      return false;
+    }
+    layout.generation = generation;
   }
+  return true;
+}
 
-  out_shapes->clear();
-  uint32_t index = 0;
-  while (index < AITRIOS_SENSOR_SHAPES_ARRAY_LENGTH) {
-    uint32_t dimension = tensor_shape.shapes_array[index++];
-    if (dimension == 0) break;
+// Discovers the real output sizes through a scratch buffer and allocates the
+// pool once, with a slot for every output tensor, so that no later request of
+// the frame moves the buffers behind the views already returned. The scratch
+// content is kept as the outputs of the current frame. Each slot is aligned
+// to its element size only, so tensors of one type are packed without gaps.
+static bool SizeOutputPool(EdgeAppCoreCtx &ctx) {
+  OutputTensorPool &pool = ctx.output_pool;
+  FreeOutputPool(pool);
+  const uint32_t num_tensors = MAX_OUTPUT_TENSOR_NUM;
+
+  const uint32_t scratch_size = MAX_OUTPUT_TENSORS_SIZE * sizeof(float);
+  uint8_t *scratch = static_cast<uint8_t *>(malloc(scratch_size));
+  if (!scratch) {
+    LOG_ERR("malloc failed");
+    return false;
+  }
 
-    out_shapes->emplace_back();
-    out_shapes->back().reserve(dimension);
-    for (uint32_t j = 0;
-         j < dimension && index < AITRIOS_SENSOR_SHAPES_ARRAY_LENGTH; ++j) {
-      out_shapes->back().push_back(tensor_shape.shapes_array[index++]);
+  uint32_t total_size = 0;
+  for (uint32_t j = 0; j < num_tensors; ++j) {
+    const uint32_t align =
+        static_cast<uint32_t>(ElementSize(OutputQuantization(ctx, j).type));
+    const uint32_t offset = (total_size + align - 1) & ~(align - 1);
+    if (offset >= scratch_size) break;
+    uint32_t outsize = scratch_size - offset;
+    pool.offsets[j] = offset;
+    if (EdgeAppLib::GetOutput(*ctx.graph_ctx, j,
+                              reinterpret_cast<float *>(scratch + offset),
+                              &outsize) != 0) {
+      continue;
     }
+    pool.sizes[j] = outsize;
+    total_size = offset + outsize;
+  }
+
+  if (total_size == 0) {
+    free(scratch);
+    pool = {};
+    return false;
+  }
+
+  // Rounded up to the largest element size, so that pools copied back to
+  // back (ProcessBatchLoop) keep every slot aligned
+  const size_t capacity = (total_size + sizeof(int64_t) - 1) &
+                          ~(sizeof(int64_t) - 1);
+  pool.buffer = static_cast<uint8_t *>(calloc(1, capacity));
+  if (!pool.buffer) {
+    LOG_ERR("calloc failed");
+    free(scratch);
+    pool = {};
+    return false;
+  }
+  memcpy(pool.buffer, scratch, total_size);
+  free(scratch);
+
+  pool.capacity = capacity;
+  pool.num_tensors = num_tensors;
+  pool.fetched = num_tensors;
+  LOG_DBG("Output pool sized: %zu bytes for %u tensors", pool.capacity,
+          pool.num_tensors);
+  return true;
+}
+
+// Fills the pool with the outputs of the current frame. Tensors already
+// fetched since the last Compute are not read again.
+static bool FetchOutputsToPool(EdgeAppCoreCtx &ctx, uint32_t num_tensors) {
+  if (num_tensors > MAX_OUTPUT_TENSOR_NUM) {
+    LOG_WARN("Too many output tensors requested, truncating to %d.",
+             MAX_OUTPUT_TENSOR_NUM);
+    num_tensors = MAX_OUTPUT_TENSOR_NUM;
   }
 
+  OutputTensorPool &pool = ctx.output_pool;
+  if (pool.buffer != nullptr && pool.fetched >= num_tensors) return true;
+  STAGE_TIMER(ctx.stats, EdgeAppCoreStageGetOutput);
+  if (pool.buffer == nullptr) return SizeOutputPool(ctx);
+
+  for (uint32_t j = pool.fetched; j < num_tensors; ++j) {
+    if (pool.sizes[j] == 0) continue;
+    uint32_t outsize = pool.sizes[j];
+    if (EdgeAppLib::GetOutput(
+            *ctx.graph_ctx, j,
+            reinterpret_cast<float *>(pool.buffer + pool.offsets[j]),
+            &outsize) != 0 ||
+        outsize != pool.sizes[j]) {
+      if (pool.fetched > 0) {
+        // Views of this frame point into the pool: it cannot move
+        LOG_ERR("Output tensor %u size changed within the frame.", j);
+        return false;
+      }
+      // Output sizes changed (e.g. new model), size the pool again
+      LOG_WARN("Output tensor %u size changed, resizing output pool.", j);
+      return SizeOutputPool(ctx);
+    }
+  }
+  if (pool.fetched < num_tensors) pool.fetched = num_tensors;
   return true;
 }
+
 // Internal function that handles both indexed and max_tensor_num cases
 static Tensor GetOutputByIndexInternal(EdgeAppCoreCtx &ctx,
                                        EdgeAppLibSensorFrame frame,
@@ -549,59 +1643,26 @@ static Tensor GetOutputByIndexInternal(EdgeAppCoreCtx &ctx,
            tensor_index);
 
   if (ctx.target == edge_imx500) {
-    EdgeAppLibSensorChannel channel;
-    int32_t ret = SensorFrameGetChannelFromChannelId(
-        frame, AITRIOS_SENSOR_CHANNEL_ID_INFERENCE_OUTPUT, &channel);
-    if (ret < 0) {
-      LOG_WARN("SensorFrameGetChannelFromChannelId failed: ret=%d.", ret);
-      return {};
-    }
-
-    struct EdgeAppLibSensorRawData data = {0};
-    if (SensorChannelGetRawData(channel, &data) < 0) {
-      LOG_WARN("SensorChannelGetRawData failed.");
-      return {};
-    }
-
-    EdgeAppLibSensorTensorShapesProperty tensor_shape{};
-    ret = SensorChannelGetProperty(channel,
-                                   AITRIOS_SENSOR_TENSOR_SHAPES_PROPERTY_KEY,
-                                   &tensor_shape, sizeof(tensor_shape));
-    if (ret != 0) {
-      LOG_ERR("SensorChannelGetProperty failed: %d", ret);
+    EdgeAppLibSensorRawData data{};
+    if (!Imx500FetchOutputOnce(ctx, frame, &data)) {
       return {};
     }
 
-    // Parse shape info and validate tensor_index
-    std::vector<std::vector<uint32_t>> shapes;
-    uint32_t index = 0;
-    while (index < AITRIOS_SENSOR_SHAPES_ARRAY_LENGTH) {
-      uint32_t dimension = tensor_shape.shapes_array[index++];
-      if (dimension == 0) break;
-
-      shapes.emplace_back();
-      for (uint32_t j = 0; j < dimension; ++j) {
-        shapes.back().push_back(tensor_shape.shapes_array[index++]);
-      }
-    }
-
     // All tensors mode
+    const OutputTensorLayout &layout = ctx.output_layout;
     output_tensor.data = data.address;
     output_tensor.size = data.size;
     output_tensor.timestamp = data.timestamp;
     output_tensor.type = TensorDataType::TensorTypeFloat32;
     output_tensor.shape_info.ndim = 0;
 
-    for (const auto &shape : shapes) {
+    for (uint32_t t = 0; t < layout.num_tensors; ++t) {
       if (output_tensor.shape_info.ndim >= MAX_OUTPUT_TENSOR_NUM) {
         LOG_WARN("Too many dimensions, truncating.");
         break;
       }
-      uint32_t dim = 1;
-      for (auto s : shape) {
-        dim *= s;
-      }
-      output_tensor.shape_info.dims[output_tensor.shape_info.ndim++] = dim;
+      output_tensor.shape_info.dims[output_tensor.shape_info.ndim++] =
+          layout.sizes[t] / sizeof(float);
     }
   } else {
     // CPU/NPU: use graph_ctx to get output
@@ -609,80 +1670,60 @@ static Tensor GetOutputByIndexInternal(EdgeAppCoreCtx &ctx,
       LOG_ERR("Graph execution context is not initialized.");
       return {};
     }
+    if (!FetchOutputsToPool(ctx, max_tensor_num)) {
+      LOG_ERR("Failed to get output tensors");
+      return {};
+    }
+    const OutputTensorPool &pool = ctx.output_pool;
+
+    output_tensor.memory_owner = TensorMemoryOwner::Core;
+    output_tensor.timestamp = ctx.temp_input.timestamp;
+    output_tensor.reused = ChangeGateReused(ctx.change_gate);
+    output_tensor.transform = ctx.temp_input.transform;
 
     if (tensor_index < 0) {
-      // All tensors mode
-      float *base =
-          static_cast<float *>(malloc(MAX_OUTPUT_TENSORS_SIZE * sizeof(float)));
-      if (!base) {
-        LOG_ERR("malloc failed");
-        return {};
+      // All tensors mode: slots of one element type are contiguous, return a
+      // view of all of them. Tensors of different types or quantization
+      // cannot be viewed as one tensor.
+      EdgeAppCoreQuantization quant = OutputQuantization(ctx, 0);
+      for (uint32_t j = 1; j < pool.fetched && j < max_tensor_num; ++j) {
+        if (pool.sizes[j] == 0) continue;
+        EdgeAppCoreQuantization other = OutputQuantization(ctx, j);
+        if (other.type != quant.type || other.scale != quant.scale ||
+            other.zero_point != quant.zero_point) {
+          LOG_ERR("Output tensors of different types cannot be combined.");
+          return {};
+        }
       }
-      float *write_ptr = base;
-      uint32_t total_element_size = 0;
-
-      output_tensor.data = base;
-      output_tensor.size = MAX_OUTPUT_TENSORS_SIZE * sizeof(float);
+      output_tensor.type = quant.type;
+      output_tensor.scale = quant.scale;
+      output_tensor.zero_point = quant.zero_point;
+      output_tensor.data = pool.buffer;
       output_tensor.shape_info.ndim = 0;
-      output_tensor.type = TensorDataType::TensorTypeFloat32;
-      output_tensor.memory_owner = TensorMemoryOwner::App;
-      output_tensor.timestamp = ctx.temp_input.timestamp;
-
-      for (size_t j = 0; j < max_tensor_num; ++j) {
-        uint32_t remaining_elements_size =
-            MAX_OUTPUT_TENSORS_SIZE - total_element_size;
-        uint32_t outsize = remaining_elements_size;
-
-        if (EdgeAppLib::GetOutput(*ctx.graph_ctx, j, write_ptr, &outsize) !=
-            0) {
-          continue;
-        }
-
+      size_t total_size = 0;
+      for (uint32_t j = 0; j < pool.fetched && j < max_tensor_num; ++j) {
+        if (pool.sizes[j] == 0) continue;
         output_tensor.shape_info.dims[output_tensor.shape_info.ndim++] =
-            outsize / sizeof(float);
-        write_ptr += outsize / sizeof(float);
-        total_element_size += outsize;
-      }
-
-      void *tmp = realloc(base, total_element_size);
-      if (tmp == nullptr) {
-        free(base);
-        LOG_ERR("realloc failed");
-        return {};
+            pool.sizes[j] / ElementSize(OutputQuantization(ctx, j).type);
+        total_size = pool.offsets[j] + pool.sizes[j];
       }
-      output_tensor.data = tmp;
-      output_tensor.size = total_element_size;
+      output_tensor.size = total_size;
 
       if (output_tensor.shape_info.ndim == 0) {
         LOG_WARN("No valid output tensors found.");
-        free(tmp);
         output_tensor.data = nullptr;
         output_tensor.size = 0;
       }
     } else {
       // Single tensor mode
-      uint32_t outsize = MAX_OUTPUT_TENSORS_SIZE;
-      float *output_data = static_cast<float *>(malloc(outsize));
-      if (!output_data) {
-        LOG_ERR("malloc failed");
-        return {};
-      }
-
-      if (EdgeAppLib::GetOutput(*ctx.graph_ctx,
-                                static_cast<uint32_t>(tensor_index),
-                                output_data, &outsize) != 0) {
+      uint32_t j = static_cast<uint32_t>(tensor_index);
+      if (j >= pool.fetched || pool.sizes[j] == 0) {
         LOG_ERR("Failed to get output tensor at index %d", tensor_index);
-        free(output_data);
         return {};
       }
-
-      output_tensor.data = output_data;
-      output_tensor.size = outsize;
-      output_tensor.type = TensorDataType::TensorTypeFloat32;
-      output_tensor.memory_owner = TensorMemoryOwner::App;
-      output_tensor.timestamp = ctx.temp_input.timestamp;
-      output_tensor.shape_info.ndim = 1;
-      output_tensor.shape_info.dims[0] = outsize / sizeof(float);
+      output_tensor.data = pool.buffer + pool.offsets[j];
+      output_tensor.size = pool.sizes[j];
+      SetOutputElementInfo(ctx, j, pool.sizes[j], output_tensor);
     }
   }
 
@@ -714,51 +1755,50 @@ std::vector<Tensor> GetOutputs(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame,
            max_tensor_num);
   if (ctx.target == edge_imx500) {
     EdgeAppLibSensorRawData data{};
-    std::vector<std::vector<uint32_t>> shapes;
-    if (!Imx500FetchOutputOnce(frame, &data, &shapes)) {
+    if (!Imx500FetchOutputOnce(ctx, frame, &data)) {
       return outputs;
     }
 
-    for (size_t tensor_index = 0; tensor_index < shapes.size();
-         ++tensor_index) {
-      // Single tensor mode
-      Tensor tensor;
-      memset(&tensor, 0, sizeof(Tensor));
-
-      // Calculate offset and size for the requested tensor
-      size_t tensor_offset = 0;
-      size_t tensor_size = 1;
-
-      for (size_t i = 0; i < static_cast<size_t>(tensor_index); ++i) {
-        size_t elements = 1;
-        for (auto s : shapes[i]) {
-          elements *= s;
-        }
-        tensor_offset += elements * sizeof(float);
-      }
-
-      for (auto s : shapes[static_cast<size_t>(tensor_index)]) {
-        tensor_size *= s;
-      }
-      tensor_size *= sizeof(float);
-
-      tensor.data = (uint8_t *)data.address + tensor_offset;
-      tensor.size = tensor_size;
+    // Views into the output, straight from the compiled layout
+    const OutputTensorLayout &layout = ctx.output_layout;
+    outputs.reserve(layout.num_tensors);
+    for (uint32_t t = 0; t < layout.num_tensors; ++t) {
+      Tensor tensor{};
+      tensor.data = static_cast<uint8_t *>(data.address) + layout.offsets[t];
+      tensor.size = layout.sizes[t];
       tensor.timestamp = data.timestamp;
       tensor.type = TensorDataType::TensorTypeFloat32;
-      tensor.shape_info.ndim = shapes[static_cast<size_t>(tensor_index)].size();
-
-      for (size_t i = 0; i < shapes[static_cast<size_t>(tensor_index)].size() &&
-                         i < MAX_TENSOR_DIMS;
-           ++i) {
-        tensor.shape_info.dims[i] =
-            shapes[static_cast<size_t>(tensor_index)][i];
+      tensor.shape_info.ndim = layout.ndims[t];
+      for (uint32_t i = 0; i < layout.ndims[t]; ++i) {
+        tensor.shape_info.dims[i] = layout.dims[t][i];
       }
       outputs.push_back(tensor);
     }
 
+  } else if (ctx.batch.num_rois > 0) {
+    // Batched Process: tensors of every ROI, ROI after ROI
+    const BatchState &batch = ctx.batch;
+    const uint8_t *base = batch.native ? ctx.output_pool.buffer : batch.outputs;
+    uint32_t num_tensors = max_tensor_num < batch.num_tensors
+                               ? max_tensor_num
+                               : batch.num_tensors;
+    outputs.reserve(num_tensors * batch.num_rois);
+    for (uint32_t i = 0; i < batch.num_rois; ++i) {
+      for (uint32_t j = 0; j < num_tensors; ++j) {
+        if (batch.sizes[i][j] == 0) continue;
+        Tensor tensor{};
+        tensor.data = const_cast<uint8_t *>(base) + batch.offsets[i][j];
+        tensor.size = batch.sizes[i][j];
+        tensor.timestamp = ctx.temp_input.timestamp;
+        tensor.transform = batch.transforms[i];
+        tensor.memory_owner = TensorMemoryOwner::Core;
+        SetOutputElementInfo(ctx, j, batch.sizes[i][j], tensor);
+        outputs.push_back(tensor);
+      }
+    }
   } else {
-    // Get individual tensors using the internal function
+    // Get individual tensors using the internal function. They all share the
+    // context output pool, so the outputs are fetched once per frame.
     for (uint32_t i = 0; i < max_tensor_num; ++i) {
       Tensor tensor = GetOutputByIndexInternal(
           ctx, frame, static_cast<int32_t>(i), max_tensor_num);
@@ -775,6 +1815,363 @@ std::vector<Tensor> GetOutputs(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame,
   return outputs;
 }
 
+EdgeAppCoreResult SetOutputDestinations(
+    EdgeAppCoreCtx &ctx, const EdgeAppCoreOutputDestination *destinations,
+    uint32_t num_tensors) {
+  if (num_tensors > MAX_OUTPUT_TENSOR_NUM ||
+      (destinations == nullptr && num_tensors != 0)) {
+    LOG_ERR("SetOutputDestinations: invalid destinations (num_tensors=%u).",
+            num_tensors);
+    return EdgeAppCoreResultInvalidParam;
+  }
+  for (uint32_t i = 0; i < num_tensors; ++i) {
+    const EdgeAppCoreOutputDestination &dest = destinations[i];
+    if (dest.buffer == nullptr || dest.capacity == 0) {
+      LOG_ERR("SetOutputDestinations: destination %u has no buffer.", i);
+      return EdgeAppCoreResultInvalidParam;
+    }
+    size_t elements =
+        static_cast<size_t>(dest.channels) * dest.height * dest.width;
+    if (elements * sizeof(float) > dest.capacity) {
+      LOG_ERR("SetOutputDestinations: destination %u is too small.", i);
+      return EdgeAppCoreResultDataTooLarge;
+    }
+  }
+  for (uint32_t i = 0; i < num_tensors; ++i) {
+    ctx.output_dests[i] = destinations[i];
+  }
+  ctx.num_output_dests = num_tensors;
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreResult SetOutputQuantization(
+    EdgeAppCoreCtx &ctx, const EdgeAppCoreQuantization *quantization,
+    uint32_t num_tensors) {
+  if (num_tensors > MAX_OUTPUT_TENSOR_NUM ||
+      (quantization == nullptr && num_tensors != 0)) {
+    LOG_ERR("SetOutputQuantization: invalid parameters (num_tensors=%u).",
+            num_tensors);
+    return EdgeAppCoreResultInvalidParam;
+  }
+  if (ctx.target == edge_imx500) {
+    LOG_ERR("SetOutputQuantization: only supported for CPU/GPU/NPU models.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  for (uint32_t i = 0; i < num_tensors; ++i) {
+    if (quantization[i].type > TensorDataType::TensorTypeInt8 ||
+        quantization[i].type == TensorDataType::TensorTypeInt64) {
+      LOG_ERR("SetOutputQuantization: type of tensor %u is not supported.", i);
+      return EdgeAppCoreResultInvalidParam;
+    }
+  }
+  for (uint32_t i = 0; i < num_tensors; ++i) {
+    ctx.output_quant[i] = quantization[i];
+  }
+  ctx.num_output_quant = num_tensors;
+  // Slots are aligned to the element types: the next request sizes it again
+  FreeOutputPool(ctx.output_pool);
+  return EdgeAppCoreResultSuccess;
+}
+
+static inline float HalfToFloat(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+  uint32_t exponent = (h >> 10) & 0x1Fu;
+  uint32_t mantissa = h & 0x3FFu;
+  uint32_t bits;
+  if (exponent == 0x1Fu) {
+    bits = sign | 0x7F800000u | (mantissa << 13);  // Inf or NaN
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else {
+    // Zero or subnormal: mantissa * 2^-24
+    float value = static_cast<float>(mantissa) * 5.9604645e-8f;
+    return sign ? -value : value;
+  }
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// scale * (q - zero_point) is folded into one multiply-add per element, with
+// no branch in the loop, so the compiler can vectorize it.
+template <typename T>
+static void DequantizeValues(const T *src, size_t count, float scale,
+                             int32_t zero_point, float *dst) {
+  if (scale == 0.0f) {
+    for (size_t i = 0; i < count; ++i) dst[i] = static_cast<float>(src[i]);
+    return;
+  }
+  const float offset = -scale * static_cast<float>(zero_point);
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = static_cast<float>(src[i]) * scale + offset;
+  }
+}
+
+EdgeAppCoreResult DequantizeTensor(const Tensor &tensor, float *dst,
+                                   size_t capacity) {
+  if (tensor.data == nullptr || dst == nullptr) {
+    LOG_ERR("DequantizeTensor: invalid parameters.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  size_t count = tensor.size / ElementSize(tensor.type);
+  if (count * sizeof(float) > capacity) {
+    LOG_ERR("DequantizeTensor: %zu elements do not fit in %zu bytes.", count,
+            capacity);
+    return EdgeAppCoreResultDataTooLarge;
+  }
+
+  switch (tensor.type) {
+    case TensorDataType::TensorTypeFloat32:
+      if (dst != tensor.data) memcpy(dst, tensor.data, count * sizeof(float));
+      break;
+    case TensorDataType::TensorTypeFloat16: {
+      const uint16_t *src = static_cast<const uint16_t *>(tensor.data);
+      for (size_t i = 0; i < count; ++i) dst[i] = HalfToFloat(src[i]);
+      break;
+    }
+    case TensorDataType::TensorTypeUInt8:
+      DequantizeValues(static_cast<const uint8_t *>(tensor.data), count,
+                       tensor.scale, tensor.zero_point, dst);
+      break;
+    case TensorDataType::TensorTypeInt8:
+      DequantizeValues(static_cast<const int8_t *>(tensor.data), count,
+                       tensor.scale, tensor.zero_point, dst);
+      break;
+    case TensorDataType::TensorTypeInt32:
+      DequantizeValues(static_cast<const int32_t *>(tensor.data), count,
+                       tensor.scale, tensor.zero_point, dst);
+      break;
+    default:
+      LOG_ERR("DequantizeTensor: type %d is not supported.", tensor.type);
+      return EdgeAppCoreResultInvalidParam;
+  }
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreResult MapPointsToFrame(const Tensor &tensor, float *points,
+                                   size_t num_points, bool normalized) {
+  const EdgeAppCoreInputTransform &t = tensor.transform;
+  if (points == nullptr || t.scale_x == 0.0f || t.scale_y == 0.0f) {
+    LOG_ERR("MapPointsToFrame: invalid parameters.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  // frame = point * a + b on each axis, one multiply-add per coordinate
+  const float ax = (normalized ? t.input_width : 1.0f) / t.scale_x;
+  const float ay = (normalized ? t.input_height : 1.0f) / t.scale_y;
+  const float bx = t.origin_x - t.pad_x / t.scale_x;
+  const float by = t.origin_y - t.pad_y / t.scale_y;
+  for (size_t i = 0; i < num_points; ++i) {
+    points[2 * i] = points[2 * i] * ax + bx;
+    points[2 * i + 1] = points[2 * i + 1] * ay + by;
+  }
+  return EdgeAppCoreResultSuccess;
+}
+
+// Writes |src| ([C,H,W] or [H,W,C], the other layout of |dest|) into the
+// destination buffer in the destination layout.
+static void TransposeOutput(const float *src,
+                            const EdgeAppCoreOutputDestination &dest) {
+  const uint32_t plane = dest.height * dest.width;
+  float *dst = dest.buffer;
+  if (dest.layout == EdgeAppCoreLayoutNHWC) {
+    for (uint32_t c = 0; c < dest.channels; ++c) {
+      const float *src_plane = src + c * plane;
+      for (uint32_t p = 0; p < plane; ++p) {
+        dst[p * dest.channels + c] = src_plane[p];
+      }
+    }
+  } else {
+    for (uint32_t c = 0; c < dest.channels; ++c) {
+      float *dst_plane = dst + c * plane;
+      for (uint32_t p = 0; p < plane; ++p) {
+        dst_plane[p] = src[p * dest.channels + c];
+      }
+    }
+  }
+}
+
+EdgeAppCoreResult GetOutputsInto(EdgeAppCoreCtx &ctx,
+                                 EdgeAppLibSensorFrame frame, Tensor *outputs,
+                                 uint32_t num_tensors) {
+  if (outputs == nullptr || num_tensors == 0 ||
+      num_tensors > ctx.num_output_dests) {
+    LOG_ERR("GetOutputsInto: %u tensors requested, %u destinations set.",
+            num_tensors, ctx.num_output_dests);
+    return EdgeAppCoreResultInvalidParam;
+  }
+  if (ctx.target == edge_imx500 || ctx.graph_ctx == nullptr) {
+    LOG_ERR("GetOutputsInto: only supported for CPU/GPU/NPU models.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  if (frame == 0) {
+    LOG_ERR("GetOutputsInto: invalid frame.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+
+  for (uint32_t j = 0; j < num_tensors; ++j) {
+    const EdgeAppCoreOutputDestination &dest = ctx.output_dests[j];
+    Tensor &tensor = outputs[j];
+    tensor = {};
+    uint32_t outsize = 0;
+
+    if (OutputQuantization(ctx, j).type != TensorDataType::TensorTypeFloat32) {
+      // Quantized tensors are read from the output pool and dequantized
+      if (dest.channels != 0) {
+        LOG_ERR("Output tensor %u: layout conversion needs float32 outputs.",
+                j);
+        return EdgeAppCoreResultInvalidParam;
+      }
+      if (!FetchOutputsToPool(ctx, j + 1)) {
+        LOG_ERR("Failed to get output tensor %u", j);
+        return EdgeAppCoreResultFailure;
+      }
+      const OutputTensorPool &pool = ctx.output_pool;
+      Tensor quantized{};
+      quantized.data = pool.buffer + pool.offsets[j];
+      SetOutputElementInfo(ctx, j, pool.sizes[j], quantized);
+      quantized.size = pool.sizes[j];
+      EdgeAppCoreResult result =
+          DequantizeTensor(quantized, dest.buffer, dest.capacity);
+      if (result != EdgeAppCoreResultSuccess) return result;
+      tensor.shape_info.ndim = 1;
+      tensor.shape_info.dims[0] = quantized.shape_info.dims[0];
+      outsize = quantized.shape_info.dims[0] * sizeof(float);
+    } else if (dest.channels == 0) {
+      // The graph writes the tensor straight into the destination
+      outsize = dest.capacity > UINT32_MAX
+                    ? UINT32_MAX
+                    : static_cast<uint32_t>(dest.capacity);
+      STAGE_TIMER(ctx.stats, EdgeAppCoreStageGetOutput);
+      if (EdgeAppLib::GetOutput(*ctx.graph_ctx, j, dest.buffer, &outsize) !=
+          0) {
+        LOG_ERR("Failed to get output tensor %u", j);
+        return EdgeAppCoreResultFailure;
+      }
+      if (outsize > dest.capacity) {
+        LOG_ERR("Output tensor %u (%u bytes) exceeds its destination.", j,
+                outsize);
+        return EdgeAppCoreResultDataTooLarge;
+      }
+      tensor.shape_info.ndim = 1;
+      tensor.shape_info.dims[0] = outsize / sizeof(float);
+    } else {
+      // Layout conversion reads the tensor from the output pool
+      if (!FetchOutputsToPool(ctx, j + 1)) {
+        LOG_ERR("Failed to get output tensor %u", j);
+        return EdgeAppCoreResultFailure;
+      }
+      const OutputTensorPool &pool = ctx.output_pool;
+      outsize = dest.channels * dest.height * dest.width * sizeof(float);
+      if (pool.sizes[j] != outsize) {
+        LOG_ERR("Output tensor %u is %u bytes, destination shape needs %u.",
+                j, pool.sizes[j], outsize);
+        return EdgeAppCoreResultInvalidParam;
+      }
+      TransposeOutput(
+          reinterpret_cast<const float *>(pool.buffer + pool.offsets[j]),
+          dest);
+      tensor.shape_info.ndim = 3;
+      if (dest.layout == EdgeAppCoreLayoutNHWC) {
+        tensor.shape_info.dims[0] = dest.height;
+        tensor.shape_info.dims[1] = dest.width;
+        tensor.shape_info.dims[2] = dest.channels;
+      } else {
+        tensor.shape_info.dims[0] = dest.channels;
+        tensor.shape_info.dims[1] = dest.height;
+        tensor.shape_info.dims[2] = dest.width;
+      }
+    }
+    tensor.data = dest.buffer;
+    tensor.size = outsize;
+    tensor.type = TensorDataType::TensorTypeFloat32;
+    tensor.timestamp = ctx.temp_input.timestamp;
+    tensor.memory_owner = TensorMemoryOwner::App;
+    tensor.reused = ChangeGateReused(ctx.change_gate);
+    tensor.transform = ctx.temp_input.transform;
+  }
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreResult ComputeConcurrent(
+    EdgeAppCoreCtx &ctx, const Tensor &input,
+    const EdgeAppCoreOutputDestination *destinations, Tensor *outputs,
+    uint32_t num_tensors) {
+  GraphContextPool *pool = ctx.context_pool;
+  if (pool == nullptr) {
+    LOG_ERR("ComputeConcurrent: model was loaded without concurrent contexts.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  if (input.data == nullptr || destinations == nullptr || outputs == nullptr ||
+      num_tensors == 0 || num_tensors > MAX_OUTPUT_TENSOR_NUM) {
+    LOG_ERR("ComputeConcurrent: invalid parameters.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  for (uint32_t j = 0; j < num_tensors; ++j) {
+    if (destinations[j].buffer == nullptr || destinations[j].channels != 0) {
+      LOG_ERR("ComputeConcurrent: destination %u is not supported.", j);
+      return EdgeAppCoreResultInvalidParam;
+    }
+  }
+
+  uint32_t dims[4] = {1, 1, 1, 1};
+  for (uint32_t i = 0; i < input.shape_info.ndim && i < 4; ++i) {
+    dims[i] = input.shape_info.dims[i];
+  }
+
+  uint32_t index = AcquireContext(pool);
+  EdgeAppLibGraphContext graph_ctx = pool->contexts[index];
+  EdgeAppCoreResult result = EdgeAppCoreResultSuccess;
+  EdgeAppLibNNResult nn_result;
+  {
+    STAGE_TIMER(ctx.stats, EdgeAppCoreStageSetInput);
+    nn_result = SetInputFromTensor(graph_ctx,
+                                   static_cast<uint8_t *>(input.data), &dims,
+                                   RuntimeTensorType(input.type));
+  }
+  if (nn_result != 0) {
+    LOG_ERR("ComputeConcurrent: failed to set input tensor.");
+    result = EdgeAppCoreResultFailure;
+  } else {
+    STAGE_TIMER(ctx.stats, EdgeAppCoreStageCompute);
+    if (Compute(graph_ctx) != 0) {
+      LOG_ERR("ComputeConcurrent: failed to compute graph.");
+      result = EdgeAppCoreResultFailure;
+    }
+  }
+
+  for (uint32_t j = 0; j < num_tensors && result == EdgeAppCoreResultSuccess;
+       ++j) {
+    const EdgeAppCoreOutputDestination &dest = destinations[j];
+    uint32_t outsize = dest.capacity > UINT32_MAX
+                           ? UINT32_MAX
+                           : static_cast<uint32_t>(dest.capacity);
+    {
+      STAGE_TIMER(ctx.stats, EdgeAppCoreStageGetOutput);
+      nn_result = EdgeAppLib::GetOutput(graph_ctx, j, dest.buffer, &outsize);
+    }
+    if (nn_result != 0) {
+      LOG_ERR("ComputeConcurrent: failed to get output tensor %u.", j);
+      result = EdgeAppCoreResultFailure;
+      break;
+    }
+    if (outsize > dest.capacity) {
+      LOG_ERR("Output tensor %u (%u bytes) exceeds its destination.", j,
+              outsize);
+      result = EdgeAppCoreResultDataTooLarge;
+      break;
+    }
+    Tensor &tensor = outputs[j];
+    tensor = {};
+    tensor.data = dest.buffer;
+    tensor.size = outsize;
+    tensor.timestamp = input.timestamp;
+    tensor.memory_owner = TensorMemoryOwner::App;
+    SetOutputElementInfo(ctx, j, outsize, tensor);
+  }
+  ReleaseContext(pool, index);
+  return result;
+}
+
 Tensor GetInput(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame) {
   if (frame == 0) {
     LOG_ERR("Frame or graph execution context is not initialized.");
@@ -846,13 +2243,20 @@ Tensor GetInput(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame) {
       input_tensor.data = temp.buffer;
       input_tensor.size = temp.size;
       input_tensor.timestamp = temp.timestamp;
-      input_tensor.type = TensorDataType::TensorTypeUInt8;
+      input_tensor.type = static_cast<TensorDataType>(temp.type);
       input_tensor.shape_info.ndim = 4;
-      input_tensor.shape_info.dims[0] = 1;
+      input_tensor.shape_info.dims[0] = temp.batch;
       input_tensor.shape_info.dims[1] = temp.height;
       input_tensor.shape_info.dims[2] = temp.width;
       input_tensor.shape_info.dims[3] = 3;
-      input_tensor.format = AITRIOS_DRAW_FORMAT_RGB8;
+      // Same convention as IMX500: planar data keeps [1, H, W, 3] dims
+      if (temp.type != EdgeAppLib::TensorTypeUInt8) {
+        input_tensor.format = AITRIOS_DRAW_FORMAT_UNDEFINED;
+      } else if (temp.layout == EdgeAppCoreLayoutNCHW) {
+        input_tensor.format = AITRIOS_DRAW_FORMAT_RGB8_PLANAR;
+      } else {
+        input_tensor.format = AITRIOS_DRAW_FORMAT_RGB8;
+      }
       input_tensor.memory_owner = temp.memory_owner;
       snprintf(input_tensor.name, sizeof(input_tensor.name), "wasi_nn_input_%d",
                ctx.model_idx);
@@ -872,11 +2276,87 @@ Tensor GetInput(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame frame) {
   return input_tensor;
 }
 
+EdgeAppCoreResult ReleaseOutputs(EdgeAppCoreCtx &ctx) {
+  LOG_TRACE("ReleaseOutputs: Releasing output pool of model index: %d",
+            ctx.model_idx);
+  FreeOutputPool(ctx.output_pool);
+  FreeBatchOutputs(ctx.batch);
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreResult InvalidateOutputLayout(EdgeAppCoreCtx &ctx) {
+  LOG_TRACE("InvalidateOutputLayout: model index: %d", ctx.model_idx);
+  ctx.output_layout.valid = false;
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreStats GetStats(EdgeAppCoreCtx &ctx) {
+  EdgeAppCoreStats stats = {};
+  ReadStageStats(ctx.stats, &stats);
+  ReadStageStats(send_stats, &stats);
+  return stats;
+}
+
+EdgeAppCoreResult ResetStats(EdgeAppCoreCtx &ctx) {
+#ifdef EDGEAPP_CORE_NO_STATS
+  return EdgeAppCoreResultDenied;
+#else
+  ResetStageStats(ctx.stats);
+  ResetStageStats(send_stats);
+  return EdgeAppCoreResultSuccess;
+#endif
+}
+
+static const char *const stage_names[EdgeAppCoreStageNum] = {
+    "get_frame", "get_raw_data", "crop",       "preprocess",
+    "set_input", "compute",      "get_output", "send_input"};
+
+EdgeAppCoreResult SendStats(EdgeAppCoreCtx &ctx, const char *topic) {
+#ifdef EDGEAPP_CORE_NO_STATS
+  return EdgeAppCoreResultDenied;
+#else
+  if (topic == nullptr) {
+    LOG_ERR("SendStats: topic is null.");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  EdgeAppCoreStats stats = GetStats(ctx);
+  // Each stage takes less than 192 bytes
+  size_t capacity = 64 + 192 * EdgeAppCoreStageNum;
+  char *json = (char *)malloc(capacity);
+  if (json == nullptr) {
+    LOG_ERR("SendStats: failed to allocate memory.");
+    return EdgeAppCoreResultFailure;
+  }
+  int len = snprintf(json, capacity,
+                     "{\"edgeapp_core_stats\":{\"model\":%u,\"stages\":{",
+                     ctx.model_idx);
+  for (uint32_t i = 0; i < EdgeAppCoreStageNum; ++i) {
+    const EdgeAppCoreStageStats &stage = stats.stages[i];
+    len += snprintf(json + len, capacity - len,
+                    "%s\"%s\":{\"count\":%" PRIu64
+                    ",\"p50_us\":%u,\"p95_us\":%u,\"p99_us\":%u"
+                    ",\"max_us\":%u}",
+                    i == 0 ? "" : ",", stage_names[i], stage.count,
+                    stage.p50_us, stage.p95_us, stage.p99_us, stage.max_us);
+  }
+  len += snprintf(json + len, capacity - len, "}}}");
+  // The state is freed by DataExportSendState
+  if (DataExportSendState(topic, json, len) !=
+      EdgeAppLibDataExportResultSuccess) {
+    LOG_ERR("SendStats: failed to send the statistics.");
+    return EdgeAppCoreResultFailure;
+  }
+  return EdgeAppCoreResultSuccess;
+#endif
+}
+
 static bool pending_sensor_shutdown = false;
 static EdgeAppCoreCtx *pending_ctx = nullptr;
 
 EdgeAppCoreResult UnloadModel(EdgeAppCoreCtx &ctx) {
   LOG_TRACE("UnloadModel: Unloading model index: %d", ctx.model_idx);
+  // Stop prefetching before the frames and buffers go away
+  StopPipeline(ctx);
   // For IMX500 models, mark for sensor shutdown at last model unload
   if (ctx.target == edge_imx500) {
     pending_sensor_shutdown = true;
@@ -893,11 +2373,27 @@ EdgeAppCoreResult UnloadModel(EdgeAppCoreCtx &ctx) {
     ctx.temp_input.buffer = nullptr;
     ctx.temp_input.memory_owner = TensorMemoryOwner::Unknown;
   }
-
-  // Free graph ctx
+  FreeOutputPool(ctx.output_pool);
+  FreeBatchState(ctx.batch);
+  ctx.output_layout = {};
+  ctx.num_output_dests = 0;
+  ctx.num_output_quant = 0;
+  DestroyPreprocessPlan(ctx.preprocess);
+  ctx.preprocess = nullptr;
+  delete ctx.context_pool;
+  ctx.context_pool = nullptr;
+  DestroyStageStats(ctx.stats);
+  ctx.stats = nullptr;
+  ReleaseInputBinding(ctx.input_binding);
+  DestroyChangeGate(ctx.change_gate);
+  ctx.change_gate = nullptr;
+
+  // Free graph ctx. A cached graph stays resident for the next LoadModel.
   if (ctx.graph_ctx != nullptr) {
     free(ctx.graph_ctx);
     ctx.graph_ctx = nullptr;
+    ReleaseCachedModel(ctx.cached_model);
+    ctx.cached_model = nullptr;
 
     // Decrease model count
     model_count--;
@@ -910,8 +2406,14 @@ EdgeAppCoreResult UnloadModel(EdgeAppCoreCtx &ctx) {
       LOG_INFO("UnloadModel: All models unloaded. Stopping IMX500 sensor.");
 
       SensorStop(*pending_ctx->sensor_stream);
-      SensorCoreCloseStream(*pending_ctx->sensor_core,
-                            *pending_ctx->sensor_stream);
+      if (pending_ctx->cached_model != nullptr) {
+        // Keep the stream open for the next LoadModel of the bundle
+        ReleaseCachedModel(pending_ctx->cached_model);
+        pending_ctx->cached_model = nullptr;
+      } else {
+        SensorCoreCloseStream(*pending_ctx->sensor_core,
+                              *pending_ctx->sensor_stream);
+      }
 
       free(pending_ctx->sensor_stream);
       pending_ctx->sensor_stream = nullptr;
@@ -936,6 +2438,60 @@ EdgeAppCoreResult SendInference(void *data, size_t datalen,
   return result == EdgeAppLibSendDataResultSuccess ? EdgeAppCoreResultSuccess
                                                    : EdgeAppCoreResultFailure;
 }
+
+EdgeAppCoreResult SendInferenceAsync(void *data, size_t datalen,
+                                     EdgeAppLibSendDataType datatype,
+                                     uint64_t timestamp,
+                                     EdgeAppLibSendDataCallback callback,
+                                     void *user_data) {
+  EdgeAppLibSendDataResult result = EdgeAppLib::SendDataAsyncMeta(
+      data, datalen, datatype, timestamp, callback, user_data);
+  return result == EdgeAppLibSendDataResultEnqueued ? EdgeAppCoreResultSuccess
+                                                    : EdgeAppCoreResultFailure;
+}
+
+/**
+ * @brief Image properties of an input tensor sent as an image.
+ * @return false if the tensor cannot be sent as an image.
+ */
+static bool InputTensorImageProperty(const Tensor *input_tensor,
+                                     EdgeAppLibImageProperty *image_property) {
+  if (input_tensor == nullptr || input_tensor->data == nullptr) {
+    LOG_ERR("Invalid input tensor data.");
+    return false;
+  }
+  if (input_tensor->type != TensorDataType::TensorTypeUInt8) {
+    LOG_ERR("Input tensor type %d cannot be sent as an image.",
+            input_tensor->type);
+    return false;
+  }
+
+  *image_property = {};
+  image_property->width = input_tensor->shape_info.dims[2];
+  image_property->height = input_tensor->shape_info.dims[1];
+  if (input_tensor->format == AITRIOS_DRAW_FORMAT_RGB8) {
+    snprintf(image_property->pixel_format,
+             sizeof(image_property->pixel_format), "%s",
+             AITRIOS_SENSOR_PIXEL_FORMAT_RGB24);
+    image_property->stride_bytes =
+        input_tensor->shape_info.dims[2] * 3;  // RGB
+  } else if (input_tensor->format == AITRIOS_DRAW_FORMAT_RGB8_PLANAR) {
+    snprintf(image_property->pixel_format,
+             sizeof(image_property->pixel_format), "%s",
+             AITRIOS_SENSOR_PIXEL_FORMAT_RGB8_PLANAR);
+    image_property->stride_bytes =
+        input_tensor->shape_info.dims[2];  // RGB planar
+  } else {
+    LOG_WARN("Unknown input tensor format: %d, defaulting to RGB8_PLANAR",
+             input_tensor->format);
+    snprintf(image_property->pixel_format,
+             sizeof(image_property->pixel_format), "%s",
+             AITRIOS_SENSOR_PIXEL_FORMAT_RGB8_PLANAR);
+  }
+
+  return true;
+}
+
 /**
  * @brief Sends the Input Tensor to the cloud asynchronously.
  *
@@ -951,36 +2507,20 @@ EdgeAppCoreResult SendInference(void *data, size_t datalen,
  * @return A future representing the asynchronous operation of sending the input
  * tensor.
  */
-
 EdgeAppCoreResult SendInputTensor(Tensor *input_tensor) {
   LOG_TRACE("Inside sendInputTensor.");
-  if (input_tensor == nullptr || input_tensor->data == nullptr) {
-    LOG_ERR("Invalid input tensor data.");
+  EdgeAppLibImageProperty image_property = {};
+  if (!InputTensorImageProperty(input_tensor, &image_property)) {
     return EdgeAppCoreResultInvalidParam;
   }
 
-  EdgeAppLibImageProperty image_property = {};
-  image_property.width = input_tensor->shape_info.dims[2];
-  image_property.height = input_tensor->shape_info.dims[1];
-  if (input_tensor->format == AITRIOS_DRAW_FORMAT_RGB8) {
-    snprintf(image_property.pixel_format, sizeof(image_property.pixel_format),
-             "%s", AITRIOS_SENSOR_PIXEL_FORMAT_RGB24);
-    image_property.stride_bytes = input_tensor->shape_info.dims[2] * 3;  // RGB
-  } else if (input_tensor->format == AITRIOS_DRAW_FORMAT_RGB8_PLANAR) {
-    snprintf(image_property.pixel_format, sizeof(image_property.pixel_format),
-             "%s", AITRIOS_SENSOR_PIXEL_FORMAT_RGB8_PLANAR);
-    image_property.stride_bytes =
-        input_tensor->shape_info.dims[2];  // RGB planar
-  } else {
-    LOG_WARN("Unknown input tensor format: %d, defaulting to RGB8_PLANAR",
-             input_tensor->format);
-    snprintf(image_property.pixel_format, sizeof(image_property.pixel_format),
-             "%s", AITRIOS_SENSOR_PIXEL_FORMAT_RGB8_PLANAR);
+  EdgeAppLibSendDataResult ret;
+  {
+    STAGE_TIMER(send_stats, EdgeAppCoreStageSendInput);
+    ret = SendDataSyncImage(input_tensor->data, input_tensor->size,
+                            (EdgeAppLibImageProperty *)&image_property,
+                            input_tensor->timestamp, -1);
   }
-
-  EdgeAppLibSendDataResult ret = SendDataSyncImage(
-      input_tensor->data, input_tensor->size,
-      (EdgeAppLibImageProperty *)&image_property, input_tensor->timestamp, -1);
   if (input_tensor->memory_owner == TensorMemoryOwner::App) {
     // Free the input tensor data if it was allocated by the app
     free(input_tensor->data);
@@ -990,6 +2530,48 @@ EdgeAppCoreResult SendInputTensor(Tensor *input_tensor) {
                                                   : EdgeAppCoreResultFailure;
 }
 
+static void FreeInputTensorData(void *data, void *user_data) { free(data); }
+
+/**
+ * @brief Queues the Input Tensor to the image encoder worker of SendData.
+ *
+ * Data owned by the app is handed over to the worker. Data of the sensor
+ * frame or of the graph is only valid for the iteration: it is copied first.
+ */
+EdgeAppCoreResult SendInputTensorAsync(Tensor *input_tensor,
+                                       EdgeAppLibSendDataCallback callback,
+                                       void *user_data) {
+  LOG_TRACE("Inside SendInputTensorAsync.");
+  EdgeAppLibImageProperty image_property = {};
+  if (!InputTensorImageProperty(input_tensor, &image_property)) {
+    return EdgeAppCoreResultInvalidParam;
+  }
+
+  STAGE_TIMER(send_stats, EdgeAppCoreStageSendInput);
+  void *data = input_tensor->data;
+  if (input_tensor->memory_owner == TensorMemoryOwner::App) {
+    input_tensor->data = nullptr;
+  } else {
+    data = malloc(input_tensor->size);
+    if (data == nullptr) {
+      LOG_ERR("Failed to allocate %zu bytes for the input tensor.",
+              input_tensor->size);
+      return EdgeAppCoreResultFailure;
+    }
+    memcpy(data, input_tensor->data, input_tensor->size);
+  }
+  // The release callback frees |data| once encoded, or when the image is
+  // dropped by the queue
+  EdgeAppLibSendDataResult ret = SendDataAsyncImage(
+      data, input_tensor->size, &image_property, input_tensor->timestamp,
+      FreeInputTensorData, callback, user_data);
+  if (ret != EdgeAppLibSendDataResultEnqueued) {
+    free(data);
+    return EdgeAppCoreResultFailure;
+  }
+  return EdgeAppCoreResultSuccess;
+}
+
 ProcessedFrame ProcessedFrame::compute() {
   if (!ctx_ || !shared_ctx_) {
     LOG_ERR("Invalid context.");
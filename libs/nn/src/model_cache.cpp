@@ -0,0 +1,176 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "model_cache.hpp"
+
+#include <string.h>
+#include <sys/stat.h>
+
+#include "log.h"
+#include "sensor.h"
+
+namespace EdgeAppCore {
+
+static CachedModel cache[MAX_CACHED_MODELS] = {};
+static bool cache_used[MAX_CACHED_MODELS] = {};
+static size_t cache_limit = 0;  // 0 disables the cache
+static size_t cache_size = 0;
+static uint64_t release_tick = 0;
+
+static void EvictEntry(uint32_t index) {
+  CachedModel &entry = cache[index];
+  LOG_INFO("Model cache: evicting %s (target %d)", entry.name, entry.target);
+  if (entry.target == edge_imx500) {
+    if (EdgeAppLib::SensorCoreCloseStream(entry.sensor_core,
+                                          entry.sensor_stream) != 0) {
+      LOG_WARN("Model cache: SensorCoreCloseStream failed.");
+    }
+  }
+  // wasi-nn has no call to release a graph or a context: the runtime frees
+  // them with the module instance, dropping the handles is all we can do.
+  cache_size -= entry.size;
+  cache_used[index] = false;
+  entry = {};
+}
+
+// Unused entry released the longest time ago, or -1.
+static int32_t LeastRecentlyUsed() {
+  int32_t lru = -1;
+  for (uint32_t i = 0; i < MAX_CACHED_MODELS; ++i) {
+    if (cache_used[i] && !cache[i].in_use &&
+        (lru < 0 || cache[i].last_used < cache[lru].last_used)) {
+      lru = i;
+    }
+  }
+  return lru;
+}
+
+// Evicts unused entries, least recently used first, until |size| more bytes
+// and one more entry fit. Returns the free slot, or -1.
+static int32_t MakeRoom(size_t size) {
+  while (true) {
+    int32_t free_slot = -1;
+    for (uint32_t i = 0; i < MAX_CACHED_MODELS && free_slot < 0; ++i) {
+      if (!cache_used[i]) free_slot = i;
+    }
+    if (free_slot >= 0 && cache_size + size <= cache_limit) return free_slot;
+    int32_t lru = LeastRecentlyUsed();
+    if (lru < 0) return -1;
+    EvictEntry(lru);
+  }
+}
+
+bool ModelCacheEnabled() { return cache_limit != 0; }
+
+uint64_t ModelFileFingerprint(const char *path, size_t *size) {
+  struct stat st;
+  if (stat(path, &st) != 0) return 0;
+  *size = static_cast<size_t>(st.st_size);
+
+  // FNV-1a over the path, size and modification time
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto mix = [&hash](const void *data, size_t len) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < len; ++i) {
+      hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+  };
+  mix(path, strlen(path));
+  uint64_t file_size = static_cast<uint64_t>(st.st_size);
+  int64_t mtime = static_cast<int64_t>(st.st_mtime);
+  mix(&file_size, sizeof(file_size));
+  mix(&mtime, sizeof(mtime));
+  return hash != 0 ? hash : 1;
+}
+
+CachedModel *AcquireCachedModel(const char *name, EdgeAppCoreTarget target,
+                                uint64_t fingerprint) {
+  if (!ModelCacheEnabled()) return nullptr;
+  CachedModel *hit = nullptr;
+  for (uint32_t i = 0; i < MAX_CACHED_MODELS; ++i) {
+    CachedModel &entry = cache[i];
+    if (!cache_used[i] || entry.in_use || entry.target != target) continue;
+    bool same_name = strncmp(entry.name, name, sizeof(entry.name)) == 0;
+    if (same_name && entry.fingerprint == fingerprint && hit == nullptr) {
+      hit = &entry;
+    } else if (same_name || target == edge_imx500) {
+      EvictEntry(i);
+    }
+  }
+  if (hit != nullptr) {
+    hit->in_use = true;
+    LOG_INFO("Model cache: reusing %s", hit->name);
+  }
+  return hit;
+}
+
+CachedModel *InsertCachedModel(const CachedModel &model) {
+  if (!ModelCacheEnabled() || model.size > cache_limit) return nullptr;
+  int32_t slot = MakeRoom(model.size);
+  if (slot < 0) {
+    LOG_WARN("Model cache: no room for %s", model.name);
+    return nullptr;
+  }
+  cache[slot] = model;
+  cache[slot].in_use = true;
+  cache_used[slot] = true;
+  cache_size += model.size;
+  return &cache[slot];
+}
+
+void ReleaseCachedModel(CachedModel *model) {
+  if (model == nullptr) return;
+  model->in_use = false;
+  model->last_used = ++release_tick;
+}
+
+EdgeAppCoreResult SetModelCacheLimit(size_t max_bytes) {
+  cache_limit = max_bytes;
+  // Evict unused entries above the new limit, or all of them when disabled
+  while (cache_limit == 0 || cache_size > cache_limit) {
+    int32_t lru = LeastRecentlyUsed();
+    if (lru < 0) break;
+    EvictEntry(lru);
+  }
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreResult EvictModel(const char *model_name) {
+  bool found = false;
+  for (uint32_t i = 0; i < MAX_CACHED_MODELS; ++i) {
+    if (!cache_used[i]) continue;
+    if (model_name != nullptr &&
+        strncmp(cache[i].name, model_name, sizeof(cache[i].name)) != 0) {
+      continue;
+    }
+    found = true;
+    if (cache[i].in_use) {
+      if (model_name != nullptr) {
+        LOG_ERR("EvictModel: %s is loaded.", model_name);
+        return EdgeAppCoreResultDenied;
+      }
+      continue;
+    }
+    EvictEntry(i);
+  }
+  if (model_name != nullptr && !found) {
+    LOG_ERR("EvictModel: %s is not cached.", model_name);
+    return EdgeAppCoreResultInvalidParam;
+  }
+  return EdgeAppCoreResultSuccess;
+}
+
+}  // namespace EdgeAppCore
@@ -0,0 +1,85 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef EDGEAPP_CORE_MODEL_CACHE_H_
+#define EDGEAPP_CORE_MODEL_CACHE_H_
+
+#include "edgeapp_core.h"
+
+#define MODEL_CACHE_NAME_LEN 256
+
+namespace EdgeAppCore {
+
+/**
+ * @brief Model kept resident by the model cache.
+ * @details CPU/GPU/NPU entries hold the graph and execution context loaded
+ * from a model file, identified by name, target and file fingerprint. The
+ * IMX500 entry holds the open sensor core and stream of an AI model bundle.
+ * Entries in use by a context are never evicted.
+ */
+struct CachedModel {
+  char name[MODEL_CACHE_NAME_LEN];
+  EdgeAppCoreTarget target;
+  uint64_t fingerprint;  ///< Model file fingerprint, 0 for IMX500
+  size_t size;           ///< Bytes counted against the cache limit
+  bool in_use;
+  uint64_t last_used;  ///< Release order, for LRU eviction
+  EdgeAppLibGraph graph;
+  EdgeAppLibGraphContext graph_ctx;
+  EdgeAppLibSensorCore sensor_core;
+  EdgeAppLibSensorStream sensor_stream;
+};
+
+bool ModelCacheEnabled();
+
+/**
+ * @brief Fingerprint of a model file, from its name, size and mtime.
+ *
+ * @param[in] path Full path of the model file.
+ * @param[out] size Size of the file in bytes.
+ *
+ * @return The fingerprint, or 0 if the file cannot be read.
+ */
+uint64_t ModelFileFingerprint(const char *path, size_t *size);
+
+/**
+ * @brief Takes an unused cached model.
+ * @details Unused entries of the same name and target with another
+ * fingerprint are stale and evicted. For IMX500, unused entries of another
+ * bundle are evicted too, since only one sensor stream can be open.
+ *
+ * @return The entry, marked in use, or nullptr on a miss.
+ */
+CachedModel *AcquireCachedModel(const char *name, EdgeAppCoreTarget target,
+                                uint64_t fingerprint);
+
+/**
+ * @brief Adds a loaded model to the cache, marked in use.
+ * @details Unused entries are evicted in LRU order to make room.
+ *
+ * @return The entry, or nullptr if the model does not fit in the cache. The
+ * caller then keeps ownership of the model.
+ */
+CachedModel *InsertCachedModel(const CachedModel &model);
+
+/**
+ * @brief Marks a cached model as unused. It stays resident until evicted.
+ */
+void ReleaseCachedModel(CachedModel *model);
+
+}  // namespace EdgeAppCore
+
+#endif  // EDGEAPP_CORE_MODEL_CACHE_H_
@@ -64,10 +64,10 @@ EdgeAppLibNNResult InitContext(EdgeAppLibGraph g, EdgeAppLibGraphContext *ctx) {
 EdgeAppLibNNResult SetInputFromTensor(EdgeAppLibGraphContext ctx,
                                       uint8_t *input_tensor, uint32_t (*dim)[4],
                                       EdgeAppLibTensorType type) {
+  uint32_t buf[INPUT_TENSOR_DIMS];
   tensor_dimensions dims;
   dims.size = INPUT_TENSOR_DIMS;
-  dims.buf = (uint32_t *)malloc(dims.size * sizeof(uint32_t));
-  if (dims.buf == NULL) return EDGEAPP_LIB_NN_TOO_LARGE;
+  dims.buf = buf;
 
   for (int i = 0; i < dims.size; ++i) {
     dims.buf[i] = (*dim)[i];
@@ -80,9 +80,6 @@ EdgeAppLibNNResult SetInputFromTensor(EdgeAppLibGraphContext ctx,
   // Call wasi-nn set_input
   wasi_nn_error err = set_input((graph_execution_context)ctx, 0, &tensor);
 
-  // Clean up temporary buffers
-  free(dims.buf);
-
   return convert_err_code_from_wasi_nn(err);
 }
 
@@ -90,10 +87,10 @@ EdgeAppLibNNResult SetInput(EdgeAppLibGraphContext ctx, uint8_t *input_tensor,
                             uint32_t *dim, const float *mean_values,
                             size_t mean_size, const float *norm_values,
                             size_t norm_size) {
+  uint32_t buf[INPUT_TENSOR_DIMS];
   tensor_dimensions dims;
   dims.size = INPUT_TENSOR_DIMS;
-  dims.buf = (uint32_t *)malloc(dims.size * sizeof(uint32_t));
-  if (dims.buf == NULL) return EDGEAPP_LIB_NN_TOO_LARGE;
+  dims.buf = buf;
 
   for (int i = 0; i < dims.size; ++i) {
     dims.buf[i] = dim[i];
@@ -107,7 +104,6 @@ EdgeAppLibNNResult SetInput(EdgeAppLibGraphContext ctx, uint8_t *input_tensor,
 
   float *float_buffer = (float *)malloc(num_elements * sizeof(float));
   if (float_buffer == NULL) {
-    free(dims.buf);
     return EDGEAPP_LIB_NN_TOO_LARGE;
   }
 
@@ -131,11 +127,116 @@ EdgeAppLibNNResult SetInput(EdgeAppLibGraphContext ctx, uint8_t *input_tensor,
 
   // Clean up temporary buffers
   free(float_buffer);
-  free(dims.buf);
 
   return convert_err_code_from_wasi_nn(err);
 }
 
+struct EdgeAppLibInputBinding {
+  graph_execution_context ctx;
+  uint32_t buf[INPUT_TENSOR_DIMS];
+  tensor_dimensions dims;
+  tensor tensor;
+  size_t num_pixels;
+  uint32_t channels;
+  float *staging;  // Normalized input, NULL without normalization
+  float *lut;      // Normalized value of each uint8 value, per channel
+};
+
+void DestroyInputBinding(EdgeAppLibInputBinding *binding) {
+  if (binding == NULL) return;
+  free(binding->staging);
+  free(binding->lut);
+  free(binding);
+}
+
+EdgeAppLibNNResult CreateInputBinding(
+    EdgeAppLibGraphContext ctx, uint32_t (*dim)[4], EdgeAppLibTensorType type,
+    const float *mean_values, size_t mean_size, const float *norm_values,
+    size_t norm_size, EdgeAppLibInputBinding **binding) {
+  if (dim == NULL || binding == NULL) return EDGEAPP_LIB_NN_INVALID_ARGUMENT;
+  *binding = NULL;
+
+  bool normalize = mean_values != NULL || norm_values != NULL;
+  uint32_t c = (*dim)[3];
+  size_t num_elements = 1;
+  if (normalize) {
+    if (type != TensorTypeFloat32 || (mean_values != NULL && mean_size < c) ||
+        (norm_values != NULL && norm_size < c)) {
+      return EDGEAPP_LIB_NN_INVALID_ARGUMENT;
+    }
+    for (int i = 0; i < INPUT_TENSOR_DIMS; ++i) {
+      uint32_t d = (*dim)[i];
+      if (d == 0 || num_elements > SIZE_MAX / sizeof(float) / d) {
+        return EDGEAPP_LIB_NN_INVALID_ARGUMENT;
+      }
+      num_elements *= d;
+    }
+    for (uint32_t ci = 0; norm_values != NULL && ci < c; ++ci) {
+      if (norm_values[ci] == 0.0f) return EDGEAPP_LIB_NN_INVALID_ARGUMENT;
+    }
+  }
+
+  EdgeAppLibInputBinding *b =
+      (EdgeAppLibInputBinding *)calloc(1, sizeof(EdgeAppLibInputBinding));
+  if (b == NULL) return EDGEAPP_LIB_NN_TOO_LARGE;
+  b->ctx = (graph_execution_context)ctx;
+  for (int i = 0; i < INPUT_TENSOR_DIMS; ++i) {
+    b->buf[i] = (*dim)[i];
+  }
+  b->dims.buf = b->buf;
+  b->dims.size = INPUT_TENSOR_DIMS;
+  b->tensor.dimensions = &b->dims;
+  b->tensor.type = (tensor_type)type;
+
+  if (normalize) {
+    b->num_pixels = num_elements / c;
+    b->channels = c;
+    b->staging = (float *)malloc(num_elements * sizeof(float));
+    b->lut = (float *)malloc(256 * c * sizeof(float));
+    if (b->staging == NULL || b->lut == NULL) {
+      DestroyInputBinding(b);
+      return EDGEAPP_LIB_NN_TOO_LARGE;
+    }
+    // Same arithmetic as SetInput, once per channel and uint8 value
+    for (uint32_t ci = 0; ci < c; ++ci) {
+      float mean = mean_values != NULL ? mean_values[ci] : 0.0f;
+      float norm = norm_values != NULL ? norm_values[ci] : 1.0f;
+      for (uint32_t v = 0; v < 256; ++v) {
+        float val = static_cast<float>(v) / 255.0f;
+        b->lut[ci * 256 + v] = (val - mean) / norm;
+      }
+    }
+    b->tensor.data = (uint8_t *)b->staging;
+  }
+  *binding = b;
+  return EDGEAPP_LIB_NN_SUCCESS;
+}
+
+EdgeAppLibNNResult BindInput(EdgeAppLibInputBinding *binding,
+                             uint8_t *input_tensor) {
+  if (binding == NULL || input_tensor == NULL) {
+    return EDGEAPP_LIB_NN_INVALID_ARGUMENT;
+  }
+  if (binding->staging != NULL) {
+    const uint8_t *src = input_tensor;
+    float *dst = binding->staging;
+    uint32_t c = binding->channels;
+    for (size_t i = 0; i < binding->num_pixels; ++i) {
+      for (uint32_t ci = 0; ci < c; ++ci) {
+        dst[ci] = binding->lut[ci * 256 + src[ci]];
+      }
+      src += c;
+      dst += c;
+    }
+  } else {
+    binding->tensor.data = (uint8_t *)input_tensor;
+  }
+
+  // Call wasi-nn set_input
+  wasi_nn_error err = set_input(binding->ctx, 0, &binding->tensor);
+  return convert_err_code_from_wasi_nn(err);
+}
+
 EdgeAppLibNNResult Compute(EdgeAppLibGraphContext ctx) {
   wasi_nn_error err = compute((graph_execution_context)ctx);
 
@@ -0,0 +1,477 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "preprocess.hpp"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include "convert.hpp"
+#include "log.h"
+
+#define PREPROCESS_CHANNELS 3
+#define RESIZE_WEIGHT_BITS 11
+#define RESIZE_WEIGHT_ONE (1 << RESIZE_WEIGHT_BITS)
+
+namespace EdgeAppCore {
+
+struct PreprocessPlan {
+  EdgeAppCorePreprocessInfo info;
+  // Normalization lookup tables: (x / 255 - mean) / norm for every x
+  float lut[PREPROCESS_CHANNELS][256];
+  void *output;
+  size_t output_size;
+
+  // Bilinear tables for the last crop size. Offsets are in bytes from the
+  // crop origin (x) or in rows (y), weights are fixed point of the 2nd pixel.
+  // They cover the placement of the crop in the input: all of it, or the
+  // letterboxed window.
+  uint32_t crop_width;
+  uint32_t crop_height;
+  EdgeAppLibLetterbox placement;
+  uint32_t *x0;
+  uint32_t *x1;
+  uint16_t *wx;
+  uint32_t *y0;
+  uint32_t *y1;
+  uint16_t *wy;
+
+  // Two crop rows converted to RGB8, for sources of other formats
+  uint8_t *rows;
+  size_t rows_size;
+};
+
+// Source rows of the crop as RGB8: rows of RGB8 images are read in place,
+// others are converted by LoadRgbRow when the resampler first reads them.
+// The two slots hold the last rows read, which are the next ones to be read
+// again since the output rows read the crop from top to bottom.
+struct CropRows {
+  const EdgeAppLibDrawBuffer *src;
+  uint32_t left;
+  uint32_t top;
+  uint32_t width;
+  const uint8_t *base;  // Crop origin of an RGB8 source, nullptr otherwise
+  size_t stride;
+  uint8_t *slot[2];
+  uint32_t held[2];
+  uint32_t last;
+};
+
+static inline const uint8_t *CropRow(CropRows &rows, uint32_t y) {
+  if (rows.base != nullptr) return rows.base + y * rows.stride;
+  if (rows.held[rows.last] == y) return rows.slot[rows.last];
+  const uint32_t other = 1 - rows.last;
+  if (rows.held[other] != y) {
+    LoadRgbRow(rows.src, rows.left, rows.top + y, rows.width,
+               rows.slot[other]);
+    rows.held[other] = y;
+  }
+  rows.last = other;
+  return rows.slot[other];
+}
+
+// Pixel-center mapping, same as ResizeRectangle in libs/draw
+static void ComputeAxisTable(uint32_t src_size, uint32_t dst_size,
+                             uint32_t step, uint32_t *i0, uint32_t *i1,
+                             uint16_t *w) {
+  const float scale =
+      static_cast<float>(src_size) / static_cast<float>(dst_size);
+  for (uint32_t d = 0; d < dst_size; ++d) {
+    float s = (static_cast<float>(d) + 0.5f) * scale - 0.5f;
+    if (s < 0.0f) s = 0.0f;
+    uint32_t p0 = static_cast<uint32_t>(s);
+    uint32_t p1 = p0 + 1;
+    uint16_t weight = static_cast<uint16_t>(
+        lroundf((s - static_cast<float>(p0)) * RESIZE_WEIGHT_ONE));
+    if (p1 >= src_size) {
+      p0 = src_size - 1;
+      p1 = p0;
+      weight = 0;
+    }
+    i0[d] = p0 * step;
+    i1[d] = p1 * step;
+    w[d] = weight;
+  }
+}
+
+template <typename T>
+static inline T StoreValue(const PreprocessPlan *plan, uint32_t channel,
+                           uint8_t value) {
+  if constexpr (std::is_same<T, float>::value) {
+    return plan->lut[channel][value];
+  } else {
+    return value;
+  }
+}
+
+// Fills pixels [x_begin, x_end) of an output row with the padding value
+template <typename T, EdgeAppCoreTensorLayout LAYOUT>
+static inline void FillPad(const T *pad, T *dst_row, size_t plane,
+                           uint32_t x_begin, uint32_t x_end) {
+  for (uint32_t x = x_begin; x < x_end; ++x) {
+    for (uint32_t c = 0; c < PREPROCESS_CHANNELS; ++c) {
+      if (LAYOUT == EdgeAppCoreLayoutNHWC) {
+        dst_row[x * PREPROCESS_CHANNELS + c] = pad[c];
+      } else {
+        dst_row[c * plane + x] = pad[c];
+      }
+    }
+  }
+}
+
+// Single pass over the output: every output row reads two source rows of the
+// crop, interpolates in fixed point, normalizes through the lookup tables and
+// stores in the model layout. Pixels outside of the placement of the crop
+// are padding.
+template <typename T, EdgeAppCoreTensorLayout LAYOUT>
+static void ResizeNormalize(const PreprocessPlan *plan, CropRows &rows,
+                            T *out) {
+  const uint32_t dst_w = plan->info.width;
+  const uint32_t dst_h = plan->info.height;
+  const size_t plane = static_cast<size_t>(dst_w) * dst_h;
+  const uint32_t shift = 2 * RESIZE_WEIGHT_BITS;
+  const uint32_t round = 1u << (shift - 1);
+  const EdgeAppLibLetterbox &window = plan->placement;
+  const uint32_t x_end = window.left + window.width;
+  const uint32_t y_end = window.top + window.height;
+  T pad[PREPROCESS_CHANNELS];
+  for (uint32_t c = 0; c < PREPROCESS_CHANNELS; ++c) {
+    pad[c] = StoreValue<T>(plan, c, plan->info.pad_value);
+  }
+
+  for (uint32_t y = 0; y < dst_h; ++y) {
+    T *dst_row = (LAYOUT == EdgeAppCoreLayoutNHWC)
+                     ? out + static_cast<size_t>(y) * dst_w *
+                                 PREPROCESS_CHANNELS
+                     : out + static_cast<size_t>(y) * dst_w;
+    if (y < window.top || y >= y_end) {
+      FillPad<T, LAYOUT>(pad, dst_row, plane, 0, dst_w);
+      continue;
+    }
+    FillPad<T, LAYOUT>(pad, dst_row, plane, 0, window.left);
+    FillPad<T, LAYOUT>(pad, dst_row, plane, x_end, dst_w);
+
+    const uint32_t wy = y - window.top;
+    const uint8_t *row0 = CropRow(rows, plan->y0[wy]);
+    const uint8_t *row1 = CropRow(rows, plan->y1[wy]);
+    const uint32_t wy1 = plan->wy[wy];
+    const uint32_t wy0 = RESIZE_WEIGHT_ONE - wy1;
+
+    for (uint32_t x = window.left; x < x_end; ++x) {
+      const uint32_t wx = x - window.left;
+      const uint32_t x0 = plan->x0[wx];
+      const uint32_t x1 = plan->x1[wx];
+      const uint32_t wx1 = plan->wx[wx];
+      const uint32_t wx0 = RESIZE_WEIGHT_ONE - wx1;
+      for (uint32_t c = 0; c < PREPROCESS_CHANNELS; ++c) {
+        uint32_t top = row0[x0 + c] * wx0 + row0[x1 + c] * wx1;
+        uint32_t bottom = row1[x0 + c] * wx0 + row1[x1 + c] * wx1;
+        uint8_t v =
+            static_cast<uint8_t>((top * wy0 + bottom * wy1 + round) >> shift);
+        if (LAYOUT == EdgeAppCoreLayoutNHWC) {
+          dst_row[x * PREPROCESS_CHANNELS + c] = StoreValue<T>(plan, c, v);
+        } else {
+          dst_row[c * plane + x] = StoreValue<T>(plan, c, v);
+        }
+      }
+    }
+  }
+}
+
+// Bytes of a |src| image with rows of |stride| bytes, zero if its format is
+// not supported
+static size_t SourceSize(const EdgeAppLibDrawBuffer &src, uint32_t stride) {
+  const size_t plane = static_cast<size_t>(stride) * src.height;
+  switch (src.format) {
+    case AITRIOS_DRAW_FORMAT_RGB8:
+    case AITRIOS_DRAW_FORMAT_BGR8:
+      return stride < src.width * 3 ? 0 : plane;
+    case AITRIOS_DRAW_FORMAT_GRAY8:
+      return stride < src.width ? 0 : plane;
+    case AITRIOS_DRAW_FORMAT_RGB8_PLANAR:
+      return stride < src.width ? 0 : plane * 3;
+    case AITRIOS_DRAW_FORMAT_NV12:
+    case AITRIOS_DRAW_FORMAT_I420:
+      // Chroma at half resolution in both directions
+      if (stride < src.width || src.width % 2 != 0 || src.height % 2 != 0) {
+        return 0;
+      }
+      return plane + plane / 2;
+    default:
+      return 0;
+  }
+}
+
+// Allocates the output and the bilinear tables of |plan| for its input size.
+static bool AllocatePlanBuffers(PreprocessPlan *plan) {
+  const EdgeAppCorePreprocessInfo &info = plan->info;
+  size_t elem_size =
+      (info.type == EdgeAppLib::TensorTypeFloat32) ? sizeof(float) : 1;
+  plan->output_size = static_cast<size_t>(info.width) * info.height *
+                      PREPROCESS_CHANNELS * elem_size;
+  plan->output = malloc(plan->output_size);
+  plan->x0 = static_cast<uint32_t *>(malloc(info.width * sizeof(uint32_t)));
+  plan->x1 = static_cast<uint32_t *>(malloc(info.width * sizeof(uint32_t)));
+  plan->wx = static_cast<uint16_t *>(malloc(info.width * sizeof(uint16_t)));
+  plan->y0 = static_cast<uint32_t *>(malloc(info.height * sizeof(uint32_t)));
+  plan->y1 = static_cast<uint32_t *>(malloc(info.height * sizeof(uint32_t)));
+  plan->wy = static_cast<uint16_t *>(malloc(info.height * sizeof(uint16_t)));
+  return plan->output && plan->x0 && plan->x1 && plan->wx && plan->y0 &&
+         plan->y1 && plan->wy;
+}
+
+PreprocessPlan *CreatePreprocessPlan(const EdgeAppCorePreprocessInfo &info,
+                                     const std::vector<float> *mean_values,
+                                     const std::vector<float> *norm_values) {
+  if (info.width == 0 || info.height == 0) {
+    LOG_ERR("CreatePreprocessPlan: Invalid input size %ux%u", info.width,
+            info.height);
+    return nullptr;
+  }
+  if (info.type != EdgeAppLib::TensorTypeFloat32 &&
+      info.type != EdgeAppLib::TensorTypeUInt8) {
+    LOG_ERR("CreatePreprocessPlan: Unsupported tensor type %d", info.type);
+    return nullptr;
+  }
+  if (info.layout != EdgeAppCoreLayoutNHWC &&
+      info.layout != EdgeAppCoreLayoutNCHW) {
+    LOG_ERR("CreatePreprocessPlan: Unsupported layout %d", info.layout);
+    return nullptr;
+  }
+  if (info.resize != EdgeAppCoreResizeStretch &&
+      info.resize != EdgeAppCoreResizeLetterbox) {
+    LOG_ERR("CreatePreprocessPlan: Unsupported resize mode %d", info.resize);
+    return nullptr;
+  }
+
+  PreprocessPlan *plan =
+      static_cast<PreprocessPlan *>(calloc(1, sizeof(PreprocessPlan)));
+  if (plan == nullptr) {
+    LOG_ERR("CreatePreprocessPlan: calloc failed");
+    return nullptr;
+  }
+  plan->info = info;
+
+  for (uint32_t c = 0; c < PREPROCESS_CHANNELS; ++c) {
+    float mean = (mean_values && mean_values->size() > c) ? (*mean_values)[c]
+                                                          : 0.0f;
+    float norm = (norm_values && norm_values->size() > c) ? (*norm_values)[c]
+                                                          : 1.0f;
+    if (norm == 0.0f) {
+      LOG_ERR("CreatePreprocessPlan: norm value of channel %u is zero", c);
+      DestroyPreprocessPlan(plan);
+      return nullptr;
+    }
+    for (uint32_t v = 0; v < 256; ++v) {
+      plan->lut[c][v] = (static_cast<float>(v) / 255.0f - mean) / norm;
+    }
+  }
+
+  if (!AllocatePlanBuffers(plan)) {
+    LOG_ERR("CreatePreprocessPlan: malloc failed");
+    DestroyPreprocessPlan(plan);
+    return nullptr;
+  }
+  return plan;
+}
+
+PreprocessPlan *ClonePreprocessPlan(const PreprocessPlan *plan) {
+  if (plan == nullptr) return nullptr;
+  PreprocessPlan *clone =
+      static_cast<PreprocessPlan *>(calloc(1, sizeof(PreprocessPlan)));
+  if (clone == nullptr) {
+    LOG_ERR("ClonePreprocessPlan: calloc failed");
+    return nullptr;
+  }
+  // The bilinear tables are computed again for the first crop
+  clone->info = plan->info;
+  memcpy(clone->lut, plan->lut, sizeof(clone->lut));
+  if (!AllocatePlanBuffers(clone)) {
+    LOG_ERR("ClonePreprocessPlan: malloc failed");
+    DestroyPreprocessPlan(clone);
+    return nullptr;
+  }
+  return clone;
+}
+
+void DestroyPreprocessPlan(PreprocessPlan *plan) {
+  if (plan == nullptr) return;
+  free(plan->output);
+  free(plan->x0);
+  free(plan->x1);
+  free(plan->wx);
+  free(plan->y0);
+  free(plan->y1);
+  free(plan->wy);
+  free(plan->rows);
+  free(plan);
+}
+
+const EdgeAppCorePreprocessInfo &GetPreprocessInfo(const PreprocessPlan *plan) {
+  return plan->info;
+}
+
+size_t GetPreprocessOutputSize(const PreprocessPlan *plan) {
+  return plan->output_size;
+}
+
+EdgeAppCoreResult RunPreprocess(PreprocessPlan *plan,
+                                const EdgeAppLibDrawBuffer &src,
+                                const EdgeAppLibSensorImageCropProperty &roi,
+                                void *dst, Tensor *output) {
+  if (plan == nullptr || output == nullptr || src.address == nullptr ||
+      src.width == 0 || src.height == 0) {
+    LOG_ERR("RunPreprocess: Invalid parameter");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  const bool rgb = src.format == AITRIOS_DRAW_FORMAT_RGB8;
+  const bool interleaved = rgb || src.format == AITRIOS_DRAW_FORMAT_BGR8;
+  const uint32_t stride =
+      src.stride_byte ? src.stride_byte
+                      : src.width * (interleaved ? PREPROCESS_CHANNELS : 1);
+  const size_t src_size = SourceSize(src, stride);
+  if (src_size == 0) {
+    LOG_ERR("RunPreprocess: Unsupported format %d", src.format);
+    return EdgeAppCoreResultInvalidParam;
+  }
+
+  uint32_t left = roi.left;
+  uint32_t top = roi.top;
+  uint32_t width = roi.width;
+  uint32_t height = roi.height;
+  if (width == 0 || height == 0) {
+    left = 0;
+    top = 0;
+    width = src.width;
+    height = src.height;
+  }
+  if (left >= src.width || top >= src.height) {
+    LOG_ERR("RunPreprocess: ROI is outside of the image");
+    return EdgeAppCoreResultInvalidParam;
+  }
+  if (left + width > src.width) width = src.width - left;
+  if (top + height > src.height) height = src.height - top;
+
+  // RGB8 crops are read in place and only need their own rows
+  size_t needed = src_size;
+  if (rgb) {
+    needed = static_cast<size_t>(top + height - 1) * stride +
+             static_cast<size_t>(left + width) * PREPROCESS_CHANNELS;
+  }
+  if (needed > src.size) {
+    LOG_ERR("RunPreprocess: Source buffer is too small");
+    return EdgeAppCoreResultInvalidParam;
+  }
+
+  // LoadRgbRow reads the rows with the stride of the buffer
+  EdgeAppLibDrawBuffer source = src;
+  source.stride_byte = stride;
+  CropRows rows = {&source, left, top, width, nullptr, stride, {}, {}, 0};
+  if (rgb) {
+    rows.base = static_cast<const uint8_t *>(src.address) +
+                static_cast<size_t>(top) * stride +
+                static_cast<size_t>(left) * PREPROCESS_CHANNELS;
+  } else {
+    const size_t row_size = static_cast<size_t>(width) * PREPROCESS_CHANNELS;
+    if (plan->rows_size < 2 * row_size) {
+      uint8_t *grown =
+          static_cast<uint8_t *>(realloc(plan->rows, 2 * row_size));
+      if (grown == nullptr) {
+        LOG_ERR("RunPreprocess: realloc failed");
+        return EdgeAppCoreResultFailure;
+      }
+      plan->rows = grown;
+      plan->rows_size = 2 * row_size;
+    }
+    rows.slot[0] = plan->rows;
+    rows.slot[1] = plan->rows + row_size;
+    rows.held[0] = rows.held[1] = UINT32_MAX;
+  }
+
+  const EdgeAppCorePreprocessInfo &info = plan->info;
+  EdgeAppLibLetterbox &window = plan->placement;
+  if (width != plan->crop_width || height != plan->crop_height) {
+    if (info.resize == EdgeAppCoreResizeLetterbox) {
+      ComputeLetterbox(width, height, info.width, info.height, &window);
+    } else {
+      window = {0.0f, 0, 0, info.width, info.height};
+    }
+    ComputeAxisTable(width, window.width, PREPROCESS_CHANNELS, plan->x0,
+                     plan->x1, plan->wx);
+    ComputeAxisTable(height, window.height, 1, plan->y0, plan->y1, plan->wy);
+    plan->crop_width = width;
+    plan->crop_height = height;
+  }
+
+  void *buffer = dst ? dst : plan->output;
+  const bool nhwc = plan->info.layout == EdgeAppCoreLayoutNHWC;
+  if (plan->info.type == EdgeAppLib::TensorTypeFloat32) {
+    float *out = static_cast<float *>(buffer);
+    if (nhwc) {
+      ResizeNormalize<float, EdgeAppCoreLayoutNHWC>(plan, rows, out);
+    } else {
+      ResizeNormalize<float, EdgeAppCoreLayoutNCHW>(plan, rows, out);
+    }
+  } else {
+    uint8_t *out = static_cast<uint8_t *>(buffer);
+    if (nhwc) {
+      ResizeNormalize<uint8_t, EdgeAppCoreLayoutNHWC>(plan, rows, out);
+    } else {
+      ResizeNormalize<uint8_t, EdgeAppCoreLayoutNCHW>(plan, rows, out);
+    }
+  }
+
+  *output = {};
+  output->data = buffer;
+  output->size = plan->output_size;
+  output->type = static_cast<TensorDataType>(plan->info.type);
+  output->memory_owner = TensorMemoryOwner::Core;
+  output->shape_info.ndim = 4;
+  output->shape_info.dims[0] = 1;
+  if (nhwc) {
+    output->shape_info.dims[1] = plan->info.height;
+    output->shape_info.dims[2] = plan->info.width;
+    output->shape_info.dims[3] = PREPROCESS_CHANNELS;
+  } else {
+    output->shape_info.dims[1] = PREPROCESS_CHANNELS;
+    output->shape_info.dims[2] = plan->info.height;
+    output->shape_info.dims[3] = plan->info.width;
+  }
+  if (plan->info.type == EdgeAppLib::TensorTypeUInt8) {
+    output->format =
+        nhwc ? AITRIOS_DRAW_FORMAT_RGB8 : AITRIOS_DRAW_FORMAT_RGB8_PLANAR;
+  }
+
+  EdgeAppCoreInputTransform &transform = output->transform;
+  transform.scale_x = static_cast<float>(window.width) / width;
+  transform.scale_y = static_cast<float>(window.height) / height;
+  if (info.resize == EdgeAppCoreResizeLetterbox) {
+    // The same scale on both sides, not the rounded window size
+    transform.scale_x = transform.scale_y = window.scale;
+  }
+  transform.pad_x = static_cast<float>(window.left);
+  transform.pad_y = static_cast<float>(window.top);
+  transform.origin_x = static_cast<float>(left);
+  transform.origin_y = static_cast<float>(top);
+  transform.input_width = info.width;
+  transform.input_height = info.height;
+  return EdgeAppCoreResultSuccess;
+}
+
+}  // namespace EdgeAppCore
@@ -0,0 +1,66 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef EDGEAPP_CORE_PREPROCESS_H_
+#define EDGEAPP_CORE_PREPROCESS_H_
+
+#include "edgeapp_core.h"
+
+namespace EdgeAppCore {
+
+/**
+ * @brief Precomputed state of the built-in preprocessing of a model.
+ * @details Holds the per-channel normalization lookup tables, the bilinear
+ * resize tables of the last crop geometry and the model input buffer. It is
+ * created once at LoadModel time and reused for every frame.
+ */
+struct PreprocessPlan;
+
+PreprocessPlan *CreatePreprocessPlan(const EdgeAppCorePreprocessInfo &info,
+                                     const std::vector<float> *mean_values,
+                                     const std::vector<float> *norm_values);
+// Same tables in new buffers, for a thread preprocessing frames concurrently
+PreprocessPlan *ClonePreprocessPlan(const PreprocessPlan *plan);
+void DestroyPreprocessPlan(PreprocessPlan *plan);
+const EdgeAppCorePreprocessInfo &GetPreprocessInfo(const PreprocessPlan *plan);
+size_t GetPreprocessOutputSize(const PreprocessPlan *plan);
+
+/**
+ * @brief Crop, resize, normalize and lay out a frame in a single pass.
+ * @details In letterbox mode, the input pixels outside of the resized crop
+ * are set to the padding value.
+ *
+ * @param[in] plan Plan created by CreatePreprocessPlan.
+ * @param[in] src Source image of any draw format. Rows of other formats
+ * than AITRIOS_DRAW_FORMAT_RGB8 are converted as the resize reads them.
+ * @param[in] roi Region to crop, in source pixels. Zero width or height
+ * selects the full image.
+ * @param[in] dst Destination of GetPreprocessOutputSize bytes, or nullptr to
+ * use the buffer of the plan.
+ * @param[out] output Model input tensor, with the transform of the crop.
+ * Without |dst|, its data is owned by the plan and is valid until the next
+ * call.
+ *
+ * @return EdgeAppCoreResultSuccess on success.
+ */
+EdgeAppCoreResult RunPreprocess(PreprocessPlan *plan,
+                                const EdgeAppLibDrawBuffer &src,
+                                const EdgeAppLibSensorImageCropProperty &roi,
+                                void *dst, Tensor *output);
+
+}  // namespace EdgeAppCore
+
+#endif  // EDGEAPP_CORE_PREPROCESS_H_
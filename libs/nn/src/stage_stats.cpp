@@ -0,0 +1,145 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include "stage_stats.hpp"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#define STATS_SUB_BUCKETS 4
+#define STATS_BUCKETS (26 * STATS_SUB_BUCKETS)  // Up to 2^26 us (67 s)
+#define STATS_WINDOW 1024                       // Samples per window
+
+namespace EdgeAppCore {
+
+struct StageHistogram {
+  uint16_t current[STATS_BUCKETS];
+  uint16_t previous[STATS_BUCKETS];
+  uint32_t current_count;
+  uint32_t previous_count;
+  uint32_t current_max;
+  uint32_t previous_max;
+  uint64_t total_count;
+};
+
+struct StageStats {
+  pthread_mutex_t mutex;
+  StageHistogram stages[EdgeAppCoreStageNum];
+};
+
+// Bucket of |us|: values below 4 have their own bucket, above that each power
+// of two is split in 4.
+static uint32_t BucketIndex(uint32_t us) {
+  if (us < STATS_SUB_BUCKETS) return us;
+  uint32_t log2 = 31 - __builtin_clz(us);
+  uint32_t sub = (us >> (log2 - 2)) & (STATS_SUB_BUCKETS - 1);
+  uint32_t index = (log2 - 1) * STATS_SUB_BUCKETS + sub;
+  return index < STATS_BUCKETS ? index : STATS_BUCKETS - 1;
+}
+
+// Smallest value of bucket |index|.
+static uint64_t BucketLowerBound(uint32_t index) {
+  if (index < STATS_SUB_BUCKETS) return index;
+  uint32_t log2 = index / STATS_SUB_BUCKETS + 1;
+  uint64_t sub = index % STATS_SUB_BUCKETS;
+  return (STATS_SUB_BUCKETS + sub) << (log2 - 2);
+}
+
+StageStats *CreateStageStats() {
+  StageStats *stats = new StageStats;
+  memset(stats->stages, 0, sizeof(stats->stages));
+  pthread_mutex_init(&stats->mutex, nullptr);
+  return stats;
+}
+
+void DestroyStageStats(StageStats *stats) {
+  if (stats == nullptr) return;
+  pthread_mutex_destroy(&stats->mutex);
+  delete stats;
+}
+
+void ResetStageStats(StageStats *stats) {
+  if (stats == nullptr) return;
+  pthread_mutex_lock(&stats->mutex);
+  memset(stats->stages, 0, sizeof(stats->stages));
+  pthread_mutex_unlock(&stats->mutex);
+}
+
+void RecordStage(StageStats *stats, EdgeAppCoreStage stage, uint64_t us) {
+  uint32_t value = us > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us);
+  uint32_t index = BucketIndex(value);
+
+  pthread_mutex_lock(&stats->mutex);
+  StageHistogram &h = stats->stages[stage];
+  if (h.current_count == STATS_WINDOW) {
+    memcpy(h.previous, h.current, sizeof(h.previous));
+    memset(h.current, 0, sizeof(h.current));
+    h.previous_count = h.current_count;
+    h.previous_max = h.current_max;
+    h.current_count = 0;
+    h.current_max = 0;
+  }
+  h.current[index]++;
+  h.current_count++;
+  if (value > h.current_max) h.current_max = value;
+  h.total_count++;
+  pthread_mutex_unlock(&stats->mutex);
+}
+
+// Upper bound of the bucket holding the |permille| percentile, capped by the
+// largest sample.
+static uint32_t Percentile(const StageHistogram &h, uint32_t permille,
+                           uint32_t max) {
+  uint64_t samples = h.current_count + h.previous_count;
+  uint64_t rank = (samples * permille + 999) / 1000;
+  if (rank == 0) rank = 1;
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < STATS_BUCKETS; ++i) {
+    seen += h.current[i] + h.previous[i];
+    if (seen >= rank) {
+      uint64_t upper = BucketLowerBound(i + 1) - 1;
+      return upper < max ? static_cast<uint32_t>(upper) : max;
+    }
+  }
+  return max;
+}
+
+void ReadStageStats(StageStats *stats, EdgeAppCoreStats *out) {
+  if (stats == nullptr) return;
+  pthread_mutex_lock(&stats->mutex);
+  for (uint32_t s = 0; s < EdgeAppCoreStageNum; ++s) {
+    const StageHistogram &h = stats->stages[s];
+    if (h.total_count == 0) continue;
+    EdgeAppCoreStageStats &stage = out->stages[s];
+    uint32_t max =
+        h.current_max > h.previous_max ? h.current_max : h.previous_max;
+    stage.count = h.total_count;
+    stage.p50_us = Percentile(h, 500, max);
+    stage.p95_us = Percentile(h, 950, max);
+    stage.p99_us = Percentile(h, 990, max);
+    stage.max_us = max;
+  }
+  pthread_mutex_unlock(&stats->mutex);
+}
+
+uint64_t StageClockUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+}  // namespace EdgeAppCore
@@ -0,0 +1,74 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef EDGEAPP_CORE_STAGE_STATS_H_
+#define EDGEAPP_CORE_STAGE_STATS_H_
+
+#include "edgeapp_core.h"
+
+namespace EdgeAppCore {
+
+/**
+ * @brief Latency histograms of the stages of a context.
+ * @details One log-linear histogram per stage (4 buckets per power of two,
+ * up to 2^26 us). Samples go to the current window; when it holds
+ * STATS_WINDOW samples it becomes the previous window, so percentiles always
+ * cover the last STATS_WINDOW to 2 * STATS_WINDOW samples. Recording is
+ * guarded by a mutex, since the frame pipeline and ComputeConcurrent record
+ * from other threads.
+ */
+struct StageStats;
+
+StageStats *CreateStageStats();
+void DestroyStageStats(StageStats *stats);
+void ResetStageStats(StageStats *stats);
+void RecordStage(StageStats *stats, EdgeAppCoreStage stage, uint64_t us);
+
+/**
+ * @brief Computes the percentiles of the stages recorded in |stats|.
+ * Stages without samples are left unchanged in |out|.
+ */
+void ReadStageStats(StageStats *stats, EdgeAppCoreStats *out);
+
+uint64_t StageClockUs();
+
+#ifndef EDGEAPP_CORE_NO_STATS
+/**
+ * @brief Records the time spent in the current block as one |stage| sample.
+ */
+class StageTimer {
+ public:
+  StageTimer(StageStats *stats, EdgeAppCoreStage stage)
+      : stats_(stats), stage_(stage), start_(stats ? StageClockUs() : 0) {}
+  ~StageTimer() {
+    if (stats_ != nullptr) RecordStage(stats_, stage_, StageClockUs() - start_);
+  }
+
+ private:
+  StageStats *stats_;
+  EdgeAppCoreStage stage_;
+  uint64_t start_;
+};
+
+#define STAGE_TIMER(stats, stage) \
+  EdgeAppCore::StageTimer stage_timer__##stage(stats, stage)
+#else
+#define STAGE_TIMER(stats, stage)
+#endif
+
+}  // namespace EdgeAppCore
+
+#endif  // EDGEAPP_CORE_STAGE_STATS_H_
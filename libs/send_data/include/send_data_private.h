@@ -25,6 +25,7 @@
 #ifndef SEND_DATA_PRIVATE_H
 #define SEND_DATA_PRIVATE_H
 
+#include "process_format.hpp"
 #include "send_data_types.h"
 
 #ifdef __cplusplus
@@ -32,21 +33,87 @@ extern "C" {
 #endif
 namespace EdgeAppLib {
 
+/**
+ * @brief Inferences of one metadata header waiting to be sent
+ * @details |buffer| holds the header and the "Inferences" array without its
+ * closing "]}", inferences being appended as they come.
+ */
+typedef struct {
+  char *buffer;
+  size_t header_size; /* Bytes of the header, up to "Inferences":[ */
+  size_t size;
+  size_t capacity;
+  uint64_t timestamp; /* Smallest timestamp of the inferences */
+} InfBatch;
+
+/**
+ * @brief Inferences of one metadata header waiting to be sent in a binary
+ * envelope
+ * @details The output tensors are copies owned by the batch, the envelope
+ * being formatted when the batch is sent.
+ */
+typedef struct {
+  ProcessFormatMetaHeader header;
+  ProcessFormatInference *inferences;
+  uint32_t num;
+  uint32_t capacity;
+  uint64_t timestamp; /* Smallest timestamp of the inferences */
+} InfBinaryBatch;
+
+/**
+ * @brief Metadata message, as queued by SendDataAsyncMeta
+ */
 typedef struct {
-  const char *key;
-  JSON_Value *value;
-} InfElem;
+  char *buffer; /* Owned by the queue */
+  size_t size;
+  uint64_t timestamp;
+  EdgeAppLibSendDataCallback callback;
+  void *user_data;
+} SendDataAsyncMsg;
 
 /**
- * @brief Append Output Tensor to output_tensor_vec
- * @param key A pointer to AI model bundle ID
- * @param value A pointer to Output Tensor
- * @return A result of SendDataAppendOutputTensor
+ * @brief Image queued by SendDataAsyncImage
  */
-EdgeAppLibSendDataResult SendDataAppendOutputTensor(const char *key,
-                                                    JSON_Value *value);
+typedef struct {
+  void *data; /* Owned by the caller until release */
+  int datalen;
+  EdgeAppLibImageProperty image_property;
+  uint64_t timestamp;
+  ProcessFormatImageType format; /* Raw if already encoded */
+  EdgeAppLibSendDataReleaseCallback release;
+  EdgeAppLibSendDataCallback callback;
+  void *user_data;
+} SendDataImageJob;
+
+/**
+ * @brief Output buffer of the encode worker, kept from image to image
+ * @details In use from its encoding until the end of its upload, whose
+ * completion is reported to callback.
+ */
+typedef struct {
+  void *buffer;
+  size_t capacity;
+  bool in_use;
+  EdgeAppLibSendDataCallback callback;
+  void *user_data;
+} SendDataImageBuffer;
 
-uint64_t SendDataConvertTimeToNanoseconds(const char *datetime);
+/**
+ * @brief Append an inference formatted by ProcessFormatMeta to the batch of
+ * its header
+ * @param json JSON formatted by ProcessFormatMeta, of one inference
+ * @param timestamp The timestamp of the inference in nanoseconds
+ * @return A result of SendDataAppendInference
+ */
+EdgeAppLibSendDataResult SendDataAppendInference(const char *json,
+                                                 uint64_t timestamp);
+
+/**
+ * @brief Send the batched inferences, one message per header
+ * @param timeout_ms Timeout in milliseconds of each message
+ * @return A result of SendDataFlushInferences
+ */
+EdgeAppLibSendDataResult SendDataFlushInferences(int timeout_ms);
 
 #ifdef __cplusplus
 }
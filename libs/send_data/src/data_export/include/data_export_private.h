@@ -46,6 +46,9 @@ typedef struct {
   uint32_t identifier;
 } module_vars_t;
 
+typedef void (*DataExportCompletionCallback)(EdgeAppLibDataExportResult result,
+                                             void *user_data);
+
 /**
  * @struct EdgeAppLibDataExportFuture
  * @brief Represents the state of an asynchronous operation.
@@ -72,6 +75,10 @@ struct EdgeAppLibDataExportFuture {
                                 data has been sent. */
 
   module_vars_t module_vars; /**< @brief Arguments for evp module*/
+
+  DataExportCompletionCallback on_done; /**< @brief Called once the EVP
+                                           operation has completed. */
+  void *on_done_data; /**< @brief Argument of on_done. */
 };
 
 #ifdef __cplusplus
@@ -115,6 +122,53 @@ EdgeAppLibDataExportResult DataExportUnInitialize();
  */
 bool DataExportHasPendingOperations();
 
+/**
+ * @brief Counts an operation prepared before reaching Data Export, such as an
+ * image being encoded, as pending until DataExportEndPendingOperation.
+ */
+void DataExportBeginPendingOperation();
+
+/**
+ * @brief Ends an operation counted by DataExportBeginPendingOperation, once it
+ * has been handed to EdgeAppLib::DataExportSendData or given up.
+ */
+void DataExportEndPendingOperation();
+
+/**
+ * @brief Sends data as EdgeAppLib::DataExportSendData does, without taking
+ * ownership of it.
+ * @details data is not released, whatever its type, and must stay valid until
+ * the operation has completed.
+ * @param portname The port name of the destination. [Parameter currently
+ * unused]
+ * @param datatype The type of the data to upload.
+ * @param data The serialized data to upload.
+ * @param datalen The length of the serialized data.
+ * @param timestamp The timestamp of the processed frame in nanoseconds.
+ * @param current Current frame number (for multi-frame data).
+ * @param division Total number of frames (for multi-frame data).
+ * @return Reference to the future representing the asynchronous operation.
+ *         Returns NULL on failure or when disabled.
+ */
+EdgeAppLibDataExportFuture *DataExportSendBorrowedData(
+    char *portname, EdgeAppLibDataExportDataType datatype, void *data,
+    int datalen, uint64_t timestamp, uint32_t current = 1,
+    uint32_t division = 1);
+
+/**
+ * @brief Sets a function called when the operation of `future` completes,
+ * from the thread processing EVP events.
+ * @details If the operation has already completed, `callback` is called
+ * before returning. The future must still be released with
+ * EdgeAppLib::DataExportCleanup, which can be done right away.
+ * @param future The future of the operation.
+ * @param callback Function receiving the result of the operation.
+ * @param user_data Argument passed to callback.
+ */
+void DataExportSetCompletionCallback(EdgeAppLibDataExportFuture *future,
+                                     DataExportCompletionCallback callback,
+                                     void *user_data);
+
 /**
  * @brief Formats a Unix timestamp in nanoseconds as yyyyMMddHHmmssSSS, in UTC.
  * @param buffer Buffer where to store formatted string.
@@ -22,6 +22,8 @@
 #include <string.h>
 #include <sys/time.h>
 
+#include <atomic>
+
 #include "data_export_private.h"
 #include "data_export_types.h"
 #include "dtdl_model/properties.h"
@@ -35,6 +37,9 @@
 
 static Context *context_;
 static int registered_send_data_callback = 0;
+/* Operations prepared outside of Data Export, see
+ * DataExportBeginPendingOperation */
+static std::atomic<int> pending_operations{0};
 
 struct EVP_client *evp_client_;
 static const char *g_placeholder_telemetry_key = "placeholder";
@@ -78,6 +83,8 @@ static EdgeAppLibDataExportFuture *InitializeFuture() {
   future->mutex = PTHREAD_MUTEX_INITIALIZER;
   future->is_processed = false;
   future->is_cleanup_requested = false;
+  future->on_done = NULL;
+  future->on_done_data = NULL;
   return future;
 }
 
@@ -110,6 +117,21 @@ static void DataExportCleanupOrUnlock(EdgeAppLibDataExportFuture *future) {
   pthread_mutex_unlock(&future->mutex);
 }
 
+/**
+ * @brief Unlocks a processed future and calls its completion callback, if any.
+ * The callback is called without the lock, as the future may be deleted.
+ *
+ * @param future parameter to complete. Assumption: future is locked.
+ */
+static void DataExportCompleteAndUnlock(EdgeAppLibDataExportFuture *future) {
+  DataExportCompletionCallback on_done = future->on_done;
+  void *on_done_data = future->on_done_data;
+  EdgeAppLibDataExportResult result = future->result;
+  future->on_done = NULL;
+  DataExportCleanupOrUnlock(future);
+  if (on_done != NULL) on_done(result, on_done_data);
+}
+
 /**
  * @brief Cleans up the data buffer
  *
@@ -164,7 +186,7 @@ static void DataExportSendDataDoneCallback(EVP_BLOB_CALLBACK_REASON reason,
    * change in configuration) */
   // free(cb_data->blob_url);//url is saved in stack.
   pthread_cond_signal(&future->cond);
-  DataExportCleanupOrUnlock(future);
+  DataExportCompleteAndUnlock(future);
 }
 
 /**
@@ -203,7 +225,7 @@ static void DataExportTelemetryDoneCallback(
           "EVP_TELEMETRY_CALLBACK_REASON.");
   }
   pthread_cond_signal(&future->cond);
-  DataExportCleanupOrUnlock(future);
+  DataExportCompleteAndUnlock(future);
 }
 
 EdgeAppLibDataExportResult DataExportInitialize(Context *context,
@@ -219,14 +241,17 @@ EdgeAppLibDataExportResult DataExportUnInitialize() {
   return EdgeAppLibDataExportResultSuccess;
 }
 
-EdgeAppLibDataExportFuture *DataExportSendData(
-    char *portname, EdgeAppLibDataExportDataType datatype, void *data,
-    int datalen, uint64_t timestamp, uint32_t current, uint32_t division,
-    EdgeAppLibImageProperty *image_property) {
+/**
+ * @brief Sends data, releasing it once sent if |owns_data|
+ */
+static EdgeAppLibDataExportFuture *SendData(
+    EdgeAppLibDataExportDataType datatype, void *data, int datalen,
+    uint64_t timestamp, uint32_t current, uint32_t division,
+    EdgeAppLibImageProperty *image_property, bool owns_data) {
   LOG_TRACE("Entering SendData");
 
   if (!DataExportIsEnabled(datatype)) {
-    if (datatype == EdgeAppLibDataExportRaw) {
+    if (owns_data && datatype == EdgeAppLibDataExportRaw) {
       free(data);
     }
     return nullptr;
@@ -274,14 +299,36 @@ EdgeAppLibDataExportFuture *DataExportSendData(
     }
   }
 
+  ProcessFormatPort port = datatype == EdgeAppLibDataExportRaw
+                               ? kProcessFormatPortInputTensor
+                               : kProcessFormatPortMetadata;
+  ProcessFormatCompression compression = ProcessFormatGetCompression(port);
+  bool compressed = false;
+  if (compression != kProcessFormatCompressionNone) {
+    void *frame = nullptr;
+    uint32_t frame_size = 0;
+    ProcessFormatResult ret =
+        ProcessFormatCompress(port, compression, processed_data,
+                              processed_datalen, &frame, &frame_size);
+    if (ret != kProcessFormatResultOk) {
+      LOG_WARN("ProcessFormatCompress failed: %d. Sending as is.", ret);
+    } else if (frame != nullptr) {
+      // Release the uncompressed data if it was handed over
+      if (owns_data || needs_cleanup) free(processed_data);
+      processed_data = frame;
+      processed_datalen = frame_size;
+      needs_cleanup = true;
+      compressed = true;
+    }
+  }
+
   EdgeAppLibDataExportFuture *future = InitializeFuture();
   if (future == nullptr) {
     return nullptr;
   }
 
   // Release sent data inside DataExportCleanupOrUnlock
-  future->is_cleanup_sent_data =
-      (datatype != EdgeAppLibDataExportMetadata) || needs_cleanup;
+  future->is_cleanup_sent_data = owns_data || needs_cleanup;
 
   if (map_set((void *)&(future->module_vars), future) == -1) {
     // TODO: add more meaningful result
@@ -318,7 +365,7 @@ EdgeAppLibDataExportFuture *DataExportSendData(
   if (sendMethod == METHOD_HTTP_STORAGE || sendMethod == METHOD_BLOB_STORAGE) {
     /* Data used for blob_cb to share instance context and current url
      * used, and free configuration after use it */
-    char filename[32] = {0};
+    char filename[48] = {0};
     char filename_extension[10] = {0};
     const char *path = NULL;
     if (json_object_has_value(port_setting, "path")) {
@@ -351,6 +398,7 @@ EdgeAppLibDataExportFuture *DataExportSendData(
     }
 
     strncat(filename, filename_extension, strlen(filename_extension));
+    if (compressed) strncat(filename, ".lz4", strlen(".lz4"));
     void *request;
     EVP_BLOB_TYPE blob_type;
     if (sendMethod == METHOD_HTTP_STORAGE) {
@@ -413,16 +461,28 @@ EdgeAppLibDataExportFuture *DataExportSendData(
     future->is_processed = true;
     future->result = EdgeAppLibDataExportResultFailure;
     map_pop((void *)&(future->module_vars));
-    // Clean up allocated codec buffer on error
-    if (needs_cleanup && processed_data != data) {
-      free(processed_data);
-    }
+    // The buffer is released with the future, as is_cleanup_sent_data is set
   }
 
   LOG_TRACE("Exit SendData");
   return future;
 }
 
+EdgeAppLibDataExportFuture *DataExportSendData(
+    char *portname, EdgeAppLibDataExportDataType datatype, void *data,
+    int datalen, uint64_t timestamp, uint32_t current, uint32_t division,
+    EdgeAppLibImageProperty *image_property) {
+  return SendData(datatype, data, datalen, timestamp, current, division,
+                  image_property, datatype != EdgeAppLibDataExportMetadata);
+}
+
+EdgeAppLibDataExportFuture *DataExportSendBorrowedData(
+    char *portname, EdgeAppLibDataExportDataType datatype, void *data,
+    int datalen, uint64_t timestamp, uint32_t current, uint32_t division) {
+  return SendData(datatype, data, datalen, timestamp, current, division,
+                  nullptr, false);
+}
+
 EdgeAppLibDataExportResult DataExportSendState(const char *topic, void *state,
                                                int statelen) {
   LOG_TRACE("Entering SendState");
@@ -500,7 +560,32 @@ EdgeAppLibDataExportResult DataExportStopSelf() {
   return EdgeAppLibDataExportResultSuccess;
 }
 
-bool DataExportHasPendingOperations() { return not map_is_empty(); }
+void DataExportBeginPendingOperation() {
+  pending_operations++;
+}
+
+void DataExportEndPendingOperation() {
+  pending_operations--;
+}
+
+bool DataExportHasPendingOperations() {
+  return not map_is_empty() || pending_operations > 0;
+}
+
+void DataExportSetCompletionCallback(EdgeAppLibDataExportFuture *future,
+                                     DataExportCompletionCallback callback,
+                                     void *user_data) {
+  pthread_mutex_lock(&future->mutex);
+  if (!future->is_processed) {
+    future->on_done = callback;
+    future->on_done_data = user_data;
+    pthread_mutex_unlock(&future->mutex);
+    return;
+  }
+  EdgeAppLibDataExportResult result = future->result;
+  pthread_mutex_unlock(&future->mutex);
+  callback(result, user_data);
+}
 
 bool DataExportIsEnabled(EdgeAppLibDataExportDataType datatype) {
   const char *port_setting_key =
@@ -550,7 +635,9 @@ void DataExportFileSuffix(char *buffer, size_t buffer_size,
         break;
     }
   } else if (datatype == EdgeAppLibDataExportMetadata) {
-    extension = "txt";
+    extension = ProcessFormatGetMetaFormat() == kProcessFormatMetaBinary
+                    ? "bin"
+                    : "txt";
   } else {
     extension = "bmp";
   }
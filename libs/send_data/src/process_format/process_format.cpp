@@ -16,55 +16,80 @@
 
 #include "process_format.hpp"
 
+#include <pthread.h>
 #include <stdlib.h>
 
+#include "base64_codec.h"
 #include "device.h"
+#include "dtdl_model/properties.h"
 #include "log.h"
+#include "lz4_codec.h"
 #include "memory_manager.hpp"
 #include "sensor.h"
 #include "sm_api.hpp"
 #include "time.h"
-extern "C" {
-#include "base64.h"
+
+// Longest {"ModelID":"...","DeviceID":"...","Image":false, prefix
+#define META_HEADER_MAX_SIZE                                        \
+  (sizeof("{\"ModelID\":\"\",\"DeviceID\":\"\",\"Image\":false,") + \
+   AITRIOS_SENSOR_INFO_STRING_LENGTH + WASM_BINDING_DEVICEID_MAX_SIZE)
+
+static_assert(PROCESS_FORMAT_DEVICE_ID_SIZE == WASM_BINDING_DEVICEID_MAX_SIZE,
+              "PROCESS_FORMAT_DEVICE_ID_SIZE mismatch");
+
+// file_identifier of metadata_envelope.fbs
+#define META_BINARY_IDENTIFIER "EAMD"
+
+/**
+ * @brief Makes |*image| at least |size| bytes, replacing it when too small.
+ * Its contents are not kept.
+ * @param image    Pointer of the buffer, NULL if none.
+ * @param capacity Pointer of the size of the buffer.
+ * @param size     Bytes needed.
+ * @return true on success, false if the allocation failed.
+ */
+static bool ReserveImage(void **image, size_t *capacity, size_t size) {
+  if (*image != nullptr && *capacity >= size) return true;
+  void *buffer = malloc(size);
+  if (!buffer) return false;
+  free(*image);
+  *image = buffer;
+  *capacity = size;
+  return true;
 }
 
 /**
  * @brief Handles raw format processing by mapping or reading memory.
  * @param in_data      Input memory reference containing data to be processed.
  * @param in_size      Size of the input data.
- * @param image        Pointer to store the output image data.
+ * @param image        Pointer of the output buffer, reused when large enough.
+ * @param capacity     Pointer of the size of the output buffer.
  * @param image_size   Pointer to store the size of the output image data.
  * @return ProcessFormatResult
  */
 static ProcessFormatResult HandleRawFormat(MemoryRef in_data, size_t in_size,
-                                           void **image, int32_t *image_size) {
-  if (!image || !image_size) {
+                                           void **image, size_t *capacity,
+                                           int32_t *image_size) {
+  if (!image || !capacity || !image_size) {
     LOG_ERR("Invalid input arguments.");
     return kProcessFormatResultInvalidParam;
   }
 
+  if (!ReserveImage(image, capacity, in_size)) {
+    LOG_ERR("Memory allocation failed.");
+    return kProcessFormatResultOther;
+  }
+
   if (in_data.type == MEMORY_MANAGER_MAP_TYPE) {
-    *image = malloc(in_size);
-    if (!*image) {
-      LOG_ERR("Memory allocation failed.");
-      return kProcessFormatResultOther;
-    }
     memcpy(*image, in_data.u.p, in_size);
     *image_size = in_size;
   } else {
-    *image = malloc(in_size);
-    if (!*image) {
-      LOG_ERR("Memory allocation failed.");
-      return kProcessFormatResultOther;
-    }
-
     /* Copy data from Himem using handle */
     size_t size = 0;
     EsfMemoryManagerResult mem_err =
         EsfMemoryManagerPread(in_data.u.esf_handle, *image, in_size, 0, &size);
     if (mem_err != kEsfMemoryManagerResultSuccess) {
       LOG_ERR("EsfMemoryManagerPread failed. %d", mem_err);
-      free(*image);
       return kProcessFormatResultOther;
     }
 
@@ -124,17 +149,18 @@ static bool InitializeJpegEncodingParameters(
  * @param in_data      Input memory reference containing raw data.
  * @param in_size      Size of the input raw data.
  * @param image_property Pointer to the image property structure containing
- * @param image        Pointer to store the encoded JPEG image.
+ * @param image        Pointer of the output buffer, reused when large enough.
+ * @param capacity     Pointer of the size of the output buffer.
  * @param image_size   Pointer to store the size of the encoded JPEG image.
  */
 static ProcessFormatResult HandleJpegFormat(
     MemoryRef in_data, size_t in_size, EdgeAppLibImageProperty *image_property,
-    void **image, int32_t *image_size) {
+    void **image, size_t *capacity, int32_t *image_size) {
   EsfCodecJpegInfo enc_info = {};
   EsfCodecJpegEncParam enc_param = {};
 
   // Validate input arguments
-  if (!image || !image_size || !image_property ||
+  if (!image || !capacity || !image_size || !image_property ||
       (in_data.type == MEMORY_MANAGER_MAP_TYPE && in_data.u.p == nullptr)) {
     LOG_ERR("Invalid input arguments.");
     return kProcessFormatResultInvalidParam;
@@ -153,65 +179,63 @@ static ProcessFormatResult HandleJpegFormat(
     return kProcessFormatResultMemoryError;
   }
   EsfCodecJpegError jpeg_err;
+  int32_t size = 0;
   if (in_data.type == MEMORY_MANAGER_MAP_TYPE) {
-    // Set input and allocate output buffer for encoding
+    // Set input and output buffer for encoding
+    if (!ReserveImage(image, capacity, enc_param.out_buf.output_buf_size)) {
+      LOG_ERR("Memory allocation failed.");
+      return kProcessFormatResultMemoryError;
+    }
     enc_param.input_adr_handle = (uint64_t)(uintptr_t)in_data.u.p;
-    enc_param.out_buf.output_adr_handle =
-        (uint64_t)(uintptr_t)malloc(enc_param.out_buf.output_buf_size);
+    enc_param.out_buf.output_adr_handle = (uint64_t)(uintptr_t)*image;
     LOG_DBG("JPEG encoding: input_adr_handle=%p, output_adr_handle=%p",
             (void *)enc_param.input_adr_handle,
             (void *)enc_param.out_buf.output_adr_handle);
 
-    if (!enc_param.out_buf.output_adr_handle) {
-      LOG_ERR("Memory allocation failed.");
-      return kProcessFormatResultMemoryError;
-    }
-
     // Perform JPEG encoding
-    jpeg_err = EsfCodecEncodeJpeg(&enc_param, image_size);
+    jpeg_err = EsfCodecEncodeJpeg(&enc_param, &size);
     if (jpeg_err != kJpegSuccess) {
       LOG_ERR("EsfCodecEncodeJpeg failed. %d", jpeg_err);
-      free((void *)(uintptr_t)enc_param.out_buf.output_adr_handle);
       return kProcessFormatResultOther;
     }
 
-    *image = (void *)(uintptr_t)enc_param.out_buf.output_adr_handle;
+    *image_size = size;
   } else {
     EsfMemoryManagerHandle output_adr_handle;
 
     // Perform JPEG encoding with himem memory handle
-    jpeg_err = EsfCodecJpegEncodeHandle(
-        in_data.u.esf_handle, &output_adr_handle, &enc_info, image_size);
+    jpeg_err = EsfCodecJpegEncodeHandle(in_data.u.esf_handle,
+                                        &output_adr_handle, &enc_info, &size);
 
     if (jpeg_err != kJpegSuccess) {
       LOG_ERR("EsfCodecJpegEncodeHandle failed. %d", jpeg_err);
       return kProcessFormatResultOther;
     }
 
-    size_t size = 0;
-    *image = malloc(*image_size);
-    if (!*image) {
-      LOG_ERR("Memory allocation failed.");
-      return kProcessFormatResultOther;
-    }
-
     // Get encoded data into Wasm memory
-    EsfMemoryManagerResult mem_err =
-        EsfMemoryManagerPread(output_adr_handle, *image, *image_size, 0, &size);
-    if (mem_err != kEsfMemoryManagerResultSuccess) {
-      LOG_ERR("EsfMemoryManagerPread failed. %d", mem_err);
-      free(*image);
-      return kProcessFormatResultOther;
+    ProcessFormatResult ret = kProcessFormatResultOk;
+    size_t read_size = 0;
+    if (!ReserveImage(image, capacity, size)) {
+      LOG_ERR("Memory allocation failed.");
+      ret = kProcessFormatResultOther;
+    } else {
+      EsfMemoryManagerResult mem_err = EsfMemoryManagerPread(
+          output_adr_handle, *image, size, 0, &read_size);
+      if (mem_err != kEsfMemoryManagerResultSuccess) {
+        LOG_ERR("EsfMemoryManagerPread failed. %d", mem_err);
+        ret = kProcessFormatResultOther;
+      }
     }
 
-    *image_size = size;
-    // Release himem memory handle
+    // Release himem memory handle, even if it could not be read
     jpeg_err = EsfCodecJpegEncodeRelease(output_adr_handle);
     if (jpeg_err != kJpegSuccess) {
       LOG_ERR("EsfCodecJpegEncodeRelease failed. %d", jpeg_err);
-      free(*image);
-      return kProcessFormatResultOther;
+      ret = kProcessFormatResultOther;
     }
+    if (ret != kProcessFormatResultOk) return ret;
+
+    *image_size = read_size;
   }
 
   return kProcessFormatResultOk;
@@ -226,6 +250,26 @@ ProcessFormatResult ProcessFormatInput(MemoryRef in_data, uint32_t in_size,
     LOG_ERR("Invalid input arguments.");
     return kProcessFormatResultInvalidParam;
   }
+
+  *image = nullptr;
+  size_t capacity = 0;
+  ProcessFormatResult ret = ProcessFormatInputToBuffer(
+      in_data, in_size, datatype, image_property, image, &capacity, image_size);
+  if (ret != kProcessFormatResultOk) {
+    free(*image);
+    *image = nullptr;
+  }
+  return ret;
+}
+
+ProcessFormatResult ProcessFormatInputToBuffer(
+    MemoryRef in_data, uint32_t in_size, ProcessFormatImageType datatype,
+    EdgeAppLibImageProperty *image_property, void **buffer, size_t *capacity,
+    int32_t *image_size) {
+  if (!buffer || !capacity || !image_size) {
+    LOG_ERR("Invalid input arguments.");
+    return kProcessFormatResultInvalidParam;
+  }
   if (in_data.type == MEMORY_MANAGER_MAP_TYPE && in_data.u.p == nullptr) {
     LOG_ERR("Invalid input data.");
     return kProcessFormatResultInvalidParam;
@@ -233,11 +277,11 @@ ProcessFormatResult ProcessFormatInput(MemoryRef in_data, uint32_t in_size,
 
   switch (datatype) {
     case kProcessFormatImageTypeRaw:
-      return HandleRawFormat(in_data, in_size, image, image_size);
+      return HandleRawFormat(in_data, in_size, buffer, capacity, image_size);
 
     case kProcessFormatImageTypeJpeg:
-      return HandleJpegFormat(in_data, in_size, image_property, image,
-                              image_size);
+      return HandleJpegFormat(in_data, in_size, image_property, buffer,
+                              capacity, image_size);
 
     default:
       LOG_ERR("Invalid datatype.");
@@ -245,16 +289,27 @@ ProcessFormatResult ProcessFormatInput(MemoryRef in_data, uint32_t in_size,
   }
 }
 
-ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
-                                      EdgeAppLibSendDataType datatype,
-                                      uint64_t timestamp, char *json_buffer,
-                                      size_t buffer_size) {
-  if (json_buffer == NULL) {
-    LOG_ERR("Invalid json_buffer.");
-    return kProcessFormatResultInvalidParam;
-  }
+/*
+ * Metadata header and its JSON prefix, only depending on the settings. Used
+ * by the sync senders and the async send thread, under s_meta_header_mutex.
+ */
+static struct {
+  bool valid;
+  uint32_t generation; /* getSettingsGeneration() when built */
+  ProcessFormatMetaHeader header;
+  size_t size;
+  char data[META_HEADER_MAX_SIZE];
+} s_meta_header;
+static pthread_mutex_t s_meta_header_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-  size_t offset = 0;
+/**
+ * @brief Builds the metadata header with the AI model version, the device ID
+ * and the image flag.
+ * @param generation Settings generation the prefix is built for.
+ * @return ProcessFormatResult
+ */
+static ProcessFormatResult BuildMetaHeader(uint32_t generation) {
+  s_meta_header.valid = false;
 
   // Get AI model version ID
   EdgeAppLibSensorStream stream = GetSensorStream();
@@ -282,20 +337,16 @@ ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
     LOG_ERR("%s : SensorStreamGetProperty=%d", error_msg, ret);
     return kProcessFormatResultFailure;
   }
-  // Set AI model bundle ID directly into the JSON buffer
-  offset += snprintf(json_buffer + offset, buffer_size - offset,
-                     "{\"ModelID\":\"%s\",", sensor_version_id.info);
 
-  // Get Device ID
+  // Get Device ID. Not cached on failure, so that it is read again.
+  bool cacheable = true;
   char device_id[WASM_BINDING_DEVICEID_MAX_SIZE] = {0};
   if ((ret = EsfSystemGetDeviceID(device_id)) != kEsfDeviceIdResultOk) {
     const char *error_msg = "Error GET device id.";
     LOG_ERR("%s : EsfSystemGetDeviceID=%d", error_msg, ret);
     snprintf(device_id, sizeof(device_id), "000000000000000");
+    cacheable = false;
   }
-  // Set Device ID
-  offset += snprintf(json_buffer + offset, buffer_size - offset,
-                     "\"DeviceID\":\"%s\",", device_id);
 
   // Get Image Flag
   bool image_flg = false;
@@ -307,15 +358,65 @@ ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
     }
   }
 
-  // Set Image Flag
-  if (image_flg) {
-    offset +=
-        snprintf(json_buffer + offset, buffer_size - offset, "\"Image\":true,");
-  } else {
-    offset += snprintf(json_buffer + offset, buffer_size - offset,
-                       "\"Image\":false,");
+  // Set AI model bundle ID, Device ID and Image Flag
+  ProcessFormatMetaHeader *header = &s_meta_header.header;
+  snprintf(header->model_id, sizeof(header->model_id), "%.*s",
+           AITRIOS_SENSOR_INFO_STRING_LENGTH, sensor_version_id.info);
+  snprintf(header->device_id, sizeof(header->device_id), "%.*s",
+           WASM_BINDING_DEVICEID_MAX_SIZE, device_id);
+  header->image = image_flg;
+  int written = snprintf(
+      s_meta_header.data, sizeof(s_meta_header.data),
+      "{\"ModelID\":\"%s\",\"DeviceID\":\"%s\",\"Image\":%s,",
+      header->model_id, header->device_id, image_flg ? "true" : "false");
+  if (written < 0 || (size_t)written >= sizeof(s_meta_header.data)) {
+    LOG_ERR("Metadata header too long.");
+    return kProcessFormatResultMemoryError;
+  }
+  s_meta_header.size = written;
+  s_meta_header.generation = generation;
+  s_meta_header.valid = cacheable;
+  return kProcessFormatResultOk;
+}
+
+/**
+ * @brief Builds the metadata header again if the settings changed. Called
+ * with s_meta_header_mutex held.
+ * @return ProcessFormatResult
+ */
+static ProcessFormatResult UpdateMetaHeader() {
+  // The header only changes with the settings: skip the sensor, device and
+  // port settings queries while they are unchanged
+  uint32_t generation = getSettingsGeneration();
+  if (s_meta_header.valid && s_meta_header.generation == generation) {
+    return kProcessFormatResultOk;
+  }
+  return BuildMetaHeader(generation);
+}
+
+ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
+                                      EdgeAppLibSendDataType datatype,
+                                      uint64_t timestamp, char *json_buffer,
+                                      size_t buffer_size) {
+  if (json_buffer == NULL) {
+    LOG_ERR("Invalid json_buffer.");
+    return kProcessFormatResultInvalidParam;
   }
 
+  pthread_mutex_lock(&s_meta_header_mutex);
+  ProcessFormatResult res = UpdateMetaHeader();
+  if (res == kProcessFormatResultOk && s_meta_header.size >= buffer_size) {
+    LOG_ERR("Buffer overflow when writing JSON header.");
+    res = kProcessFormatResultMemoryError;
+  }
+  size_t offset = 0;
+  if (res == kProcessFormatResultOk) {
+    memcpy(json_buffer, s_meta_header.data, s_meta_header.size);
+    offset = s_meta_header.size;
+  }
+  pthread_mutex_unlock(&s_meta_header_mutex);
+  if (res != kProcessFormatResultOk) return res;
+
   // Set "T"
   char inf_timestamp[32];
   // convert nanoseconds to milliseconds
@@ -336,13 +437,14 @@ ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
                      "\"Inferences\":[{\"T\":\"%s\",", inf_timestamp);
 
   if (datatype == EdgeAppLibSendDataBase64) {
-    int inf_o_size = b64e_size(in_size);
     offset += snprintf(json_buffer + offset, buffer_size - offset, "\"O\":\"");
-    char *inf_o = json_buffer + offset;
-    /* Memory in-place Base64 encoding */
-    int encoded_size =
-        b64_encode((unsigned char *)in_data, in_size, (unsigned char *)inf_o);
-    offset += encoded_size;
+    if (offset >= buffer_size ||
+        BASE64_ENCODED_SIZE(in_size) >= buffer_size - offset) {
+      LOG_ERR("Buffer overflow when writing Base64 data.");
+      return kProcessFormatResultMemoryError;
+    }
+    /* Encode straight into the JSON buffer */
+    offset += base64_encode(in_data, in_size, json_buffer + offset);
     int written =
         snprintf(json_buffer + offset, buffer_size - offset, "\",\"F\":0}]}");
     if (written < 0 || (size_t)written >= buffer_size - offset) {
@@ -365,3 +467,288 @@ ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
 
   return kProcessFormatResultOk;
 }
+
+ProcessFormatMetaFormat ProcessFormatGetMetaFormat(void) {
+  JSON_Object *object = getPortSettings();
+  JSON_Object *port_setting =
+      object ? json_object_get_object(object, "metadata") : NULL;
+  if (port_setting == NULL ||
+      (int)json_object_get_number(port_setting, "format") !=
+          META_FORMAT_BINARY) {
+    return kProcessFormatMetaJson;
+  }
+  // Telemetry values are JSON
+  if ((int)json_object_get_number(port_setting, "method") == METHOD_MQTT) {
+    LOG_DBG("Binary metadata not supported with MQTT: using JSON.");
+    return kProcessFormatMetaJson;
+  }
+  return kProcessFormatMetaBinary;
+}
+
+ProcessFormatResult ProcessFormatGetMetaHeader(
+    ProcessFormatMetaHeader *header) {
+  if (header == NULL) {
+    LOG_ERR("Invalid header.");
+    return kProcessFormatResultInvalidParam;
+  }
+  pthread_mutex_lock(&s_meta_header_mutex);
+  ProcessFormatResult res = UpdateMetaHeader();
+  if (res == kProcessFormatResultOk) *header = s_meta_header.header;
+  pthread_mutex_unlock(&s_meta_header_mutex);
+  return res;
+}
+
+/*
+ * FlatBuffers writer for metadata_envelope.fbs. The buffer is written front
+ * to back, each table before the strings, vectors and tables it refers to, so
+ * that the offsets point forward as required. Scalars are little endian.
+ */
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+  bool overflow;
+} FbWriter;
+
+static void FbPutBytes(FbWriter *w, const void *src, size_t n) {
+  if (w->overflow || n > w->capacity - w->size) {
+    w->overflow = true;
+    return;
+  }
+  if (n > 0) memcpy(w->data + w->size, src, n);
+  w->size += n;
+}
+
+static void FbPut(FbWriter *w, uint64_t value, size_t n) {
+  uint8_t bytes[sizeof(value)];
+  for (size_t i = 0; i < n; ++i) bytes[i] = (uint8_t)(value >> (8 * i));
+  FbPutBytes(w, bytes, n);
+}
+
+/* Pads with zeros until |offset| bytes further is aligned on |align| */
+static void FbAlign(FbWriter *w, size_t align, size_t offset) {
+  while (!w->overflow && (w->size + offset) % align != 0) FbPut(w, 0, 1);
+}
+
+/* Points the uoffset_t written at |field| to the current position */
+static void FbPatch(FbWriter *w, size_t field) {
+  if (w->overflow) return;
+  uint32_t offset = w->size - field;
+  for (size_t i = 0; i < sizeof(offset); ++i) {
+    w->data[field + i] = (uint8_t)(offset >> (8 * i));
+  }
+}
+
+static void FbPutString(FbWriter *w, size_t field, const char *str) {
+  size_t len = strlen(str);
+  FbAlign(w, 4, 0);
+  FbPatch(w, field);
+  FbPut(w, len, 4);
+  FbPutBytes(w, str, len + 1);
+}
+
+/* Inline layout of the MetadataEnvelope table: soffset_t, then fields */
+#define ENVELOPE_MODEL_ID 4
+#define ENVELOPE_DEVICE_ID 8
+#define ENVELOPE_INFERENCES 12
+#define ENVELOPE_IMAGE 16
+#define ENVELOPE_SIZE 17
+
+/* Inline layout of the Inference table, timestamp aligned on 8 */
+#define INFERENCE_TIMESTAMP 4
+#define INFERENCE_OUTPUT 12
+#define INFERENCE_FORMAT 16
+#define INFERENCE_SIZE 17
+
+size_t ProcessFormatMetaBinarySize(const ProcessFormatMetaHeader *header,
+                                   const ProcessFormatInference *inferences,
+                                   uint32_t num_inferences) {
+  // Root offset, identifier, vtables and root table, padding included
+  size_t size = 32 + ENVELOPE_SIZE;
+  // Strings: padding, length and null terminator
+  size += 2 * (3 + 4 + 1) + strlen(header->model_id) +
+          strlen(header->device_id);
+  size += 3 + 4 + 4 * num_inferences;
+  for (uint32_t i = 0; i < num_inferences; ++i) {
+    size += 7 + INFERENCE_SIZE + 7 + 4 + inferences[i].size;
+  }
+  return size;
+}
+
+ProcessFormatResult ProcessFormatMetaBinary(
+    const ProcessFormatMetaHeader *header,
+    const ProcessFormatInference *inferences, uint32_t num_inferences,
+    uint8_t *buffer, size_t buffer_size, size_t *size) {
+  if (header == NULL || buffer == NULL || size == NULL ||
+      (inferences == NULL && num_inferences > 0)) {
+    LOG_ERR("Invalid input arguments.");
+    return kProcessFormatResultInvalidParam;
+  }
+  for (uint32_t i = 0; i < num_inferences; ++i) {
+    const ProcessFormatInference *inference = &inferences[i];
+    if ((inference->data == NULL && inference->size > 0) ||
+        (inference->datatype != EdgeAppLibSendDataBase64 &&
+         inference->datatype != EdgeAppLibSendDataJson)) {
+      LOG_ERR("Invalid inference %u: datatype %d", i, inference->datatype);
+      return kProcessFormatResultInvalidParam;
+    }
+  }
+
+  FbWriter w = {buffer, 0, buffer_size, false};
+  FbPut(&w, 0, 4);
+  FbPutBytes(&w, META_BINARY_IDENTIFIER, 4);
+
+  // vtables: their size, the table size, then the offset of each field
+  size_t envelope_vtable = w.size;
+  const uint16_t envelope_fields[] = {4 + 2 * 4,          ENVELOPE_SIZE,
+                                      ENVELOPE_MODEL_ID,  ENVELOPE_DEVICE_ID,
+                                      ENVELOPE_IMAGE,     ENVELOPE_INFERENCES};
+  for (uint16_t field : envelope_fields) FbPut(&w, field, 2);
+  size_t inference_vtable = w.size;
+  const uint16_t inference_fields[] = {4 + 2 * 3, INFERENCE_SIZE,
+                                       INFERENCE_TIMESTAMP, INFERENCE_OUTPUT,
+                                       INFERENCE_FORMAT};
+  for (uint16_t field : inference_fields) FbPut(&w, field, 2);
+
+  FbAlign(&w, 4, 0);
+  FbPatch(&w, 0);
+  size_t envelope = w.size;
+  FbPut(&w, envelope - envelope_vtable, 4);
+  FbPut(&w, 0, 4);
+  FbPut(&w, 0, 4);
+  FbPut(&w, 0, 4);
+  FbPut(&w, header->image, 1);
+  FbPutString(&w, envelope + ENVELOPE_MODEL_ID, header->model_id);
+  FbPutString(&w, envelope + ENVELOPE_DEVICE_ID, header->device_id);
+
+  FbAlign(&w, 4, 0);
+  FbPatch(&w, envelope + ENVELOPE_INFERENCES);
+  FbPut(&w, num_inferences, 4);
+  size_t vector = w.size;
+  for (uint32_t i = 0; i < num_inferences; ++i) FbPut(&w, 0, 4);
+
+  for (uint32_t i = 0; i < num_inferences; ++i) {
+    const ProcessFormatInference *inference = &inferences[i];
+    FbAlign(&w, 8, INFERENCE_TIMESTAMP);
+    FbPatch(&w, vector + 4 * i);
+    size_t table = w.size;
+    FbPut(&w, table - inference_vtable, 4);
+    // "T" has a millisecond resolution
+    FbPut(&w, inference->timestamp / 1000000, 8);
+    FbPut(&w, 0, 4);
+    FbPut(&w, inference->datatype == EdgeAppLibSendDataJson ? 1 : 0, 1);
+
+    // Output aligned on 8, to be read in place as a flatbuffer
+    FbAlign(&w, 8, 4);
+    FbPatch(&w, table + INFERENCE_OUTPUT);
+    FbPut(&w, inference->size, 4);
+    FbPutBytes(&w, inference->data, inference->size);
+  }
+
+  if (w.overflow) {
+    LOG_ERR("Buffer overflow when writing binary metadata.");
+    return kProcessFormatResultMemoryError;
+  }
+  *size = w.size;
+  return kProcessFormatResultOk;
+}
+
+/* Port settings and codec settings keys of each port */
+static const char *const s_port_keys[kProcessFormatPortNum] = {
+    "metadata", "input_tensor"};
+static const char *const s_compression_keys[kProcessFormatPortNum] = {
+    "metadata_compression", "input_tensor_compression"};
+
+/* Updated by the sync senders and the async send thread */
+static ProcessFormatCompressionStats s_compression_stats[kProcessFormatPortNum];
+static pthread_mutex_t s_compression_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+ProcessFormatCompression ProcessFormatGetCompression(ProcessFormatPort port) {
+  if (port >= kProcessFormatPortNum) return kProcessFormatCompressionNone;
+  JSON_Object *codec_settings = getCodecSettings();
+  int compression =
+      codec_settings ? (int)json_object_get_number(codec_settings,
+                                                   s_compression_keys[port])
+                     : COMPRESSION_NONE;
+  if (compression != COMPRESSION_LZ4 && compression != COMPRESSION_LZ4_AUTO) {
+    return kProcessFormatCompressionNone;
+  }
+  JSON_Object *object = getPortSettings();
+  JSON_Object *port_setting =
+      object ? json_object_get_object(object, s_port_keys[port]) : NULL;
+  // Telemetry values are JSON
+  if (port_setting == NULL ||
+      (int)json_object_get_number(port_setting, "method") == METHOD_MQTT) {
+    LOG_DBG("Compression not supported with MQTT: sending as is.");
+    return kProcessFormatCompressionNone;
+  }
+  return compression == COMPRESSION_LZ4 ? kProcessFormatCompressionLz4
+                                        : kProcessFormatCompressionLz4Auto;
+}
+
+ProcessFormatResult ProcessFormatCompress(ProcessFormatPort port,
+                                          ProcessFormatCompression compression,
+                                          const void *in_data, uint32_t in_size,
+                                          void **out_data, uint32_t *out_size) {
+  if (port >= kProcessFormatPortNum || out_data == NULL || out_size == NULL ||
+      (in_data == NULL && in_size > 0)) {
+    LOG_ERR("Invalid input arguments.");
+    return kProcessFormatResultInvalidParam;
+  }
+  *out_data = NULL;
+  *out_size = 0;
+  if (compression == kProcessFormatCompressionNone) {
+    return kProcessFormatResultOk;
+  }
+
+  // In auto mode, the compressor gives up as soon as the frame gets too big
+  size_t capacity = compression == kProcessFormatCompressionLz4Auto
+                        ? in_size - in_size / 8
+                        : LZ4_COMPRESS_BOUND(in_size);
+  Lz4Compressor *compressor = (Lz4Compressor *)malloc(sizeof(Lz4Compressor));
+  void *frame = malloc(capacity > 0 ? capacity : 1);
+  if (compressor == NULL || frame == NULL) {
+    LOG_ERR("Memory allocation failed.");
+    free(compressor);
+    free(frame);
+    return kProcessFormatResultMemoryError;
+  }
+  size_t size = lz4_compress(compressor, in_data, in_size, frame, capacity);
+  free(compressor);
+
+  pthread_mutex_lock(&s_compression_mutex);
+  ProcessFormatCompressionStats *stats = &s_compression_stats[port];
+  stats->in_bytes += in_size;
+  if (size == 0) {
+    stats->skipped++;
+    stats->out_bytes += in_size;
+  } else {
+    stats->compressed++;
+    stats->out_bytes += size;
+  }
+  pthread_mutex_unlock(&s_compression_mutex);
+
+  if (size == 0) {
+    LOG_DBG("Compression of %u bytes does not pay: sending as is.", in_size);
+    free(frame);
+    return kProcessFormatResultOk;
+  }
+  LOG_DBG("Compressed %u bytes to %zu.", in_size, size);
+  *out_data = frame;
+  *out_size = (uint32_t)size;
+  return kProcessFormatResultOk;
+}
+
+void ProcessFormatGetCompressionStats(ProcessFormatPort port,
+                                      ProcessFormatCompressionStats *stats) {
+  if (port >= kProcessFormatPortNum || stats == NULL) return;
+  pthread_mutex_lock(&s_compression_mutex);
+  *stats = s_compression_stats[port];
+  pthread_mutex_unlock(&s_compression_mutex);
+}
+
+void ProcessFormatResetCompressionStats(void) {
+  pthread_mutex_lock(&s_compression_mutex);
+  memset(s_compression_stats, 0, sizeof(s_compression_stats));
+  pthread_mutex_unlock(&s_compression_mutex);
+}
@@ -27,6 +27,10 @@
 #include "memory_manager.hpp"
 #include "parson.h"
 #include "send_data_types.h"
+#include "sensor.h"
+
+/* Size of the device ID, as WASM_BINDING_DEVICEID_MAX_SIZE */
+#define PROCESS_FORMAT_DEVICE_ID_SIZE (41)
 
 typedef enum {
   kProcessFormatResultOk,           /**< Operation succeeded. */
@@ -43,6 +47,54 @@ typedef enum {
   kProcessFormatImageTypeOther /**< Image type is other. (not implemented) */
 } ProcessFormatImageType;
 
+typedef enum {
+  kProcessFormatMetaJson,  /**< JSON envelope, output tensors in base64. */
+  kProcessFormatMetaBinary /**< FlatBuffers envelope, metadata_envelope.fbs */
+} ProcessFormatMetaFormat;
+
+typedef enum {
+  kProcessFormatCompressionNone,   /**< Data sent as is. */
+  kProcessFormatCompressionLz4,    /**< LZ4 frame. */
+  kProcessFormatCompressionLz4Auto /**< LZ4 frame, if it saves 1/8 or more. */
+} ProcessFormatCompression;
+
+typedef enum {
+  kProcessFormatPortMetadata,    /**< "metadata" port. */
+  kProcessFormatPortInputTensor, /**< "input_tensor" port. */
+  kProcessFormatPortNum
+} ProcessFormatPort;
+
+/**
+ * @brief Counters of the compression stage of a port. The ratio is
+ * out_bytes / in_bytes.
+ */
+typedef struct {
+  uint64_t compressed; /**< Buffers sent compressed. */
+  uint64_t skipped;    /**< Buffers sent as is, as compression did not pay. */
+  uint64_t in_bytes;   /**< Size of the buffers before the stage. */
+  uint64_t out_bytes;  /**< Size of the buffers after the stage. */
+} ProcessFormatCompressionStats;
+
+/**
+ * @brief Header of the metadata envelope, common to the inferences of a
+ * message.
+ */
+typedef struct {
+  char model_id[AITRIOS_SENSOR_INFO_STRING_LENGTH + 1];
+  char device_id[PROCESS_FORMAT_DEVICE_ID_SIZE + 1];
+  bool image;
+} ProcessFormatMetaHeader;
+
+/**
+ * @brief Inference of a binary metadata envelope.
+ */
+typedef struct {
+  const void *data; /**< Output tensor, or JSON string. */
+  uint32_t size;
+  EdgeAppLibSendDataType datatype;
+  uint64_t timestamp; /**< In nanoseconds. */
+} ProcessFormatInference;
+
 /**
  * @brief Format the data to be Output Tensor
  * @param in_data Pointer of output tensor buffer.
@@ -58,6 +110,47 @@ ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
                                       uint64_t timestamp, char *json_buffer,
                                       size_t buffer_size);
 
+/**
+ * @brief Get the metadata envelope format set in the metadata port settings.
+ * @details The binary envelope can only be uploaded to a storage: with MQTT
+ * telemetry, the JSON envelope is used.
+ * @return Format of the metadata envelope.
+ */
+ProcessFormatMetaFormat ProcessFormatGetMetaFormat(void);
+
+/**
+ * @brief Get the header of the metadata envelope.
+ * @param header Pointer of the header to fill.
+ * @return Result of the operation.
+ */
+ProcessFormatResult ProcessFormatGetMetaHeader(ProcessFormatMetaHeader *header);
+
+/**
+ * @brief Get the buffer size needed by ProcessFormatMetaBinary.
+ * @param header Pointer of the header of the envelope.
+ * @param inferences Inferences of the envelope.
+ * @param num_inferences Number of inferences.
+ * @return Upper bound of the size of the envelope.
+ */
+size_t ProcessFormatMetaBinarySize(const ProcessFormatMetaHeader *header,
+                                   const ProcessFormatInference *inferences,
+                                   uint32_t num_inferences);
+
+/**
+ * @brief Serialize inferences in a binary metadata envelope.
+ * @param header Pointer of the header of the envelope.
+ * @param inferences Inferences of the envelope.
+ * @param num_inferences Number of inferences.
+ * @param buffer Pointer of output buffer.
+ * @param buffer_size Size of output buffer.
+ * @param size Pointer to store the size of the envelope.
+ * @return Result of the formating operation for meta data.
+ */
+ProcessFormatResult ProcessFormatMetaBinary(
+    const ProcessFormatMetaHeader *header,
+    const ProcessFormatInference *inferences, uint32_t num_inferences,
+    uint8_t *buffer, size_t buffer_size, size_t *size);
+
 /**
  * @brief Encode the data to be Input Tensor
  * @param in_data Pointer or handle for input tensor buffer.
@@ -75,4 +168,60 @@ ProcessFormatResult ProcessFormatInput(MemoryRef in_data, uint32_t in_size,
                                        uint64_t timestamp, void **image,
                                        int32_t *image_size);
 
+/**
+ * @brief Encode the data to be Input Tensor as ProcessFormatInput does, in a
+ * buffer reused from call to call
+ * @param in_data Pointer or handle for input tensor buffer.
+ * @param in_size Size of input tensor buffer.
+ * @param datatype The type of the data to upload.
+ * @param image_property Pointer to the image property structure.
+ * @param buffer Pointer of the output buffer, NULL at first. Replaced by a
+ * larger one when too small. Owned by the caller, even on failure.
+ * @param capacity Pointer of the size of the output buffer.
+ * @param image_size Size of encoded input tensor.
+ * @return Result of the formating operation for image data.
+ */
+ProcessFormatResult ProcessFormatInputToBuffer(
+    MemoryRef in_data, uint32_t in_size, ProcessFormatImageType datatype,
+    EdgeAppLibImageProperty *image_property, void **buffer, size_t *capacity,
+    int32_t *image_size);
+
+/**
+ * @brief Get the compression of a port set in the codec settings.
+ * @details Only uploads to a storage are compressed: with MQTT telemetry,
+ * data is sent as is.
+ * @param port Port of the data.
+ * @return Compression of the port.
+ */
+ProcessFormatCompression ProcessFormatGetCompression(ProcessFormatPort port);
+
+/**
+ * @brief Compress the data of a port, and count it in the port statistics.
+ * @param port Port of the data.
+ * @param compression Compression to apply.
+ * @param in_data Pointer of data buffer.
+ * @param in_size Size of data buffer.
+ * @param out_data Pointer to store the allocated LZ4 frame, to be released
+ * with free(). Set to NULL when the data is to be sent as is.
+ * @param out_size Pointer to store the size of the LZ4 frame.
+ * @return Result of the compression.
+ */
+ProcessFormatResult ProcessFormatCompress(ProcessFormatPort port,
+                                          ProcessFormatCompression compression,
+                                          const void *in_data, uint32_t in_size,
+                                          void **out_data, uint32_t *out_size);
+
+/**
+ * @brief Get the compression statistics of a port.
+ * @param port Port of the statistics.
+ * @param stats Pointer of the statistics to fill.
+ */
+void ProcessFormatGetCompressionStats(ProcessFormatPort port,
+                                      ProcessFormatCompressionStats *stats);
+
+/**
+ * @brief Reset the compression statistics of every port.
+ */
+void ProcessFormatResetCompressionStats(void);
+
 #endif /* PROCESS_FORMAT_H */
@@ -18,8 +18,12 @@
 
 #include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
 
+#include "base64_codec.h"
 #include "data_export.h"
+#include "data_export_private.h"
 #include "log.h"
 #include "process_format.hpp"
 #include "send_data_private.h"
@@ -32,8 +36,16 @@ namespace EdgeAppLib {
 extern "C" {
 #endif
 
-static InfElem output_tensor_vec[MAX_NUMBER_OF_INFERENCE_QUEUE] = {
-    {nullptr, nullptr}};
+#define INFERENCES_KEY "\"Inferences\":["
+#define INFERENCES_END "]}"
+
+/* At most one message per header of each format */
+#define MAX_NUMBER_OF_BATCH_MESSAGES (2 * MAX_NUMBER_OF_INFERENCE_QUEUE)
+
+static InfBatch inf_batches[MAX_NUMBER_OF_INFERENCE_QUEUE] = {};
+static InfBinaryBatch inf_binary_batches[MAX_NUMBER_OF_INFERENCE_QUEUE] = {};
+/* Inferences in inf_batches and inf_binary_batches */
+static uint32_t inf_cnt = 0;
 
 static pthread_mutex_t inf_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -108,21 +120,27 @@ EdgeAppLibSendDataResult SendDataSyncImage(
     return EdgeAppLibSendDataResultFailure;
 }
 
-EdgeAppLibSendDataResult SendDataSyncMeta(void *data, int datalen,
-                                          EdgeAppLibSendDataType datatype,
-                                          uint64_t timestamp, int timeout_ms) {
-  LOG_TRACE("Entering SendDataSyncMeta");
-
-  if (data == nullptr) {
-    const char *error_msg = "Invalid data param";
-    LOG_ERR("%s", error_msg);
-    return EdgeAppLibSendDataResultInvalidParam;
-  }
+/* Terminates the "Inferences" array of |batch| and hands over its buffer */
+static char *InfBatchTake(InfBatch *batch, size_t *size) {
+  char *buffer = batch->buffer;
+  memcpy(buffer + batch->size, INFERENCES_END, sizeof(INFERENCES_END));
+  *size = batch->size + strlen(INFERENCES_END);
+  *batch = {};
+  return buffer;
+}
 
+/**
+ * @brief Formats one inference as ProcessFormatMeta does, in a buffer
+ * allocated for it
+ */
+static EdgeAppLibSendDataResult FormatMetaJson(void *data, int datalen,
+                                               EdgeAppLibSendDataType datatype,
+                                               uint64_t timestamp,
+                                               char **json) {
   // Calculate the size of the Base64 encoded data
-  int base64_size = ((datalen + 2) / 3) * 4;  // For Base64 encoding
-  int json_overhead = 256;                    // For JSON formatting
-  int extra_padding = 0;                      // For extra padding
+  size_t base64_size = BASE64_ENCODED_SIZE((size_t)datalen);
+  int json_overhead = 256;  // For JSON formatting
+  int extra_padding = 0;    // For extra padding
 
   size_t buffer_size = base64_size + json_overhead + extra_padding;
 
@@ -142,121 +160,767 @@ EdgeAppLibSendDataResult SendDataSyncMeta(void *data, int datalen,
     free(json_buffer);
     return EdgeAppLibSendDataResultFailure;
   }
+  *json = json_buffer;
+  return EdgeAppLibSendDataResultSuccess;
+}
+
+/**
+ * @brief Formats inferences of one header in a binary envelope, in a buffer
+ * allocated for it
+ */
+static EdgeAppLibSendDataResult FormatMetaBinary(
+    const ProcessFormatMetaHeader *header,
+    const ProcessFormatInference *inferences, uint32_t num_inferences,
+    char **buffer, size_t *size) {
+  size_t buffer_size =
+      ProcessFormatMetaBinarySize(header, inferences, num_inferences);
+  uint8_t *binary = (uint8_t *)malloc(buffer_size);
+  if (!binary) {
+    LOG_ERR("Failed to allocate memory for binary metadata");
+    return EdgeAppLibSendDataResultDataTooLarge;
+  }
+  ProcessFormatResult process_format_ret = ProcessFormatMetaBinary(
+      header, inferences, num_inferences, binary, buffer_size, size);
+  if (process_format_ret != kProcessFormatResultOk) {
+    LOG_ERR("ProcessFormatMetaBinary failed. Exit with return %d.",
+            process_format_ret);
+    free(binary);
+    return EdgeAppLibSendDataResultFailure;
+  }
+  *buffer = (char *)binary;
+  return EdgeAppLibSendDataResultSuccess;
+}
+
+/**
+ * @brief Formats one inference in a message of its own, in the format of the
+ * metadata port settings
+ */
+static EdgeAppLibSendDataResult FormatMeta(void *data, int datalen,
+                                           EdgeAppLibSendDataType datatype,
+                                           uint64_t timestamp, char **buffer,
+                                           size_t *size) {
+  if (data == nullptr) {
+    const char *error_msg = "Invalid data param";
+    LOG_ERR("%s", error_msg);
+    return EdgeAppLibSendDataResultInvalidParam;
+  }
+
+  if (ProcessFormatGetMetaFormat() == kProcessFormatMetaBinary) {
+    ProcessFormatMetaHeader header = {};
+    if (ProcessFormatGetMetaHeader(&header) != kProcessFormatResultOk) {
+      LOG_ERR("ProcessFormatGetMetaHeader failed.");
+      return EdgeAppLibSendDataResultFailure;
+    }
+    ProcessFormatInference inference = {data, (uint32_t)datalen, datatype,
+                                        timestamp};
+    return FormatMetaBinary(&header, &inference, 1, buffer, size);
+  }
+
+  EdgeAppLibSendDataResult ret =
+      FormatMetaJson(data, datalen, datatype, timestamp, buffer);
+  if (ret == EdgeAppLibSendDataResultSuccess) *size = strlen(*buffer);
+  return ret;
+}
+
+static bool SameMetaHeader(const ProcessFormatMetaHeader *a,
+                           const ProcessFormatMetaHeader *b) {
+  return a->image == b->image && strcmp(a->model_id, b->model_id) == 0 &&
+         strcmp(a->device_id, b->device_id) == 0;
+}
+
+/**
+ * @brief Appends an inference to the binary batch of its header, copying its
+ * output tensor. Assumption: inf_mutex is locked.
+ */
+static EdgeAppLibSendDataResult InfBinaryBatchAppend(
+    void *data, int datalen, EdgeAppLibSendDataType datatype,
+    uint64_t timestamp) {
+  if (datatype != EdgeAppLibSendDataBase64 &&
+      datatype != EdgeAppLibSendDataJson) {
+    LOG_ERR("Invalid datatype: %d", datatype);
+    return EdgeAppLibSendDataResultInvalidParam;
+  }
+  ProcessFormatMetaHeader header = {};
+  if (ProcessFormatGetMetaHeader(&header) != kProcessFormatResultOk) {
+    LOG_ERR("ProcessFormatGetMetaHeader failed.");
+    return EdgeAppLibSendDataResultFailure;
+  }
+
+  for (int i = 0; i < MAX_NUMBER_OF_INFERENCE_QUEUE; ++i) {
+    InfBinaryBatch *batch = &inf_binary_batches[i];
+    if (batch->num > 0 && !SameMetaHeader(&batch->header, &header)) continue;
+    if (batch->num == batch->capacity) {
+      uint32_t capacity = batch->capacity ? batch->capacity * 2 : 4;
+      ProcessFormatInference *inferences = (ProcessFormatInference *)realloc(
+          batch->inferences, capacity * sizeof(ProcessFormatInference));
+      if (inferences == nullptr) {
+        LOG_ERR("Failed to allocate memory for inference batch");
+        return EdgeAppLibSendDataResultDataTooLarge;
+      }
+      batch->inferences = inferences;
+      batch->capacity = capacity;
+    }
+    void *copy = malloc(datalen > 0 ? datalen : 1);
+    if (copy == nullptr) {
+      LOG_ERR("Failed to allocate memory for inference batch");
+      return EdgeAppLibSendDataResultDataTooLarge;
+    }
+    memcpy(copy, data, datalen);
+    if (batch->num == 0) {
+      batch->header = header;
+      batch->timestamp = timestamp;
+    } else if (timestamp < batch->timestamp) {
+      batch->timestamp = timestamp;
+    }
+    batch->inferences[batch->num++] = {copy, (uint32_t)datalen, datatype,
+                                       timestamp};
+    inf_cnt++;
+    return EdgeAppLibSendDataResultSuccess;
+  }
+  return EdgeAppLibSendDataResultDataTooLarge;
+}
+
+/* Formats the binary envelope of |batch| and releases the batch */
+static EdgeAppLibSendDataResult InfBinaryBatchTake(InfBinaryBatch *batch,
+                                                   char **buffer,
+                                                   size_t *size) {
+  EdgeAppLibSendDataResult ret = FormatMetaBinary(
+      &batch->header, batch->inferences, batch->num, buffer, size);
+  for (uint32_t i = 0; i < batch->num; ++i) {
+    free((void *)batch->inferences[i].data);
+  }
+  free(batch->inferences);
+  *batch = {};
+  return ret;
+}
+
+/**
+ * @brief Takes the batched inferences as messages, one per header.
+ * Assumption: inf_mutex is locked.
+ * @param msgs Messages, MAX_NUMBER_OF_BATCH_MESSAGES of them
+ * @param result Failure if a message could not be formatted
+ * @return Number of messages
+ */
+static int InfBatchTakeAll(SendDataAsyncMsg *msgs,
+                           EdgeAppLibSendDataResult *result) {
+  int num_msgs = 0;
+  *result = EdgeAppLibSendDataResultSuccess;
+  for (int i = 0; i < MAX_NUMBER_OF_INFERENCE_QUEUE; ++i) {
+    if (inf_batches[i].buffer == nullptr) break;
+    SendDataAsyncMsg *msg = &msgs[num_msgs++];
+    *msg = {};
+    msg->timestamp = inf_batches[i].timestamp;
+    msg->buffer = InfBatchTake(&inf_batches[i], &msg->size);
+  }
+  for (int i = 0; i < MAX_NUMBER_OF_INFERENCE_QUEUE; ++i) {
+    if (inf_binary_batches[i].num == 0) break;
+    SendDataAsyncMsg *msg = &msgs[num_msgs];
+    *msg = {};
+    msg->timestamp = inf_binary_batches[i].timestamp;
+    if (InfBinaryBatchTake(&inf_binary_batches[i], &msg->buffer,
+                           &msg->size) != EdgeAppLibSendDataResultSuccess) {
+      *result = EdgeAppLibSendDataResultFailure;
+      continue;
+    }
+    num_msgs++;
+  }
+  inf_cnt = 0;
+  return num_msgs;
+}
+
+/**
+ * @brief Appends an inference to its batch. Assumption: inf_mutex is locked.
+ * @return true if the batches are due to be sent
+ */
+static bool BatchInference(void *data, int datalen,
+                           EdgeAppLibSendDataType datatype, uint64_t timestamp,
+                           EdgeAppLibSendDataResult *result) {
+  if (data == nullptr) {
+    const char *error_msg = "Invalid data param";
+    LOG_ERR("%s", error_msg);
+    *result = EdgeAppLibSendDataResultInvalidParam;
+    return false;
+  }
+
+  if (ProcessFormatGetMetaFormat() == kProcessFormatMetaBinary) {
+    *result = InfBinaryBatchAppend(data, datalen, datatype, timestamp);
+    if (*result != EdgeAppLibSendDataResultSuccess) {
+      LOG_ERR("InfBinaryBatchAppend failed");
+      return false;
+    }
+  } else {
+    char *json = nullptr;
+    *result = FormatMetaJson(data, datalen, datatype, timestamp, &json);
+    if (*result != EdgeAppLibSendDataResultSuccess) return false;
+    *result = SendDataAppendInference(json, timestamp);
+    free(json);
+    if (*result != EdgeAppLibSendDataResultSuccess) {
+      LOG_ERR("SendDataAppendInference failed");
+      *result = EdgeAppLibSendDataResultFailure;
+      return false;
+    }
+  }
+
+  // Check number_of_inference_per_message and the batching window
+  uint64_t oldest = timestamp;
+  for (int i = 0; i < MAX_NUMBER_OF_INFERENCE_QUEUE; ++i) {
+    if (inf_batches[i].buffer == nullptr) break;
+    if (inf_batches[i].timestamp < oldest) oldest = inf_batches[i].timestamp;
+  }
+  for (int i = 0; i < MAX_NUMBER_OF_INFERENCE_QUEUE; ++i) {
+    if (inf_binary_batches[i].num == 0) break;
+    if (inf_binary_batches[i].timestamp < oldest) {
+      oldest = inf_binary_batches[i].timestamp;
+    }
+  }
+  *result = EdgeAppLibSendDataResultEnqueued;
+  return inf_cnt >= getNumOfInfPerMsg() ||
+         timestamp - oldest >= INFERENCE_BATCH_WINDOW_MS * 1000000ULL;
+}
+
+EdgeAppLibSendDataResult SendDataSyncMeta(void *data, int datalen,
+                                          EdgeAppLibSendDataType datatype,
+                                          uint64_t timestamp, int timeout_ms) {
+  LOG_TRACE("Entering SendDataSyncMeta");
 
   // Keep simple for Single Inference case
-  // TODO : Refactor for multiple inferences
   if (getNumOfInfPerMsg() == 1) {
+    char *buffer = nullptr;
+    size_t size = 0;
+    EdgeAppLibSendDataResult format_ret =
+        FormatMeta(data, datalen, datatype, timestamp, &buffer, &size);
+    if (format_ret != EdgeAppLibSendDataResultSuccess) return format_ret;
+
     EdgeAppLibDataExportFuture *future =
         DataExportSendData((char *)PORTNAME_META, EdgeAppLibDataExportMetadata,
-                           json_buffer, strlen(json_buffer), timestamp);
+                           buffer, size, timestamp);
     EdgeAppLibDataExportResult send_ret = DataExportAwait(future, timeout_ms);
     DataExportCleanup(future);
-    free(json_buffer);
-    pthread_mutex_unlock(&inf_mutex);
+    free(buffer);
 
     if (send_ret == EdgeAppLibDataExportResultSuccess)
       return EdgeAppLibSendDataResultSuccess;
     else
       return EdgeAppLibSendDataResultFailure;
   }
-  // Append one inference to Output Tensor
-  JSON_Value *output_tensor_value = json_parse_string((char *)json_buffer);
-  free(json_buffer);
-  JSON_Object *output_tensor_object =
-      json_value_get_object(output_tensor_value);
-  const char *model_id =
-      json_object_get_string(output_tensor_object, "ModelID");
-  if (SendDataAppendOutputTensor(model_id, output_tensor_value) !=
-      EdgeAppLibSendDataResultSuccess) {
-    LOG_ERR("SendDataAppendOutputTensor failed");
-    json_value_free(output_tensor_value);
-    return EdgeAppLibSendDataResultFailure;
+  // Append one inference to the batch of its header
+  pthread_mutex_lock(&inf_mutex);
+  EdgeAppLibSendDataResult ret;
+  bool due = BatchInference(data, datalen, datatype, timestamp, &ret);
+  if (due) ret = SendDataFlushInferences(timeout_ms);
+  pthread_mutex_unlock(&inf_mutex);
+  return ret;
+}
+
+/* Messages of SendDataAsyncMeta: async_count of them from async_head, the
+ * first one being handed to EVP while async_busy */
+static SendDataAsyncMsg async_queue[SEND_DATA_ASYNC_MAX_QUEUE_SIZE] = {};
+static uint32_t async_head = 0;
+static uint32_t async_count = 0;
+static bool async_busy = false;
+static uint32_t async_queue_size = SEND_DATA_ASYNC_DEFAULT_QUEUE_SIZE;
+static EdgeAppLibSendDataOverflowPolicy async_policy =
+    EdgeAppLibSendDataOverflowBlock;
+
+static pthread_mutex_t async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t async_cond = PTHREAD_COND_INITIALIZER;
+
+/* Set on the threads running a callback of the application */
+static pthread_key_t async_callback_key;
+static pthread_once_t async_callback_once = PTHREAD_ONCE_INIT;
+
+static void AsyncCallbackKeyCreate() {
+  pthread_key_create(&async_callback_key, nullptr);
+}
+
+/* Whether the calling thread is running a callback of the application */
+static bool AsyncInCallback() {
+  pthread_once(&async_callback_once, AsyncCallbackKeyCreate);
+  return pthread_getspecific(async_callback_key) != nullptr;
+}
+
+/* Calls |callback|, marking the thread as running a callback */
+static void AsyncCallback(EdgeAppLibSendDataCallback callback,
+                          EdgeAppLibSendDataResult result, void *user_data) {
+  if (callback == nullptr) return;
+  bool nested = AsyncInCallback();
+  pthread_setspecific(async_callback_key, (void *)1);
+  callback(result, user_data);
+  if (!nested) pthread_setspecific(async_callback_key, nullptr);
+}
+
+/* Calls |release|, marking the thread as running a callback */
+static void AsyncRelease(EdgeAppLibSendDataReleaseCallback release, void *data,
+                         void *user_data) {
+  if (release == nullptr) return;
+  bool nested = AsyncInCallback();
+  pthread_setspecific(async_callback_key, (void *)1);
+  release(data, user_data);
+  if (!nested) pthread_setspecific(async_callback_key, nullptr);
+}
+
+/* Overflow policy of the calling thread. Uploads complete, and the queues
+ * drain, on the threads running the callbacks, so these threads drop the new
+ * message instead of blocking. Assumption: async_mutex is locked. */
+static EdgeAppLibSendDataOverflowPolicy AsyncOverflowPolicy() {
+  if (async_policy == EdgeAppLibSendDataOverflowBlock && AsyncInCallback()) {
+    LOG_WARN("Queue full in a send callback: dropping instead of blocking");
+    return EdgeAppLibSendDataOverflowDropNewest;
   }
+  return async_policy;
+}
 
-  // Check number_of_inference_per_message
-  static uint32_t inf_cnt = 1;
-  if (inf_cnt < getNumOfInfPerMsg()) {
-    inf_cnt++;
-    return EdgeAppLibSendDataResultEnqueued;
-  } else {
-    // Send Data
-    EdgeAppLibSendDataResult send_ret = EdgeAppLibSendDataResultSuccess;
-    pthread_mutex_lock(&inf_mutex);
-    for (int i = 0; i < MAX_NUMBER_OF_INFERENCE_QUEUE; ++i) {
-      if (output_tensor_vec[i].key == nullptr) break;
-      // Get smallest timestamp
-      JSON_Object *output_tensor_object_buf =
-          json_value_get_object(output_tensor_vec[i].value);
-      JSON_Array *infs_json_array =
-          json_object_get_array(output_tensor_object_buf, "Inferences");
-      JSON_Object *first_inf = json_array_get_object(infs_json_array, 0);
-      const char *smallest_timestamp_str =
-          json_object_get_string(first_inf, "T");
-      uint64_t samllest_timestamp =
-          SendDataConvertTimeToNanoseconds(smallest_timestamp_str);
-      char *send_buffer = json_serialize_to_string(output_tensor_vec[i].value);
-      // Send Data
-      EdgeAppLibDataExportFuture *future = DataExportSendData(
-          (char *)PORTNAME_META, EdgeAppLibDataExportMetadata, send_buffer,
-          strlen(send_buffer), samllest_timestamp);
-      EdgeAppLibDataExportResult ret = DataExportAwait(future, timeout_ms);
-
-      if (ret != EdgeAppLibDataExportResultSuccess) {
-        send_ret = EdgeAppLibSendDataResultFailure;
-      }
-      DataExportCleanup(future);
-      json_free_serialized_string((char *)send_buffer);
-      json_value_free(output_tensor_vec[i].value);
-      output_tensor_vec[i] = (InfElem){.key = nullptr, .value = nullptr};
+static SendDataAsyncMsg *AsyncAt(uint32_t i) {
+  return &async_queue[(async_head + i) % SEND_DATA_ASYNC_MAX_QUEUE_SIZE];
+}
+
+/* Releases a message taken out of the queue. Called without async_mutex. */
+static void AsyncFinish(SendDataAsyncMsg *msg,
+                        EdgeAppLibSendDataResult result) {
+  free(msg->buffer);
+  AsyncCallback(msg->callback, result, msg->user_data);
+}
+
+static void AsyncPump();
+
+static void AsyncDone(EdgeAppLibDataExportResult result, void *) {
+  pthread_mutex_lock(&async_mutex);
+  SendDataAsyncMsg msg = *AsyncAt(0);
+  *AsyncAt(0) = {};
+  async_head = (async_head + 1) % SEND_DATA_ASYNC_MAX_QUEUE_SIZE;
+  async_count--;
+  async_busy = false;
+  pthread_cond_broadcast(&async_cond);
+  pthread_mutex_unlock(&async_mutex);
+
+  AsyncFinish(&msg, result == EdgeAppLibDataExportResultSuccess
+                        ? EdgeAppLibSendDataResultSuccess
+                        : EdgeAppLibSendDataResultFailure);
+  AsyncPump();
+}
+
+/* Hands the oldest message to EVP unless one is already in flight */
+static void AsyncPump() {
+  pthread_mutex_lock(&async_mutex);
+  if (async_busy || async_count == 0) {
+    pthread_mutex_unlock(&async_mutex);
+    return;
+  }
+  async_busy = true;
+  SendDataAsyncMsg msg = *AsyncAt(0);
+  pthread_mutex_unlock(&async_mutex);
+
+  EdgeAppLibDataExportFuture *future =
+      DataExportSendData((char *)PORTNAME_META, EdgeAppLibDataExportMetadata,
+                         msg.buffer, msg.size, msg.timestamp);
+  if (future == nullptr) {
+    AsyncDone(EdgeAppLibDataExportResultFailure, nullptr);
+    return;
+  }
+  // Completes in the thread processing EVP events, which sends the next one
+  DataExportSetCompletionCallback(future, AsyncDone, nullptr);
+  DataExportCleanup(future);
+}
+
+static EdgeAppLibSendDataResult AsyncEnqueue(const SendDataAsyncMsg *msg) {
+  pthread_mutex_lock(&async_mutex);
+  while (async_count >= async_queue_size) {
+    EdgeAppLibSendDataOverflowPolicy policy = AsyncOverflowPolicy();
+    if (policy == EdgeAppLibSendDataOverflowBlock) {
+      pthread_cond_wait(&async_cond, &async_mutex);
+      continue;
     }
+    // Only the messages not handed to EVP can be dropped
+    uint32_t oldest = async_busy ? 1 : 0;
+    if (policy == EdgeAppLibSendDataOverflowDropNewest ||
+        oldest >= async_count) {
+      pthread_mutex_unlock(&async_mutex);
+      LOG_WARN("Asynchronous queue full: dropping the new message");
+      SendDataAsyncMsg dropped = *msg;
+      AsyncFinish(&dropped, EdgeAppLibSendDataResultDropped);
+      return EdgeAppLibSendDataResultDropped;
+    }
+    SendDataAsyncMsg dropped = *AsyncAt(oldest);
+    for (uint32_t i = oldest; i + 1 < async_count; ++i) {
+      *AsyncAt(i) = *AsyncAt(i + 1);
+    }
+    async_count--;
+    *AsyncAt(async_count) = {};
+    pthread_mutex_unlock(&async_mutex);
+    LOG_WARN("Asynchronous queue full: dropping the oldest message");
+    AsyncFinish(&dropped, EdgeAppLibSendDataResultDropped);
+    pthread_mutex_lock(&async_mutex);
+  }
+  *AsyncAt(async_count) = *msg;
+  async_count++;
+  pthread_mutex_unlock(&async_mutex);
+
+  AsyncPump();
+  return EdgeAppLibSendDataResultEnqueued;
+}
+
+EdgeAppLibSendDataResult SendDataAsyncMeta(void *data, int datalen,
+                                           EdgeAppLibSendDataType datatype,
+                                           uint64_t timestamp,
+                                           EdgeAppLibSendDataCallback callback,
+                                           void *user_data) {
+  LOG_TRACE("Entering SendDataAsyncMeta");
+
+  if (getNumOfInfPerMsg() == 1) {
+    SendDataAsyncMsg msg = {nullptr, 0, timestamp, callback, user_data};
+    EdgeAppLibSendDataResult format_ret =
+        FormatMeta(data, datalen, datatype, timestamp, &msg.buffer, &msg.size);
+    if (format_ret != EdgeAppLibSendDataResultSuccess) return format_ret;
+    return AsyncEnqueue(&msg);
+  }
+
+  pthread_mutex_lock(&inf_mutex);
+  EdgeAppLibSendDataResult ret;
+  bool due = BatchInference(data, datalen, datatype, timestamp, &ret);
+  if (!due) {
     pthread_mutex_unlock(&inf_mutex);
+    return ret;
+  }
+  // Queue one message per header, the last one reporting to callback
+  SendDataAsyncMsg msgs[MAX_NUMBER_OF_BATCH_MESSAGES];
+  int num_msgs = InfBatchTakeAll(msgs, &ret);
+  pthread_mutex_unlock(&inf_mutex);
+  if (num_msgs == 0) return ret;
 
-    inf_cnt = 1;
-    return send_ret;
+  msgs[num_msgs - 1].callback = callback;
+  msgs[num_msgs - 1].user_data = user_data;
+  for (int i = 0; i < num_msgs; ++i) {
+    EdgeAppLibSendDataResult enqueue_ret = AsyncEnqueue(&msgs[i]);
+    if (i == num_msgs - 1) ret = enqueue_ret;
   }
+  return ret;
 }
 
-EdgeAppLibSendDataResult SendDataAppendOutputTensor(const char *key,
-                                                    JSON_Value *value) {
-  pthread_mutex_lock(&inf_mutex);
-  bool is_set = false;
+/* Images of SendDataAsyncImage: image_count of them from image_head, the
+ * first one being encoded while image_busy. Guarded by async_mutex. */
+static SendDataImageJob image_queue[SEND_DATA_ASYNC_IMAGE_QUEUE_SIZE] = {};
+static uint32_t image_head = 0;
+static uint32_t image_count = 0;
+static bool image_busy = false;
+static bool image_worker_started = false;
+static pthread_t image_worker;
+static SendDataImageBuffer image_pool[SEND_DATA_ASYNC_IMAGE_POOL_SIZE] = {};
+
+static SendDataImageJob *ImageAt(uint32_t i) {
+  return &image_queue[(image_head + i) % SEND_DATA_ASYNC_IMAGE_QUEUE_SIZE];
+}
+
+/* Ends an image which is not sent. Called without async_mutex. */
+static void ImageFinish(SendDataImageJob *job,
+                        EdgeAppLibSendDataResult result) {
+  AsyncRelease(job->release, job->data, job->user_data);
+  AsyncCallback(job->callback, result, job->user_data);
+  DataExportEndPendingOperation();
+}
+
+/* An output buffer not in use, or nullptr. Assumption: async_mutex is
+ * locked. */
+static SendDataImageBuffer *ImageFreeBuffer() {
+  for (int i = 0; i < SEND_DATA_ASYNC_IMAGE_POOL_SIZE; ++i) {
+    if (!image_pool[i].in_use) return &image_pool[i];
+  }
+  return nullptr;
+}
+
+/* Reports the result of the image of |slot| and returns |slot| to the pool.
+ * Called without async_mutex. */
+static void ImageReleaseBuffer(SendDataImageBuffer *slot,
+                               EdgeAppLibSendDataResult result) {
+  EdgeAppLibSendDataCallback callback = slot->callback;
+  void *user_data = slot->user_data;
+  AsyncCallback(callback, result, user_data);
+
+  pthread_mutex_lock(&async_mutex);
+  slot->in_use = false;
+  slot->callback = nullptr;
+  slot->user_data = nullptr;
+  pthread_cond_broadcast(&async_cond);
+  pthread_mutex_unlock(&async_mutex);
+}
+
+static void ImageUploaded(EdgeAppLibDataExportResult result, void *slot) {
+  ImageReleaseBuffer((SendDataImageBuffer *)slot,
+                     result == EdgeAppLibDataExportResultSuccess
+                         ? EdgeAppLibSendDataResultSuccess
+                         : EdgeAppLibSendDataResultFailure);
+}
+
+/**
+ * @brief Encodes an image in |slot| and hands it to EVP. The raw image is
+ * released once encoded.
+ * @return true if handed to EVP, the upload completing in ImageUploaded
+ */
+static bool ImageEncodeAndSend(SendDataImageJob *job,
+                               SendDataImageBuffer *slot) {
+  MemoryRef in_data = {};
+  in_data.type = MEMORY_MANAGER_MAP_TYPE;
+  in_data.u.p = job->data;
+  int32_t size = 0;
+  ProcessFormatResult ret = ProcessFormatInputToBuffer(
+      in_data, job->datalen, job->format, &job->image_property, &slot->buffer,
+      &slot->capacity, &size);
+  AsyncRelease(job->release, job->data, job->user_data);
+  if (ret != kProcessFormatResultOk) {
+    LOG_ERR("ProcessFormatInputToBuffer failed. Exit with return %d.", ret);
+    return false;
+  }
+
+  EdgeAppLibDataExportFuture *future =
+      DataExportSendBorrowedData((char *)PORTNAME_INPUT,
+                                 EdgeAppLibDataExportRaw, slot->buffer, size,
+                                 job->timestamp);
+  if (future == nullptr) return false;
+  // Completes in the thread processing EVP events, freeing the buffer
+  DataExportSetCompletionCallback(future, ImageUploaded, slot);
+  DataExportCleanup(future);
+  return true;
+}
+
+static void *ImageWorker(void *) {
+  pthread_mutex_lock(&async_mutex);
+  for (;;) {
+    while (image_count == 0) pthread_cond_wait(&async_cond, &async_mutex);
+    image_busy = true;
+    // The previous outputs may still be uploading
+    SendDataImageBuffer *slot;
+    while ((slot = ImageFreeBuffer()) == nullptr) {
+      pthread_cond_wait(&async_cond, &async_mutex);
+    }
+    slot->in_use = true;
+    SendDataImageJob job = *ImageAt(0);
+    slot->callback = job.callback;
+    slot->user_data = job.user_data;
+    pthread_mutex_unlock(&async_mutex);
+
+    if (!ImageEncodeAndSend(&job, slot)) {
+      ImageReleaseBuffer(slot, EdgeAppLibSendDataResultFailure);
+    }
+    DataExportEndPendingOperation();
+
+    pthread_mutex_lock(&async_mutex);
+    *ImageAt(0) = {};
+    image_head = (image_head + 1) % SEND_DATA_ASYNC_IMAGE_QUEUE_SIZE;
+    image_count--;
+    image_busy = false;
+    pthread_cond_broadcast(&async_cond);
+  }
+  return nullptr;
+}
+
+EdgeAppLibSendDataResult SendDataAsyncImage(
+    void *data, int datalen, EdgeAppLibImageProperty *image_property,
+    uint64_t timestamp, EdgeAppLibSendDataReleaseCallback release,
+    EdgeAppLibSendDataCallback callback, void *user_data) {
+  LOG_TRACE("Entering SendDataAsyncImage");
+
+  if (data == nullptr || datalen <= 0 || image_property == nullptr) {
+    const char *error_msg = "Invalid data param";
+    LOG_ERR("%s", error_msg);
+    return EdgeAppLibSendDataResultInvalidParam;
+  }
+  if (!DataExportIsEnabled(EdgeAppLibDataExportRaw)) {
+    return EdgeAppLibSendDataResultDenied;
+  }
+
+  SendDataImageJob job = {};
+  job.data = data;
+  job.datalen = datalen;
+  job.image_property = *image_property;
+  job.timestamp = timestamp;
+  job.format = kProcessFormatImageTypeRaw;
+  job.release = release;
+  job.callback = callback;
+  job.user_data = user_data;
+  // Smaller than the image: already encoded, sent as it is
+  if (datalen >= image_property->stride_bytes * image_property->height) {
+    JSON_Object *json_object = getCodecSettings();
+    job.format =
+        (ProcessFormatImageType)json_object_get_number(json_object, "format");
+  }
+
+  pthread_mutex_lock(&async_mutex);
+  if (!image_worker_started) {
+    if (pthread_create(&image_worker, nullptr, ImageWorker, nullptr) != 0) {
+      pthread_mutex_unlock(&async_mutex);
+      LOG_ERR("Failed to start the image encode worker");
+      return EdgeAppLibSendDataResultFailure;
+    }
+    pthread_detach(image_worker);
+    image_worker_started = true;
+  }
+  while (image_count >= SEND_DATA_ASYNC_IMAGE_QUEUE_SIZE) {
+    EdgeAppLibSendDataOverflowPolicy policy = AsyncOverflowPolicy();
+    if (policy == EdgeAppLibSendDataOverflowBlock) {
+      pthread_cond_wait(&async_cond, &async_mutex);
+      continue;
+    }
+    // Only the images not being encoded can be dropped
+    uint32_t oldest = image_busy ? 1 : 0;
+    if (policy == EdgeAppLibSendDataOverflowDropNewest ||
+        oldest >= image_count) {
+      pthread_mutex_unlock(&async_mutex);
+      LOG_WARN("Image queue full: dropping the new image");
+      // data stays with the caller: only callback is called
+      AsyncCallback(callback, EdgeAppLibSendDataResultDropped, user_data);
+      return EdgeAppLibSendDataResultDropped;
+    }
+    SendDataImageJob dropped = *ImageAt(oldest);
+    for (uint32_t i = oldest; i + 1 < image_count; ++i) {
+      *ImageAt(i) = *ImageAt(i + 1);
+    }
+    image_count--;
+    *ImageAt(image_count) = {};
+    pthread_mutex_unlock(&async_mutex);
+    LOG_WARN("Image queue full: dropping the oldest image");
+    ImageFinish(&dropped, EdgeAppLibSendDataResultDropped);
+    pthread_mutex_lock(&async_mutex);
+  }
+  *ImageAt(image_count) = job;
+  image_count++;
+  // Until handed to EVP by the worker
+  DataExportBeginPendingOperation();
+  pthread_cond_broadcast(&async_cond);
+  pthread_mutex_unlock(&async_mutex);
+  return EdgeAppLibSendDataResultEnqueued;
+}
+
+EdgeAppLibSendDataResult SendDataSetAsyncPolicy(
+    uint32_t queue_size, EdgeAppLibSendDataOverflowPolicy policy) {
+  if (queue_size == 0 || queue_size > SEND_DATA_ASYNC_MAX_QUEUE_SIZE ||
+      policy < EdgeAppLibSendDataOverflowBlock ||
+      policy > EdgeAppLibSendDataOverflowDropNewest) {
+    LOG_ERR("Invalid asynchronous queue size %u or policy %d", queue_size,
+            policy);
+    return EdgeAppLibSendDataResultInvalidParam;
+  }
+  pthread_mutex_lock(&async_mutex);
+  async_queue_size = queue_size;
+  async_policy = policy;
+  pthread_cond_broadcast(&async_cond);
+  pthread_mutex_unlock(&async_mutex);
+  return EdgeAppLibSendDataResultSuccess;
+}
+
+/* Queued messages and images, or uploads of encoded images. Assumption:
+ * async_mutex is locked. */
+static bool AsyncPending() {
+  if (async_count > 0 || image_count > 0) return true;
+  for (int i = 0; i < SEND_DATA_ASYNC_IMAGE_POOL_SIZE; ++i) {
+    if (image_pool[i].in_use) return true;
+  }
+  return false;
+}
+
+EdgeAppLibSendDataResult SendDataAsyncDrain(int timeout_ms) {
+  struct timespec deadline;
+  if (timeout_ms >= 0) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    deadline.tv_sec = now.tv_sec + timeout_ms / 1000;
+    deadline.tv_nsec = (now.tv_usec + (timeout_ms % 1000) * 1000) * 1000;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000;
+    deadline.tv_nsec %= 1000000000;
+  }
+  int res = 0;
+  pthread_mutex_lock(&async_mutex);
+  while (AsyncPending() && res == 0) {
+    if (timeout_ms < 0) {
+      res = pthread_cond_wait(&async_cond, &async_mutex);
+    } else {
+      res = pthread_cond_timedwait(&async_cond, &async_mutex, &deadline);
+    }
+  }
+  bool drained = !AsyncPending();
+  pthread_mutex_unlock(&async_mutex);
+  return drained ? EdgeAppLibSendDataResultSuccess
+                 : EdgeAppLibSendDataResultTimeout;
+}
+
+static bool InfBatchReserve(InfBatch *batch, size_t size) {
+  if (batch->size + size <= batch->capacity) return true;
+  size_t capacity = batch->capacity ? batch->capacity : 1024;
+  while (batch->size + size > capacity) capacity *= 2;
+  char *buffer = (char *)realloc(batch->buffer, capacity);
+  if (buffer == nullptr) {
+    LOG_ERR("Failed to allocate memory for inference batch");
+    return false;
+  }
+  batch->buffer = buffer;
+  batch->capacity = capacity;
+  return true;
+}
+
+EdgeAppLibSendDataResult SendDataAppendInference(const char *json,
+                                                 uint64_t timestamp) {
+  // {<header>"Inferences":[<inference>]}
+  const char *inferences = strstr(json, INFERENCES_KEY);
+  size_t json_size = strlen(json);
+  size_t header_size =
+      inferences ? inferences - json + strlen(INFERENCES_KEY) : 0;
+  if (inferences == nullptr ||
+      json_size < header_size + strlen(INFERENCES_END)) {
+    LOG_ERR("Unexpected metadata format");
+    return EdgeAppLibSendDataResultInvalidParam;
+  }
+  const char *inference = json + header_size;
+  size_t inference_size = json_size - header_size - strlen(INFERENCES_END);
+
   for (int i = 0; i < MAX_NUMBER_OF_INFERENCE_QUEUE; ++i) {
-    if (output_tensor_vec[i].key == nullptr) {
-      output_tensor_vec[i].key = key;
-      output_tensor_vec[i].value = value;
-      is_set = true;
-      break;
-    } else if (strcmp(output_tensor_vec[i].key, key) == 0) {
-      // Append value to output_tensor_vec[i].value
-      JSON_Object *output_tensor_object_buf =
-          json_value_get_object(output_tensor_vec[i].value);
-      JSON_Array *infs_json_array =
-          json_object_get_array(output_tensor_object_buf, "Inferences");
-      JSON_Object *output_tensor_object = json_value_get_object(value);
-      JSON_Array *inf_value =
-          json_object_get_array(output_tensor_object, "Inferences");
-      JSON_Value *inf_first = json_array_get_value(inf_value, 0);
-      json_array_append_value(infs_json_array, json_value_deep_copy(inf_first));
-      json_value_free(value);
-      is_set = true;
-      break;
+    InfBatch *batch = &inf_batches[i];
+    if (batch->buffer == nullptr) {
+      // New header: start a batch with the whole message but its end
+      if (!InfBatchReserve(batch, header_size + inference_size +
+                                      sizeof(INFERENCES_END))) {
+        return EdgeAppLibSendDataResultDataTooLarge;
+      }
+      memcpy(batch->buffer, json, header_size + inference_size);
+      batch->header_size = header_size;
+      batch->size = header_size + inference_size;
+      batch->timestamp = timestamp;
+      inf_cnt++;
+      return EdgeAppLibSendDataResultSuccess;
+    }
+    if (batch->header_size == header_size &&
+        memcmp(batch->buffer, json, header_size) == 0) {
+      // Keep room for INFERENCES_END and its null terminator
+      if (!InfBatchReserve(batch, 1 + inference_size +
+                                      sizeof(INFERENCES_END))) {
+        return EdgeAppLibSendDataResultDataTooLarge;
+      }
+      batch->buffer[batch->size++] = ',';
+      memcpy(batch->buffer + batch->size, inference, inference_size);
+      batch->size += inference_size;
+      if (timestamp < batch->timestamp) batch->timestamp = timestamp;
+      inf_cnt++;
+      return EdgeAppLibSendDataResultSuccess;
     }
   }
-  pthread_mutex_unlock(&inf_mutex);
-  return is_set ? EdgeAppLibSendDataResultSuccess
-                : EdgeAppLibSendDataResultDataTooLarge;
-}
-
-uint64_t SendDataConvertTimeToNanoseconds(const char *datetime) {
-  struct tm tm;
-  char milliseconds[4];
-  uint64_t nanoseconds;
-  strptime(datetime, "%Y%m%d%H%M%S", &tm);
-  sscanf(datetime + 14, "%3s", milliseconds);
-  time_t epoch_time = timegm(&tm);
-  nanoseconds = (uint64_t)epoch_time * 1000000000ULL;
-  nanoseconds += (uint64_t)atoi(milliseconds) * 1000000ULL;
-  return nanoseconds;
+  return EdgeAppLibSendDataResultDataTooLarge;
+}
+
+EdgeAppLibSendDataResult SendDataFlushInferences(int timeout_ms) {
+  SendDataAsyncMsg msgs[MAX_NUMBER_OF_BATCH_MESSAGES];
+  EdgeAppLibSendDataResult send_ret;
+  int num_msgs = InfBatchTakeAll(msgs, &send_ret);
+  for (int i = 0; i < num_msgs; ++i) {
+    // Send Data
+    EdgeAppLibDataExportFuture *future =
+        DataExportSendData((char *)PORTNAME_META, EdgeAppLibDataExportMetadata,
+                           msgs[i].buffer, msgs[i].size, msgs[i].timestamp);
+    EdgeAppLibDataExportResult ret = DataExportAwait(future, timeout_ms);
+
+    if (ret != EdgeAppLibDataExportResultSuccess) {
+      send_ret = EdgeAppLibSendDataResultFailure;
+    }
+    DataExportCleanup(future);
+    free(msgs[i].buffer);
+  }
+  return send_ret;
 }
 
 #ifdef __cplusplus
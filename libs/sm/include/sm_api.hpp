@@ -35,4 +35,9 @@ JSON_Object *getCodecSettings(void);
 uint32_t getNumOfInfPerMsg(void);
 
 EdgeAppLibSensorStream GetSensorStream(void);
+
+/**
+ * Changes when the AI model, the port settings or the sensor stream change
+ */
+uint32_t getSettingsGeneration(void);
 #endif /* AITRIOS_SM_API_H */
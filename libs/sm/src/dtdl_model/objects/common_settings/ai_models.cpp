@@ -132,6 +132,9 @@ int AiModels::Apply(JSON_Array *array) {
   }
   ai_model_array_count = valid_count;
 
+  // bump only once applied: a header rebuilt meanwhile must not stay valid
+  StateMachineContext::GetInstance(nullptr)->UpdateSettingsGeneration();
+
   LOG_INFO("AiModels::Apply exits");
   return result;
 }
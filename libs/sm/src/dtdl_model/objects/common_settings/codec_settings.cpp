@@ -21,24 +21,48 @@
 #include "sm_context.hpp"
 
 #define FORMAT "format"
+#define METADATA_COMPRESSION "metadata_compression"
+#define INPUT_TENSOR_COMPRESSION "input_tensor_compression"
 
 CodecSettings::CodecSettings() {
   static Validation s_validations[] = {
       {.property = FORMAT, .validation = kType, .value = JSONNumber},
+      {.property = METADATA_COMPRESSION, .validation = kType,
+       .value = JSONNumber},
+      {.property = METADATA_COMPRESSION, .validation = kGe,
+       .value = COMPRESSION_NONE},
+      {.property = METADATA_COMPRESSION, .validation = kLe,
+       .value = COMPRESSION_LZ4_AUTO},
+      {.property = INPUT_TENSOR_COMPRESSION, .validation = kType,
+       .value = JSONNumber},
+      {.property = INPUT_TENSOR_COMPRESSION, .validation = kGe,
+       .value = COMPRESSION_NONE},
+      {.property = INPUT_TENSOR_COMPRESSION, .validation = kLe,
+       .value = COMPRESSION_LZ4_AUTO},
   };
   SetValidations(s_validations, sizeof(s_validations) / sizeof(Validation));
   json_object_set_number(json_obj, FORMAT, 1);
 }
 
 int CodecSettings::Apply(JSON_Object *obj) {
-  if (!json_object_has_value(obj, FORMAT)) return 0;
+  bool updated = false;
+  // Compression is absent unless configured, which reads as COMPRESSION_NONE
+  for (const char *property :
+       {FORMAT, METADATA_COMPRESSION, INPUT_TENSOR_COMPRESSION}) {
+    if (!json_object_has_value(obj, property)) continue;
 
-  uint32_t format = (uint32_t)json_object_get_number(obj, FORMAT);
-  if ((uint32_t)json_object_get_number(json_obj, FORMAT) == format) return 0;
+    uint32_t value = (uint32_t)json_object_get_number(obj, property);
+    if (json_object_has_value(json_obj, property) &&
+        (uint32_t)json_object_get_number(json_obj, property) == value) {
+      continue;
+    }
+    json_object_set_number(json_obj, property, value);
+    updated = true;
+  }
+  if (!updated) return 0;
 
   StateMachineContext::GetInstance(nullptr)->EnableNotification();
 
   LOG_INFO("Updating CodecSettings");
-  json_object_set_number(json_obj, FORMAT, format);
   return 0;
 }
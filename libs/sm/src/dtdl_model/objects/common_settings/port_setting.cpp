@@ -28,6 +28,7 @@
 #define ENDPOINT "endpoint"
 #define PATH "path"
 #define ENABLED "enabled"
+#define FORMAT "format"
 
 PortSetting::PortSetting(PortSettingOption ps_opt) {
   static Validation s_validations[] = {
@@ -36,6 +37,9 @@ PortSetting::PortSetting(PortSettingOption ps_opt) {
       {.property = ENDPOINT, .validation = kType, .value = JSONString},
       {.property = PATH, .validation = kType, .value = JSONString},
       {.property = ENABLED, .validation = kType, .value = JSONBoolean},
+      {.property = FORMAT, .validation = kType, .value = JSONNumber},
+      {.property = FORMAT, .validation = kGe, .value = META_FORMAT_JSON},
+      {.property = FORMAT, .validation = kLe, .value = META_FORMAT_BINARY},
   };
   SetValidations(s_validations, sizeof(s_validations) / sizeof(Validation));
   json_object_set_number(json_obj, METHOD, 0);
@@ -60,6 +64,11 @@ int PortSetting::Apply(JSON_Object *obj) {
   if (json_object_has_value(obj, ENABLED))
     json_object_set_boolean(json_obj, ENABLED,
                             json_object_get_boolean(obj, ENABLED));
+  if (json_object_has_value(obj, FORMAT))
+    json_object_set_number(json_obj, FORMAT,
+                           json_object_get_number(obj, FORMAT));
+  if (GetFormat() == META_FORMAT_BINARY && GetMethod() == METHOD_MQTT)
+    LOG_WARN("Binary metadata cannot be sent as telemetry: using JSON");
   return 0;
 }
 
@@ -82,3 +91,8 @@ const char *PortSetting::GetPath() const {
 bool PortSetting::GetEnabled() const {
   return (bool)json_object_get_boolean(json_obj, ENABLED);
 }
+
+uint32_t PortSetting::GetFormat() const {
+  // Absent unless configured, which reads as META_FORMAT_JSON
+  return (uint32_t)json_object_get_number(json_obj, FORMAT);
+}
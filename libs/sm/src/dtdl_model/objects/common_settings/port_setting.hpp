@@ -34,6 +34,7 @@ class PortSetting : public JsonObject {
   const char *GetEndpoint() const;
   const char *GetPath() const;
   bool GetEnabled() const;
+  uint32_t GetFormat() const;
 };
 
 #endif /* DTDL_MODEL_OBJECTS_COMMON_SETTINGS_PORT_SETTING_HPP */
@@ -104,15 +104,16 @@ int PortSettings::Apply(JSON_Object *obj) {
     input_tensor.Apply(json_input_tensor);
   }
 
+  int result = 0;
   if (!input_tensor.GetEnabled() && !metadata.GetEnabled()) {
-    return -1;
+    result = -1;
+  } else if (ApplyStreamChannels() != 0) {
+    result = -1;
   }
 
-  if (ApplyStreamChannels() != 0) {
-    return -1;
-  }
-
-  return 0;
+  // bump only once applied: a header rebuilt meanwhile must not stay valid
+  StateMachineContext::GetInstance(nullptr)->UpdateSettingsGeneration();
+  return result;
 }
 
 PortSetting *PortSettings::GetMetadata() { return &metadata; }
@@ -49,6 +49,14 @@ typedef enum {
 
 typedef enum { METHOD_BMP = 0, METHOD_JPEG } METHOD_FORMAT;
 
+typedef enum { META_FORMAT_JSON = 0, META_FORMAT_BINARY } META_FORMAT;
+
+typedef enum {
+  COMPRESSION_NONE = 0,
+  COMPRESSION_LZ4,
+  COMPRESSION_LZ4_AUTO
+} COMPRESSION;
+
 typedef enum {
   LEVEL_CRITICAL = 0,
   LEVEL_ERROR,
@@ -30,6 +30,7 @@ void updateProperty(EdgeAppLibSensorStream stream, const char *property_key,
                     const void *value, size_t value_size) {
   DtdlModel *dtdl = StateMachineContext::GetInstance(nullptr)->GetDtdlModel();
   PqSettings *pq = dtdl->GetCommonSettings()->GetPqSettings();
+  bool model_changed = false;
   if (compare_string(property_key,
                      AITRIOS_SENSOR_CAMERA_IMAGE_SIZE_PROPERTY_KEY)) {
     EdgeAppLibSensorCameraImageSizeProperty *camera_size =
@@ -151,7 +152,8 @@ void updateProperty(EdgeAppLibSensorStream stream, const char *property_key,
         AITRIOS_SENSOR_REGISTER_64BIT);
   } else if (compare_string(property_key,
                             AITRIOS_SENSOR_AI_MODEL_BUNDLE_ID_PROPERTY_KEY)) {
-    // inside custom_settings, set by the user
+    // inside custom_settings, set by the user. Changes the model version.
+    model_changed = true;
   } else if (compare_string(property_key,
                             AITRIOS_SENSOR_GAMMA_MODE_PROPERTY_KEY)) {
     EdgeAppLibSensorInferenceGammaModeProperty *gamma_mode =
@@ -166,6 +168,10 @@ void updateProperty(EdgeAppLibSensorStream stream, const char *property_key,
   } else {
     LOG_INFO("Unknown property: %s", property_key);
   }
+  // bumped last so that a header rebuilt meanwhile is not kept as valid
+  if (model_changed) {
+    StateMachineContext::GetInstance(nullptr)->UpdateSettingsGeneration();
+  }
 }
 
 void updateCustomSettings(void *state, int statelen) {
@@ -196,3 +202,7 @@ EdgeAppLibSensorStream GetSensorStream(void) {
       StateMachineContext::GetInstance(nullptr)->GetSensorStream();
   return stream;
 }
+
+uint32_t getSettingsGeneration(void) {
+  return StateMachineContext::GetInstance(nullptr)->GetSettingsGeneration();
+}
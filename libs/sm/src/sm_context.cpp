@@ -67,8 +67,15 @@ EdgeAppLibSensorStream StateMachineContext::GetSensorStream() { return stream; }
 
 void StateMachineContext::SetSensorStream(EdgeAppLibSensorStream stream) {
   this->stream = stream;
+  UpdateSettingsGeneration();
 }
 
+uint32_t StateMachineContext::GetSettingsGeneration() {
+  return settings_generation;
+}
+
+void StateMachineContext::UpdateSettingsGeneration() { settings_generation++; }
+
 State *StateMachineContext::GetCurrentState() { return current_state; }
 
 DtdlModel *StateMachineContext::GetDtdlModel() { return &dtdl_model; }
@@ -17,6 +17,8 @@
 #ifndef AITRIOS_SM_CONTEXT_HPP
 #define AITRIOS_SM_CONTEXT_HPP
 
+#include <atomic>
+
 #include "context.hpp"
 #include "dtdl_model/dtdl_model.hpp"
 #include "evp_c_sdk/sdk.h"
@@ -39,6 +41,10 @@ class StateMachineContext : public Context {
   void SetSensorCore(EdgeAppLibSensorCore core);
   void SetSensorStream(EdgeAppLibSensorStream stream);
 
+  /* Incremented when the settings describing the metadata change */
+  uint32_t GetSettingsGeneration();
+  void UpdateSettingsGeneration();
+
   void SetPendingConfiguration(void *config, size_t configlen);
   size_t GetPendingConfiguration(void **config);
   void ClearPendingConfiguration();
@@ -55,6 +61,7 @@ class StateMachineContext : public Context {
   State *current_state = nullptr;
   EdgeAppLibSensorCore core = 0;
   EdgeAppLibSensorStream stream = 0;
+  std::atomic<uint32_t> settings_generation{0};  // Read from sender threads
   void *pending_configuration = nullptr;
   size_t pending_configuration_len = 0;
 };
@@ -65,17 +65,21 @@ void RunningThread::ThreadStop() {
   pthread_mutex_unlock(&command_mutex);
   StateMachineContext *context = StateMachineContext::GetInstance(nullptr);
   void *status = nullptr;
-  int res;
+  int res = -1;
   time_t start_time, current_time;
   const int timeout_seconds = 60;
   start_time = time(NULL);
   while (1) {
+    if (res != 0) {
 #if defined(__APPLE__)
-    res = 0;
+      res = 0;
 #else
-    res = pthread_tryjoin_np(command_thread, &status);
+      res = pthread_tryjoin_np(command_thread, &status);
 #endif
-    if (res == 0) {
+    }
+    // Keep processing events until the uploads sent by the iterations are
+    // done, so that they complete before onStop
+    if (res == 0 && !DataExportHasPendingOperations()) {
       break;
     } else {
 #ifdef EVP_REMOTE_SDK
@@ -97,7 +101,11 @@ void RunningThread::ThreadStop() {
     }
     current_time = time(NULL);
     if (difftime(current_time, start_time) >= timeout_seconds) {
-      LOG_ERR("pthread_join timeout: %d", res);
+      if (res == 0) {
+        LOG_ERR("Timeout waiting for pending uploads");
+      } else {
+        LOG_ERR("pthread_join timeout: %d", res);
+      }
       return;
     }
   }
@@ -18,6 +18,13 @@
 
 #include <stdlib.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+
 #include "data_export.h"
 #include "data_export_private.h"
 
@@ -34,6 +41,16 @@ static int EdgeAppLibDataExportCleanupCalled = 0;
 static int EdgeAppLibDataExportSendDataCalled = 0;
 static int EdgeAppLibDataExportCancelOperationCalled = 0;
 static bool EdgeAppLibDataExportIsEnabledReturn = true;
+static int EdgeAppLibDataExportSendDataCount = 0;
+static std::string EdgeAppLibDataExportSentMetadata;
+static uint64_t EdgeAppLibDataExportSentTimestamp = 0;
+static bool EdgeAppLibDataExportCompletionDeferred = false;
+static std::deque<std::pair<DataExportCompletionCallback, void *>>
+    EdgeAppLibDataExportDeferred;
+static std::mutex EdgeAppLibDataExportDeferredMutex;
+static std::condition_variable EdgeAppLibDataExportDeferredCond;
+static const void *EdgeAppLibDataExportBorrowedData = nullptr;
+static int EdgeAppLibDataExportPendingOperations = 0;
 
 namespace EdgeAppLib {
 #ifdef __cplusplus
@@ -53,6 +70,11 @@ EdgeAppLibDataExportFuture *DataExportSendData(
     int datalen, uint64_t timestamp, uint32_t current, uint32_t division,
     EdgeAppLibImageProperty *image_property) {
   EdgeAppLibDataExportSendDataCalled = 1;
+  EdgeAppLibDataExportSendDataCount++;
+  EdgeAppLibDataExportSentTimestamp = timestamp;
+  if (datatype == EdgeAppLibDataExportMetadata) {
+    EdgeAppLibDataExportSentMetadata.assign((const char *)data, datalen);
+  }
   EdgeAppLibDataExportFuture *future =
       (EdgeAppLibDataExportFuture *)malloc(sizeof(EdgeAppLibDataExportFuture));
   if (datatype == EdgeAppLibDataExportRaw) {
@@ -62,6 +84,25 @@ EdgeAppLibDataExportFuture *DataExportSendData(
 
   return future;
 }
+EdgeAppLibDataExportFuture *DataExportSendBorrowedData(
+    char *portname, EdgeAppLibDataExportDataType datatype, void *data,
+    int datalen, uint64_t timestamp, uint32_t current, uint32_t division) {
+  std::lock_guard<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  EdgeAppLibDataExportSendDataCalled = 1;
+  EdgeAppLibDataExportSendDataCount++;
+  EdgeAppLibDataExportSentTimestamp = timestamp;
+  EdgeAppLibDataExportBorrowedData = data;
+  return (EdgeAppLibDataExportFuture *)malloc(
+      sizeof(EdgeAppLibDataExportFuture));
+}
+void DataExportBeginPendingOperation() {
+  std::lock_guard<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  EdgeAppLibDataExportPendingOperations++;
+}
+void DataExportEndPendingOperation() {
+  std::lock_guard<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  EdgeAppLibDataExportPendingOperations--;
+}
 EdgeAppLibDataExportResult DataExportAwait(EdgeAppLibDataExportFuture *future,
                                            int timeout_ms) {
   EdgeAppLibDataExportAwaitCalled = 1;
@@ -87,12 +128,28 @@ bool DataExportIsEnabled(EdgeAppLibDataExportDataType) {
   return EdgeAppLibDataExportIsEnabledReturn;
 }
 bool DataExportHasPendingOperations() {
-  if (EdgeAppLibDataExportCancelOperationCalled) {
+  std::lock_guard<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  if (EdgeAppLibDataExportCancelOperationCalled ||
+      !EdgeAppLibDataExportDeferred.empty() ||
+      EdgeAppLibDataExportPendingOperations > 0) {
     return true;
   } else {
     return false;
   }
 }
+void DataExportSetCompletionCallback(EdgeAppLibDataExportFuture *future,
+                                     DataExportCompletionCallback callback,
+                                     void *user_data) {
+  {
+    std::lock_guard<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+    if (EdgeAppLibDataExportCompletionDeferred) {
+      EdgeAppLibDataExportDeferred.emplace_back(callback, user_data);
+      EdgeAppLibDataExportDeferredCond.notify_all();
+      return;
+    }
+  }
+  callback(EdgeAppLibDataExportResultSuccess, user_data);
+}
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -161,3 +218,40 @@ void resetEdgeAppLibDataExportIsEnabled() {
 void setEdgeAppLibDataExportIsEnabledDisabled() {
   EdgeAppLibDataExportIsEnabledReturn = false;
 }
+int getEdgeAppLibDataExportSendDataCount() {
+  std::lock_guard<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  return EdgeAppLibDataExportSendDataCount;
+}
+const char *getEdgeAppLibDataExportSentMetadata() {
+  return EdgeAppLibDataExportSentMetadata.c_str();
+}
+uint64_t getEdgeAppLibDataExportSentTimestamp() {
+  return EdgeAppLibDataExportSentTimestamp;
+}
+
+void setEdgeAppLibDataExportCompletionDeferred(bool deferred) {
+  EdgeAppLibDataExportCompletionDeferred = deferred;
+}
+int completeEdgeAppLibDataExportDeferred(bool success) {
+  std::unique_lock<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  if (EdgeAppLibDataExportDeferred.empty()) return 0;
+  std::pair<DataExportCompletionCallback, void *> deferred =
+      EdgeAppLibDataExportDeferred.front();
+  EdgeAppLibDataExportDeferred.pop_front();
+  lock.unlock();
+  deferred.first(success ? EdgeAppLibDataExportResultSuccess
+                         : EdgeAppLibDataExportResultFailure,
+                 deferred.second);
+  lock.lock();
+  return EdgeAppLibDataExportDeferred.size();
+}
+bool waitEdgeAppLibDataExportDeferred(int count, int timeout_ms) {
+  std::unique_lock<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  return EdgeAppLibDataExportDeferredCond.wait_for(
+      lock, std::chrono::milliseconds(timeout_ms),
+      [count] { return (int)EdgeAppLibDataExportDeferred.size() >= count; });
+}
+const void *getEdgeAppLibDataExportBorrowedData() {
+  std::lock_guard<std::mutex> lock(EdgeAppLibDataExportDeferredMutex);
+  return EdgeAppLibDataExportBorrowedData;
+}
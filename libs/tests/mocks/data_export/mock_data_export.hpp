@@ -17,6 +17,8 @@
 #ifndef MOCK_AITRIOS_DATA_EXPORT_H
 #define MOCK_AITRIOS_DATA_EXPORT_H
 
+#include <stdint.h>
+
 int wasEdgeAppLibDataExportInitializeCalled();
 void resetEdgeAppLibDataExportInitialize();
 void setEdgeAppLibDataExportInitializeError();
@@ -42,4 +44,21 @@ void resetEdgeAppLibDataExportCancelOperationCalled();
 void resetEdgeAppLibDataExportIsEnabled();
 void setEdgeAppLibDataExportIsEnabledDisabled();
 
+/* Number of DataExportSendData calls, last metadata and timestamp sent */
+int getEdgeAppLibDataExportSendDataCount();
+const char *getEdgeAppLibDataExportSentMetadata();
+uint64_t getEdgeAppLibDataExportSentTimestamp();
+
+/* While deferred, completion callbacks wait for
+ * completeEdgeAppLibDataExportDeferred, which calls the oldest one and returns
+ * how many are then pending */
+void setEdgeAppLibDataExportCompletionDeferred(bool deferred);
+int completeEdgeAppLibDataExportDeferred(bool success);
+/* Waits up to timeout_ms for |count| deferred completions, as set by another
+ * thread. Returns true if they are pending. */
+bool waitEdgeAppLibDataExportDeferred(int count, int timeout_ms);
+
+/* Data of the last DataExportSendBorrowedData call */
+const void *getEdgeAppLibDataExportBorrowedData();
+
 #endif /* MOCK_AITRIOS_DATA_EXPORT_H */
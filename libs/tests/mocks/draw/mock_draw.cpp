@@ -19,6 +19,7 @@
 #include "draw.h"
 static int32_t EdgeAppLibDrawRectangleReturn = 0;
 static int EdgeAppLibDrawRectangleCalled = 0;
+static int EdgeAppLibDrawPrimitivesCalled = 0;
 
 int32_t DrawRectangle(struct EdgeAppLibDrawBuffer *buffer, uint32_t left,
                       uint32_t top, uint32_t right, uint32_t bottom,
@@ -26,9 +27,18 @@ int32_t DrawRectangle(struct EdgeAppLibDrawBuffer *buffer, uint32_t left,
   EdgeAppLibDrawRectangleCalled = 1;
   return EdgeAppLibDrawRectangleReturn;
 }
+int32_t DrawPrimitives(struct EdgeAppLibDrawBuffer *buffer,
+                       const struct EdgeAppLibDrawPrimitives *primitives) {
+  EdgeAppLibDrawPrimitivesCalled = 1;
+  return 0;
+}
 int32_t ResizeRectangle(const struct EdgeAppLibDrawBuffer *src,
                         struct EdgeAppLibDrawBuffer *dst) {
   return 0;
 }
 int wasEdgeAppLibDrawRectangleCalled() { return EdgeAppLibDrawRectangleCalled; }
 void resetEdgeAppLibDrawRectangle() { EdgeAppLibDrawRectangleCalled = 0; }
+int wasEdgeAppLibDrawPrimitivesCalled() {
+  return EdgeAppLibDrawPrimitivesCalled;
+}
+void resetEdgeAppLibDrawPrimitives() { EdgeAppLibDrawPrimitivesCalled = 0; }
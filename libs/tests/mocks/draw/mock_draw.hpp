@@ -19,5 +19,7 @@
 
 int wasEdgeAppLibDrawRectangleCalled();
 void resetEdgeAppLibDrawRectangle();
+int wasEdgeAppLibDrawPrimitivesCalled();
+void resetEdgeAppLibDrawPrimitives();
 
 #endif /* MOCK_AITRIOS_DRAW_H */
@@ -170,6 +170,16 @@ ProcessedFrame Process(EdgeAppCoreCtx &ctx, EdgeAppCoreCtx *shared_ctx,
   return ProcessedFrame(&g_mock_sensor_stream, g_mock_sensor_frame);
 }
 
+ProcessedFrame Process(EdgeAppCoreCtx &, EdgeAppCoreCtx *,
+                       EdgeAppLibSensorFrame,
+                       const EdgeAppLibSensorImageCropProperty *, uint32_t) {
+  EdgeAppCoreProcessCalled = 1;
+  if (!process_result) {
+    return ProcessedFrame();  // Simulate failure
+  }
+  return ProcessedFrame(&g_mock_sensor_stream, g_mock_sensor_frame);
+}
+
 Tensor GetOutput(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame, uint32_t) {
   EdgeAppCoreGetOutputCalled = 1;
   if (get_output_result) {
@@ -259,11 +269,21 @@ Tensor GetInput(EdgeAppCoreCtx &ctx, EdgeAppLibSensorFrame) {
   return g_mock_tensor;
 }
 
+EdgeAppCoreResult InvalidateOutputLayout(EdgeAppCoreCtx &) {
+  return EdgeAppCoreResultSuccess;
+}
+
 EdgeAppCoreResult UnloadModel(EdgeAppCoreCtx &) {
   EdgeAppCoreUnloadModelCalled = 1;
   return unload_model_result;
 }
 
+EdgeAppCoreResult SetModelCacheLimit(size_t) {
+  return EdgeAppCoreResultSuccess;
+}
+
+EdgeAppCoreResult EvictModel(const char *) { return EdgeAppCoreResultSuccess; }
+
 EdgeAppCoreResult SendInputTensor(Tensor *) {
   EdgeAppCoreSendInputTensorCalled = 1;
   return send_it_result;
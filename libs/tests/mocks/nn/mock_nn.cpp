@@ -24,10 +24,19 @@ static EdgeAppLibNNResult InitContextStatus = EDGEAPP_LIB_NN_SUCCESS;
 static EdgeAppLibNNResult SetInputStatus = EDGEAPP_LIB_NN_SUCCESS;
 static EdgeAppLibNNResult ComputeStatus = EDGEAPP_LIB_NN_SUCCESS;
 static EdgeAppLibNNResult GetOutputStatus = EDGEAPP_LIB_NN_SUCCESS;
+static EdgeAppLibNNResult BatchInputStatus = EDGEAPP_LIB_NN_SUCCESS;
+// Images in the last input, outputs are scaled accordingly
+static uint32_t InputBatch = 1;
+static uint32_t OutputSizeScale = 1;
+static int LoadModelCalled = 0;
+static EdgeAppLib::EdgeAppLibTensorType LastInputType =
+    EdgeAppLib::TensorTypeFloat32;
 
 // Functions to toggle error simulation for tests
 void setLoadModelError() { LoadModelStatus = EDGEAPP_LIB_NN_RUNTIME_ERROR; }
 void resetLoadModelStatus() { LoadModelStatus = EDGEAPP_LIB_NN_SUCCESS; }
+int wasLoadModelCalled() { return LoadModelCalled; }
+void resetLoadModelCalled() { LoadModelCalled = 0; }
 
 void setInitContextError() { InitContextStatus = EDGEAPP_LIB_NN_RUNTIME_ERROR; }
 void resetInitContextStatus() { InitContextStatus = EDGEAPP_LIB_NN_SUCCESS; }
@@ -39,13 +48,24 @@ void setComputeError() { ComputeStatus = EDGEAPP_LIB_NN_RUNTIME_ERROR; }
 void resetComputeStatus() { ComputeStatus = EDGEAPP_LIB_NN_SUCCESS; }
 
 void setGetOutputError() { GetOutputStatus = EDGEAPP_LIB_NN_RUNTIME_ERROR; }
-void resetGetOutputStatus() { GetOutputStatus = EDGEAPP_LIB_NN_SUCCESS; }
+void resetGetOutputStatus() {
+  GetOutputStatus = EDGEAPP_LIB_NN_SUCCESS;
+  OutputSizeScale = 1;
+}
+
+void setOutputSizeScale(uint32_t scale) { OutputSizeScale = scale; }
+
+void setBatchInputError() { BatchInputStatus = EDGEAPP_LIB_NN_RUNTIME_ERROR; }
+void resetBatchInputStatus() { BatchInputStatus = EDGEAPP_LIB_NN_SUCCESS; }
+
+EdgeAppLib::EdgeAppLibTensorType getLastInputType() { return LastInputType; }
 
 namespace EdgeAppLib {
 
 // Mock implementation of LoadModel
 EdgeAppLibNNResult LoadModel(const char *model_name, EdgeAppLibGraph *g,
                              EdgeAppLibExecutionTarget target) {
+  LoadModelCalled++;
   if (LoadModelStatus != EDGEAPP_LIB_NN_SUCCESS) return LoadModelStatus;
   *g = (EdgeAppLibGraph)123;  // Dummy graph handle
   return EDGEAPP_LIB_NN_SUCCESS;
@@ -64,6 +84,8 @@ EdgeAppLibNNResult SetInput(EdgeAppLibGraphContext ctx, uint8_t *input_tensor,
                             size_t mean_size, const float *norm_values,
                             size_t norm_size) {
   if (SetInputStatus != EDGEAPP_LIB_NN_SUCCESS) return SetInputStatus;
+  InputBatch = 1;
+  LastInputType = TensorTypeFloat32;
   return EDGEAPP_LIB_NN_SUCCESS;
 }
 
@@ -89,12 +111,17 @@ EdgeAppLibNNResult GetOutput(EdgeAppLibGraphContext ctx, uint32_t index,
     return EDGEAPP_LIB_NN_RUNTIME_ERROR;  // Return error for invalid index
   }
 
-  uint32_t size = tensor_sizes[index];
+  uint32_t size = tensor_sizes[index] * InputBatch * OutputSizeScale;
+  // Never write past the capacity given by the caller
+  uint32_t capacity = *out_size / sizeof(float);
+  uint32_t count = (size < capacity) ? size : capacity;
 
   *out_size = size;
-  for (uint32_t i = 0; i < size; ++i) {
-    // Generate different data patterns for different tensor indices
-    out_tensor[i] = (float)(index * 100 + i);
+  for (uint32_t i = 0; i < count; ++i) {
+    // Generate different data patterns for different tensor indices. Slots
+    // of quantized tensors need not be float aligned.
+    float value = (float)(index * 100 + i);
+    memcpy(out_tensor + i, &value, sizeof(value));
   }
   return EDGEAPP_LIB_NN_SUCCESS;
 }
@@ -105,11 +132,56 @@ EdgeAppLibNNResult SetInputFromTensor(EdgeAppLibGraphContext ctx,
                                       EdgeAppLibTensorType type) {
   (void)ctx;
   (void)input_tensor;
-  (void)dim;
-  (void)type;
+  if ((*dim)[0] > 1 && BatchInputStatus != EDGEAPP_LIB_NN_SUCCESS) {
+    return BatchInputStatus;
+  }
+  InputBatch = (*dim)[0] > 0 ? (*dim)[0] : 1;
+  LastInputType = type;
+  return EDGEAPP_LIB_NN_SUCCESS;
+}
+
+// Mock input binding: keeps what the mock input functions look at
+struct EdgeAppLibInputBinding {
+  uint32_t batch;
+  EdgeAppLibTensorType type;
+  bool normalize;
+};
+
+// Mock implementation of CreateInputBinding
+EdgeAppLibNNResult CreateInputBinding(
+    EdgeAppLibGraphContext ctx, uint32_t (*dim)[4], EdgeAppLibTensorType type,
+    const float *mean_values, size_t mean_size, const float *norm_values,
+    size_t norm_size, EdgeAppLibInputBinding **binding) {
+  (void)ctx;
+  (void)mean_size;
+  (void)norm_size;
+  *binding = new EdgeAppLibInputBinding{
+      (*dim)[0], type, mean_values != NULL || norm_values != NULL};
+  return EDGEAPP_LIB_NN_SUCCESS;
+}
+
+// Mock implementation of BindInput, failing like SetInput for normalized
+// inputs and like SetInputFromTensor otherwise
+EdgeAppLibNNResult BindInput(EdgeAppLibInputBinding *binding,
+                             uint8_t *input_tensor) {
+  (void)input_tensor;
+  if (binding->normalize) {
+    if (SetInputStatus != EDGEAPP_LIB_NN_SUCCESS) return SetInputStatus;
+    InputBatch = 1;
+    LastInputType = TensorTypeFloat32;
+    return EDGEAPP_LIB_NN_SUCCESS;
+  }
+  if (binding->batch > 1 && BatchInputStatus != EDGEAPP_LIB_NN_SUCCESS) {
+    return BatchInputStatus;
+  }
+  InputBatch = binding->batch > 0 ? binding->batch : 1;
+  LastInputType = binding->type;
   return EDGEAPP_LIB_NN_SUCCESS;
 }
 
+// Mock implementation of DestroyInputBinding
+void DestroyInputBinding(EdgeAppLibInputBinding *binding) { delete binding; }
+
 }  // namespace EdgeAppLib
 
 #include <stdlib.h>
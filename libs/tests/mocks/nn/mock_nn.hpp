@@ -19,6 +19,8 @@
 // Mock error toggle functions
 void setLoadModelError();
 void resetLoadModelStatus();
+int wasLoadModelCalled();  // Number of LoadModel calls
+void resetLoadModelCalled();
 
 void setInitContextError();
 void resetInitContextStatus();
@@ -30,7 +32,17 @@ void setComputeError();
 void resetComputeStatus();
 
 void setGetOutputError();
-void resetGetOutputStatus();
+void resetGetOutputStatus();  // Also resets the output size scale
+
+// Multiplies the size of every output tensor
+void setOutputSizeScale(uint32_t scale);
+
+// Rejects inputs with more than one image in dims[0]
+void setBatchInputError();
+void resetBatchInputStatus();
+
+// Element type of the last input given to the graph (float32 after SetInput)
+EdgeAppLib::EdgeAppLibTensorType getLastInputType();
 
 typedef uint32_t EdgeAppLibGraphContext;
 typedef uint32_t EdgeAppLibGraph;
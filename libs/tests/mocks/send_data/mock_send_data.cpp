@@ -20,6 +20,8 @@
 /* 0 = no called, 1 = called */
 static int EdgeAppLibSendDataSyncMetaCalled = 0;
 static int EdgeAppLibSendDataSyncImageCalled = 0;
+static int EdgeAppLibSendDataAsyncMetaCalled = 0;
+static int EdgeAppLibSendDataAsyncImageCalled = 0;
 
 static EdgeAppLibSendDataResult SendDataSyncMetaSuccess =
     EdgeAppLibSendDataResultSuccess;
@@ -38,6 +40,14 @@ int wasEdgeAppLibSendDataSyncMetaCalled() {
   return EdgeAppLibSendDataSyncMetaCalled;
 }
 
+int wasEdgeAppLibSendDataAsyncMetaCalled() {
+  return EdgeAppLibSendDataAsyncMetaCalled;
+}
+
+void resetEdgeAppLibSendDataAsyncMetaCalled() {
+  EdgeAppLibSendDataAsyncMetaCalled = 0;
+}
+
 void setSendDataImageSuccess() { EdgeAppLibSendDataSyncImageCalled = 1; }
 
 void resetSendDataImageSuccess() { EdgeAppLibSendDataSyncImageCalled = 0; }
@@ -46,6 +56,14 @@ int wasEdgeAppLibSendDataSyncImageCalled() {
   return EdgeAppLibSendDataSyncImageCalled;
 }
 
+int wasEdgeAppLibSendDataAsyncImageCalled() {
+  return EdgeAppLibSendDataAsyncImageCalled;
+}
+
+void resetEdgeAppLibSendDataAsyncImageCalled() {
+  EdgeAppLibSendDataAsyncImageCalled = 0;
+}
+
 namespace EdgeAppLib {
 #ifdef __cplusplus
 extern "C" {
@@ -72,6 +90,39 @@ EdgeAppLibSendDataResult SendDataSyncImage(
   return EdgeAppLibSendDataResultSuccess;
 }
 
+EdgeAppLibSendDataResult SendDataAsyncMeta(void *data, int datalen,
+                                           EdgeAppLibSendDataType datatype,
+                                           uint64_t timestamp,
+                                           EdgeAppLibSendDataCallback callback,
+                                           void *user_data) {
+  EdgeAppLibSendDataAsyncMetaCalled = 1;
+  if (SendDataSyncMetaSuccess != EdgeAppLibSendDataResultSuccess)
+    return SendDataSyncMetaSuccess;
+  if (callback != nullptr) callback(EdgeAppLibSendDataResultSuccess, user_data);
+  return EdgeAppLibSendDataResultEnqueued;
+}
+
+EdgeAppLibSendDataResult SendDataAsyncImage(
+    void *data, int datalen, EdgeAppLibImageProperty *image_property,
+    uint64_t timestamp, EdgeAppLibSendDataReleaseCallback release,
+    EdgeAppLibSendDataCallback callback, void *user_data) {
+  EdgeAppLibSendDataAsyncImageCalled = 1;
+  if (SendDataSyncImageSuccess != EdgeAppLibSendDataResultSuccess)
+    return SendDataSyncImageSuccess;
+  if (release != nullptr) release(data, user_data);
+  if (callback != nullptr) callback(EdgeAppLibSendDataResultSuccess, user_data);
+  return EdgeAppLibSendDataResultEnqueued;
+}
+
+EdgeAppLibSendDataResult SendDataSetAsyncPolicy(
+    uint32_t queue_size, EdgeAppLibSendDataOverflowPolicy policy) {
+  return EdgeAppLibSendDataResultSuccess;
+}
+
+EdgeAppLibSendDataResult SendDataAsyncDrain(int timeout_ms) {
+  return EdgeAppLibSendDataResultSuccess;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,7 +22,11 @@
 void setSendDataSyncMetaFail(EdgeAppLibSendDataResult result);
 void resetSendDataSyncMetaSuccess();
 int wasEdgeAppLibSendDataSyncMetaCalled();
+int wasEdgeAppLibSendDataAsyncMetaCalled();
+void resetEdgeAppLibSendDataAsyncMetaCalled();
 void setSendDataImage(EdgeAppLibSendDataResult result);
 void resetSendDataImageSuccess();
 int wasEdgeAppLibSendDataSyncImageCalled();
+int wasEdgeAppLibSendDataAsyncImageCalled();
+void resetEdgeAppLibSendDataAsyncImageCalled();
 #endif  // MOCKS_MOCK_SEND_DATA_HPP
@@ -34,6 +34,52 @@ void resetProcessFormatMetaSuccess() {
 
 void setProcessFormatMetaOutput(const char *model_id) { s_model_id = model_id; }
 
+static ProcessFormatMetaFormat s_meta_format = kProcessFormatMetaJson;
+
+void setProcessFormatMetaFormat(ProcessFormatMetaFormat format) {
+  s_meta_format = format;
+}
+
+static ProcessFormatResult s_input_result = kProcessFormatResultOk;
+
+void setProcessFormatInputResult(ProcessFormatResult result) {
+  s_input_result = result;
+}
+
+ProcessFormatMetaFormat ProcessFormatGetMetaFormat(void) {
+  return s_meta_format;
+}
+
+ProcessFormatResult ProcessFormatGetMetaHeader(
+    ProcessFormatMetaHeader *header) {
+  *header = {};
+  snprintf(header->model_id, sizeof(header->model_id), "%s", s_model_id);
+  snprintf(header->device_id, sizeof(header->device_id), "aabbcc");
+  return ProcessFormatMetaSuccess;
+}
+
+size_t ProcessFormatMetaBinarySize(const ProcessFormatMetaHeader *header,
+                                   const ProcessFormatInference *inferences,
+                                   uint32_t num_inferences) {
+  return strlen(header->model_id) + 2 + 21 * num_inferences;
+}
+
+/* Not an envelope: "<ModelID>;<T>,<T>..." with T in milliseconds */
+ProcessFormatResult ProcessFormatMetaBinary(
+    const ProcessFormatMetaHeader *header,
+    const ProcessFormatInference *inferences, uint32_t num_inferences,
+    uint8_t *buffer, size_t buffer_size, size_t *size) {
+  char *out = (char *)buffer;
+  size_t offset = snprintf(out, buffer_size, "%s;", header->model_id);
+  for (uint32_t i = 0; i < num_inferences; ++i) {
+    offset += snprintf(out + offset, buffer_size - offset, "%s%llu",
+                       i ? "," : "",
+                       (unsigned long long)inferences[i].timestamp / 1000000);
+  }
+  *size = offset;
+  return ProcessFormatMetaSuccess;
+}
+
 ProcessFormatResult ProcessFormatMeta(void *in_data, uint32_t in_size,
                                       EdgeAppLibSendDataType datatype,
                                       uint64_t timestamp, char *json_buffer,
@@ -103,3 +149,30 @@ ProcessFormatResult ProcessFormatInput(MemoryRef data, uint32_t datalen,
     return kProcessFormatResultInvalidParam;
   }
 }
+
+ProcessFormatResult ProcessFormatInputToBuffer(
+    MemoryRef data, uint32_t datalen, ProcessFormatImageType codec_number,
+    EdgeAppLibImageProperty *image_property, void **buffer, size_t *capacity,
+    int32_t *image_size) {
+  if (s_input_result != kProcessFormatResultOk) return s_input_result;
+  if (codec_number != kProcessFormatImageTypeRaw &&
+      codec_number != kProcessFormatImageTypeJpeg) {
+    return kProcessFormatResultInvalidParam;
+  }
+  // JPEG: assume the encoded image is smaller
+  size_t size =
+      codec_number == kProcessFormatImageTypeRaw ? datalen : datalen / 2;
+  if (*buffer == nullptr || *capacity < size) {
+    free(*buffer);
+    *buffer = malloc(size);
+    if (!*buffer) return kProcessFormatResultOther;
+    *capacity = size;
+  }
+  if (codec_number == kProcessFormatImageTypeRaw) {
+    memcpy(*buffer, data.u.p, size);
+  } else {
+    memset(*buffer, 0xFF, size);
+  }
+  *image_size = size;
+  return kProcessFormatResultOk;
+}
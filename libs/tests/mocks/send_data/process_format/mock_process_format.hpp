@@ -22,5 +22,9 @@ void setProcessFormatMetaFail(ProcessFormatResult result);
 void resetProcessFormatMetaSuccess();
 
 void setProcessFormatMetaOutput(const char *model_id);
+void setProcessFormatMetaFormat(ProcessFormatMetaFormat format);
+
+/* Result of ProcessFormatInputToBuffer, kProcessFormatResultOk by default */
+void setProcessFormatInputResult(ProcessFormatResult result);
 
 #endif  // MOCKS_MOCK_PROCSS_FORMAT_HPP
@@ -21,8 +21,10 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -56,10 +58,12 @@ static int EdgeAppLibSensorGetFrameCalled = 0;
 static int EdgeAppLibSensorGetFrameSuccess = 0;
 static int EdgeAppLibSensorReleaseFrameCalled = 0;
 static int EdgeAppLibSensorReleaseFrameSuccess = 0;
+static std::atomic<int> EdgeAppLibSensorReleaseFrameCount{0};
 static int EdgeAppLibSensorStreamGetPropertyCalled = 0;
 static int EdgeAppLibSensorStreamGetPropertySuccess = 0;
 static int EdgeAppLibSensorStreamSetPropertyCalled = 0;
 static int EdgeAppLibSensorStreamSetPropertySuccess = 0;
+static void (*EdgeAppLibSensorStreamSetPropertyHook)(const char *) = nullptr;
 static int EdgeAppLibSensorFrameGetChannelFromChannelIdCalled = 0;
 static int EdgeAppLibSensorFrameGetChannelFromChannelIdSuccess = 0;
 static int EdgeAppLibSensorChannelGetRawDataCalled = 0;
@@ -87,6 +91,8 @@ typedef struct {
 } MapValue;
 
 static std::map<std::string, MapValue> property_map;
+// Frames and channels may be accessed from the EdgeAppCore pipeline thread
+static std::recursive_mutex mock_mutex;
 static uint32_t frame_number = 0;
 static float **data = nullptr;
 static uint32_t *lengths = nullptr;
@@ -272,6 +278,9 @@ int32_t SensorStreamSetProperty(EdgeAppLibSensorStream stream,
   if (EdgeAppLibSensorStreamSetPropertySuccess != 0) {
     return EdgeAppLibSensorStreamSetPropertySuccess;
   }
+  if (EdgeAppLibSensorStreamSetPropertyHook != nullptr) {
+    EdgeAppLibSensorStreamSetPropertyHook(property_key);
+  }
 
   if (std::string(property_key) ==
       std::string(AITRIOS_SENSOR_CAMERA_FRAME_RATE_PROPERTY_KEY)) {
@@ -304,6 +313,7 @@ int32_t SensorStreamSetProperty(EdgeAppLibSensorStream stream,
 int32_t SensorFrameGetChannelFromChannelId(EdgeAppLibSensorFrame frame,
                                            uint32_t channel_id,
                                            EdgeAppLibSensorChannel *channel) {
+  std::lock_guard<std::recursive_mutex> lock(mock_mutex);
   EdgeAppLibSensorFrameGetChannelFromChannelIdCalled = 1;
   if (EdgeAppLibSensorFrameGetChannelFromChannelIdSuccess != 0) {
     return EdgeAppLibSensorFrameGetChannelFromChannelIdSuccess;
@@ -320,6 +330,7 @@ int32_t SensorFrameGetChannelFromChannelId(EdgeAppLibSensorFrame frame,
 }
 int32_t SensorChannelGetRawData(EdgeAppLibSensorChannel channel,
                                 struct EdgeAppLibSensorRawData *raw_data) {
+  std::lock_guard<std::recursive_mutex> lock(mock_mutex);
   EdgeAppLibSensorChannelGetRawDataCalled = 1;
   if (EdgeAppLibSensorChannelGetRawDataSuccess != 0) {
     return EdgeAppLibSensorChannelGetRawDataSuccess;
@@ -528,6 +539,7 @@ int32_t SensorCoreOpenStream(EdgeAppLibSensorCore core, const char *stream_key,
 }
 int32_t SensorGetFrame(EdgeAppLibSensorStream stream,
                        EdgeAppLibSensorFrame *frame, int32_t timeout_msec) {
+  std::lock_guard<std::recursive_mutex> lock(mock_mutex);
   EdgeAppLibSensorGetFrameCalled = 1;
   if (EdgeAppLibSensorGetFrameSuccess != 0) {
     return EdgeAppLibSensorGetFrameSuccess;
@@ -542,6 +554,7 @@ enum EdgeAppLibSensorErrorCause SensorGetLastErrorCause(void) {
 }
 int32_t SensorReleaseFrame(EdgeAppLibSensorStream stream,
                            EdgeAppLibSensorFrame frame) {
+  std::lock_guard<std::recursive_mutex> lock(mock_mutex);
   auto channels_it = map_frame_channels.find(frame);
 
   if (channels_it != map_frame_channels.end()) {
@@ -575,6 +588,7 @@ int32_t SensorReleaseFrame(EdgeAppLibSensorStream stream,
     lengths = nullptr;
   }
   EdgeAppLibSensorReleaseFrameCalled = 1;
+  EdgeAppLibSensorReleaseFrameCount++;
   return EdgeAppLibSensorReleaseFrameSuccess;
 }
 int32_t SensorStreamGetProperty(EdgeAppLibSensorStream stream,
@@ -608,6 +622,7 @@ enum EdgeAppLibSensorErrorLevel SensorGetLastErrorLevel(void) {
 int32_t SensorChannelGetProperty(EdgeAppLibSensorChannel channel,
                                  const char *property_key, void *value,
                                  size_t value_size) {
+  std::lock_guard<std::recursive_mutex> lock(mock_mutex);
   EdgeAppLibSensorChannelGetPropertyCalled = 1;
 
   if (EdgeAppLibSensorChannelGetPropertySuccess != 0) {
@@ -796,6 +811,12 @@ void resetEdgeAppLibSensorStreamSetPropertySuccess() {
 void resetEdgeAppLibSensorStreamSetPropertyCalled() {
   EdgeAppLibSensorStreamSetPropertyCalled = 0;
 }
+void setEdgeAppLibSensorStreamSetPropertyHook(void (*hook)(const char *)) {
+  EdgeAppLibSensorStreamSetPropertyHook = hook;
+}
+void resetEdgeAppLibSensorStreamSetPropertyHook() {
+  EdgeAppLibSensorStreamSetPropertyHook = nullptr;
+}
 
 int wasEdgeAppLibSensorCoreOpenStreamCalled() {
   return EdgeAppLibSensorCoreOpenStreamCalled;
@@ -856,6 +877,12 @@ void resetEdgeAppLibSensorReleaseFrameSuccess() {
 void resetEdgeAppLibSensorReleaseFrameCalled() {
   EdgeAppLibSensorReleaseFrameCalled = 0;
 }
+int getEdgeAppLibSensorReleaseFrameCount() {
+  return EdgeAppLibSensorReleaseFrameCount;
+}
+void resetEdgeAppLibSensorReleaseFrameCount() {
+  EdgeAppLibSensorReleaseFrameCount = 0;
+}
 
 int wasEdgeAppLibSensorStreamGetPropertyCalled() {
   return EdgeAppLibSensorStreamGetPropertyCalled;
@@ -43,6 +43,8 @@ int wasEdgeAppLibSensorReleaseFrameCalled();
 void setEdgeAppLibSensorReleaseFrameFail();
 void resetEdgeAppLibSensorReleaseFrameSuccess();
 void resetEdgeAppLibSensorReleaseFrameCalled();
+int getEdgeAppLibSensorReleaseFrameCount();
+void resetEdgeAppLibSensorReleaseFrameCount();
 
 int wasEdgeAppLibSensorGetFrameCalled();
 void setEdgeAppLibSensorGetFrameFail();
@@ -86,6 +88,8 @@ int wasEdgeAppLibSensorStreamSetPropertyCalled();
 void setEdgeAppLibSensorStreamSetPropertyFail();
 void resetEdgeAppLibSensorStreamSetPropertySuccess();
 void resetEdgeAppLibSensorStreamSetPropertyCalled();
+void setEdgeAppLibSensorStreamSetPropertyHook(void (*hook)(const char *));
+void resetEdgeAppLibSensorStreamSetPropertyHook();
 
 int wasEdgeAppLibSensorCoreCloseStreamCalled();
 void setEdgeAppLibSensorCoreCloseStreamFail();
@@ -28,9 +28,11 @@ static JSON_Value *test_value = nullptr;
 static JSON_Value *test_value1 = nullptr;
 static int32_t num_of_inf = 0;
 static EdgeAppLibSensorStream mock_stream;
+static uint32_t settings_generation = 0;
 
 void setPortSettings(int method) {
   if (test_value != nullptr) json_value_free(test_value);
+  settings_generation++;
   const char *test_port_settings_template = R"({
         "metadata": {
             "method": %d,
@@ -101,6 +103,12 @@ void setPortSettingsInputTensorDisabled(void) {
                              false);
 }
 
+void setPortSettingsMetadataFormat(int method, int format) {
+  setPortSettings(method);
+  json_object_dotset_number(json_object(test_value), "metadata.format",
+                            format);
+}
+
 void resetPortSettings(void) { setPortSettings(2); }
 
 void freePortSettingsValue(void) {
@@ -135,8 +143,18 @@ void setCodecSettingsFormatValue(int num) {
   JSON_Object *test_object = json_object(test_value1);
   json_object_set_number(test_object, "format", num);
 }
+void setCodecSettingsCompression(int metadata, int input_tensor) {
+  setCodecSettingsFull();
+  JSON_Object *test_object = json_object(test_value1);
+  json_object_set_number(test_object, "metadata_compression", metadata);
+  json_object_set_number(test_object, "input_tensor_compression",
+                         input_tensor);
+}
 
 void setNumOfInfPerMsg(int num) { num_of_inf = num; }
 uint32_t getNumOfInfPerMsg(void) { return num_of_inf; }
 
 EdgeAppLibSensorStream GetSensorStream(void) { return mock_stream; }
+
+void updateSettingsGeneration(void) { settings_generation++; }
+uint32_t getSettingsGeneration(void) { return settings_generation; }
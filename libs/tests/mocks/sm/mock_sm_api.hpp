@@ -26,12 +26,15 @@ void setPortSettingsMetadataEndpoint(const char *endpoint, const char *path);
 void setPortSettingsInputTensorEndpoint(const char *endpoint, const char *path);
 void setPortSettingsMetadataDisabled(void);
 void setPortSettingsInputTensorDisabled(void);
+void setPortSettingsMetadataFormat(int method, int format);
 void resetPortSettings(void);
 void freePortSettingsValue(void);
 void setCodecSettingsFull(void);
 void resetCodecSettings(void);
 void freeCodecSettingsValue(void);
 void setCodecSettingsFormatValue(int num);
+void setCodecSettingsCompression(int metadata, int input_tensor);
 void setNumOfInfPerMsg(int num);
+void updateSettingsGeneration(void);
 
 #endif /* MOCK_AITRIOS_SM_API_H */
@@ -0,0 +1,132 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+// Native benchmark of the LZ4 codec on the sample apps test_data fixtures and
+// on a segmentation class map. Fails when a round trip differs.
+// Usage: bench_lz4_codec [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "lz4_codec.h"
+
+/* Class map of CreateSegmentationFlatbuffer: uint16_t per pixel */
+#define CLASS_MAP_WIDTH 321
+#define CLASS_MAP_HEIGHT 321
+
+static const char *const kFixtures[] = {
+    "posenet/test_data/westworld_out_w481_h353.bin",
+    "detection/test_data/output_tensor.jsonc",
+    "lp_recog/test_data/output_tensor_lpr.jsonc",
+    "classification/test_data/output_tensor.jsonc",
+};
+
+static bool ReadFile(const std::string &path, std::vector<uint8_t> &data) {
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (fp == NULL) return false;
+  fseek(fp, 0, SEEK_END);
+  data.resize(ftell(fp));
+  fseek(fp, 0, SEEK_SET);
+  bool ok = fread(data.data(), 1, data.size(), fp) == data.size();
+  fclose(fp);
+  return ok;
+}
+
+static std::vector<uint8_t> MakeClassMap() {
+  std::vector<uint16_t> map(CLASS_MAP_WIDTH * CLASS_MAP_HEIGHT);
+  for (int y = 0; y < CLASS_MAP_HEIGHT; ++y) {
+    for (int x = 0; x < CLASS_MAP_WIDTH; ++x) {
+      // Background, a road band and two blobs
+      uint16_t id = y > 200 ? 1 : 0;
+      if ((x - 100) * (x - 100) + (y - 120) * (y - 120) < 40 * 40) id = 15;
+      if ((x - 230) * (x - 230) + (y - 150) * (y - 150) < 60 * 60) id = 7;
+      map[y * CLASS_MAP_WIDTH + x] = id;
+    }
+  }
+  const uint8_t *bytes = (const uint8_t *)map.data();
+  return std::vector<uint8_t>(bytes, bytes + map.size() * sizeof(uint16_t));
+}
+
+static double MBps(size_t size, int iterations, double seconds) {
+  return seconds > 0 ? size * (double)iterations / seconds / 1e6 : 0;
+}
+
+static bool Bench(const char *name, const std::vector<uint8_t> &data,
+                  int iterations) {
+  static Lz4Compressor compressor;
+  std::vector<uint8_t> frame(LZ4_COMPRESS_BOUND(data.size()));
+  std::vector<uint8_t> out(data.size());
+
+  size_t size = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    size = lz4_compress(&compressor, data.data(), data.size(), frame.data(),
+                        frame.size());
+  }
+  double compress_s = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+  size_t out_size = 0;
+  int ret = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations && ret == 0; ++i) {
+    out_size = out.size();
+    ret = lz4_decompress(frame.data(), size, out.data(), &out_size);
+  }
+  double decompress_s = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+
+  bool pays = size <= data.size() - data.size() / 8;
+  printf("%-48s %8zu -> %8zu  ratio %5.3f  %s  %8.1f MB/s  %8.1f MB/s\n",
+         name, data.size(), size, (double)size / data.size(),
+         pays ? "auto:lz4 " : "auto:none",
+         MBps(data.size(), iterations, compress_s),
+         MBps(data.size(), iterations, decompress_s));
+  if (size == 0 || ret != 0 || out_size != data.size() || out != data) {
+    printf("  round trip differs\n");
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 200;
+  if (iterations <= 0) iterations = 1;
+
+  printf("%-48s %8s    %8s  %11s  %9s  %13s  %13s\n", "input", "size",
+         "frame", "", "", "compress", "decompress");
+  int failures = 0;
+  for (const char *fixture : kFixtures) {
+    std::vector<uint8_t> data;
+    if (!ReadFile(std::string(BENCH_DATA_DIR "/") + fixture, data)) {
+      printf("%s: cannot read\n", fixture);
+      failures++;
+      continue;
+    }
+    if (!Bench(fixture, data, iterations)) failures++;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "segmentation class map %dx%d",
+           CLASS_MAP_WIDTH, CLASS_MAP_HEIGHT);
+  if (!Bench(name, MakeClassMap(), iterations)) failures++;
+  return failures == 0 ? 0 : 1;
+}
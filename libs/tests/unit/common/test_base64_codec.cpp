@@ -0,0 +1,96 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "base64_codec.h"
+
+static std::string Encode(const std::string &in) {
+  std::string out(BASE64_ENCODED_SIZE(in.size()), '\0');
+  size_t written = base64_encode(in.data(), in.size(), &out[0]);
+  EXPECT_EQ(written, out.size());
+  return out;
+}
+
+TEST(Base64Codec, Rfc4648Vectors) {
+  EXPECT_EQ(Encode(""), "");
+  EXPECT_EQ(Encode("f"), "Zg==");
+  EXPECT_EQ(Encode("fo"), "Zm8=");
+  EXPECT_EQ(Encode("foo"), "Zm9v");
+  EXPECT_EQ(Encode("foob"), "Zm9vYg==");
+  EXPECT_EQ(Encode("fooba"), "Zm9vYmE=");
+  EXPECT_EQ(Encode("foobar"), "Zm9vYmFy");
+}
+
+TEST(Base64Codec, LongInputRoundTrip) {
+  // Long enough to go through the vectorized blocks and the scalar remainder
+  std::vector<uint8_t> data(1000);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = (i * 131 + 7) & 0xff;
+
+  for (size_t size = 0; size <= data.size(); size += 37) {
+    std::string encoded(BASE64_ENCODED_SIZE(size), '\0');
+    ASSERT_EQ(base64_encode(data.data(), size, &encoded[0]), encoded.size());
+
+    std::vector<uint8_t> decoded(size);
+    size_t decoded_size = decoded.size();
+    ASSERT_EQ(base64_decode(encoded.data(), encoded.size(), decoded.data(),
+                            &decoded_size),
+              0);
+    ASSERT_EQ(decoded_size, size);
+    EXPECT_TRUE(std::equal(decoded.begin(), decoded.end(), data.begin()));
+  }
+}
+
+TEST(Base64Codec, StreamingMatchesOneShot) {
+  std::vector<uint8_t> data(500);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = (i * 31) & 0xff;
+  std::string expected(BASE64_ENCODED_SIZE(data.size()), '\0');
+  base64_encode(data.data(), data.size(), &expected[0]);
+
+  for (size_t chunk : {1, 2, 3, 5, 16, 47, 64}) {
+    std::string out(expected.size(), '\0');
+    Base64Encoder encoder;
+    base64_encoder_init(&encoder);
+    size_t written = 0;
+    for (size_t pos = 0; pos < data.size(); pos += chunk) {
+      size_t n = std::min(chunk, data.size() - pos);
+      written +=
+          base64_encoder_update(&encoder, &data[pos], n, &out[written]);
+    }
+    written += base64_encoder_final(&encoder, &out[written]);
+    EXPECT_EQ(written, expected.size()) << "chunk " << chunk;
+    EXPECT_EQ(out, expected) << "chunk " << chunk;
+  }
+}
+
+TEST(Base64Codec, DecodeRejectsInvalidInput) {
+  uint8_t out[16];
+  size_t out_size = sizeof(out);
+  EXPECT_EQ(base64_decode("Zm9", 3, out, &out_size), -1);
+  out_size = sizeof(out);
+  EXPECT_EQ(base64_decode("Zm9*", 4, out, &out_size), -1);
+  out_size = sizeof(out);
+  EXPECT_EQ(base64_decode("Z===", 4, out, &out_size), -1);
+  out_size = 2;
+  EXPECT_EQ(base64_decode("Zm9v", 4, out, &out_size), -1);
+  out_size = sizeof(out);
+  EXPECT_EQ(base64_decode("Zm8=", 4, out, &out_size), 0);
+  EXPECT_EQ(out_size, 2);
+  EXPECT_EQ(std::string((char *)out, out_size), "fo");
+}
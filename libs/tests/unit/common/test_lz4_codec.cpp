@@ -0,0 +1,145 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "lz4_codec.h"
+
+static Lz4Compressor s_compressor;
+
+static std::vector<uint8_t> Compress(const std::vector<uint8_t> &in) {
+  std::vector<uint8_t> out(LZ4_COMPRESS_BOUND(in.size()));
+  size_t size =
+      lz4_compress(&s_compressor, in.data(), in.size(), out.data(), out.size());
+  EXPECT_GT(size, 0);
+  out.resize(size);
+  return out;
+}
+
+static void ExpectRoundTrip(const std::vector<uint8_t> &in) {
+  std::vector<uint8_t> frame = Compress(in);
+  std::vector<uint8_t> out(in.size());
+  size_t out_size = out.size();
+  ASSERT_EQ(lz4_decompress(frame.data(), frame.size(), out.data(), &out_size),
+            0);
+  ASSERT_EQ(out_size, in.size());
+  EXPECT_EQ(out, in);
+}
+
+TEST(Lz4Codec, RoundTrip) {
+  // Empty, all literals, and with matches of every length encoding
+  for (size_t size : {0, 1, 12, 13, 100, 1000, 70000}) {
+    std::vector<uint8_t> repeated(size);
+    for (size_t i = 0; i < size; ++i) repeated[i] = "EdgeApp!"[i % 8];
+    ExpectRoundTrip(repeated);
+
+    std::vector<uint8_t> noise(size);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < size; ++i) {
+      seed = seed * 1103515245 + 12345;
+      noise[i] = seed >> 24;
+    }
+    ExpectRoundTrip(noise);
+  }
+}
+
+TEST(Lz4Codec, SeveralBlocks) {
+  // A class map: runs of a few values, over 2 blocks and a half
+  std::vector<uint8_t> map(LZ4_BLOCK_SIZE * 5 / 2);
+  for (size_t i = 0; i < map.size(); ++i) map[i] = (i / 4000) % 21;
+  std::vector<uint8_t> frame = Compress(map);
+  EXPECT_LT(frame.size(), map.size() / 100);
+  ExpectRoundTrip(map);
+}
+
+TEST(Lz4Codec, IncompressibleBlocksAreStored) {
+  std::vector<uint8_t> noise(5000);
+  uint32_t seed = 7;
+  for (size_t i = 0; i < noise.size(); ++i) {
+    seed = seed * 1103515245 + 12345;
+    noise[i] = seed >> 24;
+  }
+  std::vector<uint8_t> frame = Compress(noise);
+  EXPECT_EQ(frame.size(), LZ4_COMPRESS_BOUND(noise.size()));
+  // Block size with the high bit set
+  EXPECT_EQ(frame[10], 0x80);
+}
+
+TEST(Lz4Codec, CompressStopsAtCapacity) {
+  std::vector<uint8_t> data(1000, 'a');
+  std::vector<uint8_t> out(LZ4_COMPRESS_BOUND(data.size()));
+  size_t size = lz4_compress(&s_compressor, data.data(), data.size(),
+                             out.data(), out.size());
+  ASSERT_GT(size, 0);
+  EXPECT_EQ(lz4_compress(&s_compressor, data.data(), data.size(), out.data(),
+                         size - 1),
+            0);
+  EXPECT_EQ(lz4_compress(&s_compressor, data.data(), data.size(), out.data(),
+                         size),
+            size);
+  EXPECT_EQ(lz4_compress(&s_compressor, data.data(), 0, out.data(), 10), 0);
+}
+
+TEST(Lz4Codec, DecompressReferenceFrame) {
+  // `lz4` command line output, with a content checksum
+  const uint8_t frame[] = {0x04, 0x22, 0x4d, 0x18, 0x64, 0x40, 0xa7, 0x12,
+                           0x00, 0x00, 0x00, 0x8f, 0x45, 0x64, 0x67, 0x65,
+                           0x41, 0x70, 0x70, 0x20, 0x08, 0x00, 0x18, 0x50,
+                           0x65, 0x41, 0x70, 0x70, 0x21, 0x00, 0x00, 0x00,
+                           0x00, 0xf0, 0xc1, 0xda, 0xba};
+  char out[64];
+  size_t out_size = sizeof(out);
+  ASSERT_EQ(lz4_decompress(frame, sizeof(frame), out, &out_size), 0);
+  std::string expected;
+  for (int i = 0; i < 7; ++i) expected += "EdgeApp ";
+  expected.back() = '!';
+  EXPECT_EQ(std::string(out, out_size), expected);
+}
+
+TEST(Lz4Codec, DecompressRejectsInvalidInput) {
+  std::vector<uint8_t> data(200);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = i % 10;
+  std::vector<uint8_t> frame = Compress(data);
+  std::vector<uint8_t> out(data.size());
+  size_t out_size;
+
+  out_size = out.size() - 1;
+  EXPECT_EQ(lz4_decompress(frame.data(), frame.size(), out.data(), &out_size),
+            -1);
+  out_size = out.size();
+  EXPECT_EQ(
+      lz4_decompress(frame.data(), frame.size() - 1, out.data(), &out_size),
+      -1);
+
+  std::vector<uint8_t> bad_magic = frame;
+  bad_magic[0] ^= 1;
+  out_size = out.size();
+  EXPECT_EQ(lz4_decompress(bad_magic.data(), bad_magic.size(), out.data(),
+                           &out_size),
+            -1);
+
+  // First sequence: 10 literals, then an offset past the start of the block
+  std::vector<uint8_t> bad_offset = frame;
+  ASSERT_EQ(bad_offset[11] >> 4, 10);
+  bad_offset[22] = 11;
+  out_size = out.size();
+  EXPECT_EQ(lz4_decompress(bad_offset.data(), bad_offset.size(), out.data(),
+                           &out_size),
+            -1);
+}
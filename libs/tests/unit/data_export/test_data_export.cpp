@@ -20,11 +20,13 @@
 #include "context.hpp"
 #include "data_export.h"
 #include "data_export_private.h"
+#include "dtdl_model/properties.h"
 #include "evp/mock_evp.hpp"
 #include "fixtures/data_export_fixture.hpp"
 #include "log.h"
 #include "map.hpp"
 #include "memory_manager.hpp"
+#include "process_format.hpp"
 #include "sm/mock_sm_api.hpp"
 #include "sm_api.hpp"
 
@@ -283,6 +285,49 @@ TEST_F(EdgeAppLibDataExportApiTest, BlockingAwaitEnqueued) {
   free(dummy_data.array);
 }
 
+static void RecordCompletion(EdgeAppLibDataExportResult result,
+                             void *user_data) {
+  *(EdgeAppLibDataExportResult *)user_data = result;
+}
+
+TEST_F(EdgeAppLibDataExportApiTest, CompletionCallbackAlreadyProcessed) {
+  dummy_data = getDummyData(5);
+  EdgeAppLibDataExportFuture *future = DataExportSendData(
+      PORTNAME_META, EdgeAppLibDataExportMetadata, (void *)dummy_data.array,
+      dummy_data.size, dummy_data.timestamp);
+  ASSERT_TRUE(future->is_processed);
+
+  EdgeAppLibDataExportResult completed = EdgeAppLibDataExportResultEnqueued;
+  DataExportSetCompletionCallback(future, RecordCompletion, &completed);
+  EXPECT_EQ(completed, future->result);
+
+  DataExportCleanup(future);
+  free(dummy_data.array);
+}
+
+TEST_F(EdgeAppLibDataExportApiTest, CompletionCallbackFromEventProcessing) {
+  dummy_data = getDummyData(5);
+  Mock_SetCallbackTest(0);
+  EdgeAppLibDataExportFuture *future = DataExportSendData(
+      PORTNAME_META, EdgeAppLibDataExportMetadata, (void *)dummy_data.array,
+      dummy_data.size, dummy_data.timestamp);
+  ASSERT_EQ(future->result, EdgeAppLibDataExportResultEnqueued);
+
+  EdgeAppLibDataExportResult completed = EdgeAppLibDataExportResultEnqueued;
+  DataExportSetCompletionCallback(future, RecordCompletion, &completed);
+  EXPECT_EQ(completed, EdgeAppLibDataExportResultEnqueued);
+  // The future is released by the EVP callback
+  DataExportCleanup(future);
+  EXPECT_TRUE(DataExportHasPendingOperations());
+
+  EVP_processEvent((struct EVP_client *)evp_client, 0);
+  EXPECT_NE(completed, EdgeAppLibDataExportResultEnqueued);
+  EXPECT_FALSE(DataExportHasPendingOperations());
+
+  Mock_SetCallbackTest(1);
+  free(dummy_data.array);
+}
+
 TEST_F(EdgeAppLibDataExportApiTest, SendDataEnqueues) {
   EdgeAppLibDataExportResult res = DataExportInitialize(context, evp_client);
   dummy_data = getDummyData(5);
@@ -404,6 +449,58 @@ TEST_F(EdgeAppLibDataExportApiTest, SendDataMetadataUsesCorrectEndpoint) {
   free(dummy_data.array);
 }
 
+TEST_F(EdgeAppLibDataExportApiTest, SendDataCompressed) {
+  DataExportInitialize(context, evp_client);
+  ProcessFormatResetCompressionStats();
+  setPortSettingsMetadataEndpoint("my_metadata_endpoint", "my_metadata_path");
+  setCodecSettingsCompression(COMPRESSION_LZ4, COMPRESSION_LZ4_AUTO);
+  dummy_data = getDummyData(5);
+  EdgeAppLibDataExportFuture *future =
+      DataExportSendData(PORTNAME_META, EdgeAppLibDataExportMetadata,
+                         (void *)dummy_data.array, dummy_data.size, 0);
+  EXPECT_EQ(future->result, EdgeAppLibDataExportResultSuccess);
+  EXPECT_STREQ(
+      getEvpBlobOperationRequestedUrl(),
+      "my_metadata_endpoint/my_metadata_path/19700101000000000.txt.lz4");
+  DataExportCleanup(future);
+  free(dummy_data.array);
+
+  // Too small to pay off in auto mode
+  setPortSettingsInputTensorEndpoint("my_input_tensor_endpoint",
+                                     "my_input_tensor_path");
+  dummy_data = getDummyData(5);
+  future = DataExportSendData(PORTNAME_META, EdgeAppLibDataExportRaw,
+                              (void *)dummy_data.array, dummy_data.size, 0);
+  EXPECT_EQ(future->result, EdgeAppLibDataExportResultSuccess);
+  EXPECT_STREQ(
+      getEvpBlobOperationRequestedUrl(),
+      "my_input_tensor_endpoint/my_input_tensor_path/19700101000000000.jpg");
+  DataExportCleanup(future);
+
+  ProcessFormatCompressionStats stats;
+  ProcessFormatGetCompressionStats(kProcessFormatPortMetadata, &stats);
+  EXPECT_EQ(stats.compressed, 1);
+  EXPECT_EQ(stats.in_bytes, dummy_data.size);
+  EXPECT_GT(stats.out_bytes, dummy_data.size);
+  ProcessFormatGetCompressionStats(kProcessFormatPortInputTensor, &stats);
+  EXPECT_EQ(stats.skipped, 1);
+  EXPECT_EQ(stats.out_bytes, dummy_data.size);
+
+  // Telemetry is not compressed
+  setPortSettings(0);
+  dummy_data = getDummyData(5);
+  future = DataExportSendData(PORTNAME_META, EdgeAppLibDataExportMetadata,
+                              (void *)dummy_data.array, dummy_data.size, 0);
+  EXPECT_EQ(future->result, EdgeAppLibDataExportResultSuccess);
+  DataExportCleanup(future);
+  free(dummy_data.array);
+  ProcessFormatGetCompressionStats(kProcessFormatPortMetadata, &stats);
+  EXPECT_EQ(stats.compressed, 1);
+
+  resetCodecSettings();
+  resetPortSettings();
+}
+
 TEST_F(EdgeAppLibDataExportApiTest, SendDataMetadataUsesTelemetry) {
   EdgeAppLibDataExportResult res = DataExportInitialize(context, evp_client);
   dummy_data = getDummyData(5);
@@ -509,6 +606,14 @@ TEST_F(CommonTest, FileSuffix) {
   ASSERT_STREQ(str, ".bmp");
   DataExportFileSuffix(str, sizeof(str), EdgeAppLibDataExportMetadata);
   ASSERT_STREQ(str, ".txt");
+  setPortSettingsMetadataFormat(2, 1);
+  DataExportFileSuffix(str, sizeof(str), EdgeAppLibDataExportMetadata);
+  ASSERT_STREQ(str, ".bin");
+  // binary metadata is not sent over MQTT
+  setPortSettingsMetadataFormat(0, 1);
+  DataExportFileSuffix(str, sizeof(str), EdgeAppLibDataExportMetadata);
+  ASSERT_STREQ(str, ".txt");
+  resetPortSettings();
 }
 
 TEST_F(EdgeAppLibDataExportApiTest, SendDataMetadataUsesTelemetryFail) {
@@ -0,0 +1,109 @@
+/****************************************************************************
+ * Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+// Native benchmark of the draw operations on full sensor frames, for each
+// number of threads. Fails when the results depend on the number of threads.
+// Usage: bench_draw [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "draw.h"
+
+#define BENCH_WIDTH 2028
+#define BENCH_HEIGHT 1520
+
+struct BenchCase {
+  const char *name;
+  EdgeAppLibDrawFormat format;
+  uint32_t width;
+  uint32_t height;
+  bool crop;
+};
+
+static EdgeAppLibDrawBuffer MakeBuffer(EdgeAppLibDrawFormat format,
+                                       uint32_t width, uint32_t height,
+                                       std::vector<uint8_t> &data) {
+  EdgeAppLibDrawBuffer buffer{};
+  buffer.format = format;
+  buffer.width = width;
+  buffer.height = height;
+  buffer.stride_byte =
+      format == AITRIOS_DRAW_FORMAT_RGB8 ? width * 3 : width;
+  buffer.size = width * height * 3;
+  data.resize(buffer.size);
+  buffer.address = data.data();
+  return buffer;
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 20;
+  if (iterations <= 0) iterations = 1;
+
+  const BenchCase cases[] = {
+      {"resize area  RGB8   2028x1520 -> 300x300",
+       AITRIOS_DRAW_FORMAT_RGB8, 300, 300, false},
+      {"resize bilin RGB8   2028x1520 -> 1280x960",
+       AITRIOS_DRAW_FORMAT_RGB8, 1280, 960, false},
+      {"resize area  PLANAR 2028x1520 -> 640x480",
+       AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 640, 480, false},
+      {"crop         RGB8   1600x1200 of 2028x1520",
+       AITRIOS_DRAW_FORMAT_RGB8, 1600, 1200, true},
+  };
+  const uint32_t threads[] = {1, 2, 4, AITRIOS_DRAW_MAX_THREADS};
+
+  int failures = 0;
+  for (const BenchCase &c : cases) {
+    std::vector<uint8_t> src_data;
+    EdgeAppLibDrawBuffer src =
+        MakeBuffer(c.format, BENCH_WIDTH, BENCH_HEIGHT, src_data);
+    for (size_t i = 0; i < src_data.size(); ++i) {
+      src_data[i] = static_cast<uint8_t>((i * 7919) % 251);
+    }
+    std::vector<uint8_t> reference;
+    for (uint32_t t : threads) {
+      if (SetDrawThreads(t) != 0) return 1;
+      std::vector<uint8_t> dst_data;
+      EdgeAppLibDrawBuffer dst =
+          MakeBuffer(c.format, c.width, c.height, dst_data);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i) {
+        int32_t ret = c.crop ? CropRectangle(&src, &dst, 200, 100,
+                                             200 + c.width - 1,
+                                             100 + c.height - 1)
+                             : ResizeRectangle(&src, &dst);
+        if (ret != 0) return 1;
+      }
+      double ms = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count() /
+                  iterations;
+      printf("%s  threads=%u  %8.3f ms\n", c.name, t, ms);
+      if (reference.empty()) {
+        reference = dst_data;
+      } else if (reference != dst_data) {
+        printf("  result differs from threads=1\n");
+        failures++;
+      }
+    }
+  }
+  SetDrawThreads(1);
+  return failures == 0 ? 0 : 1;
+}
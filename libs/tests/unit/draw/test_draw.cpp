@@ -14,9 +14,12 @@
  * limitations under the License.
  ****************************************************************************/
 
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <vector>
+
 #include "draw.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -186,6 +189,27 @@ TEST_F(EdgeAppLibDrawApiTest, CropOutOfBoundsClamped_RGB8) {
   delete[] reinterpret_cast<uint8_t *>(dst.address);
 }
 
+TEST_F(EdgeAppLibDrawApiTest, CropRegion_RGB8Planar) {
+  // 4x3 planes, component value = plane * 100 + y * 4 + x
+  uint8_t src_data[4 * 3 * 3];
+  for (int i = 0; i < 36; ++i) src_data[i] = (i / 12) * 100 + (i % 12);
+  EdgeAppLibDrawBuffer src = {src_data, sizeof(src_data),
+                              AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 4, 3, 4};
+  uint8_t dst_data[3 * 2 * 3] = {0};
+  EdgeAppLibDrawBuffer dst = {dst_data, sizeof(dst_data),
+                              AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 3, 2, 3};
+
+  ASSERT_EQ(CropRectangle(&src, &dst, 1, 1, 3, 2), 0);
+  for (int p = 0; p < 3; ++p) {
+    for (int y = 0; y < 2; ++y) {
+      for (int x = 0; x < 3; ++x) {
+        EXPECT_EQ(dst_data[p * 6 + y * 3 + x],
+                  p * 100 + (y + 1) * 4 + (x + 1));
+      }
+    }
+  }
+}
+
 TEST_F(EdgeAppLibDrawApiTest, NullSourceBufferPointer) {
   // Destination buffer with valid allocation
   EdgeAppLibDrawBuffer dst{};
@@ -530,7 +554,7 @@ TEST_F(EdgeAppLibDrawApiTest,
 }
 
 TEST_F(EdgeAppLibDrawApiTest, ResizeRectangleBilinear_FailureCases) {
-  // Format mismatch
+  // Unsupported destination format
   EdgeAppLibDrawBuffer src{};
   src.width = 2;
   src.height = 2;
@@ -542,9 +566,9 @@ TEST_F(EdgeAppLibDrawApiTest, ResizeRectangleBilinear_FailureCases) {
   EdgeAppLibDrawBuffer dst{};
   dst.width = 4;
   dst.height = 4;
-  dst.format = AITRIOS_DRAW_FORMAT_RGB8_PLANAR;  // mismatch on purpose
+  dst.format = AITRIOS_DRAW_FORMAT_NV12;  // YUV is source only
   dst.stride_byte = 4;
-  dst.size = dst.stride_byte * dst.height * 3;
+  dst.size = dst.stride_byte * dst.height * 3 / 2;
   dst.address = new uint8_t[dst.size];
 
   EXPECT_EQ(ResizeRectangle(&src, &dst), -1);
@@ -565,4 +589,453 @@ TEST_F(EdgeAppLibDrawApiTest, ResizeRectangleBilinear_FailureCases) {
   delete[] reinterpret_cast<uint8_t *>(src.address);
   delete[] reinterpret_cast<uint8_t *>(dst.address);
 }
+// Float bilinear with pixel-center mapping, the reference of the fixed-point
+// implementation
+static uint8_t ReferenceBilinear(const uint8_t *s, uint32_t stride,
+                                 uint32_t w, uint32_t h, float sx, float sy,
+                                 int c) {
+  int x0 = static_cast<int>(floorf(sx)), y0 = static_cast<int>(floorf(sy));
+  float wx = sx - x0, wy = sy - y0;
+  if (x0 < 0) x0 = 0, wx = 0.0f;
+  if (y0 < 0) y0 = 0, wy = 0.0f;
+  int x1 = x0 + 1 < static_cast<int>(w) ? x0 + 1 : w - 1;
+  int y1 = y0 + 1 < static_cast<int>(h) ? y0 + 1 : h - 1;
+  auto at = [&](int x, int y) { return s[y * stride + x * 3 + c]; };
+  float v = (at(x0, y0) * (1 - wx) + at(x1, y0) * wx) * (1 - wy) +
+            (at(x0, y1) * (1 - wx) + at(x1, y1) * wx) * wy;
+  return static_cast<uint8_t>(v + 0.5f);
+}
+
+TEST_F(EdgeAppLibDrawApiTest, ResizeRectangleBilinear_MatchesFloatReference) {
+  EdgeAppLibDrawBuffer src{};
+  src.width = 37;
+  src.height = 23;
+  src.format = AITRIOS_DRAW_FORMAT_RGB8;
+  src.stride_byte = 37 * 3 + 5;
+  src.size = src.stride_byte * src.height;
+  std::vector<uint8_t> s(src.size);
+  for (size_t i = 0; i < s.size(); ++i) s[i] = (i * 7919) % 251;
+  src.address = s.data();
+
+  const uint32_t sizes[2][2] = {{50, 31}, {29, 17}};  // Up and down
+  for (auto &size : sizes) {
+    EdgeAppLibDrawBuffer dst{};
+    dst.width = size[0];
+    dst.height = size[1];
+    dst.format = AITRIOS_DRAW_FORMAT_RGB8;
+    dst.stride_byte = dst.width * 3;
+    dst.size = dst.stride_byte * dst.height;
+    std::vector<uint8_t> d(dst.size);
+    dst.address = d.data();
+    ASSERT_EQ(ResizeRectangle(&src, &dst), 0);
+
+    const float scale_x = 37.0f / dst.width, scale_y = 23.0f / dst.height;
+    for (uint32_t y = 0; y < dst.height; ++y) {
+      for (uint32_t x = 0; x < dst.width; ++x) {
+        for (int c = 0; c < 3; ++c) {
+          uint8_t expected = ReferenceBilinear(
+              s.data(), src.stride_byte, src.width, src.height,
+              (x + 0.5f) * scale_x - 0.5f, (y + 0.5f) * scale_y - 0.5f, c);
+          EXPECT_NEAR(d[y * dst.stride_byte + x * 3 + c], expected, 1)
+              << x << "," << y << "," << c;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(EdgeAppLibDrawApiTest, ResizeRectangleArea_Downscale) {
+  // 4x3 blocks of 12 pixels each
+  EdgeAppLibDrawBuffer src{};
+  src.width = 8;
+  src.height = 6;
+  src.format = AITRIOS_DRAW_FORMAT_RGB8;
+  src.stride_byte = 8 * 3;
+  src.size = src.stride_byte * src.height;
+  std::vector<uint8_t> s(src.size);
+  for (uint32_t y = 0; y < 6; ++y) {
+    for (uint32_t x = 0; x < 8; ++x) {
+      uint8_t *p = &s[y * src.stride_byte + x * 3];
+      p[0] = (x / 4) * 100 + (y / 3) * 50;
+      p[1] = x % 2 ? 10 : 20;  // Averages to 15 over a block
+      p[2] = 255;
+    }
+  }
+  src.address = s.data();
+
+  EdgeAppLibDrawBuffer dst{};
+  dst.width = 2;
+  dst.height = 2;
+  dst.format = AITRIOS_DRAW_FORMAT_RGB8;
+  dst.stride_byte = 2 * 3;
+  dst.size = dst.stride_byte * dst.height;
+  std::vector<uint8_t> d(dst.size);
+  dst.address = d.data();
+  ASSERT_EQ(ResizeRectangle(&src, &dst), 0);
+  for (uint32_t y = 0; y < 2; ++y) {
+    for (uint32_t x = 0; x < 2; ++x) {
+      const uint8_t *p = &d[y * dst.stride_byte + x * 3];
+      EXPECT_EQ(p[0], x * 100 + y * 50);
+      EXPECT_EQ(p[1], 15);
+      EXPECT_EQ(p[2], 255);
+    }
+  }
+
+  // Planar: each plane is averaged on its own
+  EdgeAppLibDrawBuffer planar = src;
+  planar.format = AITRIOS_DRAW_FORMAT_RGB8_PLANAR;
+  planar.stride_byte = 8;
+  planar.size = 8 * 6 * 3;
+  std::vector<uint8_t> sp(planar.size);
+  for (size_t i = 0; i < sp.size(); ++i) sp[i] = i < 48 ? 4 : (i < 96 ? 8 : 12);
+  planar.address = sp.data();
+  EdgeAppLibDrawBuffer planar_dst = dst;
+  planar_dst.format = AITRIOS_DRAW_FORMAT_RGB8_PLANAR;
+  planar_dst.stride_byte = 2;
+  ASSERT_EQ(ResizeRectangle(&planar, &planar_dst), 0);
+  for (int i = 0; i < 12; ++i) EXPECT_EQ(d[i], 4 * (i / 4 + 1));
+}
+
+TEST_F(EdgeAppLibDrawApiTest, DrawThreadsMatchSingleThread) {
+  EdgeAppLibDrawBuffer src{};
+  src.width = 1280;
+  src.height = 960;
+  src.format = AITRIOS_DRAW_FORMAT_RGB8;
+  src.stride_byte = src.width * 3;
+  src.size = src.stride_byte * src.height;
+  std::vector<uint8_t> s(src.size);
+  for (size_t i = 0; i < s.size(); ++i) s[i] = (i * 7919) % 251;
+  src.address = s.data();
+
+  // Bilinear, area averaging and crop
+  const uint32_t sizes[3][2] = {{800, 600}, {300, 300}, {640, 480}};
+  std::vector<uint8_t> results[2][3];
+  const uint32_t threads[2] = {1, 4};
+  for (int t = 0; t < 2; ++t) {
+    ASSERT_EQ(SetDrawThreads(threads[t]), 0);
+    for (int i = 0; i < 3; ++i) {
+      EdgeAppLibDrawBuffer dst{};
+      dst.width = sizes[i][0];
+      dst.height = sizes[i][1];
+      dst.format = AITRIOS_DRAW_FORMAT_RGB8;
+      dst.stride_byte = dst.width * 3;
+      dst.size = dst.stride_byte * dst.height;
+      results[t][i].resize(dst.size);
+      dst.address = results[t][i].data();
+      if (i < 2) {
+        ASSERT_EQ(ResizeRectangle(&src, &dst), 0);
+      } else {
+        ASSERT_EQ(CropRectangle(&src, &dst, 100, 50, 739, 529), 0);
+      }
+    }
+  }
+  for (int i = 0; i < 3; ++i) EXPECT_EQ(results[0][i], results[1][i]) << i;
+  EXPECT_EQ(results[1][2][0], s[50 * src.stride_byte + 100 * 3]);
+
+  EXPECT_EQ(SetDrawThreads(0), -1);
+  EXPECT_EQ(SetDrawThreads(AITRIOS_DRAW_MAX_THREADS + 1), -1);
+  EXPECT_EQ(SetDrawThreads(1), 0);
+}
+
 // ===================== End of ResizeRectangle tests =====================
+
+TEST_F(EdgeAppLibDrawApiTest, ConvertFormat_YuvToRgb) {
+  // NV12 2x2: luma 16..235 with neutral chroma is black to white
+  uint8_t nv12[2 * 2 + 2] = {16, 235, 81, 145, 128, 128};
+  EdgeAppLibDrawBuffer src = {nv12, sizeof(nv12), AITRIOS_DRAW_FORMAT_NV12,
+                              2, 2, 0};
+  uint8_t rgb[2 * 2 * 3] = {0};
+  EdgeAppLibDrawBuffer dst = {rgb, sizeof(rgb), AITRIOS_DRAW_FORMAT_RGB8, 2,
+                              2, 0};
+  ASSERT_EQ(ConvertFormat(&src, &dst), 0);
+  const uint8_t gray[4] = {0, 255, 76, 150};
+  for (int i = 0; i < 12; ++i) EXPECT_EQ(rgb[i], gray[i / 3]) << i;
+
+  // I420 2x2 of BT.601 red
+  uint8_t i420[2 * 2 + 2] = {81, 81, 81, 81, 90, 240};
+  src = {i420, sizeof(i420), AITRIOS_DRAW_FORMAT_I420, 2, 2, 0};
+  ASSERT_EQ(ConvertFormat(&src, &dst), 0);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(rgb[i * 3 + 0], 255);
+    EXPECT_EQ(rgb[i * 3 + 1], 0);
+    EXPECT_EQ(rgb[i * 3 + 2], 0);
+  }
+
+  // Odd YUV size, YUV destination and size mismatch
+  src = {nv12, sizeof(nv12), AITRIOS_DRAW_FORMAT_NV12, 1, 2, 3};
+  EXPECT_EQ(ConvertFormat(&src, &dst), -1);
+  src = {nv12, sizeof(nv12), AITRIOS_DRAW_FORMAT_NV12, 2, 2, 0};
+  EXPECT_EQ(ConvertFormat(&dst, &src), -1);
+  dst = {rgb, 6, AITRIOS_DRAW_FORMAT_RGB8, 2, 1, 0};
+  EXPECT_EQ(ConvertFormat(&src, &dst), -1);
+}
+
+TEST_F(EdgeAppLibDrawApiTest, ConvertFormat_RgbLayouts) {
+  // 3x2 RGB8 with padding
+  const uint32_t stride = 3 * 3 + 2;
+  uint8_t rgb[stride * 2];
+  for (uint32_t i = 0; i < sizeof(rgb); ++i) rgb[i] = i * 11;
+  EdgeAppLibDrawBuffer src = {rgb, sizeof(rgb), AITRIOS_DRAW_FORMAT_RGB8, 3,
+                              2, stride};
+
+  uint8_t bgr[3 * 2 * 3], planar[3 * 2 * 3], gray[3 * 2];
+  EdgeAppLibDrawBuffer bgr_buffer = {bgr, sizeof(bgr),
+                                     AITRIOS_DRAW_FORMAT_BGR8, 3, 2, 0};
+  EdgeAppLibDrawBuffer planar_buffer = {
+      planar, sizeof(planar), AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 3, 2, 0};
+  EdgeAppLibDrawBuffer gray_buffer = {gray, sizeof(gray),
+                                      AITRIOS_DRAW_FORMAT_GRAY8, 3, 2, 0};
+  ASSERT_EQ(ConvertFormat(&src, &bgr_buffer), 0);
+  ASSERT_EQ(ConvertFormat(&src, &planar_buffer), 0);
+  ASSERT_EQ(ConvertFormat(&src, &gray_buffer), 0);
+  for (uint32_t y = 0; y < 2; ++y) {
+    for (uint32_t x = 0; x < 3; ++x) {
+      const uint8_t *p = rgb + y * stride + x * 3;
+      uint32_t i = y * 3 + x;
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_EQ(bgr[i * 3 + c], p[2 - c]);
+        EXPECT_EQ(planar[c * 6 + i], p[c]);
+      }
+      EXPECT_EQ(gray[i], (77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+  }
+
+  // Back to RGB8, padding untouched
+  uint8_t back[stride * 2];
+  memset(back, 0xAA, sizeof(back));
+  EdgeAppLibDrawBuffer back_buffer = {back, sizeof(back),
+                                      AITRIOS_DRAW_FORMAT_RGB8, 3, 2, stride};
+  ASSERT_EQ(ConvertFormat(&planar_buffer, &back_buffer), 0);
+  for (uint32_t y = 0; y < 2; ++y) {
+    EXPECT_EQ(memcmp(back + y * stride, rgb + y * stride, 9), 0);
+    EXPECT_EQ(back[y * stride + 9], 0xAA);
+  }
+  memset(back, 0, sizeof(back));
+  ASSERT_EQ(ConvertFormat(&bgr_buffer, &back_buffer), 0);
+  for (uint32_t y = 0; y < 2; ++y) {
+    EXPECT_EQ(memcmp(back + y * stride, rgb + y * stride, 9), 0);
+  }
+}
+
+TEST_F(EdgeAppLibDrawApiTest, CropAndResizeWithConversion) {
+  // Fused conversion matches converting first
+  const uint32_t w = 16, h = 12;
+  std::vector<uint8_t> yuv(w * h * 3 / 2);
+  for (size_t i = 0; i < yuv.size(); ++i) yuv[i] = 16 + (i * 37) % 224;
+  EdgeAppLibDrawBuffer src = {yuv.data(), yuv.size(),
+                              AITRIOS_DRAW_FORMAT_NV12, w, h, 0};
+  std::vector<uint8_t> rgb(w * h * 3);
+  EdgeAppLibDrawBuffer rgb_buffer = {rgb.data(), rgb.size(),
+                                     AITRIOS_DRAW_FORMAT_RGB8, w, h, 0};
+  ASSERT_EQ(ConvertFormat(&src, &rgb_buffer), 0);
+
+  // Crop to planar
+  std::vector<uint8_t> expected(5 * 4 * 3), actual(5 * 4 * 3);
+  std::vector<uint8_t> crop(5 * 4 * 3);
+  EdgeAppLibDrawBuffer crop_buffer = {crop.data(), crop.size(),
+                                      AITRIOS_DRAW_FORMAT_RGB8, 5, 4, 0};
+  EdgeAppLibDrawBuffer expected_buffer = {
+      expected.data(), expected.size(), AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 5, 4,
+      0};
+  EdgeAppLibDrawBuffer actual_buffer = {actual.data(), actual.size(),
+                                        AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 5, 4,
+                                        0};
+  ASSERT_EQ(CropRectangle(&rgb_buffer, &crop_buffer, 3, 5, 7, 8), 0);
+  ASSERT_EQ(ConvertFormat(&crop_buffer, &expected_buffer), 0);
+  ASSERT_EQ(CropRectangle(&src, &actual_buffer, 3, 5, 7, 8), 0);
+  EXPECT_EQ(actual, expected);
+
+  // Bilinear and area resizes to planar
+  const uint32_t sizes[2][2] = {{24, 20}, {5, 4}};
+  for (int i = 0; i < 2; ++i) {
+    const uint32_t dw = sizes[i][0], dh = sizes[i][1];
+    std::vector<uint8_t> resized(dw * dh * 3);
+    EdgeAppLibDrawBuffer resized_buffer = {
+        resized.data(), resized.size(), AITRIOS_DRAW_FORMAT_RGB8, dw, dh, 0};
+    expected.assign(dw * dh * 3, 0);
+    actual.assign(dw * dh * 3, 0);
+    expected_buffer = {expected.data(), expected.size(),
+                       AITRIOS_DRAW_FORMAT_RGB8_PLANAR, dw, dh, 0};
+    actual_buffer = {actual.data(), actual.size(),
+                     AITRIOS_DRAW_FORMAT_RGB8_PLANAR, dw, dh, 0};
+    ASSERT_EQ(ResizeRectangle(&rgb_buffer, &resized_buffer), 0);
+    ASSERT_EQ(ConvertFormat(&resized_buffer, &expected_buffer), 0);
+    ASSERT_EQ(ResizeRectangle(&src, &actual_buffer), 0);
+    EXPECT_EQ(actual, expected) << i;
+  }
+}
+
+TEST_F(EdgeAppLibDrawApiTest, LetterboxRectangle_PadsAndResizes) {
+  EdgeAppLibLetterbox lb;
+  ComputeLetterbox(640, 480, 320, 320, &lb);
+  EXPECT_FLOAT_EQ(lb.scale, 0.5f);
+  EXPECT_EQ(lb.left, 0u);
+  EXPECT_EQ(lb.top, 40u);
+  EXPECT_EQ(lb.width, 320u);
+  EXPECT_EQ(lb.height, 240u);
+  ComputeLetterbox(0, 480, 320, 320, &lb);
+  EXPECT_EQ(lb.width, 0u);
+
+  // 8x4 RGB8 into 6x6: padded above and below
+  std::vector<uint8_t> s(8 * 4 * 3);
+  for (size_t i = 0; i < s.size(); ++i) s[i] = (i * 29) % 256;
+  EdgeAppLibDrawBuffer src = {s.data(), s.size(), AITRIOS_DRAW_FORMAT_RGB8, 8,
+                              4, 0};
+  std::vector<uint8_t> d(6 * 6 * 3), r(6 * 3 * 3);
+  EdgeAppLibDrawBuffer dst = {d.data(), d.size(), AITRIOS_DRAW_FORMAT_RGB8, 6,
+                              6, 0};
+  EdgeAppLibDrawBuffer ref = {r.data(), r.size(), AITRIOS_DRAW_FORMAT_RGB8, 6,
+                              3, 0};
+  ASSERT_EQ(LetterboxRectangle(&src, &dst, AITRIOS_COLOR_BLUE, &lb), 0);
+  ASSERT_EQ(ResizeRectangle(&src, &ref), 0);
+  EXPECT_EQ(lb.left, 0u);
+  EXPECT_EQ(lb.top, 1u);
+  EXPECT_EQ(lb.height, 3u);
+  for (uint32_t y = 0; y < 6; ++y) {
+    for (uint32_t x = 0; x < 6; ++x) {
+      const uint8_t *p = &d[(y * 6 + x) * 3];
+      if (y >= 1 && y < 4) {
+        EXPECT_EQ(memcmp(p, &r[((y - 1) * 6 + x) * 3], 3), 0);
+      } else {
+        EXPECT_EQ(p[0], 0x00);
+        EXPECT_EQ(p[2], 0xFF);
+      }
+    }
+  }
+
+  // 4x8 into 6x6 planar: padded left and right, converted in the same pass
+  src.width = 4;
+  src.height = 8;
+  src.stride_byte = 0;
+  dst = {d.data(), d.size(), AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 6, 6, 0};
+  ref = {r.data(), r.size(), AITRIOS_DRAW_FORMAT_RGB8_PLANAR, 3, 6, 0};
+  ASSERT_EQ(LetterboxRectangle(&src, &dst, AITRIOS_COLOR_RED, &lb), 0);
+  ASSERT_EQ(ResizeRectangle(&src, &ref), 0);
+  EXPECT_EQ(lb.left, 1u);
+  EXPECT_EQ(lb.width, 3u);
+  for (uint32_t p = 0; p < 3; ++p) {
+    for (uint32_t y = 0; y < 6; ++y) {
+      for (uint32_t x = 0; x < 6; ++x) {
+        uint8_t v = d[p * 36 + y * 6 + x];
+        if (x >= 1 && x < 4) {
+          EXPECT_EQ(v, r[p * 18 + y * 3 + x - 1]);
+        } else {
+          EXPECT_EQ(v, p == 0 ? 0xFF : 0x00);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(EdgeAppLibDrawApiTest, DrawPrimitives_BoxesMatchDrawRectangle) {
+  const EdgeAppLibDrawBox boxes[] = {
+      {10, 10, 90, 90, AITRIOS_COLOR_RED, 0},
+      {50, 5, 1000, 1000, AITRIOS_COLOR_GREEN, 1},
+      {0, 40, 20, 42, AITRIOS_COLOR_BLUE, 1},
+      {30, 30, 20, 20, AITRIOS_COLOR_BLUE, 1},  // inverted, skipped
+  };
+  EdgeAppLibDrawPrimitives primitives = {boxes, 4, nullptr, 0, nullptr, 0};
+  const enum EdgeAppLibDrawFormat formats[] = {
+      AITRIOS_DRAW_FORMAT_RGB8, AITRIOS_DRAW_FORMAT_RGB8_PLANAR,
+      AITRIOS_DRAW_FORMAT_BGR8};
+  std::vector<uint8_t> expected(TEST_IMG_BUFFER_SIZE);
+  for (enum EdgeAppLibDrawFormat format : formats) {
+    draw_buffer.format = format;
+    draw_buffer.stride_byte = format == AITRIOS_DRAW_FORMAT_RGB8_PLANAR
+                                  ? TEST_IMG_WIDTH
+                                  : TEST_IMG_WIDTH * 3;
+    memset(draw_buffer.address, 0, TEST_IMG_BUFFER_SIZE);
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_EQ(DrawRectangle(&draw_buffer, boxes[i].left, boxes[i].top,
+                              boxes[i].right, boxes[i].bottom,
+                              boxes[i].color),
+                0);
+    }
+    memcpy(expected.data(), draw_buffer.address, TEST_IMG_BUFFER_SIZE);
+    memset(draw_buffer.address, 0, TEST_IMG_BUFFER_SIZE);
+    ASSERT_EQ(DrawPrimitives(&draw_buffer, &primitives), 0);
+    EXPECT_EQ(memcmp(expected.data(), draw_buffer.address,
+                     TEST_IMG_BUFFER_SIZE),
+              0);
+  }
+
+  // Thick outlines grow inwards
+  EdgeAppLibDrawBox thick = {10, 10, 20, 20, AITRIOS_COLOR_RED, 3};
+  primitives = {&thick, 1, nullptr, 0, nullptr, 0};
+  draw_buffer.format = AITRIOS_DRAW_FORMAT_RGB8;
+  draw_buffer.stride_byte = TEST_IMG_WIDTH * 3;
+  memset(draw_buffer.address, 0, TEST_IMG_BUFFER_SIZE);
+  ASSERT_EQ(DrawPrimitives(&draw_buffer, &primitives), 0);
+  const uint8_t *img = static_cast<uint8_t *>(draw_buffer.address);
+  for (uint32_t y = 8; y < 23; ++y) {
+    for (uint32_t x = 8; x < 23; ++x) {
+      bool inside = x >= 10 && x <= 20 && y >= 10 && y <= 20;
+      bool hole = x >= 13 && x <= 17 && y >= 13 && y <= 17;
+      EXPECT_EQ(img[(y * TEST_IMG_WIDTH + x) * 3], inside && !hole ? 0xFF : 0)
+          << x << "," << y;
+    }
+  }
+}
+
+TEST_F(EdgeAppLibDrawApiTest, DrawPrimitives_MasksAndLabels) {
+  draw_buffer.format = AITRIOS_DRAW_FORMAT_RGB8_PLANAR;
+  memset(draw_buffer.address, 100, TEST_IMG_BUFFER_SIZE);
+  const uint8_t coverage[2 * 2] = {0, 255, 128, 255};
+  const EdgeAppLibDrawMask masks[] = {
+      {2, 2, 2, 2, coverage, 2, {0xFF, 0x00, 0x00}, 255},
+      {10, 10, 3, 1, nullptr, 0, {0x00, 0xFF, 0x00}, 128},
+      {98, 98, 10, 10, nullptr, 0, {0x00, 0x00, 0xFF}, 255},  // clipped
+  };
+  const EdgeAppLibDrawLabel labels[] = {
+      {20, 20, "1a", {0xFF, 0xFF, 0xFF}, 2},
+  };
+  const EdgeAppLibDrawBox box = {20, 20, 21, 21, {0x00, 0x00, 0x00}, 1};
+  EdgeAppLibDrawPrimitives primitives = {&box, 1, masks, 3, labels, 1};
+  ASSERT_EQ(DrawPrimitives(&draw_buffer, &primitives), 0);
+
+  const uint8_t *r = static_cast<uint8_t *>(draw_buffer.address);
+  const uint8_t *g = r + TEST_IMG_WIDTH * TEST_IMG_HEIGHT;
+  const uint8_t *b = g + TEST_IMG_WIDTH * TEST_IMG_HEIGHT;
+  auto at = [](const uint8_t *plane, uint32_t x, uint32_t y) {
+    return plane[y * TEST_IMG_WIDTH + x];
+  };
+  EXPECT_EQ(at(r, 2, 2), 100);
+  EXPECT_EQ(at(r, 3, 2), 0xFF);
+  EXPECT_EQ(at(g, 3, 2), 0);
+  EXPECT_EQ(at(r, 2, 3), (100 * 127 + 255 * 128 + 127) / 255);
+  EXPECT_EQ(at(g, 11, 10), (100 * 127 + 255 * 128 + 127) / 255);
+  EXPECT_EQ(at(g, 11, 11), 100);
+  EXPECT_EQ(at(b, 99, 99), 0xFF);
+  EXPECT_EQ(at(r, 99, 99), 0);
+  EXPECT_EQ(at(b, 97, 99), 100);
+
+  // '1' is rows 010 110 010 010 111 and 'A' 010 101 111 101 101, scaled by
+  // 2 and 8 pixels apart. Labels are drawn over the box.
+  const char *glyphs[2][5] = {{".#.", "##.", ".#.", ".#.", "###"},
+                              {".#.", "#.#", "###", "#.#", "#.#"}};
+  for (uint32_t c = 0; c < 2; ++c) {
+    for (uint32_t y = 0; y < 10; ++y) {
+      for (uint32_t x = 0; x < 8; ++x) {
+        bool set = x < 6 && glyphs[c][y / 2][x / 2] == '#';
+        bool boxed = c == 0 && x < 2 && y < 2;
+        uint8_t expected = set ? 0xFF : boxed ? 0 : 100;
+        EXPECT_EQ(at(g, 20 + c * 8 + x, 20 + y), expected) << c << ":" << x
+                                                            << "," << y;
+      }
+    }
+  }
+  EXPECT_EQ(at(g, 20, 30), 100);
+}
+
+TEST_F(EdgeAppLibDrawApiTest, DrawPrimitives_Failure) {
+  const EdgeAppLibDrawPrimitives empty = {nullptr, 0, nullptr, 0, nullptr, 0};
+  EXPECT_EQ(DrawPrimitives(&draw_buffer, &empty), 0);
+  EXPECT_EQ(DrawPrimitives(nullptr, &empty), -1);
+  EXPECT_EQ(DrawPrimitives(&draw_buffer, nullptr), -1);
+  const EdgeAppLibDrawPrimitives missing = {nullptr, 1, nullptr, 0, nullptr,
+                                            0};
+  EXPECT_EQ(DrawPrimitives(&draw_buffer, &missing), -1);
+  draw_buffer.format = AITRIOS_DRAW_FORMAT_GRAY8;
+  draw_buffer.size = TEST_IMG_WIDTH * TEST_IMG_HEIGHT;
+  EXPECT_EQ(DrawPrimitives(&draw_buffer, &empty), -1);
+}
@@ -17,14 +17,22 @@
 #include <gtest/gtest.h>
 #include <string.h>
 
+#include <atomic>
+#include <thread>
 #include <vector>
 
+#include "change_gate.hpp"
 #include "edgeapp_core.h"
+#include "mock_data_export.hpp"
 #include "mock_nn.hpp"  // Mock implementation of nn
+#include "mock_send_data.hpp"
 #include "mock_sensor.hpp"
+#include "sm/mock_sm_api.hpp"
+#include "sm_api.hpp"
 #include "receive_data.h"
 #include "send_data_types.h"  // For EdgeAppLibImageProperty
 #include "sensor.h"
+#include "stage_stats.hpp"
 using namespace EdgeAppCore;
 
 // Dummy sensor frame and ROI data
@@ -55,6 +63,7 @@ class EdgeAppCoreTest : public ::testing::Test {
     resetSetInputStatus();
     resetComputeStatus();
     resetGetOutputStatus();
+    resetBatchInputStatus();
     const char *model_path = EdgeAppLibReceiveDataStorePath();
     int ret = mkdir(model_path, 0755);
     LOG_INFO("mkdir ret=%d errno=%d\n", ret, errno);
@@ -81,6 +90,7 @@ class EdgeAppCoreTest : public ::testing::Test {
 
     UnloadModel(ctx_imx500);
     UnloadModel(ctx_cpu);
+    SetModelCacheLimit(0);
     if (total_count == executed_count) {
       const char *model_path = EdgeAppLibReceiveDataStorePath();
       for (auto &m : model) {
@@ -269,6 +279,56 @@ TEST_F(EdgeAppCoreTest, GetOutputsSuccessIMX500) {
   EXPECT_EQ(outputs.size(), 4);
 }
 
+TEST_F(EdgeAppCoreTest, OutputLayoutCachedIMX500) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  {
+    auto frame = Process(ctx_imx500, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    auto outputs = GetOutputs(ctx_imx500, frame, 4);
+    ASSERT_EQ(outputs.size(), 4u);
+    EXPECT_EQ(outputs[1].shape_info.ndim, 1u);
+    EXPECT_EQ(outputs[1].shape_info.dims[0], 4u);
+    EXPECT_EQ(outputs[1].size, 4 * sizeof(float));
+    EXPECT_EQ(static_cast<uint8_t *>(outputs[2].data),
+              static_cast<uint8_t *>(outputs[1].data) + 4 * sizeof(float));
+    EXPECT_TRUE(ctx_imx500.output_layout.valid);
+  }
+
+  // The tensor shapes are not read again while the layout is valid
+  setEdgeAppLibSensorChannelGetPropertyFail();
+  {
+    auto frame = Process(ctx_imx500, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    EXPECT_EQ(GetOutputs(ctx_imx500, frame, 4).size(), 4u);
+    EXPECT_NE(GetOutput(ctx_imx500, frame, 4).data, nullptr);
+
+    EXPECT_EQ(InvalidateOutputLayout(ctx_imx500), EdgeAppCoreResultSuccess);
+    EXPECT_TRUE(GetOutputs(ctx_imx500, frame, 4).empty());
+  }
+  resetEdgeAppLibSensorChannelGetPropertySuccess();
+}
+
+TEST_F(EdgeAppCoreTest, OutputLayoutFollowsSettingsGenerationIMX500) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  {
+    auto frame = Process(ctx_imx500, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    ASSERT_EQ(GetOutputs(ctx_imx500, frame, 4).size(), 4u);
+  }
+
+  // Another network selected by the configuration: the shapes are read again
+  setEdgeAppLibSensorChannelGetPropertyFail();
+  updateSettingsGeneration();
+  {
+    auto frame = Process(ctx_imx500, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    EXPECT_TRUE(GetOutputs(ctx_imx500, frame, 4).empty());
+    EXPECT_FALSE(ctx_imx500.output_layout.valid);
+  }
+  resetEdgeAppLibSensorChannelGetPropertySuccess();
+  {
+    auto frame = Process(ctx_imx500, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    EXPECT_EQ(GetOutputs(ctx_imx500, frame, 4).size(), 4u);
+    EXPECT_EQ(ctx_imx500.output_layout.generation, getSettingsGeneration());
+  }
+}
+
 TEST_F(EdgeAppCoreTest, NNLoadAPIFail) {
   setLoadModelError();
   EdgeAppCoreResult res = LoadModel(model[0], ctx_imx500, nullptr);
@@ -356,8 +416,8 @@ TEST_F(EdgeAppCoreTest, GetOutputsSuccess) {
   for (const auto &out : output) {
     EXPECT_NE(out.data, nullptr);
     EXPECT_GT(out.size, 0);
+    EXPECT_EQ(out.memory_owner, TensorMemoryOwner::Core);
     int ret = SendInference(out.data, out.size, EdgeAppLibSendDataJson, 0);
-    free(out.data);
     EXPECT_EQ(ret, 0);
   }
 }
@@ -380,10 +440,23 @@ TEST_F(EdgeAppCoreTest, GetOutputSuccess) {
 
   // Send additional outputs as raw data
   int ret = SendInference(output.data, output.size, EdgeAppLibSendDataJson, 0);
-  free(output.data);
   EXPECT_EQ(ret, 0);
 }
 
+static void CountSendResult(EdgeAppLibSendDataResult result, void *user_data) {
+  if (result == EdgeAppLibSendDataResultSuccess) ++*(int *)user_data;
+}
+
+TEST_F(EdgeAppCoreTest, SendInferenceAsyncSuccess) {
+  const char *output = "{\"a\":1}";
+  int sent = 0;
+  EXPECT_EQ(SendInferenceAsync((void *)output, strlen(output),
+                               EdgeAppLibSendDataJson, 0, CountSendResult,
+                               &sent),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(sent, 1);
+}
+
 TEST_F(EdgeAppCoreTest, GetInputsSuccess) {
   EdgeAppCoreResult res = LoadModel(model[0], ctx_imx500, nullptr);
   EXPECT_EQ(res, EdgeAppCoreResultSuccess);
@@ -391,7 +464,7 @@ TEST_F(EdgeAppCoreTest, GetInputsSuccess) {
   EXPECT_EQ(res, EdgeAppCoreResultSuccess);
   auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
   Tensor output = GetOutput(ctx_cpu, frame, 4);
-  free(output.data);
+  EXPECT_NE(output.data, nullptr);
 
   auto input = GetInput(ctx_cpu, frame);
   ASSERT_TRUE(input.data != nullptr && input.size > 0);
@@ -470,8 +543,7 @@ TEST_F(EdgeAppCoreTest, GetInputAndOutputForAllModels) {
   auto output = GetOutput(ctx_cpu, frame, 4);
   EXPECT_TRUE(output.data != nullptr && output.size > 0);
 
-  // Clean up
-  free(output.data);
+  // Clean up (output is a view into the context output pool)
   free(input.data);
 }
 
@@ -606,14 +678,1204 @@ TEST_F(EdgeAppCoreTest, GetOutputWithSpecificIndex) {
   if (outputs.size() > 1) {
     EXPECT_GE(all_outputs.size, output0.size + output1.size);
   }
+}
 
-  // Clean up
-  for (auto &tensor : outputs) {
-    if (tensor.data) {
-      free(tensor.data);
+TEST_F(EdgeAppCoreTest, GetOutputsReusesOutputPool) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+
+  void *first_data = nullptr;
+  size_t pool_capacity = 0;
+  for (int i = 0; i < 3; ++i) {
+    auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    EXPECT_NE(frame, 0);
+    auto outputs = GetOutputs(ctx_cpu, frame, 4);
+    ASSERT_EQ(outputs.size(), 4);
+    for (const auto &out : outputs) {
+      EXPECT_EQ(out.memory_owner, TensorMemoryOwner::Core);
+    }
+    // GetOutput returns a view of the same pooled storage
+    Tensor all = GetOutput(ctx_cpu, frame, 4);
+    EXPECT_EQ(all.data, outputs[0].data);
+    EXPECT_EQ(all.shape_info.ndim, 4);
+
+    if (i == 0) {
+      first_data = outputs[0].data;
+      pool_capacity = ctx_cpu.output_pool.capacity;
+    } else {
+      EXPECT_EQ(outputs[0].data, first_data);
+      EXPECT_EQ(ctx_cpu.output_pool.capacity, pool_capacity);
+    }
+  }
+}
+
+TEST_F(EdgeAppCoreTest, GetOutputsKeepsEarlierViewsOfTheFrame) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  Tensor first = GetOutput(ctx_cpu, frame, 1);
+  ASSERT_NE(first.data, nullptr);
+  EXPECT_EQ(first.shape_info.ndim, 1);
+
+  // A larger request of the same frame does not move the pool
+  auto outputs = GetOutputs(ctx_cpu, frame, 4);
+  ASSERT_EQ(outputs.size(), 4);
+  EXPECT_EQ(outputs[0].data, first.data);
+}
+
+TEST_F(EdgeAppCoreTest, ReleaseOutputsFreesOutputPool) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  auto outputs = GetOutputs(ctx_cpu, frame, 4);
+  EXPECT_FALSE(outputs.empty());
+  EXPECT_NE(ctx_cpu.output_pool.buffer, nullptr);
+
+  EXPECT_EQ(ReleaseOutputs(ctx_cpu), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(ctx_cpu.output_pool.buffer, nullptr);
+  EXPECT_EQ(ctx_cpu.output_pool.capacity, 0);
+
+  // The pool is sized again on the next request
+  outputs = GetOutputs(ctx_cpu, frame, 4);
+  EXPECT_EQ(outputs.size(), 4);
+  EXPECT_NE(ctx_cpu.output_pool.buffer, nullptr);
+}
+
+TEST_F(EdgeAppCoreTest, BuiltinPreprocessFloatNHWC) {
+  const std::vector<float> mean = {0.0f, 0.0f, 0.0f};
+  const std::vector<float> norm = {1.0f, 1.0f, 1.0f};
+  EdgeAppCorePreprocessInfo info = {5, 1, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeFloat32};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, &mean, &norm,
+                                &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+  ASSERT_NE(ctx_cpu.preprocess, nullptr);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  EXPECT_NE(frame, 0);
+  Tensor input = GetInput(ctx_cpu, frame);
+  ASSERT_NE(input.data, nullptr);
+  EXPECT_EQ(input.type, TensorTypeFloat32);
+  EXPECT_EQ(input.memory_owner, TensorMemoryOwner::Core);
+  EXPECT_EQ(input.size, 5 * 3 * sizeof(float));
+  EXPECT_EQ(input.shape_info.dims[1], 1);
+  EXPECT_EQ(input.shape_info.dims[2], 5);
+  const float *values = input.DataAs<float>();
+  ASSERT_NE(values, nullptr);
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_FLOAT_EQ(values[i], i / 255.0f);
+  }
+  // Float tensors cannot be sent as an image
+  EXPECT_EQ(SendInputTensor(&input), EdgeAppCoreResultInvalidParam);
+  EXPECT_FALSE(GetOutputs(ctx_cpu, frame, 4).empty());
+}
+
+TEST_F(EdgeAppCoreTest, BuiltinPreprocessUInt8NCHW) {
+  EdgeAppCorePreprocessInfo info = {5, 1, EdgeAppCoreLayoutNCHW,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  Tensor input = GetInput(ctx_cpu, frame);
+  ASSERT_NE(input.data, nullptr);
+  EXPECT_EQ(input.format, AITRIOS_DRAW_FORMAT_RGB8_PLANAR);
+  const uint8_t *planes = input.DataAs<uint8_t>();
+  ASSERT_NE(planes, nullptr);
+  for (int c = 0; c < 3; ++c) {
+    for (int x = 0; x < 5; ++x) {
+      EXPECT_EQ(planes[c * 5 + x], x * 3 + c);
+    }
+  }
+  EXPECT_EQ(input.memory_owner, TensorMemoryOwner::Core);
+}
+
+TEST_F(EdgeAppCoreTest, BuiltinPreprocessLetterbox) {
+  // The 5x1 frame fills the middle row of a 5x3 input
+  EdgeAppCorePreprocessInfo info = {5, 3, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8,
+                                    EdgeAppCoreResizeLetterbox, 114};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  Tensor input = GetInput(ctx_cpu, frame);
+  const uint8_t *values = input.DataAs<uint8_t>();
+  ASSERT_NE(values, nullptr);
+  for (int i = 0; i < 45; ++i) {
+    EXPECT_EQ(values[i], i >= 15 && i < 30 ? i - 15 : 114) << i;
+  }
+
+  auto outputs = GetOutputs(ctx_cpu, frame, 1);
+  ASSERT_FALSE(outputs.empty());
+  const EdgeAppCoreInputTransform &t = outputs[0].transform;
+  EXPECT_FLOAT_EQ(t.scale_x, 1.0f);
+  EXPECT_FLOAT_EQ(t.scale_y, 1.0f);
+  EXPECT_FLOAT_EQ(t.pad_x, 0.0f);
+  EXPECT_FLOAT_EQ(t.pad_y, 1.0f);
+  EXPECT_EQ(t.input_height, 3u);
+
+  // Back to frame pixels, in input pixels then normalized
+  float points[4] = {2.0f, 1.0f, 0.4f, 0.5f};
+  ASSERT_EQ(MapPointsToFrame(outputs[0], points, 1, false),
+            EdgeAppCoreResultSuccess);
+  ASSERT_EQ(MapPointsToFrame(outputs[0], points + 2, 1, true),
+            EdgeAppCoreResultSuccess);
+  EXPECT_FLOAT_EQ(points[0], 2.0f);
+  EXPECT_FLOAT_EQ(points[1], 0.0f);
+  EXPECT_FLOAT_EQ(points[2], 2.0f);
+  EXPECT_FLOAT_EQ(points[3], 0.5f);
+  EXPECT_EQ(MapPointsToFrame(outputs[0], nullptr, 1, false),
+            EdgeAppCoreResultInvalidParam);
+}
+
+TEST_F(EdgeAppCoreTest, BuiltinPreprocessUpscale) {
+  EdgeAppCorePreprocessInfo info = {10, 2, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  Tensor input = GetInput(ctx_cpu, frame);
+  const uint8_t *pixels = input.DataAs<uint8_t>();
+  ASSERT_NE(pixels, nullptr);
+  EXPECT_EQ(input.size, 10 * 2 * 3);
+  for (int row = 0; row < 2; ++row) {
+    const uint8_t *line = pixels + row * 10 * 3;
+    // Edges map to the first and last source pixels
+    EXPECT_EQ(line[0], 0);
+    EXPECT_EQ(line[27], 12);
+    EXPECT_EQ(line[29], 14);
+    // 0.75 * 0 + 0.25 * 3
+    EXPECT_EQ(line[3], 1);
+  }
+}
+
+TEST_F(EdgeAppCoreTest, BuiltinPreprocessGreyFrame) {
+  EdgeAppCorePreprocessInfo info = {5, 6, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+  // Set after loading, which resets the mock property
+  EdgeAppLibSensorImageProperty image = {};
+  image.width = 5;
+  image.height = 3;
+  image.stride_bytes = 5;
+  snprintf(image.pixel_format, sizeof(image.pixel_format), "%s",
+           AITRIOS_SENSOR_PIXEL_FORMAT_GREY);
+  setEdgeAppLibSensorChannelImageProperty(image);
+
+  // Rows are converted as the upscale reads them, twice each
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  Tensor input = GetInput(ctx_cpu, frame);
+  const uint8_t *pixels = input.DataAs<uint8_t>();
+  ASSERT_NE(pixels, nullptr);
+  EXPECT_EQ(input.size, 5 * 6 * 3);
+  const int expected[6] = {0, -1, 4, 6, -1, 10};
+  for (int row = 0; row < 6; ++row) {
+    for (int x = 0; x < 5; ++x) {
+      const uint8_t *pixel = pixels + (row * 5 + x) * 3;
+      EXPECT_EQ(pixel[0], pixel[1]);
+      EXPECT_EQ(pixel[0], pixel[2]);
+      if (expected[row] >= 0) {
+        EXPECT_EQ(pixel[0], expected[row] + x);
+      }
+    }
+  }
+  resetEdgeAppLibSensorChannelImageProperty();
+}
+
+TEST_F(EdgeAppCoreTest, BuiltinPreprocessInvalidInfo) {
+  EdgeAppCorePreprocessInfo info = {0, 1, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeFloat32};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultFailure);
+  EXPECT_EQ(ctx_cpu.preprocess, nullptr);
+
+  info = {5, 1, EdgeAppCoreLayoutNHWC, EdgeAppLib::TensorTypeInt64};
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultFailure);
+}
+
+TEST_F(EdgeAppCoreTest, SetPipelineDepthInvalidParam) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(SetPipelineDepth(ctx_cpu, &ctx_imx500, 0),
+            EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(SetPipelineDepth(ctx_cpu, &ctx_imx500, MAX_PIPELINE_DEPTH + 1),
+            EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(SetPipelineDepth(ctx_cpu, nullptr, 2),
+            EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(ctx_cpu.pipeline, nullptr);
+}
+
+TEST_F(EdgeAppCoreTest, ProcessAsyncWithoutPipeline) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  auto frame = ProcessAsync(ctx_cpu, &ctx_imx500, dummy_roi[0]);
+  EXPECT_FALSE(frame.empty());
+  EXPECT_FALSE(GetOutputs(ctx_cpu, frame, 4).empty());
+}
+
+TEST_F(EdgeAppCoreTest, ProcessAsyncKeepsFrameOrder) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  ASSERT_EQ(SetPipelineDepth(ctx_cpu, &ctx_imx500, 3),
+            EdgeAppCoreResultSuccess);
+  ASSERT_NE(ctx_cpu.pipeline, nullptr);
+
+  EdgeAppLibSensorFrame previous = 0;
+  for (int i = 0; i < 5; ++i) {
+    auto frame = ProcessAsync(ctx_cpu, &ctx_imx500, dummy_roi[0]);
+    ASSERT_FALSE(frame.empty());
+    EdgeAppLibSensorFrame current = frame;
+    if (i > 0) {
+      EXPECT_GT(current, previous);
+    }
+    previous = current;
+    Tensor input = GetInput(ctx_cpu, frame);
+    EXPECT_NE(input.data, nullptr);
+    EXPECT_EQ(input.timestamp, 10);
+    EXPECT_EQ(GetOutputs(ctx_cpu, frame, 4).size(), 4);
+  }
+
+  // Depth 1 stops the pipeline and releases the prefetched frames
+  EXPECT_EQ(SetPipelineDepth(ctx_cpu, &ctx_imx500, 1),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(ctx_cpu.pipeline, nullptr);
+  auto frame = ProcessAsync(ctx_cpu, &ctx_imx500, dummy_roi[0]);
+  EXPECT_FALSE(frame.empty());
+}
+
+TEST_F(EdgeAppCoreTest, ProcessAsyncBuiltinPreprocess) {
+  EdgeAppCorePreprocessInfo info = {5, 1, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(SetPipelineDepth(ctx_cpu, &ctx_imx500, 2),
+            EdgeAppCoreResultSuccess);
+
+  const void *last_data = nullptr;
+  for (int i = 0; i < 4; ++i) {
+    auto frame = ProcessAsync(ctx_cpu, &ctx_imx500, dummy_roi[0]);
+    ASSERT_FALSE(frame.empty());
+    Tensor input = GetInput(ctx_cpu, frame);
+    const uint8_t *pixels = input.DataAs<uint8_t>();
+    ASSERT_NE(pixels, nullptr);
+    EXPECT_EQ(input.memory_owner, TensorMemoryOwner::Core);
+    for (int j = 0; j < 15; ++j) {
+      EXPECT_EQ(pixels[j], j);
+    }
+    // Consecutive frames are prepared in different buffers
+    EXPECT_NE(input.data, last_data);
+    last_data = input.data;
+  }
+}
+
+TEST_F(EdgeAppCoreTest, ProcessAsyncInterleavedWithProcess) {
+  EdgeAppCorePreprocessInfo info = {5, 1, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(SetPipelineDepth(ctx_cpu, &ctx_imx500, 2),
+            EdgeAppCoreResultSuccess);
+
+  for (int i = 0; i < 4; ++i) {
+    auto async_frame = ProcessAsync(ctx_cpu, &ctx_imx500, dummy_roi[0]);
+    ASSERT_FALSE(async_frame.empty());
+    Tensor async_input = GetInput(ctx_cpu, async_frame);
+    ASSERT_NE(async_input.data, nullptr);
+    uint8_t expected[15];
+    memcpy(expected, async_input.data, sizeof(expected));
+
+    // The synchronous call neither writes to the slot of the async frame nor
+    // shares the preprocessing state of the worker
+    auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    ASSERT_FALSE(frame.empty());
+    Tensor input = GetInput(ctx_cpu, frame);
+    const uint8_t *pixels = input.DataAs<uint8_t>();
+    ASSERT_NE(pixels, nullptr);
+    EXPECT_NE(input.data, async_input.data);
+    for (int j = 0; j < 15; ++j) {
+      EXPECT_EQ(pixels[j], j);
+    }
+    EXPECT_EQ(memcmp(async_input.data, expected, sizeof(expected)), 0);
+  }
+}
+
+TEST_F(EdgeAppCoreTest, ProcessAsyncIMX500) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(SetPipelineDepth(ctx_imx500, &ctx_imx500, 2),
+            EdgeAppCoreResultSuccess);
+  for (int i = 0; i < 3; ++i) {
+    auto frame = ProcessAsync(ctx_imx500, &ctx_imx500, dummy_roi[0]);
+    ASSERT_FALSE(frame.empty());
+    Tensor output = GetOutput(ctx_imx500, frame, 4);
+    EXPECT_NE(output.data, nullptr);
+  }
+}
+
+TEST_F(EdgeAppCoreTest, ProcessMultiRoiBatched) {
+  EdgeAppCorePreprocessInfo info = {5, 1, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+
+  EdgeAppLibSensorImageCropProperty rois[2] = {{0, 0, 5, 1}, {0, 0, 5, 1}};
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, rois, 2);
+  ASSERT_FALSE(frame.empty());
+  EXPECT_TRUE(ctx_cpu.batch.native);
+
+  // Both ROIs are stacked in a single input tensor
+  Tensor input = GetInput(ctx_cpu, frame);
+  EXPECT_EQ(input.shape_info.dims[0], 2u);
+  ASSERT_EQ(input.size, 30u);
+  const uint8_t *pixels = input.DataAs<uint8_t>();
+  ASSERT_NE(pixels, nullptr);
+  for (int j = 0; j < 15; ++j) {
+    EXPECT_EQ(pixels[j], j);
+    EXPECT_EQ(pixels[15 + j], j);
+  }
+
+  // Each batched output tensor is split between the ROIs
+  std::vector<Tensor> outputs = GetOutputs(ctx_cpu, frame, 4);
+  ASSERT_EQ(outputs.size(), 8u);
+  const size_t sizes[] = {10, 8, 6, 4};
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    EXPECT_EQ(outputs[i].size, sizes[i % 4]);
+    EXPECT_EQ(outputs[i].memory_owner, TensorMemoryOwner::Core);
+  }
+  EXPECT_EQ(static_cast<uint8_t *>(outputs[4].data),
+            static_cast<uint8_t *>(outputs[0].data) + 10);
+}
+
+TEST_F(EdgeAppCoreTest, ProcessMultiRoiFallback) {
+  EdgeAppCorePreprocessInfo info = {5, 1, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+  setBatchInputError();
+
+  EdgeAppLibSensorImageCropProperty rois[3] = {
+      {0, 0, 5, 1}, {0, 0, 5, 1}, {0, 0, 5, 1}};
+  for (int n = 0; n < 2; ++n) {
+    auto frame = Process(ctx_cpu, &ctx_imx500, 0, rois, 3);
+    ASSERT_FALSE(frame.empty());
+    EXPECT_TRUE(ctx_cpu.batch.unsupported);
+    EXPECT_FALSE(ctx_cpu.batch.native);
+
+    std::vector<Tensor> outputs = GetOutputs(ctx_cpu, frame, 2);
+    ASSERT_EQ(outputs.size(), 6u);
+    for (uint32_t r = 0; r < 3; ++r) {
+      const float *out = outputs[r * 2].DataAs<float>();
+      ASSERT_NE(out, nullptr);
+      EXPECT_EQ(outputs[r * 2].size, 10u);
+      EXPECT_EQ(outputs[r * 2 + 1].size, 8u);
+      EXPECT_FLOAT_EQ(out[0], 0.0f);
+      EXPECT_FLOAT_EQ(outputs[r * 2 + 1].DataAs<float>()[0], 100.0f);
     }
+    EXPECT_NE(outputs[0].data, outputs[2].data);
+  }
+  resetBatchInputStatus();
+}
+
+TEST_F(EdgeAppCoreTest, ProcessMultiRoiComputeErrorKeepsBatching) {
+  EdgeAppCorePreprocessInfo info = {5, 1, EdgeAppCoreLayoutNHWC,
+                                    EdgeAppLib::TensorTypeUInt8};
+  EdgeAppCoreModelInfo fused = {"dummy_model2.onnx", edge_cpu, nullptr,
+                                nullptr, &info};
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(fused, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+
+  // A failing Compute only falls back for the current frame
+  EdgeAppLibSensorImageCropProperty rois[2] = {{0, 0, 5, 1}, {0, 0, 5, 1}};
+  setComputeError();
+  {
+    auto frame = Process(ctx_cpu, &ctx_imx500, 0, rois, 2);
+    EXPECT_FALSE(ctx_cpu.batch.unsupported);
+    EXPECT_FALSE(ctx_cpu.batch.native);
+  }
+  resetComputeStatus();
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, rois, 2);
+  ASSERT_FALSE(frame.empty());
+  EXPECT_FALSE(ctx_cpu.batch.unsupported);
+  EXPECT_TRUE(ctx_cpu.batch.native);
+  // Every ROI and the fallback are cropped from one read of each frame
+  EXPECT_EQ(GetStats(ctx_cpu).stages[EdgeAppCoreStageGetRawData].count, 2u);
+}
+
+TEST_F(EdgeAppCoreTest, ProcessMultiRoiWithoutBuiltinPreprocess) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+
+  EdgeAppLibSensorImageCropProperty rois[2] = {{0, 0, 2, 1}, {2, 0, 3, 1}};
+  {
+    auto frame = Process(ctx_cpu, &ctx_imx500, 0, rois, 2);
+    ASSERT_FALSE(frame.empty());
+    EXPECT_EQ(ctx_cpu.batch.num_rois, 2u);
+    EXPECT_EQ(GetOutputs(ctx_cpu, frame, 4).size(), 8u);
+  }
+
+  // A single ROI Process returns to per-frame outputs
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, rois[0]);
+  EXPECT_EQ(ctx_cpu.batch.num_rois, 0u);
+  EXPECT_EQ(GetOutputs(ctx_cpu, frame, 4).size(), 4u);
+}
+
+TEST_F(EdgeAppCoreTest, ProcessMultiRoiInvalidParam) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+
+  EdgeAppLibSensorImageCropProperty rois[MAX_BATCH_ROIS + 1] = {};
+  EXPECT_TRUE(Process(ctx_cpu, &ctx_imx500, 0, nullptr, 1).empty());
+  EXPECT_TRUE(Process(ctx_cpu, &ctx_imx500, 0, rois, 0).empty());
+  EXPECT_TRUE(
+      Process(ctx_cpu, &ctx_imx500, 0, rois, MAX_BATCH_ROIS + 1).empty());
+  EXPECT_TRUE(Process(ctx_cpu, nullptr, 0, rois, 1).empty());
+  EXPECT_TRUE(Process(ctx_imx500, &ctx_imx500, 0, rois, 1).empty());
+}
+
+TEST_F(EdgeAppCoreTest, GetOutputsIntoDestinations) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  // Tensor 0 holds 10 floats, tensor 1 holds 8 floats
+  setOutputSizeScale(4);
+
+  float scores[10] = {0};
+  float maps[8] = {0};
+  EdgeAppCoreOutputDestination dests[2] = {
+      {scores, sizeof(scores), EdgeAppCoreLayoutNHWC, 0, 0, 0},
+      {maps, sizeof(maps), EdgeAppCoreLayoutNHWC, 2, 2, 2}};
+  ASSERT_EQ(SetOutputDestinations(ctx_cpu, dests, 2),
+            EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+  Tensor outputs[2];
+  ASSERT_EQ(GetOutputsInto(ctx_cpu, frame, outputs, 2),
+            EdgeAppCoreResultSuccess);
+
+  // Written in place
+  EXPECT_EQ(outputs[0].data, scores);
+  EXPECT_EQ(outputs[0].size, sizeof(scores));
+  EXPECT_EQ(outputs[0].memory_owner, TensorMemoryOwner::App);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_FLOAT_EQ(scores[i], i);
+  }
+
+  // [C,H,W] output transposed to [H,W,C]
+  EXPECT_EQ(outputs[1].data, maps);
+  EXPECT_EQ(outputs[1].shape_info.ndim, 3u);
+  EXPECT_EQ(outputs[1].shape_info.dims[2], 2u);
+  const float expected[8] = {100, 104, 101, 105, 102, 106, 103, 107};
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_FLOAT_EQ(maps[i], expected[i]);
+  }
+}
+
+TEST_F(EdgeAppCoreTest, GetOutputsIntoInvalidParam) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+
+  float small[1] = {0};
+  EdgeAppCoreOutputDestination dest = {small, sizeof(small),
+                                       EdgeAppCoreLayoutNHWC, 2, 2, 2};
+  EXPECT_EQ(SetOutputDestinations(ctx_cpu, &dest, 1),
+            EdgeAppCoreResultDataTooLarge);
+  EXPECT_EQ(SetOutputDestinations(ctx_cpu, nullptr, 1),
+            EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(SetOutputDestinations(ctx_imx500, nullptr, 0),
+            EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+  Tensor output;
+  // No destination registered
+  EXPECT_EQ(GetOutputsInto(ctx_cpu, frame, &output, 1),
+            EdgeAppCoreResultInvalidParam);
+
+  // Tensor 0 does not fit in a single float
+  dest = {small, sizeof(small), EdgeAppCoreLayoutNHWC, 0, 0, 0};
+  ASSERT_EQ(SetOutputDestinations(ctx_cpu, &dest, 1),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(GetOutputsInto(ctx_cpu, frame, &output, 1),
+            EdgeAppCoreResultDataTooLarge);
+}
+
+TEST_F(EdgeAppCoreTest, ComputeConcurrentFromThreads) {
+  EdgeAppCoreModelInfo pooled = model[1];
+  pooled.concurrent_contexts = 3;
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(pooled, ctx_cpu, &ctx_imx500), EdgeAppCoreResultSuccess);
+  ASSERT_NE(ctx_cpu.context_pool, nullptr);
+
+  // More workers than contexts, so some of them wait for a free context
+  const int kWorkers = 6;
+  std::atomic<int> failures{0};
+  std::vector<std::thread> workers;
+  for (int w = 0; w < kWorkers; ++w) {
+    workers.emplace_back([&]() {
+      uint8_t pixels[12] = {0};
+      Tensor input{};
+      input.data = pixels;
+      input.size = sizeof(pixels);
+      input.type = TensorTypeUInt8;
+      input.shape_info = {4, {1, 2, 2, 3}};
+      float out0[4] = {0};
+      float out1[4] = {0};
+      EdgeAppCoreOutputDestination dests[2] = {
+          {out0, sizeof(out0), EdgeAppCoreLayoutNHWC, 0, 0, 0},
+          {out1, sizeof(out1), EdgeAppCoreLayoutNHWC, 0, 0, 0}};
+      Tensor outputs[2];
+      for (int i = 0; i < 50; ++i) {
+        if (ComputeConcurrent(ctx_cpu, input, dests, outputs, 2) !=
+                EdgeAppCoreResultSuccess ||
+            outputs[0].data != out0 || outputs[1].size != 8 ||
+            out1[0] != 100.0f) {
+          failures++;
+        }
+      }
+    });
+  }
+  for (auto &t : workers) t.join();
+  EXPECT_EQ(failures.load(), 0);
+}
+
+TEST_F(EdgeAppCoreTest, ComputeConcurrentInvalidParam) {
+  EdgeAppCoreModelInfo pooled = model[1];
+  pooled.concurrent_contexts = MAX_GRAPH_CONTEXTS + 1;
+  EXPECT_EQ(LoadModel(pooled, ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultInvalidParam);
+  EdgeAppCoreModelInfo imx500 = model[0];
+  imx500.concurrent_contexts = 2;
+  EXPECT_EQ(LoadModel(imx500, ctx_imx500, nullptr),
+            EdgeAppCoreResultInvalidParam);
+
+  // No context pool without concurrent_contexts
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  uint8_t pixels[3] = {0};
+  Tensor input{};
+  input.data = pixels;
+  float out[4];
+  EdgeAppCoreOutputDestination dest = {out, sizeof(out), EdgeAppCoreLayoutNHWC,
+                                       0, 0, 0};
+  Tensor output;
+  EXPECT_EQ(ComputeConcurrent(ctx_cpu, input, &dest, &output, 1),
+            EdgeAppCoreResultInvalidParam);
+}
+
+TEST_F(EdgeAppCoreTest, QuantizedOutputsKeepElementType) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  const EdgeAppCoreQuantization quant[2] = {
+      {TensorDataType::TensorTypeUInt8, 0.5f, 10},
+      {TensorDataType::TensorTypeInt8, 0.25f, -2}};
+  ASSERT_EQ(SetOutputQuantization(ctx_cpu, quant, 2),
+            EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+  std::vector<Tensor> outputs = GetOutputs(ctx_cpu, frame, 2);
+  ASSERT_EQ(outputs.size(), 2u);
+
+  // One element per byte, no float conversion
+  EXPECT_EQ(outputs[0].type, TensorDataType::TensorTypeUInt8);
+  EXPECT_EQ(outputs[0].shape_info.dims[0], 10u);
+  EXPECT_FLOAT_EQ(outputs[0].scale, 0.5f);
+  EXPECT_EQ(outputs[0].zero_point, 10);
+  EXPECT_TRUE(outputs[0].IsQuantized());
+  EXPECT_EQ(outputs[0].DataAs<float>(), nullptr);
+  EXPECT_NE(outputs[0].DataAs<uint8_t>(), nullptr);
+  EXPECT_EQ(outputs[1].type, TensorDataType::TensorTypeInt8);
+  EXPECT_EQ(outputs[1].shape_info.dims[0], 8u);
+
+  // Dequantized on request
+  const int8_t *q = outputs[1].DataAs<int8_t>();
+  ASSERT_NE(q, nullptr);
+  float values[8] = {0};
+  ASSERT_EQ(DequantizeTensor(outputs[1], values, sizeof(values)),
+            EdgeAppCoreResultSuccess);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_FLOAT_EQ(values[i], 0.25f * (q[i] + 2));
+  }
+}
+
+TEST_F(EdgeAppCoreTest, QuantizedOutputsInOneView) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  const EdgeAppCoreQuantization quant[2] = {
+      {TensorDataType::TensorTypeUInt8, 0.5f, 10},
+      {TensorDataType::TensorTypeUInt8, 0.5f, 10}};
+  ASSERT_EQ(SetOutputQuantization(ctx_cpu, quant, 2),
+            EdgeAppCoreResultSuccess);
+
+  {
+    // The 10 and 8 bytes of the two tensors, without padding between them
+    auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+    Tensor all = GetOutput(ctx_cpu, frame, 2);
+    ASSERT_NE(all.data, nullptr);
+    EXPECT_EQ(all.type, TensorDataType::TensorTypeUInt8);
+    ASSERT_EQ(all.shape_info.ndim, 2u);
+    EXPECT_EQ(all.shape_info.dims[0], 10u);
+    EXPECT_EQ(all.shape_info.dims[1], 8u);
+    EXPECT_EQ(all.size, 18u);
+    std::vector<Tensor> outputs = GetOutputs(ctx_cpu, frame, 2);
+    ASSERT_EQ(outputs.size(), 2u);
+    EXPECT_EQ(outputs[1].data, static_cast<uint8_t *>(all.data) + 10);
+  }
+
+  // Tensors of different types are only available one by one
+  const EdgeAppCoreQuantization mixed[2] = {
+      {TensorDataType::TensorTypeUInt8, 0.5f, 10},
+      {TensorDataType::TensorTypeInt8, 0.25f, -2}};
+  ASSERT_EQ(SetOutputQuantization(ctx_cpu, mixed, 2),
+            EdgeAppCoreResultSuccess);
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+  Tensor all = GetOutput(ctx_cpu, frame, 2);
+  EXPECT_EQ(all.data, nullptr);
+  EXPECT_EQ(all.size, 0u);
+  EXPECT_EQ(GetOutputs(ctx_cpu, frame, 2).size(), 2u);
+}
+
+TEST_F(EdgeAppCoreTest, GetOutputsIntoDequantizes) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  const EdgeAppCoreQuantization quant[2] = {
+      {TensorDataType::TensorTypeFloat32, 0.0f, 0},
+      {TensorDataType::TensorTypeUInt8, 2.0f, 128}};
+  ASSERT_EQ(SetOutputQuantization(ctx_cpu, quant, 2),
+            EdgeAppCoreResultSuccess);
+  float first[4] = {0};
+  float second[8] = {0};
+  EdgeAppCoreOutputDestination dests[2] = {
+      {first, sizeof(first), EdgeAppCoreLayoutNHWC, 0, 0, 0},
+      {second, sizeof(second), EdgeAppCoreLayoutNHWC, 0, 0, 0}};
+  ASSERT_EQ(SetOutputDestinations(ctx_cpu, dests, 2),
+            EdgeAppCoreResultSuccess);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+  Tensor outputs[2];
+  ASSERT_EQ(GetOutputsInto(ctx_cpu, frame, outputs, 2),
+            EdgeAppCoreResultSuccess);
+
+  // The 8 bytes of tensor 1 are the mock floats 100 and 101
+  const float raw[2] = {100.0f, 101.0f};
+  uint8_t bytes[8];
+  memcpy(bytes, raw, sizeof(bytes));
+  EXPECT_EQ(outputs[1].type, TensorDataType::TensorTypeFloat32);
+  EXPECT_EQ(outputs[1].shape_info.dims[0], 8u);
+  EXPECT_EQ(outputs[1].size, sizeof(second));
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_FLOAT_EQ(second[i], 2.0f * (bytes[i] - 128));
+  }
+
+  // Layout conversion only works on float32 outputs
+  dests[1] = {second, sizeof(second), EdgeAppCoreLayoutNHWC, 2, 2, 2};
+  ASSERT_EQ(SetOutputDestinations(ctx_cpu, dests, 2),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(GetOutputsInto(ctx_cpu, frame, outputs, 2),
+            EdgeAppCoreResultInvalidParam);
+}
+
+TEST_F(EdgeAppCoreTest, DequantizeTensorTypes) {
+  float values[4] = {0};
+  Tensor tensor{};
+
+  uint8_t u8[3] = {0, 128, 255};
+  tensor.data = u8;
+  tensor.size = sizeof(u8);
+  tensor.type = TensorDataType::TensorTypeUInt8;
+  tensor.scale = 0.5f;
+  tensor.zero_point = 128;
+  ASSERT_EQ(DequantizeTensor(tensor, values, sizeof(values)),
+            EdgeAppCoreResultSuccess);
+  EXPECT_FLOAT_EQ(values[0], -64.0f);
+  EXPECT_FLOAT_EQ(values[1], 0.0f);
+  EXPECT_FLOAT_EQ(values[2], 63.5f);
+
+  int8_t i8[3] = {-128, 0, 127};
+  tensor.data = i8;
+  tensor.type = TensorDataType::TensorTypeInt8;
+  tensor.scale = 0.0f;  // Not quantized: plain conversion
+  ASSERT_EQ(DequantizeTensor(tensor, values, sizeof(values)),
+            EdgeAppCoreResultSuccess);
+  EXPECT_FLOAT_EQ(values[0], -128.0f);
+  EXPECT_FLOAT_EQ(values[2], 127.0f);
+
+  // 1.0, -2.0, 65504 (largest half) and the smallest subnormal
+  uint16_t f16[4] = {0x3C00, 0xC000, 0x7BFF, 0x0001};
+  tensor.data = f16;
+  tensor.size = sizeof(f16);
+  tensor.type = TensorDataType::TensorTypeFloat16;
+  ASSERT_EQ(DequantizeTensor(tensor, values, sizeof(values)),
+            EdgeAppCoreResultSuccess);
+  EXPECT_FLOAT_EQ(values[0], 1.0f);
+  EXPECT_FLOAT_EQ(values[1], -2.0f);
+  EXPECT_FLOAT_EQ(values[2], 65504.0f);
+  EXPECT_FLOAT_EQ(values[3], 5.9604645e-8f);
+
+  // Destination too small for 4 elements
+  EXPECT_EQ(DequantizeTensor(tensor, values, 3 * sizeof(float)),
+            EdgeAppCoreResultDataTooLarge);
+  tensor.type = TensorDataType::TensorTypeInt64;
+  EXPECT_EQ(DequantizeTensor(tensor, values, sizeof(values)),
+            EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(DequantizeTensor(tensor, nullptr, 0),
+            EdgeAppCoreResultInvalidParam);
+}
+
+TEST_F(EdgeAppCoreTest, QuantizedInputPassThrough) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  {
+    auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+    EXPECT_EQ(getLastInputType(), EdgeAppLib::TensorTypeFloat32);
+  }
+  UnloadModel(ctx_cpu);
+
+  EdgeAppCoreModelInfo quantized = model[1];
+  quantized.quantized_input = true;
+  EXPECT_EQ(LoadModel(quantized, ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+  EXPECT_FALSE(frame.empty());
+  EXPECT_EQ(getLastInputType(), EdgeAppLib::TensorTypeUInt8);
+  Tensor input = GetInput(ctx_cpu, frame);
+  EXPECT_EQ(input.type, TensorDataType::TensorTypeUInt8);
+  if (input.memory_owner == TensorMemoryOwner::App) free(input.data);
+
+  const EdgeAppCoreQuantization int64_quant = {
+      TensorDataType::TensorTypeInt64, 1.0f, 0};
+  EXPECT_EQ(SetOutputQuantization(ctx_cpu, &int64_quant, 1),
+            EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(SetOutputQuantization(ctx_cpu, nullptr, 1),
+            EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(SetOutputQuantization(ctx_imx500, nullptr, 0),
+            EdgeAppCoreResultInvalidParam);
+}
+
+TEST_F(EdgeAppCoreTest, ModelCacheKeepsModelsAcrossRestart) {
+  ASSERT_EQ(SetModelCacheLimit(1024), EdgeAppCoreResultSuccess);
+  resetLoadModelCalled();
+  resetEdgeAppLibSensorCoreOpenStreamCalled();
+  resetEdgeAppLibSensorCoreCloseStreamCalled();
+
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasLoadModelCalled(), 1);
+  EXPECT_EQ(wasEdgeAppLibSensorCoreOpenStreamCalled(), 1);
+  // Loaded models cannot be evicted
+  EXPECT_EQ(EvictModel(model[1].model_name), EdgeAppCoreResultDenied);
+
+  // onStop / onStart: the stream stays open and the graph resident
+  UnloadModel(ctx_cpu);
+  UnloadModel(ctx_imx500);
+  EXPECT_EQ(wasEdgeAppLibSensorCoreCloseStreamCalled(), 0);
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasLoadModelCalled(), 1);
+  EXPECT_EQ(wasEdgeAppLibSensorCoreOpenStreamCalled(), 1);
+  ASSERT_NE(ctx_cpu.graph_ctx, nullptr);
+  {
+    auto frame = Process(ctx_cpu, &ctx_imx500, 0, dummy_roi[0]);
+    EXPECT_FALSE(frame.empty());
+  }
+
+  // Explicit eviction closes the stream
+  UnloadModel(ctx_cpu);
+  UnloadModel(ctx_imx500);
+  EXPECT_EQ(EvictModel(nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasEdgeAppLibSensorCoreCloseStreamCalled(), 1);
+  EXPECT_EQ(EvictModel(model[1].model_name), EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasLoadModelCalled(), 2);
+}
+
+TEST_F(EdgeAppCoreTest, ModelCacheReloadsChangedModel) {
+  ASSERT_EQ(SetModelCacheLimit(1024), EdgeAppCoreResultSuccess);
+  resetLoadModelCalled();
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, nullptr), EdgeAppCoreResultSuccess);
+  UnloadModel(ctx_cpu);
+
+  // A new model file is deployed under the same name
+  std::string path =
+      std::string(EdgeAppLibReceiveDataStorePath()) + "/" + model[1].model_name;
+  FILE *fp = fopen(path.c_str(), "wb");
+  ASSERT_NE(fp, nullptr);
+  const char data[4] = {1, 2, 3, 4};
+  fwrite(data, sizeof(data), 1, fp);
+  fclose(fp);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasLoadModelCalled(), 2);
+  UnloadModel(ctx_cpu);
+
+  // Models larger than the limit are not kept
+  ASSERT_EQ(SetModelCacheLimit(2), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasLoadModelCalled(), 3);
+  EXPECT_EQ(ctx_cpu.cached_model, nullptr);
+  UnloadModel(ctx_cpu);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasLoadModelCalled(), 4);
+}
+
+TEST_F(EdgeAppCoreTest, InputBindingReusedAcrossFrames) {
+  ASSERT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  ASSERT_NE(frame, 0);
+  EdgeAppLib::EdgeAppLibInputBinding *binding = ctx_cpu.input_binding.binding;
+  ASSERT_NE(binding, nullptr);
+  EXPECT_TRUE(ctx_cpu.input_binding.normalize);
+  EXPECT_EQ(getLastInputType(), EdgeAppLib::TensorTypeFloat32);
+
+  auto next = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+  ASSERT_NE(next, 0);
+  EXPECT_EQ(ctx_cpu.input_binding.binding, binding);
+
+  EXPECT_EQ(UnloadModel(ctx_cpu), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(ctx_cpu.input_binding.binding, nullptr);
+}
+
+TEST_F(EdgeAppCoreTest, ChangeGateReusesOutputs) {
+  resetEdgeAppLibSensorChannelImageProperty();
+  EdgeAppLibSensorImageProperty image = {};
+  image.width = 5;
+  image.height = 1;
+  image.stride_bytes = 15;
+  snprintf(image.pixel_format, sizeof(image.pixel_format), "%s",
+           AITRIOS_SENSOR_PIXEL_FORMAT_RGB24);
+  setEdgeAppLibSensorChannelImageProperty(image);
+  ASSERT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  EdgeAppCoreChangeGate gate = {1.0f, 2};
+  EXPECT_EQ(SetChangeGate(ctx_imx500, &gate), EdgeAppCoreResultInvalidParam);
+  ASSERT_EQ(SetChangeGate(ctx_cpu, &gate), EdgeAppCoreResultSuccess);
+
+  // The mock returns the same image for every frame
+  bool reused[4];
+  for (int i = 0; i < 4; ++i) {
+    auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    ASSERT_NE(frame, 0);
+    auto outputs = GetOutputs(ctx_cpu, frame, 1);
+    ASSERT_FALSE(outputs.empty());
+    EXPECT_NE(outputs[0].data, nullptr);
+    reused[i] = outputs[0].reused;
+  }
+  EXPECT_FALSE(reused[0]);
+  EXPECT_TRUE(reused[1]);
+  EXPECT_TRUE(reused[2]);
+  EXPECT_FALSE(reused[3]);  // max_reused forces an inference
+  EXPECT_EQ(GetStats(ctx_cpu).stages[EdgeAppCoreStageCompute].count, 2u);
+  // The gate and the input share one read of each frame
+  EXPECT_EQ(GetStats(ctx_cpu).stages[EdgeAppCoreStageGetRawData].count, 4u);
+
+  // Another ROI is always inferred
+  EdgeAppLibSensorImageCropProperty roi = {0, 0, 320, 240};
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, roi);
+  ASSERT_NE(frame, 0);
+  EXPECT_FALSE(GetOutputs(ctx_cpu, frame, 1)[0].reused);
+
+  // A zero threshold never reuses
+  gate.threshold = 0.0f;
+  ASSERT_EQ(SetChangeGate(ctx_cpu, &gate), EdgeAppCoreResultSuccess);
+  for (int i = 0; i < 2; ++i) {
+    frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    ASSERT_NE(frame, 0);
+    EXPECT_FALSE(GetOutputs(ctx_cpu, frame, 1)[0].reused);
+  }
+
+  gate.threshold = -1.0f;
+  EXPECT_EQ(SetChangeGate(ctx_cpu, &gate), EdgeAppCoreResultInvalidParam);
+  EXPECT_EQ(SetChangeGate(ctx_cpu, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(ctx_cpu.change_gate, nullptr);
+  resetEdgeAppLibSensorChannelImageProperty();
+}
+
+static EdgeAppLibImageProperty converted_property;
+static std::vector<uint8_t> converted_image;
+
+static EdgeAppCoreResult CaptureInput(
+    const void *input_data, EdgeAppLibImageProperty input_property,
+    void **output_data, EdgeAppLibImageProperty *output_property) {
+  converted_property = input_property;
+  size_t size = input_property.stride_bytes * input_property.height;
+  converted_image.assign(static_cast<const uint8_t *>(input_data),
+                         static_cast<const uint8_t *>(input_data) + size);
+  *output_data = malloc(size);
+  memcpy(*output_data, input_data, size);
+  *output_property = input_property;
+  return EdgeAppCoreResultSuccess;
+}
+
+TEST_F(EdgeAppCoreTest, GreyFramesAreConvertedToRgb) {
+  ASSERT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  // Set after loading, which resets the mock property
+  EdgeAppLibSensorImageProperty image = {};
+  image.width = 5;
+  image.height = 3;
+  image.stride_bytes = 5;
+  snprintf(image.pixel_format, sizeof(image.pixel_format), "%s",
+           AITRIOS_SENSOR_PIXEL_FORMAT_GREY);
+  setEdgeAppLibSensorChannelImageProperty(image);
+
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame)
+                   .withROI(dummy_roi[0])
+                   .withPreprocessing(CaptureInput)
+                   .compute();
+  ASSERT_FALSE(frame.empty());
+  EXPECT_EQ(converted_property.width, 5u);
+  EXPECT_EQ(converted_property.height, 3u);
+  EXPECT_EQ(converted_property.stride_bytes, 15u);
+  EXPECT_STREQ(converted_property.pixel_format,
+               AITRIOS_SENSOR_PIXEL_FORMAT_RGB24);
+  ASSERT_EQ(converted_image.size(), 45u);
+  for (size_t i = 0; i < 45; i += 3) {
+    EXPECT_EQ(converted_image[i], converted_image[i + 1]);
+    EXPECT_EQ(converted_image[i], converted_image[i + 2]);
+  }
+  resetEdgeAppLibSensorChannelImageProperty();
+}
+
+TEST_F(EdgeAppCoreTest, ChangeGateDetectsChanges) {
+  std::vector<uint8_t> image(64 * 48 * 3, 100);
+  EdgeAppLibDrawBuffer src = {image.data(), image.size(),
+                              AITRIOS_DRAW_FORMAT_RGB8, 64, 48, 64 * 3};
+  EdgeAppCoreChangeGate config = {2.0f, 0};
+  ChangeGate *gate = CreateChangeGate(config);
+  ASSERT_NE(gate, nullptr);
+  EXPECT_FALSE(ChangeGateCheck(gate, src, dummy_roi[0]));
+  ChangeGateCommit(gate);
+
+  // Sensor noise stays below the threshold
+  for (size_t i = 0; i < image.size(); i += 7) image[i] = 101;
+  EXPECT_TRUE(ChangeGateCheck(gate, src, dummy_roi[0]));
+  EXPECT_TRUE(ChangeGateReused(gate));
+
+  // An object entering the left half of the scene does not
+  for (uint32_t y = 0; y < 48; ++y) {
+    memset(&image[y * 64 * 3], 200, 32 * 3);
+  }
+  EXPECT_FALSE(ChangeGateCheck(gate, src, dummy_roi[0]));
+  EXPECT_FALSE(ChangeGateReused(gate));
+  ChangeGateCommit(gate);
+  EXPECT_TRUE(ChangeGateCheck(gate, src, dummy_roi[0]));
+
+  // Invalidated outputs and short buffers are never reused
+  ChangeGateInvalidate(gate);
+  EXPECT_FALSE(ChangeGateCheck(gate, src, dummy_roi[0]));
+  ChangeGateCommit(gate);
+  src.size = 64 * 3;
+  EXPECT_FALSE(ChangeGateCheck(gate, src, dummy_roi[0]));
+  DestroyChangeGate(gate);
+}
+
+TEST_F(EdgeAppCoreTest, StageStatsCountProcessedFrames) {
+  ASSERT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  for (int i = 0; i < 3; ++i) {
+    auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame, dummy_roi[0]);
+    ASSERT_NE(frame, 0);
+    GetOutputs(ctx_cpu, frame, 1);
+    EdgeAppLib::SensorReleaseFrame(*ctx_imx500.sensor_stream, frame);
+  }
+
+  EdgeAppCoreStats stats = GetStats(ctx_cpu);
+  EXPECT_EQ(stats.stages[EdgeAppCoreStageGetFrame].count, 3u);
+  EXPECT_EQ(stats.stages[EdgeAppCoreStageGetRawData].count, 3u);
+  EXPECT_EQ(stats.stages[EdgeAppCoreStageSetInput].count, 3u);
+  EXPECT_EQ(stats.stages[EdgeAppCoreStageCompute].count, 3u);
+  EXPECT_EQ(stats.stages[EdgeAppCoreStageGetOutput].count, 3u);
+  for (uint32_t i = 0; i < EdgeAppCoreStageNum; ++i) {
+    const EdgeAppCoreStageStats &stage = stats.stages[i];
+    EXPECT_LE(stage.p50_us, stage.p95_us);
+    EXPECT_LE(stage.p95_us, stage.p99_us);
+    EXPECT_LE(stage.p99_us, stage.max_us);
+  }
+
+  resetEdgeAppLibDataExportSendStateCalled();
+  EXPECT_EQ(SendStats(ctx_cpu, "stats"), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasEdgeAppLibDataExportSendStateCalled(), 1);
+  EXPECT_EQ(SendStats(ctx_cpu, nullptr), EdgeAppCoreResultInvalidParam);
+
+  EXPECT_EQ(ResetStats(ctx_cpu), EdgeAppCoreResultSuccess);
+  stats = GetStats(ctx_cpu);
+  for (uint32_t i = 0; i < EdgeAppCoreStageNum; ++i) {
+    EXPECT_EQ(stats.stages[i].count, 0u);
+  }
+}
+
+TEST_F(EdgeAppCoreTest, StageStatsPercentiles) {
+  StageStats *stats = CreateStageStats();
+  ASSERT_NE(stats, nullptr);
+  for (uint64_t us = 1; us <= 1000; ++us) {
+    RecordStage(stats, EdgeAppCoreStageCompute, us);
+  }
+  EdgeAppCoreStats out = {};
+  ReadStageStats(stats, &out);
+  const EdgeAppCoreStageStats &compute = out.stages[EdgeAppCoreStageCompute];
+  EXPECT_EQ(compute.count, 1000u);
+  EXPECT_EQ(compute.max_us, 1000u);
+  // Buckets are at most 25% wide
+  EXPECT_GE(compute.p50_us, 500u);
+  EXPECT_LE(compute.p50_us, 625u);
+  EXPECT_GE(compute.p99_us, 990u);
+  EXPECT_LE(compute.p99_us, 1000u);
+  EXPECT_EQ(out.stages[EdgeAppCoreStageGetFrame].count, 0u);
+  DestroyStageStats(stats);
+}
+
+struct CascadeCounts {
+  std::atomic<int> sinks[3];
+  bool fail_root;
+};
+
+static uint32_t CascadeThreeRois(const Tensor *outputs, uint32_t num_outputs,
+                                 const EdgeAppLibSensorImageCropProperty &,
+                                 EdgeAppLibSensorImageCropProperty *rois,
+                                 uint32_t max_rois, void *) {
+  EXPECT_NE(outputs[0].data, nullptr);
+  EXPECT_GE(max_rois, 3u);
+  for (uint32_t i = 0; i < 3; ++i) rois[i] = {i * 10, 0, 8, 8};
+  return 3;
+}
+
+static uint32_t CascadeSameRoi(const Tensor *, uint32_t,
+                               const EdgeAppLibSensorImageCropProperty &roi,
+                               EdgeAppLibSensorImageCropProperty *rois,
+                               uint32_t, void *) {
+  rois[0] = roi;
+  return 1;
+}
+
+static EdgeAppCoreResult CascadeCount(
+    uint32_t stage, EdgeAppLibSensorFrame frame,
+    const EdgeAppLibSensorImageCropProperty &, const Tensor *outputs,
+    uint32_t num_outputs, void *user_data) {
+  CascadeCounts *counts = static_cast<CascadeCounts *>(user_data);
+  EXPECT_NE(frame, 0);
+  EXPECT_GE(num_outputs, 1u);
+  EXPECT_NE(outputs[0].data, nullptr);
+  counts->sinks[stage]++;
+  return stage == 0 && counts->fail_root ? EdgeAppCoreResultFailure
+                                         : EdgeAppCoreResultSuccess;
+}
+
+TEST_F(EdgeAppCoreTest, CascadeRunsStagesOnRois) {
+  EdgeAppCoreCtx cpu[3];
+  memset(cpu, 0, sizeof(cpu));
+  ASSERT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  for (auto &ctx : cpu) {
+    ASSERT_EQ(LoadModel(model[1], ctx, &ctx_imx500), EdgeAppCoreResultSuccess);
+  }
+
+  // Detection on the IMX500, then two CPU stages per detected ROI
+  CascadeCounts counts = {};
+  CascadeStage stages[3] = {
+      {&ctx_imx500, 1, &ctx_imx500, -1, 1, nullptr, CascadeCount, &counts},
+      {&cpu[0], 2, &ctx_imx500, 0, 1, CascadeThreeRois, CascadeCount,
+       &counts},
+      {&cpu[2], 1, &ctx_imx500, 1, 1, CascadeSameRoi, CascadeCount, &counts}};
+  Cascade *cascade = CreateCascade(stages, 3, 2, 1);
+  ASSERT_NE(cascade, nullptr);
+  for (int i = 0; i < 2; ++i) {
+    // The frame is only released by the root stage
+    resetEdgeAppLibSensorReleaseFrameCount();
+    EXPECT_EQ(RunCascade(cascade, 0, dummy_roi[0]), EdgeAppCoreResultSuccess);
+    EXPECT_EQ(getEdgeAppLibSensorReleaseFrameCount(), 1);
   }
-  free(all_outputs.data);
+  EXPECT_EQ(counts.sinks[0], 2);
+  EXPECT_EQ(counts.sinks[1], 6);
+  EXPECT_EQ(counts.sinks[2], 6);
+
+  // A failing sink stops its branch
+  counts.fail_root = true;
+  EXPECT_EQ(RunCascade(cascade, 0, dummy_roi[0]), EdgeAppCoreResultFailure);
+  EXPECT_EQ(counts.sinks[0], 3);
+  EXPECT_EQ(counts.sinks[1], 6);
+  DestroyCascade(cascade);
+
+  // Without workers, every stage runs on the calling thread
+  counts.fail_root = false;
+  cascade = CreateCascade(stages, 3, 0, 0);
+  ASSERT_NE(cascade, nullptr);
+  EXPECT_EQ(RunCascade(cascade, 0, dummy_roi[0]), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(counts.sinks[2], 9);
+  DestroyCascade(cascade);
+
+  for (auto &ctx : cpu) UnloadModel(ctx);
+}
+
+TEST_F(EdgeAppCoreTest, CascadeInvalidParam) {
+  ASSERT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  ASSERT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  CascadeStage stages[2] = {
+      {&ctx_imx500, 1, &ctx_imx500, -1, 1, nullptr, nullptr, nullptr},
+      {&ctx_cpu, 1, &ctx_imx500, 0, 1, CascadeSameRoi, nullptr, nullptr}};
+  EXPECT_EQ(CreateCascade(nullptr, 2, 1, 1), nullptr);
+  EXPECT_EQ(CreateCascade(stages, MAX_CASCADE_STAGES + 1, 1, 1), nullptr);
+  EXPECT_EQ(CreateCascade(stages, 2, 1, 0), nullptr);
+  EXPECT_EQ(CreateCascade(stages, 2, MAX_CASCADE_WORKERS + 1, 1), nullptr);
+
+  stages[1].roi_source = nullptr;
+  EXPECT_EQ(CreateCascade(stages, 2, 1, 1), nullptr);
+  stages[1].roi_source = CascadeSameRoi;
+  stages[1].parent = 1;
+  EXPECT_EQ(CreateCascade(stages, 2, 1, 1), nullptr);
+  stages[1].parent = 0;
+  // The IMX500 only runs as the root
+  stages[1].contexts = &ctx_imx500;
+  EXPECT_EQ(CreateCascade(stages, 2, 1, 1), nullptr);
+  stages[1].contexts = &ctx_cpu;
+  stages[0].parent = 0;
+  EXPECT_EQ(CreateCascade(stages, 2, 1, 1), nullptr);
+
+  EXPECT_EQ(RunCascade(nullptr, 0, dummy_roi[0]),
+            EdgeAppCoreResultInvalidParam);
+  DestroyCascade(nullptr);
 }
 
 TEST_F(EdgeAppCoreTest, GetOutputsReturnsVector) {
@@ -635,13 +1897,6 @@ TEST_F(EdgeAppCoreTest, GetOutputsReturnsVector) {
         << "Tensor " << i << " has null data";
     EXPECT_GT(outputs[i].size, 0) << "Tensor " << i << " has zero size";
   }
-
-  // Clean up
-  for (auto &tensor : outputs) {
-    if (tensor.data) {
-      free(tensor.data);
-    }
-  }
 }
 
 EdgeAppCoreResult test_preprocessing_callback(
@@ -727,13 +1982,6 @@ TEST_F(EdgeAppCoreTest, GetOutputsConsistencyWithGetOutput) {
     EXPECT_GT(outputs[i].shape_info.ndim, 0)
         << "Tensor " << i << " has zero dimensions";
   }
-
-  // Clean up
-  for (auto &tensor : outputs) {
-    if (tensor.data) {
-      free(tensor.data);
-    }
-  }
 }
 
 // Tests for ProcessedFrame Method Chaining
@@ -750,11 +1998,7 @@ TEST_F(EdgeAppCoreTest, MethodChainBasic) {
 
   EXPECT_FALSE(frame.empty());
   auto outputs = GetOutputs(ctx_cpu, frame, 4);
-  for (auto &tensor : outputs) {
-    if (tensor.data) {
-      free(tensor.data);
-    }
-  }
+  EXPECT_FALSE(outputs.empty());
 }
 
 TEST_F(EdgeAppCoreTest, MethodChainWithPreprocessing) {
@@ -771,11 +2015,7 @@ TEST_F(EdgeAppCoreTest, MethodChainWithPreprocessing) {
   EXPECT_FALSE(frame.empty());
   EXPECT_NE(static_cast<EdgeAppLibSensorFrame>(frame), 0);
   auto outputs = GetOutputs(ctx_cpu, frame, 4);
-  for (auto &tensor : outputs) {
-    if (tensor.data) {
-      free(tensor.data);
-    }
-  }
+  EXPECT_FALSE(outputs.empty());
 }
 
 TEST_F(EdgeAppCoreTest, MethodChainWithPreprocessingTensor) {
@@ -794,11 +2034,7 @@ TEST_F(EdgeAppCoreTest, MethodChainWithPreprocessingTensor) {
   auto input = GetInput(ctx_cpu, frame);
   free(input.data);
   auto outputs = GetOutputs(ctx_cpu, frame, 4);
-  for (auto &tensor : outputs) {
-    if (tensor.data) {
-      free(tensor.data);
-    }
-  }
+  EXPECT_FALSE(outputs.empty());
 }
 
 TEST_F(EdgeAppCoreTest, MethodChainFullChain) {
@@ -816,11 +2052,7 @@ TEST_F(EdgeAppCoreTest, MethodChainFullChain) {
 
   EXPECT_FALSE(frame.empty());
   auto outputs = GetOutputs(ctx_cpu, frame, 4);
-  for (auto &tensor : outputs) {
-    if (tensor.data) {
-      free(tensor.data);
-    }
-  }
+  EXPECT_FALSE(outputs.empty());
 }
 
 TEST_F(EdgeAppCoreTest, MethodChainMinimal) {
@@ -924,8 +2156,31 @@ TEST_F(EdgeAppCoreTest, SendInputTensorCPU) {
     if (tensor.data) {
       ret = SendInference(tensor.data, tensor.size, EdgeAppLibSendDataJson, 0);
       EXPECT_EQ(ret, 0);
-      free(tensor.data);
     }
   }
   // free(input.data);  // Free the data if it was dynamically allocated
 }
+
+TEST_F(EdgeAppCoreTest, SendInputTensorAsyncCPU) {
+  EXPECT_EQ(LoadModel(model[0], ctx_imx500, nullptr), EdgeAppCoreResultSuccess);
+  EXPECT_EQ(LoadModel(model[1], ctx_cpu, &ctx_imx500),
+            EdgeAppCoreResultSuccess);
+  auto frame = Process(ctx_cpu, &ctx_imx500, dummy_frame)
+                   .withPreprocessing(test_preprocessing_callback_tensor)
+                   .compute();
+  auto input = GetInput(ctx_cpu, frame);
+
+  resetEdgeAppLibSendDataAsyncImageCalled();
+  int sent = 0;
+  EXPECT_EQ(SendInputTensorAsync(&input, CountSendResult, &sent),
+            EdgeAppCoreResultSuccess);
+  EXPECT_EQ(wasEdgeAppLibSendDataAsyncImageCalled(), 1);
+  EXPECT_EQ(sent, 1);
+  // Handed over to SendData, which released it
+  if (input.memory_owner == TensorMemoryOwner::App) {
+    EXPECT_EQ(input.data, nullptr);
+  }
+
+  input.data = nullptr;
+  EXPECT_EQ(SendInputTensorAsync(&input), EdgeAppCoreResultInvalidParam);
+}
@@ -107,3 +107,58 @@ TEST_F(EdgeApplibNNTest, GetOutputSuccess) {
   EXPECT_EQ(result, EDGEAPP_LIB_NN_SUCCESS);
   EXPECT_EQ(output_size, 10u);
 }
+
+TEST_F(EdgeApplibNNTest, InputBindingNormalized) {
+  LoadModel("dummy_model.onnx", &g, EDGEAPP_TARGET_CPU);
+  InitContext(g, &ctx);
+  const float mean_values[] = {0.5f, 0.5f, 0.5f};
+  const float norm_values[] = {0.5f, 0.5f, 0.5f};
+  EdgeAppLibInputBinding *binding = nullptr;
+  auto result = CreateInputBinding(ctx, &dims, TensorTypeFloat32, mean_values,
+                                   3, norm_values, 3, &binding);
+  ASSERT_EQ(result, EDGEAPP_LIB_NN_SUCCESS);
+  ASSERT_NE(binding, nullptr);
+  for (int i = 0; i < 3; ++i) {
+    input_data[0] = i;
+    EXPECT_EQ(BindInput(binding, input_data), EDGEAPP_LIB_NN_SUCCESS);
+  }
+  DestroyInputBinding(binding);
+}
+
+TEST_F(EdgeApplibNNTest, InputBindingPassThrough) {
+  LoadModel("dummy_model.onnx", &g, EDGEAPP_TARGET_CPU);
+  InitContext(g, &ctx);
+  EdgeAppLibInputBinding *binding = nullptr;
+  auto result = CreateInputBinding(ctx, &dims, TensorTypeUInt8, nullptr, 0,
+                                   nullptr, 0, &binding);
+  ASSERT_EQ(result, EDGEAPP_LIB_NN_SUCCESS);
+  EXPECT_EQ(BindInput(binding, input_data), EDGEAPP_LIB_NN_SUCCESS);
+  EXPECT_EQ(BindInput(binding, nullptr), EDGEAPP_LIB_NN_INVALID_ARGUMENT);
+  DestroyInputBinding(binding);
+  DestroyInputBinding(nullptr);
+}
+
+TEST_F(EdgeApplibNNTest, InputBindingInvalidArgument) {
+  const float values[] = {0.0f, 1.0f, 1.0f};
+  EdgeAppLibInputBinding *binding = nullptr;
+  // Normalization only produces float32
+  EXPECT_EQ(CreateInputBinding(ctx, &dims, TensorTypeUInt8, values, 3, values,
+                               3, &binding),
+            EDGEAPP_LIB_NN_INVALID_ARGUMENT);
+  // Fewer values than channels
+  EXPECT_EQ(CreateInputBinding(ctx, &dims, TensorTypeFloat32, values, 2,
+                               nullptr, 0, &binding),
+            EDGEAPP_LIB_NN_INVALID_ARGUMENT);
+  // Division by zero
+  EXPECT_EQ(CreateInputBinding(ctx, &dims, TensorTypeFloat32, nullptr, 0,
+                               values, 3, &binding),
+            EDGEAPP_LIB_NN_INVALID_ARGUMENT);
+  uint32_t empty[4] = {1, 0, 2, 3};
+  EXPECT_EQ(CreateInputBinding(ctx, &empty, TensorTypeFloat32, nullptr, 0,
+                               values + 1, 2, &binding),
+            EDGEAPP_LIB_NN_INVALID_ARGUMENT);
+  EXPECT_EQ(CreateInputBinding(ctx, &dims, TensorTypeUInt8, nullptr, 0,
+                               nullptr, 0, nullptr),
+            EDGEAPP_LIB_NN_INVALID_ARGUMENT);
+  EXPECT_EQ(binding, nullptr);
+}
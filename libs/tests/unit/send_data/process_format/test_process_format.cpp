@@ -17,6 +17,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <vector>
+
+#include "lz4_codec.h"
 #include "mock_device.hpp"
 #include "mock_sensor.hpp"
 #include "mock_sm_api.hpp"
@@ -31,7 +34,10 @@ using namespace EdgeAppLib;
 
 class ProcessFormatTest : public ::testing::Test {
  protected:
-  void SetUp() override {}
+  void SetUp() override {
+    // new settings generation: no metadata header cached from other tests
+    resetPortSettings();
+  }
 
   void TearDown() override {
     // clear mock memory.
@@ -98,6 +104,45 @@ TEST_F(ProcessFormatTest, ProcessFormatMeta_Normal) {
   json_value_free(output_tensor_value);
 }
 
+TEST_F(ProcessFormatTest, ProcessFormatMeta_HeaderCachedUntilSettingsChange) {
+  uint8_t in_data[5] = {0x51, 0x53, 0x55, 0x57, 0x59};
+  uint32_t in_size = sizeof(in_data);
+  char buffer[PREALLOCATED_BUFFER_SIZE];
+
+  StreamSetPropertyVersionID(AITRIOS_SENSOR_INFO_STRING_AI_MODEL_VERSION,
+                             "11223344", "IMX500");
+  ASSERT_EQ(ProcessFormatMeta(in_data, in_size, EdgeAppLibSendDataBase64, 0,
+                              buffer, sizeof(buffer)),
+            kProcessFormatResultOk);
+
+  // Not read again while the settings are unchanged
+  StreamSetPropertyVersionID(AITRIOS_SENSOR_INFO_STRING_AI_MODEL_VERSION,
+                             "55667788", "IMX500");
+  ASSERT_EQ(ProcessFormatMeta(in_data, in_size, EdgeAppLibSendDataBase64, 0,
+                              buffer, sizeof(buffer)),
+            kProcessFormatResultOk);
+  JSON_Value *value = json_parse_string(buffer);
+  ASSERT_STREQ(json_object_get_string(json_object(value), "ModelID"),
+               "11223344");
+  json_value_free(value);
+
+  setPortSettingsInputTensorDisabled();
+  ASSERT_EQ(ProcessFormatMeta(in_data, in_size, EdgeAppLibSendDataBase64, 0,
+                              buffer, sizeof(buffer)),
+            kProcessFormatResultOk);
+  value = json_parse_string(buffer);
+  ASSERT_STREQ(json_object_get_string(json_object(value), "ModelID"),
+               "55667788");
+  ASSERT_EQ(json_object_get_boolean(json_object(value), "Image"), false);
+  json_value_free(value);
+
+  // Too small for the header
+  ASSERT_EQ(ProcessFormatMeta(in_data, in_size, EdgeAppLibSendDataBase64, 0,
+                              buffer, 8),
+            kProcessFormatResultMemoryError);
+  resetPortSettings();
+}
+
 TEST_F(ProcessFormatTest, ProcessFormatMeta_Normal_SizeZero) {
   uint8_t in_data[1] = {0};
   uint32_t in_size = 0;  // size is zero.
@@ -395,6 +440,22 @@ TEST_F(ProcessFormatTest, ProcessFormatMeta_Error_DataType) {
   free(buffer);
 }
 
+TEST_F(ProcessFormatTest, ProcessFormatMeta_Error_Base64BufferTooSmall) {
+  uint8_t in_data[300] = {0};
+  uint32_t in_size = sizeof(in_data);
+  uint64_t time_stamp = 10000;
+
+  StreamSetPropertyVersionID(AITRIOS_SENSOR_INFO_STRING_AI_MODEL_VERSION,
+                             "11223344", "IMX500");
+
+  // Large enough for the JSON header but not for the encoded tensor
+  char buffer[256];
+  ProcessFormatResult result =
+      ProcessFormatMeta(in_data, in_size, EdgeAppLibSendDataBase64, time_stamp,
+                        buffer, sizeof(buffer));
+  ASSERT_EQ(result, kProcessFormatResultMemoryError);
+}
+
 TEST_F(ProcessFormatTest, ProcessFormatMeta_Error_verisonId) {
   uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
   uint32_t in_size = sizeof(in_data);
@@ -427,6 +488,191 @@ TEST_F(ProcessFormatTest, ProcessFormatMeta_Error_OutNull) {
   ASSERT_EQ(result, kProcessFormatResultInvalidParam);
 }
 
+static uint64_t ReadLe(const uint8_t *p, size_t n) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < n; ++i) value |= (uint64_t)p[i] << (8 * i);
+  return value;
+}
+
+/* Position of field |id| of the FlatBuffers table at |table|, 0 if unset */
+static size_t FbField(const uint8_t *buf, size_t table, int id) {
+  size_t vtable = table - (int32_t)ReadLe(buf + table, 4);
+  if (4 + 2 * id >= ReadLe(buf + vtable, 2)) return 0;
+  size_t offset = ReadLe(buf + vtable + 4 + 2 * id, 2);
+  return offset ? table + offset : 0;
+}
+
+/* Position the uoffset_t at |field| points to */
+static size_t FbDeref(const uint8_t *buf, size_t field) {
+  return field + ReadLe(buf + field, 4);
+}
+
+TEST_F(ProcessFormatTest, ProcessFormatMetaBinary_Normal) {
+  StreamSetPropertyVersionID(AITRIOS_SENSOR_INFO_STRING_AI_MODEL_VERSION,
+                             "11223344", "IMX500");
+  ProcessFormatMetaHeader header;
+  ASSERT_EQ(ProcessFormatGetMetaHeader(&header), kProcessFormatResultOk);
+  ASSERT_STREQ(header.model_id, "11223344");
+  ASSERT_STREQ(header.device_id, "test_id");
+  ASSERT_EQ(header.image, true);
+
+  uint8_t tensor[5] = {0x51, 0x53, 0x55, 0x57, 0x59};
+  const char *json = "{\"a\":1}";
+  ProcessFormatInference inferences[2] = {
+      {tensor, sizeof(tensor), EdgeAppLibSendDataBase64, 1726161043914069133},
+      {json, (uint32_t)strlen(json), EdgeAppLibSendDataJson, 5000000}};
+  size_t buffer_size = ProcessFormatMetaBinarySize(&header, inferences, 2);
+  uint8_t *buf = (uint8_t *)malloc(buffer_size);
+  size_t size = 0;
+  ASSERT_EQ(ProcessFormatMetaBinary(&header, inferences, 2, buf, buffer_size,
+                                    &size),
+            kProcessFormatResultOk);
+  ASSERT_LE(size, buffer_size);
+
+  // MetadataEnvelope of metadata_envelope.fbs
+  ASSERT_EQ(memcmp(buf + 4, "EAMD", 4), 0);
+  size_t root = FbDeref(buf, 0);
+  size_t model_id = FbDeref(buf, FbField(buf, root, 0));
+  ASSERT_EQ(ReadLe(buf + model_id, 4), strlen("11223344"));
+  ASSERT_STREQ((const char *)buf + model_id + 4, "11223344");
+  size_t device_id = FbDeref(buf, FbField(buf, root, 1));
+  ASSERT_STREQ((const char *)buf + device_id + 4, "test_id");
+  ASSERT_EQ(buf[FbField(buf, root, 2)], 1);
+
+  size_t vector = FbDeref(buf, FbField(buf, root, 3));
+  ASSERT_EQ(ReadLe(buf + vector, 4), 2);
+  const uint64_t timestamps_ms[2] = {1726161043914, 5};
+  for (size_t i = 0; i < 2; i++) {
+    size_t inference = FbDeref(buf, vector + 4 + 4 * i);
+    ASSERT_EQ(ReadLe(buf + FbField(buf, inference, 0), 8), timestamps_ms[i]);
+    size_t output = FbDeref(buf, FbField(buf, inference, 1));
+    ASSERT_EQ(ReadLe(buf + output, 4), inferences[i].size);
+    ASSERT_EQ(memcmp(buf + output + 4, inferences[i].data, inferences[i].size),
+              0);
+    ASSERT_EQ((output + 4) % 8, 0);
+    ASSERT_EQ(buf[FbField(buf, inference, 2)], i);  // "F"
+  }
+  free(buf);
+}
+
+TEST_F(ProcessFormatTest, ProcessFormatMetaBinary_Error) {
+  ProcessFormatMetaHeader header = {"11223344", "test_id", false};
+  uint8_t tensor[64] = {0};
+  ProcessFormatInference inference = {tensor, sizeof(tensor),
+                                      EdgeAppLibSendDataBase64, 0};
+  uint8_t buf[PREALLOCATED_BUFFER_SIZE];
+  size_t size = 0;
+
+  ASSERT_EQ(ProcessFormatMetaBinary(&header, &inference, 1, buf, 64, &size),
+            kProcessFormatResultMemoryError);
+  ASSERT_EQ(ProcessFormatMetaBinary(NULL, &inference, 1, buf, sizeof(buf),
+                                    &size),
+            kProcessFormatResultInvalidParam);
+  inference.datatype = (EdgeAppLibSendDataType)99;
+  ASSERT_EQ(ProcessFormatMetaBinary(&header, &inference, 1, buf, sizeof(buf),
+                                    &size),
+            kProcessFormatResultInvalidParam);
+}
+
+TEST_F(ProcessFormatTest, ProcessFormatGetMetaFormat) {
+  ASSERT_EQ(ProcessFormatGetMetaFormat(), kProcessFormatMetaJson);
+  setPortSettingsMetadataFormat(2, 1);
+  ASSERT_EQ(ProcessFormatGetMetaFormat(), kProcessFormatMetaBinary);
+  setPortSettingsMetadataFormat(1, 1);
+  ASSERT_EQ(ProcessFormatGetMetaFormat(), kProcessFormatMetaBinary);
+  // MQTT telemetry stays JSON
+  setPortSettingsMetadataFormat(0, 1);
+  ASSERT_EQ(ProcessFormatGetMetaFormat(), kProcessFormatMetaJson);
+  setPortSettingsMetadataFormat(2, 0);
+  ASSERT_EQ(ProcessFormatGetMetaFormat(), kProcessFormatMetaJson);
+  resetPortSettings();
+}
+
+TEST_F(ProcessFormatTest, ProcessFormatGetCompression) {
+  ASSERT_EQ(ProcessFormatGetCompression(kProcessFormatPortMetadata),
+            kProcessFormatCompressionNone);
+  setCodecSettingsCompression(1, 2);
+  ASSERT_EQ(ProcessFormatGetCompression(kProcessFormatPortMetadata),
+            kProcessFormatCompressionLz4);
+  ASSERT_EQ(ProcessFormatGetCompression(kProcessFormatPortInputTensor),
+            kProcessFormatCompressionLz4Auto);
+  // MQTT telemetry is sent as is
+  setPortSettings(0);
+  ASSERT_EQ(ProcessFormatGetCompression(kProcessFormatPortMetadata),
+            kProcessFormatCompressionNone);
+  resetPortSettings();
+  resetCodecSettings();
+}
+
+TEST_F(ProcessFormatTest, ProcessFormatCompress) {
+  ProcessFormatResetCompressionStats();
+  std::vector<uint8_t> map(10000);
+  for (size_t i = 0; i < map.size(); ++i) map[i] = (i / 300) % 3;
+  std::vector<uint8_t> noise(10000);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < noise.size(); ++i) {
+    seed = seed * 1103515245 + 12345;
+    noise[i] = seed >> 24;
+  }
+
+  void *frame = (void *)1;
+  uint32_t size = 1;
+  ASSERT_EQ(ProcessFormatCompress(kProcessFormatPortMetadata,
+                                  kProcessFormatCompressionNone, map.data(),
+                                  map.size(), &frame, &size),
+            kProcessFormatResultOk);
+  ASSERT_EQ(frame, nullptr);
+  ASSERT_EQ(size, 0);
+
+  ASSERT_EQ(ProcessFormatCompress(kProcessFormatPortMetadata,
+                                  kProcessFormatCompressionLz4Auto, map.data(),
+                                  map.size(), &frame, &size),
+            kProcessFormatResultOk);
+  ASSERT_NE(frame, nullptr);
+  ASSERT_LT(size, map.size() / 8);
+  std::vector<uint8_t> out(map.size());
+  size_t out_size = out.size();
+  ASSERT_EQ(lz4_decompress(frame, size, out.data(), &out_size), 0);
+  ASSERT_EQ(out, map);
+  free(frame);
+  uint32_t map_frame_size = size;
+
+  // Auto mode sends data that does not compress as is
+  ASSERT_EQ(ProcessFormatCompress(kProcessFormatPortMetadata,
+                                  kProcessFormatCompressionLz4Auto,
+                                  noise.data(), noise.size(), &frame, &size),
+            kProcessFormatResultOk);
+  ASSERT_EQ(frame, nullptr);
+  ASSERT_EQ(ProcessFormatCompress(kProcessFormatPortInputTensor,
+                                  kProcessFormatCompressionLz4, noise.data(),
+                                  noise.size(), &frame, &size),
+            kProcessFormatResultOk);
+  ASSERT_NE(frame, nullptr);
+  free(frame);
+
+  ProcessFormatCompressionStats stats;
+  ProcessFormatGetCompressionStats(kProcessFormatPortMetadata, &stats);
+  ASSERT_EQ(stats.compressed, 1);
+  ASSERT_EQ(stats.skipped, 1);
+  ASSERT_EQ(stats.in_bytes, map.size() + noise.size());
+  ASSERT_EQ(stats.out_bytes, map_frame_size + noise.size());
+  ProcessFormatGetCompressionStats(kProcessFormatPortInputTensor, &stats);
+  ASSERT_EQ(stats.compressed, 1);
+  ASSERT_EQ(stats.out_bytes, size);
+
+  ASSERT_EQ(ProcessFormatCompress(kProcessFormatPortNum,
+                                  kProcessFormatCompressionLz4, map.data(),
+                                  map.size(), &frame, &size),
+            kProcessFormatResultInvalidParam);
+  ASSERT_EQ(ProcessFormatCompress(kProcessFormatPortMetadata,
+                                  kProcessFormatCompressionLz4, nullptr, 10,
+                                  &frame, &size),
+            kProcessFormatResultInvalidParam);
+  ProcessFormatResetCompressionStats();
+  ProcessFormatGetCompressionStats(kProcessFormatPortInputTensor, &stats);
+  ASSERT_EQ(stats.in_bytes, 0);
+}
+
 TEST_F(ProcessFormatTest, ProcessFormatInputRawMap) {
   uint32_t in_size = 300 * 300 * 3;  // RGB24
   void *in_data = malloc(in_size);
@@ -448,6 +694,57 @@ TEST_F(ProcessFormatTest, ProcessFormatInputRawMap) {
   free(image);
 }
 
+TEST_F(ProcessFormatTest, ProcessFormatInputToBufferReused) {
+  uint32_t in_size = 300 * 300 * 3;  // RGB24
+  void *in_data = calloc(1, in_size);
+  MemoryRef data = {MEMORY_MANAGER_MAP_TYPE, in_data};
+  EdgeAppLibImageProperty image_property = {};
+  image_property.height = 300;
+  image_property.width = 300;
+  image_property.stride_bytes = 300 * 3;  // RGB24
+  strncpy(image_property.pixel_format, AITRIOS_SENSOR_PIXEL_FORMAT_RGB24,
+          sizeof(image_property.pixel_format));
+  int32_t image_size = 0;
+  void *buffer = nullptr;
+  size_t capacity = 0;
+
+  auto result = ProcessFormatInputToBuffer(data, in_size / 2,
+                                           kProcessFormatImageTypeRaw,
+                                           &image_property, &buffer, &capacity,
+                                           &image_size);
+  EXPECT_EQ(result, kProcessFormatResultOk);
+  EXPECT_EQ(image_size, in_size / 2);
+  EXPECT_GE(capacity, in_size / 2);
+  void *first = buffer;
+
+  // Large enough: reused
+  result = ProcessFormatInputToBuffer(data, in_size / 4,
+                                      kProcessFormatImageTypeRaw,
+                                      &image_property, &buffer, &capacity,
+                                      &image_size);
+  EXPECT_EQ(result, kProcessFormatResultOk);
+  EXPECT_EQ(buffer, first);
+  EXPECT_EQ(image_size, in_size / 4);
+
+  // Too small: replaced
+  result = ProcessFormatInputToBuffer(data, in_size,
+                                      kProcessFormatImageTypeJpeg,
+                                      &image_property, &buffer, &capacity,
+                                      &image_size);
+  EXPECT_EQ(result, kProcessFormatResultOk);
+  EXPECT_GT(image_size, 0);
+  EXPECT_GE(capacity, (size_t)image_size);
+
+  result = ProcessFormatInputToBuffer(data, in_size, kProcessFormatImageTypeBmp,
+                                      &image_property, &buffer, &capacity,
+                                      &image_size);
+  EXPECT_EQ(result, kProcessFormatResultInvalidParam);
+  EXPECT_NE(buffer, nullptr);
+
+  free(buffer);
+  free(in_data);
+}
+
 TEST_F(ProcessFormatTest, ProcessFormatInputRawFileIO) {
   EsfMemoryManagerHandle in_data = (EsfMemoryManagerHandle)0x20000000;
   MemoryRef data;
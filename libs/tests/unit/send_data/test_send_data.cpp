@@ -17,11 +17,16 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <vector>
+
+#include "data_export/mock_data_export.hpp"
 #include "mock_device.hpp"
 #include "mock_process_format.hpp"
 #include "mock_sensor.hpp"
 #include "mock_sm_api.hpp"
+#include "parson.h"
 #include "send_data.h"
+#include "send_data_private.h"
 
 using namespace EdgeAppLib;
 
@@ -32,7 +37,10 @@ class SendDataTest : public ::testing::Test {
     setNumOfInfPerMsg(1);
   }
 
-  void TearDown() override {}
+  void TearDown() override {
+    // drop the inferences left batched
+    SendDataFlushInferences(0);
+  }
 };
 
 TEST_F(SendDataTest, SendDataSyncMeta_Normal) {
@@ -272,6 +280,275 @@ TEST_F(SendDataTest,
   setNumOfInfPerMsg(1);
 }
 
+TEST_F(SendDataTest, SendDataSyncMeta_Normal_InferencesBatched) {
+  setNumOfInfPerMsg(3);
+  setProcessFormatMetaOutput("333");
+
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  uint32_t in_size = sizeof(in_data);
+  int sent = getEdgeAppLibDataExportSendDataCount();
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 3000),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 1000),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 2000),
+            EdgeAppLibSendDataResultSuccess);
+  // one message, with the smallest timestamp
+  ASSERT_EQ(getEdgeAppLibDataExportSendDataCount(), sent + 1);
+  ASSERT_EQ(getEdgeAppLibDataExportSentTimestamp(), 1000);
+
+  JSON_Value *value = json_parse_string(getEdgeAppLibDataExportSentMetadata());
+  ASSERT_NE(value, nullptr);
+  JSON_Object *object = json_object(value);
+  ASSERT_STREQ(json_object_get_string(object, "ModelID"), "333");
+  JSON_Array *inferences = json_object_get_array(object, "Inferences");
+  ASSERT_EQ(json_array_get_count(inferences), 3);
+  for (size_t i = 0; i < 3; i++) {
+    JSON_Object *inference = json_array_get_object(inferences, i);
+    ASSERT_STREQ(json_object_get_string(inference, "O"), "abcdef");
+  }
+  json_value_free(value);
+
+  setNumOfInfPerMsg(1);
+}
+
+TEST_F(SendDataTest, SendDataSyncMeta_Normal_InferencesBatchWindow) {
+  setNumOfInfPerMsg(10);
+  setProcessFormatMetaOutput("444");
+
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  uint32_t in_size = sizeof(in_data);
+  uint64_t window_ns = INFERENCE_BATCH_WINDOW_MS * 1000000ULL;
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 5),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64,
+                             window_ns),
+            EdgeAppLibSendDataResultEnqueued);
+  // sent before reaching the number of inferences once the window is over
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64,
+                             window_ns + 5),
+            EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(getEdgeAppLibDataExportSentTimestamp(), 5);
+
+  JSON_Value *value = json_parse_string(getEdgeAppLibDataExportSentMetadata());
+  JSON_Array *inferences =
+      json_object_get_array(json_object(value), "Inferences");
+  ASSERT_EQ(json_array_get_count(inferences), 3);
+  json_value_free(value);
+
+  setNumOfInfPerMsg(1);
+}
+
+TEST_F(SendDataTest, SendDataSyncMeta_Binary_Normal) {
+  setProcessFormatMetaFormat(kProcessFormatMetaBinary);
+  setProcessFormatMetaOutput("555");
+
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  ASSERT_EQ(SendDataSyncMeta(in_data, sizeof(in_data),
+                             EdgeAppLibSendDataBase64, 7000000, 0),
+            EdgeAppLibSendDataResultSuccess);
+  ASSERT_STREQ(getEdgeAppLibDataExportSentMetadata(), "555;7");
+
+  setProcessFormatMetaFormat(kProcessFormatMetaJson);
+}
+
+TEST_F(SendDataTest, SendDataSyncMeta_Binary_InferencesBatched) {
+  setNumOfInfPerMsg(3);
+  setProcessFormatMetaFormat(kProcessFormatMetaBinary);
+
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  uint32_t in_size = sizeof(in_data);
+  int sent = getEdgeAppLibDataExportSendDataCount();
+  setProcessFormatMetaOutput("666");
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64,
+                             3000000, 0),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64,
+                             1000000, 0),
+            EdgeAppLibSendDataResultEnqueued);
+  setProcessFormatMetaOutput("777");
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, EdgeAppLibSendDataBase64,
+                             2000000, 0),
+            EdgeAppLibSendDataResultSuccess);
+  // one envelope per header
+  ASSERT_EQ(getEdgeAppLibDataExportSendDataCount(), sent + 2);
+  ASSERT_STREQ(getEdgeAppLibDataExportSentMetadata(), "777;2");
+  ASSERT_EQ(getEdgeAppLibDataExportSentTimestamp(), 2000000);
+
+  // invalid datatype is rejected when batching
+  ASSERT_EQ(SendDataSyncMeta(in_data, in_size, (EdgeAppLibSendDataType)99,
+                             4000000, 0),
+            EdgeAppLibSendDataResultInvalidParam);
+
+  setProcessFormatMetaFormat(kProcessFormatMetaJson);
+  setNumOfInfPerMsg(1);
+}
+
+static void RecordResult(EdgeAppLibSendDataResult result, void *user_data) {
+  ((std::vector<EdgeAppLibSendDataResult> *)user_data)->push_back(result);
+}
+
+TEST_F(SendDataTest, SendDataAsyncMeta_Normal) {
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  uint32_t in_size = sizeof(in_data);
+  std::vector<EdgeAppLibSendDataResult> results;
+  int sent = getEdgeAppLibDataExportSendDataCount();
+
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 1000,
+                              RecordResult, &results),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataAsyncDrain(0), EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(getEdgeAppLibDataExportSendDataCount(), sent + 1);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0], EdgeAppLibSendDataResultSuccess);
+}
+
+TEST_F(SendDataTest, SendDataAsyncMeta_Error_InDataNULL) {
+  std::vector<EdgeAppLibSendDataResult> results;
+  ASSERT_EQ(SendDataAsyncMeta(nullptr, 5, EdgeAppLibSendDataBase64, 1000,
+                              RecordResult, &results),
+            EdgeAppLibSendDataResultInvalidParam);
+  ASSERT_TRUE(results.empty());
+}
+
+TEST_F(SendDataTest, SendDataAsyncMeta_OverflowPolicies) {
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  uint32_t in_size = sizeof(in_data);
+  std::vector<EdgeAppLibSendDataResult> first, second, third, fourth;
+  setEdgeAppLibDataExportCompletionDeferred(true);
+  int sent = getEdgeAppLibDataExportSendDataCount();
+
+  // One message in flight and one waiting
+  ASSERT_EQ(
+      SendDataSetAsyncPolicy(2, EdgeAppLibSendDataOverflowDropNewest),
+      EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 1,
+                              RecordResult, &first),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 2,
+                              RecordResult, &second),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(getEdgeAppLibDataExportSendDataCount(), sent + 1);
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 3,
+                              RecordResult, &third),
+            EdgeAppLibSendDataResultDropped);
+  ASSERT_EQ(third.size(), 1);
+  ASSERT_EQ(third[0], EdgeAppLibSendDataResultDropped);
+
+  // The waiting message gives way to the new one
+  ASSERT_EQ(
+      SendDataSetAsyncPolicy(2, EdgeAppLibSendDataOverflowDropOldest),
+      EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 4,
+                              RecordResult, &fourth),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(second.size(), 1);
+  ASSERT_EQ(second[0], EdgeAppLibSendDataResultDropped);
+  ASSERT_EQ(SendDataAsyncDrain(0), EdgeAppLibSendDataResultTimeout);
+
+  // Each completion hands the next message to EVP
+  ASSERT_EQ(completeEdgeAppLibDataExportDeferred(false), 1);
+  ASSERT_EQ(first.size(), 1);
+  ASSERT_EQ(first[0], EdgeAppLibSendDataResultFailure);
+  ASSERT_EQ(getEdgeAppLibDataExportSendDataCount(), sent + 2);
+  ASSERT_EQ(getEdgeAppLibDataExportSentTimestamp(), 4);
+  ASSERT_EQ(completeEdgeAppLibDataExportDeferred(true), 0);
+  ASSERT_EQ(fourth.size(), 1);
+  ASSERT_EQ(fourth[0], EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(SendDataAsyncDrain(0), EdgeAppLibSendDataResultSuccess);
+
+  setEdgeAppLibDataExportCompletionDeferred(false);
+  ASSERT_EQ(SendDataSetAsyncPolicy(SEND_DATA_ASYNC_DEFAULT_QUEUE_SIZE,
+                                   EdgeAppLibSendDataOverflowBlock),
+            EdgeAppLibSendDataResultSuccess);
+}
+
+struct ReentrantSend {
+  std::vector<EdgeAppLibSendDataResult> results;
+  std::vector<EdgeAppLibSendDataResult> nested;
+};
+
+// Queues two more messages from the completion of the first one
+static void SendFromCallback(EdgeAppLibSendDataResult result,
+                             void *user_data) {
+  ReentrantSend *send = (ReentrantSend *)user_data;
+  send->results.push_back(result);
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  for (int i = 0; i < 2; ++i) {
+    send->nested.push_back(SendDataAsyncMeta(
+        in_data, sizeof(in_data), EdgeAppLibSendDataBase64, 10 + i));
+  }
+}
+
+TEST_F(SendDataTest, SendDataAsyncMeta_BlockFromCallbackDrops) {
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  uint32_t in_size = sizeof(in_data);
+  ReentrantSend send;
+  setEdgeAppLibDataExportCompletionDeferred(true);
+  ASSERT_EQ(SendDataSetAsyncPolicy(2, EdgeAppLibSendDataOverflowBlock),
+            EdgeAppLibSendDataResultSuccess);
+
+  // One message in flight and one waiting
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 1,
+                              SendFromCallback, &send),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 2),
+            EdgeAppLibSendDataResultEnqueued);
+
+  // The queue is full again in the callback, which must not wait for the
+  // uploads completing on its own thread
+  completeEdgeAppLibDataExportDeferred(true);
+  ASSERT_EQ(send.results.size(), 1);
+  ASSERT_EQ(send.nested.size(), 2);
+  ASSERT_EQ(send.nested[0], EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(send.nested[1], EdgeAppLibSendDataResultDropped);
+
+  while (completeEdgeAppLibDataExportDeferred(true) > 0) {
+  }
+  ASSERT_EQ(SendDataAsyncDrain(0), EdgeAppLibSendDataResultSuccess);
+  setEdgeAppLibDataExportCompletionDeferred(false);
+  ASSERT_EQ(SendDataSetAsyncPolicy(SEND_DATA_ASYNC_DEFAULT_QUEUE_SIZE,
+                                   EdgeAppLibSendDataOverflowBlock),
+            EdgeAppLibSendDataResultSuccess);
+}
+
+TEST_F(SendDataTest, SendDataAsyncMeta_InferencesBatched) {
+  setNumOfInfPerMsg(2);
+  setProcessFormatMetaOutput("555");
+
+  uint8_t in_data[5] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9};
+  uint32_t in_size = sizeof(in_data);
+  std::vector<EdgeAppLibSendDataResult> results;
+  int sent = getEdgeAppLibDataExportSendDataCount();
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 1,
+                              RecordResult, &results),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(getEdgeAppLibDataExportSendDataCount(), sent);
+  ASSERT_EQ(SendDataAsyncMeta(in_data, in_size, EdgeAppLibSendDataBase64, 2,
+                              RecordResult, &results),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataAsyncDrain(0), EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(getEdgeAppLibDataExportSendDataCount(), sent + 1);
+  ASSERT_EQ(results.size(), 1);
+
+  JSON_Value *value = json_parse_string(getEdgeAppLibDataExportSentMetadata());
+  ASSERT_NE(value, nullptr);
+  JSON_Array *inferences = json_object_get_array(json_object(value),
+                                                 "Inferences");
+  ASSERT_EQ(json_array_get_count(inferences), 2);
+  json_value_free(value);
+
+  setNumOfInfPerMsg(1);
+}
+
+TEST_F(SendDataTest, SendDataSetAsyncPolicy_InvalidParam) {
+  ASSERT_EQ(SendDataSetAsyncPolicy(0, EdgeAppLibSendDataOverflowBlock),
+            EdgeAppLibSendDataResultInvalidParam);
+  ASSERT_EQ(SendDataSetAsyncPolicy(SEND_DATA_ASYNC_MAX_QUEUE_SIZE + 1,
+                                   EdgeAppLibSendDataOverflowBlock),
+            EdgeAppLibSendDataResultInvalidParam);
+}
+
 TEST_F(SendDataTest, SendDataSyncImage_SuccessRGB) {
   uint8_t in_data[12] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9, 0xab,
                          0xac, 0xad, 0xae, 0xaf, 0xb0, 0xb1};
@@ -318,3 +595,157 @@ TEST_F(SendDataTest, SendDataSyncImage_InvalidParam) {
       SendDataSyncImage(in_data, in_size, nullptr, time_stamp, timeout_ms);
   ASSERT_EQ(result, EdgeAppLibSendDataResultInvalidParam);
 }
+
+struct ImageRecord {
+  int released = 0;
+  std::vector<EdgeAppLibSendDataResult> results;
+};
+
+static void RecordImageRelease(void *data, void *user_data) {
+  ((ImageRecord *)user_data)->released++;
+}
+
+static void RecordImageResult(EdgeAppLibSendDataResult result,
+                              void *user_data) {
+  ((ImageRecord *)user_data)->results.push_back(result);
+}
+
+static EdgeAppLibImageProperty AsyncImageProperty() {
+  EdgeAppLibImageProperty image_property = {};
+  image_property.width = 2;
+  image_property.height = 2;
+  image_property.stride_bytes = 2 * 3;
+  snprintf(image_property.pixel_format, sizeof(image_property.pixel_format),
+           "%s", AITRIOS_SENSOR_PIXEL_FORMAT_RGB24);
+  return image_property;
+}
+
+TEST_F(SendDataTest, SendDataAsyncImage_Normal) {
+  uint8_t in_data[12] = {0xa1, 0xa3, 0xa5, 0xa7, 0xa9, 0xab,
+                         0xac, 0xad, 0xae, 0xaf, 0xb0, 0xb1};
+  EdgeAppLibImageProperty image_property = AsyncImageProperty();
+  ImageRecord first, second;
+
+  ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property,
+                               10000, RecordImageRelease, RecordImageResult,
+                               &first),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataAsyncDrain(10000), EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(first.released, 1);
+  ASSERT_EQ(first.results.size(), 1);
+  ASSERT_EQ(first.results[0], EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(getEdgeAppLibDataExportSentTimestamp(), 10000);
+  const void *buffer = getEdgeAppLibDataExportBorrowedData();
+  ASSERT_NE(buffer, nullptr);
+
+  // The encoded image goes to the same pooled buffer
+  ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property,
+                               20000, RecordImageRelease, RecordImageResult,
+                               &second),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataAsyncDrain(10000), EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(second.released, 1);
+  ASSERT_EQ(second.results.size(), 1);
+  ASSERT_EQ(getEdgeAppLibDataExportBorrowedData(), buffer);
+}
+
+TEST_F(SendDataTest, SendDataAsyncImage_Error) {
+  uint8_t in_data[12] = {};
+  EdgeAppLibImageProperty image_property = AsyncImageProperty();
+  ImageRecord record;
+
+  ASSERT_EQ(SendDataAsyncImage(nullptr, sizeof(in_data), &image_property, 1,
+                               RecordImageRelease, RecordImageResult,
+                               &record),
+            EdgeAppLibSendDataResultInvalidParam);
+  ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), nullptr, 1,
+                               RecordImageRelease, RecordImageResult,
+                               &record),
+            EdgeAppLibSendDataResultInvalidParam);
+  setEdgeAppLibDataExportIsEnabledDisabled();
+  ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property, 1,
+                               RecordImageRelease, RecordImageResult,
+                               &record),
+            EdgeAppLibSendDataResultDenied);
+  resetEdgeAppLibDataExportIsEnabled();
+  ASSERT_EQ(record.released, 0);
+  ASSERT_TRUE(record.results.empty());
+
+  // Released even when the encoding fails
+  setProcessFormatInputResult(kProcessFormatResultFailure);
+  ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property, 1,
+                               RecordImageRelease, RecordImageResult,
+                               &record),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(SendDataAsyncDrain(10000), EdgeAppLibSendDataResultSuccess);
+  setProcessFormatInputResult(kProcessFormatResultOk);
+  ASSERT_EQ(record.released, 1);
+  ASSERT_EQ(record.results.size(), 1);
+  ASSERT_EQ(record.results[0], EdgeAppLibSendDataResultFailure);
+}
+
+TEST_F(SendDataTest, SendDataAsyncImage_OverflowPolicies) {
+  uint8_t in_data[12] = {};
+  EdgeAppLibImageProperty image_property = AsyncImageProperty();
+  ImageRecord records[6];
+  setEdgeAppLibDataExportCompletionDeferred(true);
+
+  // Every pooled buffer uploading
+  for (int i = 0; i < SEND_DATA_ASYNC_IMAGE_POOL_SIZE; ++i) {
+    ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property, i,
+                                 RecordImageRelease, RecordImageResult,
+                                 &records[i]),
+              EdgeAppLibSendDataResultEnqueued);
+  }
+  ASSERT_TRUE(
+      waitEdgeAppLibDataExportDeferred(SEND_DATA_ASYNC_IMAGE_POOL_SIZE, 10000));
+
+  // The worker waits for a buffer: the queue fills up, blocking until the
+  // last image handed to EVP leaves it
+  for (int i = 2; i < 4; ++i) {
+    ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property, i,
+                                 RecordImageRelease, RecordImageResult,
+                                 &records[i]),
+              EdgeAppLibSendDataResultEnqueued);
+  }
+  ASSERT_EQ(SendDataSetAsyncPolicy(SEND_DATA_ASYNC_DEFAULT_QUEUE_SIZE,
+                                   EdgeAppLibSendDataOverflowDropNewest),
+            EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property, 4,
+                               RecordImageRelease, RecordImageResult,
+                               &records[4]),
+            EdgeAppLibSendDataResultDropped);
+  ASSERT_EQ(records[4].released, 0);
+  ASSERT_EQ(records[4].results.size(), 1);
+  ASSERT_EQ(records[4].results[0], EdgeAppLibSendDataResultDropped);
+
+  // A waiting image gives way to the new one
+  ASSERT_EQ(SendDataSetAsyncPolicy(SEND_DATA_ASYNC_DEFAULT_QUEUE_SIZE,
+                                   EdgeAppLibSendDataOverflowDropOldest),
+            EdgeAppLibSendDataResultSuccess);
+  ASSERT_EQ(SendDataAsyncImage(in_data, sizeof(in_data), &image_property, 5,
+                               RecordImageRelease, RecordImageResult,
+                               &records[5]),
+            EdgeAppLibSendDataResultEnqueued);
+  ASSERT_EQ(records[2].results.size() + records[3].results.size(), 1);
+  ASSERT_EQ(SendDataAsyncDrain(0), EdgeAppLibSendDataResultTimeout);
+
+  // Each completed upload frees a buffer for the next image
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(waitEdgeAppLibDataExportDeferred(1, 10000));
+    completeEdgeAppLibDataExportDeferred(true);
+  }
+  ASSERT_EQ(SendDataAsyncDrain(10000), EdgeAppLibSendDataResultSuccess);
+  int dropped = 0;
+  for (int i : {0, 1, 2, 3, 5}) {
+    ASSERT_EQ(records[i].released, 1);
+    ASSERT_EQ(records[i].results.size(), 1);
+    if (records[i].results[0] == EdgeAppLibSendDataResultDropped) dropped++;
+  }
+  ASSERT_EQ(dropped, 1);
+
+  setEdgeAppLibDataExportCompletionDeferred(false);
+  ASSERT_EQ(SendDataSetAsyncPolicy(SEND_DATA_ASYNC_DEFAULT_QUEUE_SIZE,
+                                   EdgeAppLibSendDataOverflowBlock),
+            EdgeAppLibSendDataResultSuccess);
+}
@@ -58,3 +58,27 @@ TEST(CodecSettings, DefaultValue) {
   int format = json_object_get_number(jsonObj, "format");
   ASSERT_EQ(format, 1);
 }
+
+TEST(CodecSettings, Compression) {
+  CodecSettings obj;
+  JSON_Object *jsonObj = obj.GetJsonObject();
+  ASSERT_FALSE(json_object_has_value(jsonObj, "metadata_compression"));
+
+  JSON_Value *value = json_parse_string(
+      "{\"metadata_compression\": 2, \"input_tensor_compression\": 1}");
+  ASSERT_EQ(obj.Verify(json_object(value)), 0);
+  obj.Apply(json_object(value));
+  json_value_free(value);
+  ASSERT_EQ(json_object_get_number(jsonObj, "metadata_compression"), 2);
+  ASSERT_EQ(json_object_get_number(jsonObj, "input_tensor_compression"), 1);
+  ASSERT_EQ(json_object_get_number(jsonObj, "format"), 1);
+
+  for (const char *input :
+       {"{\"metadata_compression\": 3}", "{\"input_tensor_compression\": -1}",
+        "{\"metadata_compression\": \"lz4\"}"}) {
+    value = json_parse_string(input);
+    ASSERT_EQ(obj.Verify(json_object(value)), -1) << input;
+    json_value_free(value);
+  }
+  obj.Delete();
+}
@@ -72,6 +72,16 @@ TEST(PortSetting, VerifyFailed) {
   ASSERT_EQ(ps.Verify(json_object(value)), 0);
   json_value_free(value);
 
+  value = json_parse_string("{\"format\": 2}");
+  ASSERT_EQ(ps.Verify(json_object(value)), -1);
+  json_value_free(value);
+  value = json_parse_string("{\"format\": \"binary\"}");
+  ASSERT_EQ(ps.Verify(json_object(value)), -1);
+  json_value_free(value);
+  value = json_parse_string("{\"format\": 1}");
+  ASSERT_EQ(ps.Verify(json_object(value)), 0);
+  json_value_free(value);
+
   value = json_parse_string("{\"enabled\": 3}");
   ASSERT_EQ(ps.Verify(json_object(value)), -1);
   json_value_free(value);
@@ -100,6 +110,17 @@ TEST(PortSetting, Apply) {
   ps.Delete();
 }
 
+TEST(PortSetting, Format) {
+  PortSetting metadata(PS_METADATA);
+  ASSERT_FALSE(json_object_has_value(metadata.GetJsonObject(), "format"));
+  ASSERT_EQ(metadata.GetFormat(), 0);
+  JSON_Value *value = json_parse_string("{\"format\": 1}");
+  metadata.Apply(json_object(value));
+  ASSERT_EQ(metadata.GetFormat(), 1);
+  json_value_free(value);
+  metadata.Delete();
+}
+
 TEST(PortSetting, EmptyJson) {
   PortSetting obj(PS_INFERENCE);
   JSON_Value *value = json_parse_string("{}");
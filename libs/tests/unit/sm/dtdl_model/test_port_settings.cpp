@@ -243,3 +243,27 @@ TEST_F(PortSettingsTest, ApplyStreamChannelsError) {
   ps.Delete();
   json_value_free(value);
 }
+
+static uint32_t header_generation = 0;
+
+static void RebuildHeader(const char *property_key) {
+  // what a sender thread caches when it rebuilds the header mid-apply
+  header_generation =
+      StateMachineContext::GetInstance(nullptr)->GetSettingsGeneration();
+}
+
+TEST_F(PortSettingsTest, GenerationBumpedAfterApply) {
+  JSON_Value *value = json_parse_string(TEST_PORT_SETTINGS_11);
+  JSON_Object *object = json_object(value);
+  setEdgeAppLibSensorStreamSetPropertyHook(RebuildHeader);
+  PortSettings ps;
+  ps.Verify(object);
+  ASSERT_EQ(ps.Apply(object), 0);
+  resetEdgeAppLibSensorStreamSetPropertyHook();
+
+  // the header built during Apply must not be valid afterwards
+  ASSERT_NE(context->GetSettingsGeneration(), header_generation);
+
+  ps.Delete();
+  json_value_free(value);
+}
@@ -17,6 +17,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "data_export/mock_data_export.hpp"
+#include "data_export_private.h"
 #include "dtdl_model/properties.h"
 #include "event_functions/mock_sm.hpp"
 #include "evp/mock_evp.hpp"
@@ -114,6 +116,31 @@ TEST_P(RunningTest, StartStop) {
 INSTANTIATE_TEST_CASE_P(IterateCreatesThread, RunningTest,
                         Range(0, REPEAT_TEST));
 
+static void IgnoreCompletion(EdgeAppLibDataExportResult, void *) {}
+
+static void *CompleteUploadLater(void *) {
+  usleep(100000);
+  completeEdgeAppLibDataExportDeferred(true);
+  return nullptr;
+}
+
+TEST(RunningTest, StopWaitsForPendingUploads) {
+  RunningThread running_thread;
+  running_thread.ThreadStart();
+  setEdgeAppLibDataExportCompletionDeferred(true);
+  EdgeAppLib::DataExportSetCompletionCallback(nullptr, IgnoreCompletion,
+                                              nullptr);
+  ASSERT_TRUE(EdgeAppLib::DataExportHasPendingOperations());
+
+  pthread_t thread;
+  pthread_create(&thread, nullptr, CompleteUploadLater, nullptr);
+  running_thread.ThreadStop();
+  ASSERT_FALSE(EdgeAppLib::DataExportHasPendingOperations());
+
+  pthread_join(thread, nullptr);
+  setEdgeAppLibDataExportCompletionDeferred(false);
+}
+
 TEST_P(RunningTest, StopUninitialized) {
   RunningThread running_thread;
   running_thread.ThreadStart();
@@ -353,3 +353,21 @@ TEST_F(StateMachineApiTest, GetSensorStream) {
   stream = GetSensorStream();
   ASSERT_EQ(stream, 0x123456);
 }
+
+TEST_F(StateMachineApiTest, SettingsGeneration) {
+  uint32_t generation = getSettingsGeneration();
+  context->SetSensorStream(stream);
+  ASSERT_NE(getSettingsGeneration(), generation);
+
+  generation = getSettingsGeneration();
+  EdgeAppLibSensorAiModelBundleIdProperty bundle = {"000001"};
+  updateProperty(stream, AITRIOS_SENSOR_AI_MODEL_BUNDLE_ID_PROPERTY_KEY,
+                 &bundle, sizeof(bundle));
+  ASSERT_NE(getSettingsGeneration(), generation);
+
+  generation = getSettingsGeneration();
+  EdgeAppLibSensorCameraFrameRateProperty frame_rate = {30, 1};
+  updateProperty(stream, AITRIOS_SENSOR_CAMERA_FRAME_RATE_PROPERTY_KEY,
+                 &frame_rate, sizeof(frame_rate));
+  ASSERT_EQ(getSettingsGeneration(), generation);
+}
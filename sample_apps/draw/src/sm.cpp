@@ -18,6 +18,8 @@
 
 #include <stdlib.h>
 
+#include <vector>
+
 #include "data_export.h"
 #include "data_processor_api.hpp"
 #include "detection_utils.hpp"
@@ -134,15 +136,22 @@ static EdgeAppLibDataExportFuture *sendInputTensor(
     auto object_detection_root = SmartCamera::GetObjectDetectionTop(s_metadata);
     auto obj_detection_data =
         object_detection_root->perception()->object_detection_list();
+    std::vector<EdgeAppLibDrawBox> boxes;
+    boxes.reserve(obj_detection_data->size());
     for (int i = 0; i < obj_detection_data->size(); ++i) {
       auto general_object = obj_detection_data->Get(i);
 
       auto bbox = general_object->bounding_box_as_BoundingBox2d();
       LOG_DBG("box[%d]=[ %d, %d, %d, %d]", i, bbox->left(), bbox->top(),
               bbox->right(), bbox->bottom());
-      DrawRectangle(&buffer, bbox->left(), bbox->top(), bbox->right(),
-                    bbox->bottom(), AITRIOS_COLOR_RED);
+      boxes.push_back({(uint32_t)bbox->left(), (uint32_t)bbox->top(),
+                       (uint32_t)bbox->right(), (uint32_t)bbox->bottom(),
+                       AITRIOS_COLOR_RED, 1});
     }
+    // Draw all the boxes in a single pass over the image
+    struct EdgeAppLibDrawPrimitives primitives = {
+        boxes.data(), (uint32_t)boxes.size(), nullptr, 0, nullptr, 0};
+    DrawPrimitives(&buffer, &primitives);
   }
   if ((res_release_frame = SensorReleaseFrame(s_stream, *frame)) < 0) {
     free(data.address);
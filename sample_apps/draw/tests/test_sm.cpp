@@ -193,7 +193,7 @@ TEST_F(EvenFunctionsTest, OnIterateSendDataSyncMetaError) {
   EXPECT_EQ(wasEdgeAppLibSensorFrameGetChannelFromChannelIdCalled(), 1);
   EXPECT_EQ(wasEdgeAppLibSensorChannelGetRawDataCalled(), 1);
   EXPECT_EQ(wasEdgeAppLibSensorReleaseFrameCalled(), 1);
-  EXPECT_EQ(wasEdgeAppLibDrawRectangleCalled(), 0);
+  EXPECT_EQ(wasEdgeAppLibDrawPrimitivesCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibDataExportAwaitCalled(), 1);
   EXPECT_EQ(wasEdgeAppLibDataExportCleanupCalled(), 1);
   EXPECT_EQ(wasEdgeAppLibDataExportSendDataCalled(), 1);
@@ -213,7 +213,7 @@ TEST_F(EvenFunctionsTest, OnIterateRawDataNull) {
   EXPECT_EQ(wasEdgeAppLibSensorChannelGetRawDataCalled(), 1);
   EXPECT_EQ(wasEdgeAppLibSensorReleaseFrameCalled(), 1);
   EXPECT_EQ(wasDataProcessorAnalyzeCalled(), 1);
-  EXPECT_EQ(wasEdgeAppLibDrawRectangleCalled(), 0);
+  EXPECT_EQ(wasEdgeAppLibDrawPrimitivesCalled(), 0);
   EXPECT_EQ(wasDataProcessorGetDataTypeCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibDataExportAwaitCalled(), 1);
   EXPECT_EQ(wasEdgeAppLibDataExportCleanupCalled(), 1);
@@ -231,7 +231,7 @@ TEST_F(EvenFunctionsTest, OnIterateGetFrameError) {
   EXPECT_EQ(wasEdgeAppLibSensorChannelGetRawDataCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibSensorReleaseFrameCalled(), 0);
   EXPECT_EQ(wasDataProcessorAnalyzeCalled(), 0);
-  EXPECT_EQ(wasEdgeAppLibDrawRectangleCalled(), 0);
+  EXPECT_EQ(wasEdgeAppLibDrawPrimitivesCalled(), 0);
   EXPECT_EQ(wasDataProcessorGetDataTypeCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibDataExportAwaitCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibDataExportCleanupCalled(), 0);
@@ -250,7 +250,7 @@ TEST_F(EvenFunctionsTest, OnIterateGetFrameErrorTimeout) {
   EXPECT_EQ(wasEdgeAppLibSensorChannelGetRawDataCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibSensorReleaseFrameCalled(), 0);
   EXPECT_EQ(wasDataProcessorAnalyzeCalled(), 0);
-  EXPECT_EQ(wasEdgeAppLibDrawRectangleCalled(), 0);
+  EXPECT_EQ(wasEdgeAppLibDrawPrimitivesCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibDataExportAwaitCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibDataExportCleanupCalled(), 0);
   EXPECT_EQ(wasEdgeAppLibDataExportSendDataCalled(), 0);
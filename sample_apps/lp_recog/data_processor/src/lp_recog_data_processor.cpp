@@ -209,15 +209,19 @@ DataProcessorResultCode LPDDataProcessorAnalyze(
 
   FilterByParams(&detections, analyze_params);
 
-  // Update the ROI based on the first detection
-  if (detections->num_detections > 0) {
-    roi->left = detections->detection_data[0].bbox.left;
-    roi->top = detections->detection_data[0].bbox.top;
-    roi->width = detections->detection_data[0].bbox.right -
-                 detections->detection_data[0].bbox.left;
-    roi->height = detections->detection_data[0].bbox.bottom -
-                  detections->detection_data[0].bbox.top;
-  } else {
+  // Update the ROIs based on the first detections
+  lp_param->num_rois = 0;
+  for (int i = 0; i < detections->num_detections &&
+                  lp_param->num_rois < lp_param->max_rois;
+       ++i) {
+    const BBox &bbox = detections->detection_data[i].bbox;
+    roi[i].left = bbox.left;
+    roi[i].top = bbox.top;
+    roi[i].width = bbox.right - bbox.left;
+    roi[i].height = bbox.bottom - bbox.top;
+    lp_param->num_rois++;
+  }
+  if (lp_param->num_rois == 0) {
     LOG_INFO("No objects detected in the metadata.");
   }
 
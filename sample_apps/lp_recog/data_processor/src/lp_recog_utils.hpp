@@ -94,8 +94,10 @@ DataProcessorResultCode ExtractBboxNormIMX500(
     JSON_Object *json, DataProcessorCustomParam_LPD *detection_param);
 
 struct LPAnalysisParam {
-  EdgeAppLibSensorImageCropProperty *roi;
+  EdgeAppLibSensorImageCropProperty *roi;  // Array of max_rois ROIs
   EdgeAppCore::Tensor *tensor;
+  uint32_t max_rois = 1;
+  uint32_t num_rois = 0;  // ROIs updated by the last analysis
 };
 
 struct Prediction {
@@ -467,6 +467,40 @@ TEST_F(ConfigureAnalyzeFixtureTests, CorrectLPDAnalyzeJsonTest) {
   EXPECT_EQ(lp_param.roi->top, 30);
   EXPECT_EQ(lp_param.roi->width, 30);
   EXPECT_EQ(lp_param.roi->height, 30);
+  EXPECT_EQ(lp_param.num_rois, 1u);
+}
+
+TEST_F(ConfigureAnalyzeFixtureTests, MultipleRoisLPDAnalyzeJsonTest) {
+  char *output = NULL;
+  DataProcessorResultCode res = DataProcessorConfigure((char *)config, &output);
+  EXPECT_EQ(res, kDataProcessorOk);
+
+  LPDataProcessorAnalyzeParam param;
+  LPAnalysisParam lp_param;
+  EdgeAppLibSensorImageCropProperty rois[4] = {};
+  lp_param.roi = rois;
+  lp_param.max_rois = 4;
+
+  EdgeAppCore::Tensor test_tensor;
+  test_tensor.data = out_data;
+  test_tensor.size = out_size * sizeof(float);
+  test_tensor.type = EdgeAppCore::TensorTypeFloat32;
+  test_tensor.shape_info.ndim = 4;
+  test_tensor.shape_info.dims[0] = 1;
+  test_tensor.shape_info.dims[1] = 1;
+  test_tensor.shape_info.dims[2] = 4;
+  test_tensor.shape_info.dims[3] = 6;
+  lp_param.tensor = &test_tensor;
+  param.app_specific = &lp_param;
+
+  // Every detection kept by the filter gets its own ROI
+  res = LPDDataProcessorAnalyze(out_data, out_size, &param);
+  EXPECT_EQ(res, kDataProcessorOk);
+  ASSERT_EQ(lp_param.num_rois, 2u);
+  EXPECT_EQ(rois[0].left, 30);
+  EXPECT_EQ(rois[0].width, 30);
+  EXPECT_GT(rois[1].width, 0);
+  EXPECT_GT(rois[1].height, 0);
 }
 
 TEST_F(ConfigureAnalyzeFixtureTests, NullParamLPAnalyzeTest) {
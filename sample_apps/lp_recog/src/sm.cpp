@@ -32,6 +32,10 @@
 
 #define MAX_PATH_LEN 256
 #define DEFAULT_LPR_MODEL_NAME "lp_recognition"
+// Keep the models loaded across onStop/onStart
+#define MODEL_CACHE_LIMIT (16 * 1024 * 1024)
+// Plates read per frame, at most MAX_BATCH_ROIS
+#define MAX_PLATES 4
 
 using namespace EdgeAppLib;
 EdgeAppLibSensorCore s_core = 0;
@@ -62,12 +66,16 @@ static const uint32_t model_count = 2;
 // initialize the models inside onIterate.
 static bool first_flag = true;
 
-EdgeAppLibSensorImageCropProperty roi[2] = {
-    {0, 0, 2028, 1520},
-    {0, 0, 300, 300}  // It must be smaller than input tensor size of imx500
-};                    // These values are initial values.
+EdgeAppLibSensorImageCropProperty roi = {0, 0, 2028, 1520};
+// Plates found by the detection model, read with one batched Process. They
+// must be smaller than input tensor size of imx500. These values are initial
+// values, kept while no plate is detected.
+static EdgeAppLibSensorImageCropProperty plates[MAX_PLATES] = {
+    {0, 0, 300, 300}};
+static uint32_t num_plates = 1;
 int onCreate() {
   LOG_TRACE("Inside onCreate.");
+  EdgeAppCore::SetModelCacheLimit(MODEL_CACHE_LIMIT);
   return 0;
 }
 
@@ -96,7 +104,7 @@ int onIterate() {
   LOG_TRACE("Inside onIterate.");
 
   // Process the frame using the sensor stream
-  auto frame = EdgeAppCore::Process(ctx_imx500, &ctx_imx500, 0, roi[0]);
+  auto frame = EdgeAppCore::Process(ctx_imx500, &ctx_imx500, 0, roi);
   if (frame == 0) {
     LOG_ERR("Failed to get frame from sensor stream.");
     return -1;
@@ -106,7 +114,8 @@ int onIterate() {
 
   LPDataProcessorAnalyzeParam param;
   LPAnalysisParam lp_param;
-  lp_param.roi = &roi[1];
+  lp_param.roi = plates;
+  lp_param.max_rois = MAX_PLATES;
   lp_param.tensor = &output;
   param.app_specific = &lp_param;
 
@@ -117,11 +126,7 @@ int onIterate() {
     LOG_ERR("DataProcessorAnalyze: ret=%d", data_processor_ret);
     return -1;
   }
-
-  LOG_DBG(
-      "roi[1]: [left=%d, top=%d, width=%d, "
-      "height=%d]",
-      roi[1].left, roi[1].top, roi[1].width, roi[1].height);
+  if (lp_param.num_rois > 0) num_plates = lp_param.num_rois;
 
   auto input = EdgeAppCore::GetInput(ctx_imx500, frame);
   if (input.data == nullptr || input.size == 0) {
@@ -130,12 +135,17 @@ int onIterate() {
   }
 
   // Draw rectangles on the input image
-  if (roi[1].width != 0 && roi[1].height != 0) {
-    struct EdgeAppLibDrawBuffer buffer = {input.data, input.size, input.format,
-                                          input.shape_info.dims[2],
-                                          input.shape_info.dims[1]};
-    DrawRectangle(&buffer, roi[1].left, roi[1].top, roi[1].left + roi[1].width,
-                  roi[1].top + roi[1].height, AITRIOS_COLOR_BLUE);
+  struct EdgeAppLibDrawBuffer buffer = {input.data, input.size, input.format,
+                                        input.shape_info.dims[2],
+                                        input.shape_info.dims[1]};
+  for (uint32_t i = 0; i < num_plates; ++i) {
+    const EdgeAppLibSensorImageCropProperty &plate = plates[i];
+    LOG_DBG("plates[%u]: [left=%d, top=%d, width=%d, height=%d]", i,
+            plate.left, plate.top, plate.width, plate.height);
+    if (plate.width != 0 && plate.height != 0) {
+      DrawRectangle(&buffer, plate.left, plate.top, plate.left + plate.width,
+                    plate.top + plate.height, AITRIOS_COLOR_BLUE);
+    }
   }
 
   if (EdgeAppCore::SendInputTensor(&input) != EdgeAppCoreResultSuccess) {
@@ -144,17 +154,21 @@ int onIterate() {
 
   LOG_DBG("Start processing frames for additional models on CPU.");
 
-  for (int i = 1; i < model_count; ++i) {
-    LOG_DBG("model_count=%d, i=%d", model_count, i);
-
-    frame = EdgeAppCore::Process(*ctx_list[i], shared_list[i], frame, roi[i]);
-    if (frame == 0) {
-      LOG_ERR("Failed to process frame for context %d.", i);
-      return -1;
-    }
+  // Read every plate of the frame with the recognition model
+  frame = EdgeAppCore::Process(ctx_cpu, &ctx_imx500, frame, plates, num_plates);
+  if (frame == 0) {
+    LOG_ERR("Failed to process frame for the recognition model.");
+    return -1;
+  }
 
-    EdgeAppCore::Tensor output_cpu =
-        EdgeAppCore::GetOutput(*ctx_list[i], frame, 4);
+  // One output tensor per plate
+  std::vector<EdgeAppCore::Tensor> outputs =
+      EdgeAppCore::GetOutputs(ctx_cpu, frame, 1);
+  if (outputs.empty()) {
+    LOG_ERR("Output tensor is empty or invalid.");
+    return -1;
+  }
+  for (const EdgeAppCore::Tensor &output_cpu : outputs) {
     LOG_INFO("Output tensor size: %zu", output_cpu.size);
     if (output_cpu.data == nullptr || output_cpu.size == 0) {
       LOG_ERR("Output tensor is empty or invalid.");
@@ -176,10 +190,6 @@ int onIterate() {
       }
     }
 
-    if (output_cpu.data) {
-      free(output_cpu.data);  // Always free for CPU model
-      output_cpu.data = nullptr;
-    }
     if (recognized_data != NULL && recognized_data_size > 0) {
       free(recognized_data);
     }
@@ -261,5 +271,6 @@ int onDestroy() {
   for (auto ctx : ctx_list) {
     EdgeAppCore::UnloadModel(*ctx);
   }
+  EdgeAppCore::EvictModel(nullptr);
   return 0;
 }
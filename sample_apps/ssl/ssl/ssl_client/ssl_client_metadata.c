@@ -21,7 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "base64.h"
+#include "base64_codec.h"
 #include "log.h"
 #include "parson.h"
 #include "ssl_client.h"
@@ -44,19 +44,19 @@ static int encode_tensor_to_base64(const unsigned char *data, size_t data_size,
   }
 
   // Calculate required buffer size for base64 encoding
-  unsigned int base64_size = b64e_size((unsigned int)data_size);
+  size_t base64_size = BASE64_ENCODED_SIZE(data_size);
 
   if (base64_size >= feature_str_size) {
-    LOG_ERR("Buffer too small for base64 encoding: required=%u, available=%zu",
+    LOG_ERR("Buffer too small for base64 encoding: required=%zu, available=%zu",
             base64_size, feature_str_size);
     return -1;
   }
 
   // Convert binary tensor data to base64 string
-  unsigned int encoded_size =
-      b64_encode(data, (unsigned int)data_size, (unsigned char *)feature_str);
+  size_t encoded_size = base64_encode(data, data_size, feature_str);
+  feature_str[encoded_size] = '\0';
 
-  LOG_INFO("Converted tensor data to base64: %zu bytes -> %u base64 chars",
+  LOG_INFO("Converted tensor data to base64: %zu bytes -> %zu base64 chars",
            data_size, encoded_size);
 
   return 0;
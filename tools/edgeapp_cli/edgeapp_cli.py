@@ -35,6 +35,8 @@ import paho.mqtt.client as mqtt
 from src.ai_models import AIModel
 from src.modules import Module
 from src.interface import OnWireSchema
+from src.lz4_frame import decompress_frame, is_lz4_frame
+from src.metadata_envelope import decode_envelope, is_envelope
 from colored_logger import get_colored_logger
 
 try:
@@ -2043,6 +2045,11 @@ def main():
       instance_id: Optional Edge App instance UUID (if omitted, CLI tries to auto-detect)
       ps=value: Optional process_state value (ps=0/1/2) or use --process-state
       example: edgeapp_cli send conf configuration.json my_instance_id ps=1
+
+  decode
+    decode <metadata_file>
+      metadata_file: Uploaded metadata: binary (.bin), compressed (.lz4) or both
+      example: edgeapp_cli decode 20240101000000000.bin.lz4
 """
 
     # Custom formatter to remove metavar and improve layout
@@ -2120,8 +2127,28 @@ def main():
     conf_parser.add_argument('--process-state', type=int, choices=[0, 1, 2],
                            help='Set process_state (0=stop, 1=start, 2=restart)')
 
+    # Add 'decode' command
+    decode_parser = subparsers.add_parser('decode', help='Decode uploaded metadata')
+    decode_parser.add_argument('metadata_file', help='Path to uploaded metadata file')
+
     args = parser.parse_args()
 
+    # Decoding is offline: no MQTT broker nor HTTP server needed
+    if args.command == 'decode':
+        try:
+            with open(args.metadata_file, 'rb') as f:
+                data = f.read()
+            if is_lz4_frame(data):
+                data = decompress_frame(data)
+            if is_envelope(data):
+                print(json.dumps(decode_envelope(data), indent=2))
+            else:
+                print(data.decode('utf-8'))
+        except (OSError, ValueError) as e:
+            main_logger.error(f"Failed to decode {args.metadata_file}: {e}")
+            return 1
+        return 0
+
     # Handle command-line argument parsing for send conf command
     if args.command == 'send' and args.send_command == 'conf':
         # Parse positional arguments: [config_file] [instance_id] [ps=value]
@@ -0,0 +1,98 @@
+# Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Decompressor for the LZ4 frames of compressed uploads
+
+Uploads compressed with codec_settings "metadata_compression" or
+"input_tensor_compression" are standard LZ4 frames, as `lz4 -d` reads. This
+avoids depending on the lz4 package for the few files the CLI decodes.
+"""
+
+import struct
+
+MAGIC = 0x184D2204
+
+FLAG_VERSION_MASK = 0xC0
+FLAG_VERSION = 0x40
+FLAG_BLOCK_CHECKSUM = 0x10
+FLAG_CONTENT_SIZE = 0x08
+FLAG_DICT_ID = 0x01
+BLOCK_UNCOMPRESSED = 0x80000000
+
+
+def is_lz4_frame(data: bytes) -> bool:
+    """Check the magic number of an LZ4 frame"""
+    return len(data) >= 4 and struct.unpack_from("<I", data, 0)[0] == MAGIC
+
+
+def _read_length(data, pos, length):
+    if length == 15:
+        while True:
+            byte = data[pos]
+            pos += 1
+            length += byte
+            if byte != 255:
+                break
+    return pos, length
+
+
+def _decompress_block(block: bytes, out: bytearray):
+    pos = 0
+    while pos < len(block):
+        token = block[pos]
+        pos, length = _read_length(block, pos + 1, token >> 4)
+        if pos + length > len(block):
+            raise ValueError("Literals past the end of the block")
+        out += block[pos:pos + length]
+        pos += length
+        if pos == len(block):
+            break
+        offset = struct.unpack_from("<H", block, pos)[0]
+        pos, length = _read_length(block, pos + 2, token & 15)
+        if offset == 0 or offset > len(out):
+            raise ValueError("Invalid match offset")
+        start = len(out) - offset
+        for i in range(length + 4):
+            out.append(out[start + i])
+
+
+def decompress_frame(data: bytes) -> bytes:
+    """Decompress an LZ4 frame. Checksums are not verified."""
+    if not is_lz4_frame(data) or len(data) < 7:
+        raise ValueError("Not an LZ4 frame: missing magic number")
+    flags = data[4]
+    if flags & FLAG_VERSION_MASK != FLAG_VERSION or flags & FLAG_DICT_ID:
+        raise ValueError("Unsupported LZ4 frame")
+    pos = 7 + (8 if flags & FLAG_CONTENT_SIZE else 0)
+    out = bytearray()
+    try:
+        while True:
+            block_size = struct.unpack_from("<I", data, pos)[0]
+            pos += 4
+            if block_size == 0:
+                break
+            size = block_size & ~BLOCK_UNCOMPRESSED
+            block = data[pos:pos + size]
+            if len(block) != size:
+                raise ValueError("Truncated LZ4 block")
+            if block_size & BLOCK_UNCOMPRESSED:
+                out += block
+            else:
+                # Linked blocks may refer to the previous ones: keep a single
+                # output window
+                _decompress_block(block, out)
+            pos += size + (4 if flags & FLAG_BLOCK_CHECKSUM else 0)
+    except (struct.error, IndexError) as e:
+        raise ValueError(f"Truncated LZ4 frame: {e}") from e
+    return bytes(out)
@@ -0,0 +1,130 @@
+# Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Decoder for the binary metadata envelope
+
+The layout is libs/send_data/schemas/metadata_envelope.fbs. Only the few
+FlatBuffers accessors needed for it are implemented, so that the CLI does not
+depend on the flatbuffers package.
+"""
+
+import base64
+import json
+import struct
+from datetime import datetime, timezone
+
+IDENTIFIER = b"EAMD"
+
+# Field indexes, in declaration order of the schema
+ENVELOPE_MODEL_ID = 0
+ENVELOPE_DEVICE_ID = 1
+ENVELOPE_IMAGE = 2
+ENVELOPE_INFERENCES = 3
+INFERENCE_TIMESTAMP = 0
+INFERENCE_OUTPUT = 1
+INFERENCE_FORMAT = 2
+
+FORMAT_JSON = 1
+
+
+class _Table:
+    """Read-only view on a FlatBuffers table"""
+
+    def __init__(self, buf: bytes, pos: int):
+        self.buf = buf
+        self.pos = pos
+        self.vtable = pos - struct.unpack_from("<i", buf, pos)[0]
+        self.vtable_size = struct.unpack_from("<H", buf, self.vtable)[0]
+
+    def _field(self, index):
+        entry = 4 + 2 * index
+        if entry >= self.vtable_size:
+            return 0
+        return struct.unpack_from("<H", self.buf, self.vtable + entry)[0]
+
+    def scalar(self, index, fmt, default=0):
+        offset = self._field(index)
+        if offset == 0:
+            return default
+        return struct.unpack_from("<" + fmt, self.buf, self.pos + offset)[0]
+
+    def _deref(self, index):
+        offset = self._field(index)
+        if offset == 0:
+            return None
+        pos = self.pos + offset
+        return pos + struct.unpack_from("<I", self.buf, pos)[0]
+
+    def bytes(self, index):
+        pos = self._deref(index)
+        if pos is None:
+            return b""
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        return self.buf[pos + 4:pos + 4 + length]
+
+    def string(self, index):
+        return self.bytes(index).decode("utf-8")
+
+    def tables(self, index):
+        pos = self._deref(index)
+        if pos is None:
+            return []
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        result = []
+        for i in range(length):
+            item = pos + 4 + 4 * i
+            result.append(
+                _Table(self.buf,
+                       item + struct.unpack_from("<I", self.buf, item)[0]))
+        return result
+
+
+def _format_timestamp(timestamp_ms):
+    """Format a timestamp as the "T" of the JSON envelope"""
+    seconds, ms = divmod(timestamp_ms, 1000)
+    date = datetime.fromtimestamp(seconds, tz=timezone.utc)
+    return date.strftime("%Y%m%d%H%M%S") + f"{ms:03d}"
+
+
+def is_envelope(data: bytes) -> bool:
+    """Check the file identifier of a binary envelope"""
+    return len(data) >= 8 and data[4:8] == IDENTIFIER
+
+
+def decode_envelope(data: bytes) -> dict:
+    """Decode a binary envelope into its JSON equivalent"""
+    if not is_envelope(data):
+        raise ValueError("Not a metadata envelope: missing identifier")
+    try:
+        root = _Table(data, struct.unpack_from("<I", data, 0)[0])
+        inferences = []
+        for inference in root.tables(ENVELOPE_INFERENCES):
+            output = inference.bytes(INFERENCE_OUTPUT)
+            entry = {"T": _format_timestamp(
+                inference.scalar(INFERENCE_TIMESTAMP, "Q"))}
+            if inference.scalar(INFERENCE_FORMAT, "B") == FORMAT_JSON:
+                entry["O"] = json.loads(output.rstrip(b"\0").decode("utf-8"))
+                entry["F"] = 1
+            else:
+                entry["O"] = base64.b64encode(output).decode("ascii")
+                entry["F"] = 0
+            inferences.append(entry)
+        return {
+            "ModelID": root.string(ENVELOPE_MODEL_ID),
+            "DeviceID": root.string(ENVELOPE_DEVICE_ID),
+            "Image": bool(root.scalar(ENVELOPE_IMAGE, "B")),
+            "Inferences": inferences,
+        }
+    except struct.error as e:
+        raise ValueError(f"Truncated metadata envelope: {e}") from e
@@ -0,0 +1,71 @@
+# Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#!/usr/bin/env python3
+"""
+Tests for the LZ4 frame decompressor
+"""
+
+import os
+import struct
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+from src.lz4_frame import decompress_frame, is_lz4_frame
+
+# Metadata compressed by lz4_compress of libs/common
+EDGE_APP_FRAME = bytes([
+    4, 34, 77, 24, 96, 112, 115, 63, 0, 0, 0, 255, 32, 123, 34, 77, 111, 100,
+    101, 108, 73, 68, 34, 58, 34, 48, 51, 49, 49, 34, 44, 34, 73, 110, 102,
+    101, 114, 101, 110, 99, 101, 115, 34, 58, 91, 123, 34, 84, 34, 58, 34, 49,
+    34, 44, 34, 79, 34, 58, 34, 65, 1, 0, 4, 160, 34, 44, 34, 70, 34, 58, 48,
+    125, 93, 125, 0, 0, 0, 0])
+EDGE_APP_TEXT = (b'{"ModelID":"0311","Inferences":[{"T":"1","O":"'
+                 + b'A' * 24 + b'","F":0}]}')
+
+# `lz4` command line output, with a content checksum
+REFERENCE_FRAME = bytes([
+    0x04, 0x22, 0x4d, 0x18, 0x64, 0x40, 0xa7, 0x12, 0x00, 0x00, 0x00, 0x8f,
+    0x45, 0x64, 0x67, 0x65, 0x41, 0x70, 0x70, 0x20, 0x08, 0x00, 0x18, 0x50,
+    0x65, 0x41, 0x70, 0x70, 0x21, 0x00, 0x00, 0x00, 0x00, 0xf0, 0xc1, 0xda,
+    0xba])
+
+
+class TestLz4Frame(unittest.TestCase):
+    """Test decompression of compressed uploads"""
+
+    def test_decompress(self):
+        self.assertTrue(is_lz4_frame(EDGE_APP_FRAME))
+        self.assertEqual(decompress_frame(EDGE_APP_FRAME), EDGE_APP_TEXT)
+        self.assertEqual(decompress_frame(REFERENCE_FRAME),
+                         b'EdgeApp ' * 6 + b'EdgeApp!')
+
+    def test_decompress_stored_block(self):
+        frame = (bytes([0x04, 0x22, 0x4d, 0x18, 0x60, 0x70, 0x73])
+                 + struct.pack('<I', 3 | 0x80000000) + b'abc'
+                 + struct.pack('<I', 0))
+        self.assertEqual(decompress_frame(frame), b'abc')
+
+    def test_decompress_invalid(self):
+        self.assertFalse(is_lz4_frame(b'{"ModelID":""}'))
+        with self.assertRaises(ValueError):
+            decompress_frame(b'{"ModelID":""}')
+        with self.assertRaises(ValueError):
+            decompress_frame(EDGE_APP_FRAME[:40])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,104 @@
+# Copyright 2024 Sony Semiconductor Solutions Corp. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#!/usr/bin/env python3
+"""
+Tests for the binary metadata envelope decoder
+"""
+
+import os
+import struct
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+from src.metadata_envelope import decode_envelope, is_envelope
+
+
+def build_envelope(model_id, device_id, image, inferences):
+    """Build an envelope laid out as ProcessFormatMetaBinary does"""
+    buf = bytearray()
+
+    def align(n, extra=0):
+        while (len(buf) + extra) % n:
+            buf.append(0)
+
+    def patch(pos):
+        struct.pack_into("<I", buf, pos, len(buf) - pos)
+
+    buf += struct.pack("<I", 0) + b"EAMD"
+    envelope_vtable = len(buf)
+    buf += struct.pack("<6H", 12, 17, 4, 8, 16, 12)
+    inference_vtable = len(buf)
+    buf += struct.pack("<5H", 10, 17, 4, 12, 16)
+    align(4)
+    patch(0)
+    envelope = len(buf)
+    buf += struct.pack("<iIIIB", envelope - envelope_vtable, 0, 0, 0, image)
+    for field, text in ((4, model_id), (8, device_id)):
+        align(4)
+        patch(envelope + field)
+        buf += struct.pack("<I", len(text)) + text.encode() + b"\0"
+    align(4)
+    patch(envelope + 12)
+    buf += struct.pack("<I", len(inferences))
+    vector = len(buf)
+    buf += bytes(4 * len(inferences))
+    for i, (timestamp, output, fmt) in enumerate(inferences):
+        align(8, 4)
+        patch(vector + 4 * i)
+        table = len(buf)
+        buf += struct.pack("<iQIB", table - inference_vtable, timestamp, 0, fmt)
+        align(8, 4)
+        patch(table + 12)
+        buf += struct.pack("<I", len(output)) + output
+    return bytes(buf)
+
+
+class TestMetadataEnvelope(unittest.TestCase):
+    """Test decoding of binary metadata"""
+
+    def test_decode(self):
+        data = build_envelope("0311", "aabbcc", True, [
+            (1700000000123, b"\x01\x02\x03", 0),
+            (1700000000456, b'{"score":0.5}\0', 1),
+        ])
+        self.assertTrue(is_envelope(data))
+        self.assertEqual(decode_envelope(data), {
+            "ModelID": "0311",
+            "DeviceID": "aabbcc",
+            "Image": True,
+            "Inferences": [
+                {"T": "20231114221320123", "O": "AQID", "F": 0},
+                {"T": "20231114221320456", "O": {"score": 0.5}, "F": 1},
+            ],
+        })
+
+    def test_decode_empty(self):
+        data = build_envelope("", "", False, [])
+        self.assertEqual(decode_envelope(data), {
+            "ModelID": "", "DeviceID": "", "Image": False, "Inferences": []})
+
+    def test_decode_invalid(self):
+        self.assertFalse(is_envelope(b'{"ModelID":""}'))
+        with self.assertRaises(ValueError):
+            decode_envelope(b'{"ModelID":""}')
+        data = build_envelope("0311", "aabbcc", False, [(0, b"\x01", 0)])
+        with self.assertRaises(ValueError):
+            decode_envelope(data[:48])
+
+
+if __name__ == '__main__':
+    unittest.main()